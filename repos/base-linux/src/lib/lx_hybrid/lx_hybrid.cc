@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2011-2017 Genode Labs GmbH
+ * Copyright (C) 2011-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -563,6 +563,8 @@ Thread::~Thread()
 
 	_native_thread = nullptr;
 
+	release_magazine_heap_caches(*this);
+
 	/* inform core about the killed thread */
 	_cpu_session->kill_thread(_thread_cap);
 }
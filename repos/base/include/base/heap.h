@@ -25,6 +25,8 @@ namespace Genode {
 
 	class Heap;
 	class Sliced_heap;
+	class Magazine_heap;
+	class Thread;
 }
 
 
@@ -229,4 +231,176 @@ class Genode::Sliced_heap : public Allocator
 		bool   need_size_for_free()  const override { return false; }
 };
 
+
+/**
+ * Per-thread cache of small blocks in front of a 'Heap'
+ *
+ * Small allocations are served from size-class magazines that are private to
+ * the calling thread and thereby do not touch any shared lock. Only when a
+ * thread's magazine runs empty or overflows, a batch of blocks is exchanged
+ * with a lock-protected depot. The depot is shared by all threads, which
+ * makes it safe to free a block from a thread different from the one that
+ * allocated it. All cached blocks are allocated from the backing heap, which
+ * thereby stays in charge of the quota accounting.
+ *
+ * Threads are assigned a cache slot on their first allocation. When a
+ * thread is destructed, its blocks are returned to the depot and its slot
+ * becomes available to other threads. Once all slots are taken, the
+ * remaining threads are served from the depot. If the backing heap runs out
+ * of quota, the blocks cached by all threads are released to the heap.
+ */
+class Genode::Magazine_heap : public Allocator
+{
+	public:
+
+		enum {
+			NUM_SIZE_CLASSES = 8,   /* block sizes 32 ... 4096 bytes */
+			MAGAZINE_ROUNDS  = 32,  /* blocks per thread and size class */
+			DEPOT_LIMIT      = 256, /* blocks per size class kept at depot */
+			MAX_THREADS      = 32,  /* number of thread caches */
+		};
+
+	private:
+
+		/*
+		 * The header preserves the 16-byte alignment of the backing heap
+		 */
+		struct Block_header
+		{
+			enum { DIRECT = ~0UL };
+
+			unsigned long size_class;
+			unsigned long padding;
+		};
+
+		/**
+		 * Block kept at the depot, stored in place of the block content
+		 */
+		struct Free_block { Free_block *next; };
+
+		struct Magazine
+		{
+			void    *rounds[MAGAZINE_ROUNDS];
+			unsigned count;
+		};
+
+		struct Thread_cache
+		{
+			int volatile     claimed;
+			Thread *volatile owner;
+
+			/* taken by the owner and by threads draining the cache */
+			Lock             lock { };
+
+			Magazine         magazines[NUM_SIZE_CLASSES];
+		};
+
+		struct Depot_class
+		{
+			Free_block *head;
+			unsigned    count;
+		};
+
+		Heap &_heap;
+
+		/* element of the list of all magazine heaps */
+		List_element<Magazine_heap> _list_element { this };
+
+		Lock        mutable _depot_lock { };
+		Depot_class         _depot[NUM_SIZE_CLASSES] { };
+		Thread_cache        _caches[MAX_THREADS]     { };
+
+		static size_t _class_size(unsigned c) { return 32UL << c; }
+
+		/**
+		 * Return size class for requested block size including header
+		 *
+		 * \return  NUM_SIZE_CLASSES if the block is too large to be cached
+		 */
+		static unsigned _size_class(size_t size)
+		{
+			unsigned c = 0;
+			for (; c < NUM_SIZE_CLASSES && _class_size(c) < size; c++);
+			return c;
+		}
+
+		/**
+		 * Return cache of calling thread, claim a free slot if needed
+		 *
+		 * \return  nullptr if no slot is available
+		 */
+		Thread_cache *_thread_cache();
+
+		/**
+		 * Move up to 'count' blocks from the depot into 'magazine'
+		 */
+		void _refill_from_depot(unsigned c, Magazine &magazine, unsigned count);
+
+		/**
+		 * Move 'count' blocks from 'magazine' to the depot
+		 */
+		void _spill_to_depot(unsigned c, Magazine &magazine, unsigned count);
+
+		void *_alloc_from_depot(unsigned c);
+		void  _free_to_depot(unsigned c, void *block);
+
+		/**
+		 * Allocate block of 'size' bytes from the backing heap
+		 *
+		 * If the heap is out of quota, the blocks cached at the depot and
+		 * by all threads are released to the heap before retrying. The
+		 * caller must not hold the lock of its thread cache.
+		 */
+		void *_alloc_from_heap(size_t size);
+
+		/**
+		 * Release all blocks held by the depot to the backing heap
+		 */
+		void _flush_depot();
+
+		void _flush_magazines(Thread_cache &);
+
+		/**
+		 * Return blocks of all thread caches to the depot
+		 */
+		void _flush_thread_caches();
+
+		/*
+		 * Noncopyable
+		 */
+		Magazine_heap(Magazine_heap const &);
+		Magazine_heap &operator = (Magazine_heap const &);
+
+	public:
+
+		Magazine_heap(Heap &heap);
+
+		~Magazine_heap();
+
+		/**
+		 * Return cached blocks of 'thread' to the depot
+		 *
+		 * The cache slot of the thread is released. This is done
+		 * automatically when the thread is destructed.
+		 */
+		void release_thread_cache(Thread const &thread);
+
+		/**
+		 * Return cached blocks of the calling thread to the depot
+		 */
+		void flush_thread_cache();
+
+
+		/*************************
+		 ** Allocator interface **
+		 *************************/
+
+		bool   alloc(size_t, void **) override;
+		void   free(void *, size_t) override;
+		size_t consumed() const override { return _heap.consumed(); }
+		size_t overhead(size_t size) const override {
+			return sizeof(Block_header) + _heap.overhead(size); }
+		bool   need_size_for_free() const override { return false; }
+};
+
 #endif /* _INCLUDE__BASE__HEAP_H_ */
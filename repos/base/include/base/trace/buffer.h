@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2013-2017 Genode Labs GmbH
+ * Copyright (C) 2013-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -15,6 +15,8 @@
 #define _INCLUDE__BASE__TRACE__BUFFER_H_
 
 #include <base/stdint.h>
+#include <cpu/atomic.h>
+#include <cpu/memory_barrier.h>
 #include <cpu_session/cpu_session.h>
 
 namespace Genode { namespace Trace { class Buffer; } }
@@ -22,38 +24,92 @@ namespace Genode { namespace Trace { class Buffer; } }
 
 /**
  * Buffer shared between CPU client thread and TRACE client
+ *
+ * Entries are addressed by their sequence number, which is the position of
+ * the entry within the endless stream of bytes written to the buffer. The
+ * offset of an entry within the buffer is its sequence number modulo the
+ * buffer size. An entry never crosses the buffer boundary. If it does not
+ * fit at the end of the buffer, the remaining space is skipped and the entry
+ * starts the next lap at offset 0.
+ *
+ * Space is reserved by atomically advancing the head, which allows multiple
+ * writers to share one buffer. Each entry carries its sequence number, which
+ * is published by the writer after the entry content is complete. A reader
+ * that expects an entry at a given sequence number can thereby tell whether
+ * the entry is not yet committed or was already overwritten by a later lap.
  */
 class Genode::Trace::Buffer
 {
+	public:
+
+		/*
+		 * Version of the buffer layout, to be checked by TRACE clients
+		 */
+		enum { VERSION = 2 };
+
 	private:
 
-		unsigned volatile _head_offset;  /* in bytes, relative to 'entries' */
+		unsigned volatile _version;      /* layout of buffer */
+		unsigned volatile _head;         /* sequence number of next entry */
 		unsigned volatile _size;         /* in bytes */
 		unsigned volatile _wrapped;      /* count of buffer wraps */
+		unsigned volatile _dropped;      /* count of too large entries */
 
 		struct _Entry
 		{
-			size_t len;
-			char   data[0];
+			unsigned volatile seq;   /* valid once the entry is committed */
+			unsigned          size;  /* reserved bytes following the header */
+			size_t            len;   /* used bytes, 0 for padding */
+			char              data[0];
 		};
 
 		_Entry _entries[0];
 
-		_Entry *_head_entry() { return (_Entry *)((addr_t)_entries + _head_offset); }
+		/*
+		 * The 'entries' member marks the beginning of the trace buffer
+		 * entries. No other member variables must follow.
+		 */
+
+		enum { ALIGN = sizeof(size_t) - 1 };
 
-		void _buffer_wrapped()
-		{
-			_head_offset = 0;
-			_wrapped++;
+		static size_t _aligned(size_t len) { return (len + ALIGN) & ~(size_t)ALIGN; }
+
+		unsigned _offset(unsigned seq) const { return seq % _size; }
 
-			/* mark first entry with len 0 */
-			_head_entry()->len = 0;
+		_Entry *_entry(unsigned seq) {
+			return (_Entry *)((addr_t)_entries + _offset(seq)); }
+
+		_Entry const *_entry(unsigned seq) const {
+			return (_Entry const *)((addr_t)_entries + _offset(seq)); }
+
+		/**
+		 * Return sequence number of the first entry of the lap after 'seq'
+		 *
+		 * Sequence numbers restart at 0 before overflowing so that each lap
+		 * starts at offset 0.
+		 */
+		unsigned _next_lap(unsigned seq) const
+		{
+			unsigned const next = seq - _offset(seq) + _size;
+			return (next > ~0U - _size) ? 0 : next;
 		}
 
-		/*
-		 * The 'entries' member marks the beginning of the trace buffer
-		 * entries. No other member variables must follow.
+		/**
+		 * Skip space at the end of the buffer that cannot hold a header
 		 */
+		unsigned _skip_tail(unsigned seq) const
+		{
+			return (_offset(seq) + sizeof(_Entry) > _size) ? _next_lap(seq) : seq;
+		}
+
+		static void _atomic_inc(unsigned volatile &value)
+		{
+			for (;;) {
+				unsigned const old = value;
+				if (cmpxchg((int volatile *)&value, (int)old, (int)(old + 1)))
+					return;
+			}
+		}
 
 	public:
 
@@ -63,46 +119,108 @@ class Genode::Trace::Buffer
 
 		void init(size_t size)
 		{
-			_head_offset = 0;
-
 			/* compute number of bytes available for tracing data */
 			size_t const header_size = (addr_t)&_entries - (addr_t)this;
 
-			_size = size - header_size;
-
+			_size    = (unsigned)((size - header_size) & ~(size_t)ALIGN);
+			_head    = 0;
 			_wrapped = 0;
+			_dropped = 0;
+
+			/* the initially zeroed first entry must not appear as committed */
+			_entries[0].seq = ~0U;
+
+			memory_barrier();
+			_version = VERSION;
 		}
 
+		/**
+		 * Reserve space for an entry of up to 'len' bytes
+		 *
+		 * \return  pointer to entry payload, or nullptr if the entry does
+		 *          not fit into the buffer
+		 *
+		 * The reservation must be completed by calling 'commit'.
+		 */
 		char *reserve(size_t len)
 		{
-			if (_head_offset + sizeof(_Entry) + len <= _size)
-				return _head_entry()->data;
-
-			/* mark last entry with len 0 and wrap */
-			if (_head_offset + sizeof(_Entry) <= _size)
-				_head_entry()->len = 0;
-
-			_buffer_wrapped();
-
-			return _head_entry()->data;
+			size_t const need = sizeof(_Entry) + _aligned(len);
+			if (need > _size) {
+				_atomic_inc(_dropped);
+				return nullptr;
+			}
+
+			unsigned old_head = 0, seq = 0;
+			for (;;) {
+				old_head = _head;
+				seq      = _skip_tail(old_head);
+
+				/* start next lap if the entry does not fit at the end */
+				if (_offset(seq) + need > _size)
+					seq = _next_lap(seq);
+
+				if (cmpxchg((int volatile *)&_head, (int)old_head,
+				            (int)(seq + need)))
+					break;
+			}
+
+			if (seq != old_head) {
+
+				/* mark skipped space at the end of the buffer as padding */
+				if (_skip_tail(old_head) == old_head) {
+					_Entry &padding = *_entry(old_head);
+					padding.size = _size - _offset(old_head) - sizeof(_Entry);
+					padding.len  = 0;
+					memory_barrier();
+					padding.seq  = old_head;
+				}
+				_atomic_inc(_wrapped);
+			}
+
+			_Entry &e = *_entry(seq);
+			e.seq  = seq - 1;
+			memory_barrier();
+			e.size = (unsigned)(need - sizeof(_Entry));
+			e.len  = 0;
+
+			return e.data;
 		}
 
-		void commit(size_t len)
+		/**
+		 * Publish entry reserved via 'reserve' with 'len' bytes of payload
+		 *
+		 * An entry with a length of 0 is discarded. If another reservation
+		 * followed in the meantime, its space stays occupied by padding,
+		 * which is skipped by the reader.
+		 */
+		void commit(char *data, size_t len)
 		{
-			/* omit empty entries */
-			if (len == 0)
+			if (!data)
 				return;
 
-			_head_entry()->len = len;
+			_Entry &e = *(_Entry *)(data - sizeof(_Entry));
+
+			/* 'reserve' marked the entry with its sequence number minus 1 */
+			unsigned const seq = e.seq + 1;
 
-			/* advance head offset, wrap when reaching buffer boundary */
-			_head_offset += sizeof(_Entry) + len;
-			if (_head_offset == _size)
-				_buffer_wrapped();
+			unsigned const reserved_end = seq + sizeof(_Entry) + e.size;
 
-			/* mark entry next to new entry with len 0 */
-			else if (_head_offset + sizeof(_Entry) <= _size)
-				_head_entry()->len = 0;
+			/* give back the whole reservation of an empty entry */
+			if (len == 0 && _head == reserved_end
+			 && cmpxchg((int volatile *)&_head, (int)reserved_end, (int)seq))
+				return;
+
+			/*
+			 * Give back unused space if no other reservation followed
+			 */
+			unsigned const used_end = seq + sizeof(_Entry) + (unsigned)_aligned(len);
+			if (used_end < reserved_end && _head == reserved_end
+			 && cmpxchg((int volatile *)&_head, (int)reserved_end, (int)used_end))
+				e.size = (unsigned)_aligned(len);
+
+			e.len = len;
+			memory_barrier();
+			e.seq = seq;
 		}
 
 		unsigned wrapped() const { return _wrapped; }
@@ -112,70 +230,123 @@ class Genode::Trace::Buffer
 		 ** Functions called from the TRACE client **
 		 ********************************************/
 
+		unsigned version() const { return _version; }
+
+		/**
+		 * Return number of entries that did not fit into the buffer
+		 */
+		unsigned dropped() const { return _dropped; }
+
 		class Entry
 		{
 			private:
 
 				_Entry const *_entry;
+				unsigned      _seq;
 
 				friend class Buffer;
 
-				Entry(_Entry const *entry) : _entry(entry) { }
+				Entry(_Entry const *entry, unsigned seq)
+				: _entry(entry), _seq(seq) { }
 
 			public:
 
 				size_t      length() const { return _entry->len; }
 				char const *data()   const { return _entry->data; }
+				unsigned    seq()    const { return _seq; }
 
-				/*
-				 * XXX The meaning of this method is irritating.
-				 *
-				 * If it returns 'true', it means either that the entry marks
-				 * the empty padding after the entry with the highest memory
-				 * address or that it actually marks the end of the buffer
-				 * according to commit order. This is an example state of the
-				 * buffer with the two types of "last" entry:
-				 *
-				 * +-------------+------------+---+---------+-------------+------------+---+-------+
-				 * | len3  data3 | len4 data4 | 0 | empty   | len1  data1 | len2 data2 | 0 | empty |
-				 * +-------------+------------+---+---------+-------------+------------+---+-------+
-				 *
-				 * If the entry with the highest memory address fits
-				 * perfectly, the first type of "last" entry is not needed:
+				/**
+				 * Return true if the entry was overwritten in the meantime
+				 */
+				bool overwritten() const { return _entry->seq != _seq; }
+		};
+
+		/**
+		 * Read position of a TRACE client
+		 */
+		class Reader
+		{
+			private:
+
+				unsigned _seq      = 0;
+				unsigned _overruns = 0;
+
+			public:
+
+				/**
+				 * Return how often the writer overtook the reader
 				 *
-				 * +------------+--------------------+---+-------+-------------+-------------------+
-				 * | len3 data3 | len4         data4 | 0 | empty | len1  data1 | len2        data2 |
-				 * +------------+--------------------+---+-------+-------------+-------------------+
+				 * Each overrun means that one or more entries got lost.
+				 */
+				unsigned overruns() const { return _overruns; }
+
+				/**
+				 * Call 'fn' for each committed entry not yet read
 				 *
-				 * If the buffer didn't wrap so far, there is only one "last"
-				 * entry that has both meanings:
+				 * The functor is called with an 'Entry' as argument and
+				 * returns false to stop the iteration. An entry on which the
+				 * iteration stopped is passed again on the next call.
 				 *
-				 * +--------------------------+------------+-------------+---+---------------------+
-				 * | len1               data1 | len2 data2 | len3  data3 | 0 | empty               |
-				 * +--------------------------+------------+-------------+---+---------------------+
+				 * \param update  if false, the read position is not advanced
 				 */
-				bool last() const { return _entry == 0; }
-		};
+				template <typename FN>
+				void for_each_new_entry(Buffer const &buffer, FN const &fn,
+				                        bool update = true)
+				{
+					if (buffer.version() != VERSION)
+						return;
 
-		Entry first() const
-		{
-			return _entries->len ? Entry(_entries) : Entry(0);
-		}
+					unsigned seq      = _seq;
+					bool     resynced = false;
 
-		Entry next(Entry entry) const
-		{
-			if (entry.last())
-				return Entry(0);
+					for (;;) {
 
-			if (entry.length() == 0)
-				return Entry(0);
+						seq = buffer._skip_tail(seq);
 
-			addr_t const offset = (addr_t)entry._entry - (addr_t)_entries;
-			if (offset + entry.length() + sizeof(_Entry) > _size)
-				return Entry(0);
+						_Entry const &e = *buffer._entry(seq);
 
-			return Entry((_Entry const *)((addr_t)entry.data() + entry.length()));
-		}
+						int const diff = (int)(e.seq - seq);
+
+						/* entry not yet committed */
+						if (diff < 0)
+							break;
+
+						/*
+						 * The writer overtook us, continue at the oldest lap
+						 * start that is still intact.
+						 */
+						if (diff > 0) {
+							if (resynced)
+								break;
+
+							_overruns++;
+							unsigned const head = buffer._head;
+							seq = head - buffer._offset(head);
+							resynced = true;
+							continue;
+						}
+
+						memory_barrier();
+
+						Entry const entry(&e, seq);
+						unsigned const next = seq + sizeof(_Entry) + e.size;
+
+						if (entry.length() && !fn(entry))
+							break;
+
+						/* detect entry being torn by the writer while reading */
+						if (entry.overwritten()) {
+							_overruns++;
+							continue;
+						}
+
+						seq = next;
+					}
+
+					if (update)
+						_seq = seq;
+				}
+		};
 };
 
 #endif /* _INCLUDE__BASE__TRACE__BUFFER_H_ */
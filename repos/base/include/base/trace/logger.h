@@ -76,7 +76,9 @@ struct Genode::Trace::Logger
 		{
 			if (!this || !_evaluate_control()) return;
 
-			buffer->commit(event->generate(*policy_module, buffer->reserve(max_event_size)));
+			char * const dst = buffer->reserve(max_event_size);
+			if (dst)
+				buffer->commit(dst, event->generate(*policy_module, dst));
 		}
 };
 
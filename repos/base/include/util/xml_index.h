@@ -0,0 +1,299 @@
+/*
+ * \brief  Pre-parsed view of XML data
+ * \author Genode Labs
+ * \date   2019-10-27
+ *
+ * An 'Xml_node' validates its structure by searching the matching end tag
+ * whenever it is constructed. Walking a large document via 'sub_node',
+ * 'next', and 'for_each_sub_node' therefore scans the same data over and
+ * over. The 'Xml_index' parses the data once and records the offsets of all
+ * nodes and attributes along with their relations. The 'Xml_node' objects
+ * obtained from the index share the index and navigate to sub nodes, siblings,
+ * and attributes without scanning the XML data.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__UTIL__XML_INDEX_H_
+#define _INCLUDE__UTIL__XML_INDEX_H_
+
+#include <util/noncopyable.h>
+#include <util/xml_node.h>
+#include <base/allocator.h>
+
+namespace Genode { class Xml_index; }
+
+
+/**
+ * Index of the nodes and attributes of XML data
+ *
+ * The memory needed for the index is allocated as one block at construction
+ * time. Its size is bounded by the number of '<' and '=' characters of the
+ * XML data. The XML data and the index must outlive all 'Xml_node' objects
+ * obtained from the index.
+ */
+class Genode::Xml_index : Noncopyable
+{
+	private:
+
+		typedef Xml_node::Token   Token;
+		typedef Xml_node::Tag     Tag;
+		typedef Xml_node::Comment Comment;
+		typedef Xml_node::Index   Index;
+
+		enum : uint32_t { NONE = Index::NONE };
+
+		/*
+		 * Noncopyable
+		 */
+		Xml_index(Xml_index const &);
+		Xml_index &operator = (Xml_index const &);
+
+		Allocator &_alloc;
+
+		char const * const _base;
+		size_t       const _len;
+
+		size_t const _max_nodes;
+		size_t const _max_attributes;
+
+		size_t const _alloc_size = _max_nodes*sizeof(Index::Node)
+		                         + _max_attributes*sizeof(uint32_t);
+
+		void * const _block = _alloc_size ? _alloc.alloc(_alloc_size) : nullptr;
+
+		Index::Node * const _nodes      = (Index::Node *)_block;
+		uint32_t    * const _attributes = (uint32_t *)(_nodes + _max_nodes);
+
+		size_t _num_nodes      = 0;
+		size_t _num_attributes = 0;
+
+		Index _index { _base, _len, _nodes, _attributes, false };
+
+		/**
+		 * Return length of XML data, limited to the range of the index offsets
+		 */
+		static size_t _data_len(char const *base, size_t len)
+		{
+			size_t i = 0;
+			for (; i < len && i < NONE && base[i]; i++);
+			return i;
+		}
+
+		/**
+		 * Return upper bound of the number of nodes
+		 *
+		 * Each start tag begins with '<' followed by the tag name.
+		 */
+		static size_t _count_nodes(char const *base, size_t len)
+		{
+			size_t result = 0;
+			for (size_t i = 0; i + 1 < len; i++)
+				if (base[i] == '<' && base[i + 1] != '/' && base[i + 1] != '!')
+					result++;
+			return result;
+		}
+
+		/**
+		 * Return upper bound of the number of attributes
+		 */
+		static size_t _count_attributes(char const *base, size_t len)
+		{
+			size_t result = 0;
+			for (size_t i = 0; i < len; i++)
+				result += (base[i] == '=');
+			return result;
+		}
+
+		uint32_t _offset(Token t) const { return (uint32_t)(t.start() - _base); }
+
+		/**
+		 * Return true if the end tag matches the start tag of the node
+		 */
+		bool _matches(Index::Node const &node, Tag const &end) const
+		{
+			Token const name = Token(_base + node.start, _len - node.start).next();
+
+			return name.len() == end.name().len()
+			    && !strcmp(name.start(), end.name().start(), name.len());
+		}
+
+		/**
+		 * Add node for the given start or empty-element tag
+		 *
+		 * \param parent      innermost node without end tag, or NONE
+		 * \param last_top    last node at the top level
+		 */
+		uint32_t _add_node(Tag const &tag, uint32_t parent, uint32_t &last_top)
+		{
+			uint32_t const i = (uint32_t)_num_nodes++;
+
+			Index::Node &node = _nodes[i];
+
+			node.start          = _offset(tag.token());
+			node.end            = NONE;
+			node.first_sub_node = NONE;
+			node.next           = NONE;
+			node.num_sub_nodes  = 0;
+			node.attributes     = (uint32_t)_num_attributes;
+
+			/* the tag is valid, so its attributes are well formed */
+			for (Token t = tag.name().next().eat_whitespace();
+			     t.type() == Token::IDENT && _num_attributes < _max_attributes;
+			     t = t.next().next().next().eat_whitespace())
+				_attributes[_num_attributes++] = _offset(t);
+
+			node.num_attributes = (uint32_t)_num_attributes - node.attributes;
+
+			/*
+			 * While a node is open, its 'next' member refers to its last sub
+			 * node. It becomes the link to the next sibling when the node is
+			 * closed.
+			 */
+			uint32_t &last = (parent == NONE) ? last_top : _nodes[parent].next;
+
+			if (parent != NONE) {
+				_nodes[parent].num_sub_nodes++;
+				if (last == NONE)
+					_nodes[parent].first_sub_node = i;
+			}
+
+			if (last != NONE)
+				_nodes[last].next = i;
+
+			last = i;
+			return i;
+		}
+
+		/**
+		 * Parse XML data
+		 *
+		 * The nesting of nodes is tracked in the same way as by
+		 * 'Xml_node::_search_end_tag'. As long as a node is open, its 'end'
+		 * member holds the number of its parent node.
+		 */
+		void _build()
+		{
+			uint32_t open     = NONE;
+			uint32_t last_top = NONE;
+
+			Token t(_base, _len);
+			while (t.type() != Token::END) {
+
+				Comment const comment(t);
+				if (comment.valid()) {
+					t = comment.next_token();
+					continue;
+				}
+
+				Tag tag { };
+				try { tag = Tag(t); }
+				catch (Xml_node::Invalid_syntax) {
+					_index.syntax_error = true;
+					break;
+				}
+
+				if (tag.type() == Tag::INVALID) {
+					t = t.next();
+					continue;
+				}
+
+				if (tag.node() && _num_nodes < _max_nodes) {
+
+					uint32_t const i = _add_node(tag, open, last_top);
+
+					if (tag.type() == Tag::EMPTY) {
+						_nodes[i].end = _nodes[i].start;
+					} else {
+						_nodes[i].end = open;
+						open = i;
+					}
+				}
+
+				/* a stray end tag terminates the sequence of top-level nodes */
+				if (tag.type() == Tag::END && open == NONE)
+					last_top = NONE;
+
+				if (tag.type() == Tag::END && open != NONE) {
+
+					Index::Node &node = _nodes[open];
+
+					open      = node.end;
+					node.next = NONE;
+					node.end  = _matches(node, tag) ? _offset(tag.token()) : NONE;
+				}
+
+				t = tag.next_token();
+			}
+
+			/* nodes without end tag are invalid */
+			while (open != NONE) {
+				Index::Node &node = _nodes[open];
+				open      = node.end;
+				node.next = NONE;
+				node.end  = NONE;
+			}
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param alloc  allocator used for the index
+		 * \param base   XML data
+		 * \param len    length of XML data in bytes
+		 *
+		 * \throw Allocator::Out_of_memory
+		 */
+		Xml_index(Allocator &alloc, char const *base, size_t len)
+		:
+			_alloc(alloc), _base(base), _len(_data_len(base, len)),
+			_max_nodes(_count_nodes(_base, _len)),
+			_max_attributes(_count_attributes(_base, _len))
+		{
+			_build();
+		}
+
+		/**
+		 * Constructor for indexing the data of an existing XML node
+		 */
+		Xml_index(Allocator &alloc, Xml_node const &node)
+		:
+			Xml_index(alloc, node._addr, node.size())
+		{ }
+
+		~Xml_index()
+		{
+			if (_block)
+				_alloc.free(_block, _alloc_size);
+		}
+
+		/**
+		 * Return top-level node of the XML data
+		 *
+		 * \throw Xml_node::Invalid_syntax
+		 */
+		Xml_node xml() const
+		{
+			Token const first = Xml_node::skip_non_tag_characters(Token(_base, _len));
+
+			if (_num_nodes && first.start() == _base + _nodes[0].start)
+				return Xml_node(_index, 0, _base);
+
+			/* let the regular 'Xml_node' report the error */
+			return Xml_node(_base, _len);
+		}
+
+		/**
+		 * Return number of indexed nodes
+		 */
+		size_t num_nodes() const { return _num_nodes; }
+};
+
+#endif /* _INCLUDE__UTIL__XML_INDEX_H_ */
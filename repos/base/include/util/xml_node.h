@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2007-2017 Genode Labs GmbH
+ * Copyright (C) 2007-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -20,6 +20,7 @@
 namespace Genode {
 	class Xml_attribute;
 	class Xml_node;
+	class Xml_index;
 }
 
 
@@ -291,6 +292,12 @@ class Genode::Xml_node
 
 			public:
 
+				/**
+				 * Constructor for a tag already validated by 'Xml_index'
+				 */
+				Tag(Token token, Token name, Type type)
+				: _token(token), _name(name), _type(type) { }
+
 				/**
 				 * Constructor
 				 *
@@ -322,13 +329,22 @@ class Genode::Xml_node
 					if (_name.type() != Token::IDENT)
 						return;
 
-					/* skip attributes to find tag delimiter */
+					/*
+					 * Skip attributes to find tag delimiter. The checks
+					 * correspond to those of the 'Xml_attribute' constructor
+					 * but avoid the exception at the end of the attributes.
+					 */
 					Token delimiter = _name.next();
 					if (supposed_type != END)
-						try {
-							for (Xml_attribute a = _name.next(); ; a = a._next())
-								delimiter = a._next();
-						} catch (Nonexistent_attribute) { }
+						for (Token a = delimiter.eat_whitespace();
+						     a.type() == Token::IDENT;
+						     a = delimiter.eat_whitespace()) {
+
+							if (a.next()[0] != '=' || a.next().next().type() != Token::STRING)
+								throw Invalid_syntax();
+
+							delimiter = a.next().next().next();
+						}
 
 					delimiter = delimiter.eat_whitespace();
 
@@ -505,6 +521,36 @@ class Genode::Xml_node
 			}
 		};
 
+		/**
+		 * Structure of XML data as pre-parsed by 'Xml_index'
+		 *
+		 * Nodes are numbered in document order. All offsets are relative to
+		 * the start of the XML data.
+		 */
+		struct Index
+		{
+			enum : uint32_t { NONE = ~0U };
+
+			struct Node
+			{
+				uint32_t start;           /* offset of start tag */
+				uint32_t end;             /* offset of end tag, NONE if invalid */
+				uint32_t first_sub_node;  /* NONE if there is no sub node */
+				uint32_t next;            /* next node of the same parent */
+				uint32_t num_sub_nodes;
+				uint32_t attributes;      /* first entry of the node in 'attributes' */
+				uint32_t num_attributes;
+			};
+
+			char     const *base;
+			size_t          len;
+			Node     const *nodes;
+			uint32_t const *attributes;  /* offsets of the attribute names */
+			bool            syntax_error;  /* parsing stopped at a malformed tag */
+		};
+
+		friend class Xml_index;
+
 		int _num_sub_nodes { 0 }; /* number of immediate sub nodes */
 
 		char const * _addr;       /* first character of XML data */
@@ -512,6 +558,10 @@ class Genode::Xml_node
 		Tag          _start_tag;
 		Tag          _end_tag;
 
+		/* index and node number, if the node is part of an 'Xml_index' */
+		Index const *_index      = nullptr;
+		uint32_t     _index_node = 0;
+
 		/**
 		 * Search matching end tag for given start tag and detemine number of
 		 * immediate sub nodes along the way.
@@ -630,6 +680,72 @@ class Genode::Xml_node
 		 */
 		char const *_content_base() const { return _start_tag.next_token().start(); }
 
+		/**
+		 * Return start or end tag of an indexed node
+		 *
+		 * \throw Invalid_syntax  node has no matching end tag
+		 */
+		static Tag _indexed_tag(Index const &index, Index::Node const &node,
+		                        bool end_tag)
+		{
+			if (node.end == Index::NONE)
+				throw Invalid_syntax();
+
+			bool     const empty  = (node.end == node.start);
+			uint32_t const offset = end_tag ? node.end : node.start;
+			Token    const token(index.base + offset, index.len - offset);
+
+			if (end_tag && !empty)
+				return Tag(token, token.next().next(), Tag::END);
+
+			return Tag(token, token.next(), empty ? Tag::EMPTY : Tag::START);
+		}
+
+		/**
+		 * Constructor used by 'Xml_index'
+		 *
+		 * \param addr  start of the node data, which may precede the start
+		 *              tag in the same way as for the regular constructor
+		 *
+		 * \throw Invalid_syntax
+		 */
+		Xml_node(Index const &index, uint32_t node, char const *addr)
+		:
+			_num_sub_nodes((int)index.nodes[node].num_sub_nodes),
+			_addr(addr),
+			_max_len(index.len - (addr - index.base)),
+			_start_tag(_indexed_tag(index, index.nodes[node], false)),
+			_end_tag(_indexed_tag(index, index.nodes[node], true)),
+			_index(&index), _index_node(node)
+		{ }
+
+		/**
+		 * Return first sub node
+		 *
+		 * \throw Nonexistent_sub_node
+		 * \throw Invalid_syntax
+		 */
+		Xml_node _first_sub_node() const
+		{
+			if (!_index)
+				return _sub_node(_content_base());
+
+			uint32_t const first = _index->nodes[_index_node].first_sub_node;
+			if (first == Index::NONE)
+				throw Nonexistent_sub_node();
+
+			return Xml_node(*_index, first, _content_base());
+		}
+
+		/**
+		 * Return attribute of an indexed node
+		 */
+		Xml_attribute _indexed_attribute(uint32_t i) const
+		{
+			uint32_t const offset = _index->attributes[i];
+			return Xml_attribute(Token(_index->base + offset, _index->len - offset));
+		}
+
 	public:
 
 		/**
@@ -801,6 +917,25 @@ class Genode::Xml_node
 		 */
 		Xml_node next() const
 		{
+			if (_index) {
+				uint32_t const next = _index->nodes[_index_node].next;
+				if (next == Index::NONE) {
+
+					/*
+					 * Like the plain parser, report a malformed tag that
+					 * follows the node
+					 */
+					if (_index->syntax_error)
+						skip_non_tag_characters(_end_tag.next_token());
+
+					throw Nonexistent_sub_node();
+				}
+
+				char const *addr = _index->base + _index->nodes[next].start;
+				try { return Xml_node(*_index, next, addr); }
+				catch (Invalid_syntax) { throw Nonexistent_sub_node(); }
+			}
+
 			Token after_node = _end_tag.next_token();
 			after_node = skip_non_tag_characters(after_node);
 			try { return _sub_node(after_node.start()); }
@@ -843,7 +978,7 @@ class Genode::Xml_node
 
 				/* look up node at specified index */
 				try {
-					Xml_node curr_node = _sub_node(_content_base());
+					Xml_node curr_node = _first_sub_node();
 					for (; idx > 0; idx--)
 						curr_node = curr_node.next();
 					return curr_node;
@@ -864,7 +999,7 @@ class Genode::Xml_node
 
 				/* search for sub node of specified type */
 				try {
-					Xml_node curr_node = _sub_node(_content_base());
+					Xml_node curr_node = _first_sub_node();
 					for ( ; true; curr_node = curr_node.next())
 						if (curr_node.has_type(type))
 							return curr_node;
@@ -928,6 +1063,14 @@ class Genode::Xml_node
 		 */
 		Xml_attribute attribute(unsigned idx) const
 		{
+			if (_index) {
+				Index::Node const &node = _index->nodes[_index_node];
+				if (idx >= node.num_attributes)
+					throw Nonexistent_attribute();
+
+				return _indexed_attribute(node.attributes + idx);
+			}
+
 			/* get first attribute of the node */
 			Xml_attribute a = _start_tag.attribute();
 
@@ -947,6 +1090,16 @@ class Genode::Xml_node
 		 */
 		Xml_attribute attribute(char const *type) const
 		{
+			if (_index) {
+				Index::Node const &node = _index->nodes[_index_node];
+				for (uint32_t i = 0; i < node.num_attributes; i++) {
+					Xml_attribute a = _indexed_attribute(node.attributes + i);
+					if (a.has_type(type))
+						return a;
+				}
+				throw Nonexistent_attribute();
+			}
+
 			/* iterate, beginning with the first attribute of the node */
 			for (Xml_attribute a = _start_tag.attribute(); ; a = a.next())
 				if (a.has_type(type))
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2016-2017 Genode Labs GmbH
+ * Copyright (C) 2016-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -22,6 +22,7 @@ namespace Genode {
 	class Ram_allocator;
 	class Env;
 	class Local_session_id_space;
+	class Thread;
 
 	extern Region_map    *env_stack_area_region_map;
 	extern Ram_allocator *env_stack_area_ram_allocator;
@@ -49,6 +50,8 @@ namespace Genode {
 	void cxx_current_exception(char *out, size_t size);
 	void cxx_free_tls(void *thread);
 
+	void release_magazine_heap_caches(Thread const &);
+
 	Id_space<Parent::Client> &env_session_id_space();
 	Env &internal_env();
 }
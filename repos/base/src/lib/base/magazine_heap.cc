@@ -0,0 +1,348 @@
+/*
+ * \brief  Per-thread cache of small heap blocks
+ * \author Genode Labs
+ * \date   2019-10-01
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/heap.h>
+#include <base/thread.h>
+#include <base/log.h>
+#include <cpu/atomic.h>
+#include <cpu/memory_barrier.h>
+
+/* base-internal includes */
+#include <base/internal/globals.h>
+
+using namespace Genode;
+
+
+namespace {
+
+	struct Magazine_heap_registry
+	{
+		Lock                              lock { };
+		List<List_element<Magazine_heap>> heaps { };
+	};
+
+	Magazine_heap_registry &magazine_heap_registry()
+	{
+		static Magazine_heap_registry inst;
+		return inst;
+	}
+}
+
+
+void Genode::release_magazine_heap_caches(Thread const &thread)
+{
+	Magazine_heap_registry &registry = magazine_heap_registry();
+
+	Lock::Guard guard(registry.lock);
+
+	for (List_element<Magazine_heap> *e = registry.heaps.first(); e; e = e->next())
+		e->object()->release_thread_cache(thread);
+}
+
+
+Magazine_heap::Thread_cache *Magazine_heap::_thread_cache()
+{
+	Thread * const myself = Thread::myself();
+
+	/* the main thread may have no 'Thread' object during initialization */
+	if (!myself)
+		return nullptr;
+
+	/* start probing at a slot derived from the 'Thread' object address */
+	unsigned const start = (unsigned)(((addr_t)myself >> 6) % MAX_THREADS);
+
+	for (unsigned i = 0; i < MAX_THREADS; i++) {
+		Thread_cache &cache = _caches[(start + i) % MAX_THREADS];
+		if (cache.owner == myself)
+			return &cache;
+	}
+
+	for (unsigned i = 0; i < MAX_THREADS; i++) {
+		Thread_cache &cache = _caches[(start + i) % MAX_THREADS];
+		if (cache.claimed || !cmpxchg(&cache.claimed, 0, 1))
+			continue;
+
+		Lock::Guard guard(cache.lock);
+
+		for (unsigned c = 0; c < NUM_SIZE_CLASSES; c++)
+			cache.magazines[c].count = 0;
+
+		cache.owner = myself;
+		return &cache;
+	}
+	return nullptr;
+}
+
+
+void Magazine_heap::_refill_from_depot(unsigned c, Magazine &magazine,
+                                       unsigned count)
+{
+	Lock::Guard guard(_depot_lock);
+
+	Depot_class &depot = _depot[c];
+	for (; count && depot.head; count--) {
+		Free_block *block = depot.head;
+		depot.head = block->next;
+		depot.count--;
+		magazine.rounds[magazine.count++] = block;
+	}
+}
+
+
+void Magazine_heap::_spill_to_depot(unsigned c, Magazine &magazine,
+                                    unsigned count)
+{
+	Lock::Guard guard(_depot_lock);
+
+	Depot_class &depot = _depot[c];
+	for (; count && magazine.count; count--) {
+
+		void * const block = magazine.rounds[--magazine.count];
+
+		/* release surplus blocks to the heap to keep the depot bounded */
+		if (depot.count >= DEPOT_LIMIT) {
+			_heap.free(block, _class_size(c));
+			continue;
+		}
+
+		Free_block * const free_block = (Free_block *)block;
+		free_block->next = depot.head;
+		depot.head = free_block;
+		depot.count++;
+	}
+}
+
+
+void *Magazine_heap::_alloc_from_depot(unsigned c)
+{
+	Lock::Guard guard(_depot_lock);
+
+	Depot_class &depot = _depot[c];
+	Free_block * const block = depot.head;
+	if (block) {
+		depot.head = block->next;
+		depot.count--;
+	}
+	return block;
+}
+
+
+void Magazine_heap::_free_to_depot(unsigned c, void *block)
+{
+	Lock::Guard guard(_depot_lock);
+
+	Depot_class &depot = _depot[c];
+	if (depot.count >= DEPOT_LIMIT) {
+		_heap.free(block, _class_size(c));
+		return;
+	}
+
+	Free_block * const free_block = (Free_block *)block;
+	free_block->next = depot.head;
+	depot.head = free_block;
+	depot.count++;
+}
+
+
+void Magazine_heap::_flush_depot()
+{
+	Lock::Guard guard(_depot_lock);
+
+	for (unsigned c = 0; c < NUM_SIZE_CLASSES; c++) {
+		Depot_class &depot = _depot[c];
+		while (Free_block * const block = depot.head) {
+			depot.head = block->next;
+			_heap.free(block, _class_size(c));
+		}
+		depot.count = 0;
+	}
+}
+
+
+void *Magazine_heap::_alloc_from_heap(size_t size)
+{
+	void *block = nullptr;
+	if (_heap.alloc(size, &block))
+		return block;
+
+	/* blocks cached at the depot count against the quota of the heap */
+	_flush_depot();
+
+	if (_heap.alloc(size, &block))
+		return block;
+
+	/* reclaim the blocks cached by all threads */
+	_flush_thread_caches();
+	_flush_depot();
+
+	if (_heap.alloc(size, &block))
+		return block;
+
+	return nullptr;
+}
+
+
+void Magazine_heap::_flush_magazines(Thread_cache &cache)
+{
+	for (unsigned c = 0; c < NUM_SIZE_CLASSES; c++)
+		_spill_to_depot(c, cache.magazines[c], MAGAZINE_ROUNDS);
+}
+
+
+void Magazine_heap::_flush_thread_caches()
+{
+	for (unsigned i = 0; i < MAX_THREADS; i++) {
+		Thread_cache &cache = _caches[i];
+
+		Lock::Guard guard(cache.lock);
+
+		if (cache.claimed)
+			_flush_magazines(cache);
+	}
+}
+
+
+void Magazine_heap::release_thread_cache(Thread const &thread)
+{
+	for (unsigned i = 0; i < MAX_THREADS; i++) {
+		Thread_cache &cache = _caches[i];
+		if (cache.owner != &thread)
+			continue;
+
+		Lock::Guard guard(cache.lock);
+
+		_flush_magazines(cache);
+
+		cache.owner = nullptr;
+		memory_barrier();
+		cache.claimed = 0;
+		return;
+	}
+}
+
+
+void Magazine_heap::flush_thread_cache()
+{
+	if (Thread * const myself = Thread::myself())
+		release_thread_cache(*myself);
+}
+
+
+bool Magazine_heap::alloc(size_t size, void **out_addr)
+{
+	size_t   const block_size = size + sizeof(Block_header);
+	unsigned const c          = _size_class(block_size);
+
+	void *block = nullptr;
+
+	if (c == NUM_SIZE_CLASSES) {
+
+		/* large blocks are not cached */
+		block = _alloc_from_heap(block_size);
+
+	} else if (Thread_cache * const cache = _thread_cache()) {
+
+		{
+			Lock::Guard guard(cache->lock);
+
+			Magazine &magazine = cache->magazines[c];
+			if (magazine.count == 0)
+				_refill_from_depot(c, magazine, MAGAZINE_ROUNDS/2);
+
+			if (magazine.count)
+				block = magazine.rounds[--magazine.count];
+		}
+
+		/* the cache lock is released as the heap may drain all caches */
+		if (!block)
+			block = _alloc_from_heap(_class_size(c));
+
+	} else {
+
+		block = _alloc_from_depot(c);
+		if (!block)
+			block = _alloc_from_heap(_class_size(c));
+	}
+
+	if (!block)
+		return false;
+
+	Block_header * const header = (Block_header *)block;
+	header->size_class = (c == NUM_SIZE_CLASSES)
+	                   ? (unsigned long)Block_header::DIRECT : c;
+
+	*out_addr = header + 1;
+	return true;
+}
+
+
+void Magazine_heap::free(void *addr, size_t)
+{
+	Block_header * const header = (Block_header *)addr - 1;
+
+	if (header->size_class == Block_header::DIRECT) {
+		_heap.free(header, 0);
+		return;
+	}
+
+	unsigned const c = (unsigned)header->size_class;
+	if (c >= NUM_SIZE_CLASSES) {
+		warning("magazine heap could not free corrupted memory block");
+		return;
+	}
+
+	Thread_cache * const cache = _thread_cache();
+	if (!cache) {
+		_free_to_depot(c, header);
+		return;
+	}
+
+	Lock::Guard guard(cache->lock);
+
+	Magazine &magazine = cache->magazines[c];
+	if (magazine.count == MAGAZINE_ROUNDS)
+		_spill_to_depot(c, magazine, MAGAZINE_ROUNDS/2);
+
+	magazine.rounds[magazine.count++] = header;
+}
+
+
+Magazine_heap::Magazine_heap(Heap &heap) : _heap(heap)
+{
+	Magazine_heap_registry &registry = magazine_heap_registry();
+
+	Lock::Guard guard(registry.lock);
+	registry.heaps.insert(&_list_element);
+}
+
+
+Magazine_heap::~Magazine_heap()
+{
+	{
+		Magazine_heap_registry &registry = magazine_heap_registry();
+
+		Lock::Guard guard(registry.lock);
+		registry.heaps.remove(&_list_element);
+	}
+
+	/*
+	 * At destruction time, no thread is expected to use the allocator
+	 * anymore. Hence, it is safe to access the caches of all threads.
+	 */
+	for (unsigned i = 0; i < MAX_THREADS; i++)
+		if (_caches[i].claimed)
+			_flush_magazines(_caches[i]);
+
+	_flush_depot();
+}
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -252,6 +252,7 @@ Thread::~Thread()
 	_free_stack(_stack);
 
 	cxx_free_tls(this);
+	release_magazine_heap_caches(*this);
 
 	/*
 	 * We have to detach the trace control dataspace last because
@@ -152,8 +152,12 @@ void Trace::Logger::log(char const *msg, size_t len)
 {
 	if (!this || !_evaluate_control()) return;
 
-	memcpy(buffer->reserve(len), msg, len);
-	buffer->commit(len);
+	char * const dst = buffer->reserve(len);
+	if (!dst)
+		return;
+
+	memcpy(dst, msg, len);
+	buffer->commit(dst, len);
 }
 
 
@@ -0,0 +1,134 @@
+/*
+ * \brief  Benchmark for concurrent heap allocations
+ * \author Genode Labs
+ * \date   2019-10-01
+ *
+ * A number of threads allocate and free small blocks of varying sizes at a
+ * shared allocator. The benchmark compares the plain 'Heap' with the
+ * 'Magazine_heap' put in front of it.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <base/thread.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+
+struct Worker : Thread
+{
+	enum { ROUNDS = 200000, BLOCKS = 64 };
+
+	Allocator &_alloc;
+
+	/* set if the thread cache must be released when the worker is done */
+	Magazine_heap * const _magazine_heap;
+
+	/*
+	 * Noncopyable
+	 */
+	Worker(Worker const &);
+	Worker &operator = (Worker const &);
+
+	Worker(Env &env, Allocator &alloc, Magazine_heap *magazine_heap,
+	       Affinity::Location location)
+	:
+		Thread(env, "worker", 8*1024*sizeof(long), location,
+		       Weight(), env.cpu()),
+		_alloc(alloc), _magazine_heap(magazine_heap)
+	{ }
+
+	void entry() override
+	{
+		void    *blocks[BLOCKS] { };
+		unsigned seed = (unsigned)(addr_t)this;
+
+		for (unsigned i = 0; i < ROUNDS; i++) {
+
+			seed = seed*1103515245 + 12345;
+
+			void *&block = blocks[i % BLOCKS];
+			if (block)
+				_alloc.free(block, 0);
+
+			size_t const size = 8 + ((seed >> 16) % 512);
+			if (!_alloc.alloc(size, &block)) {
+				error("allocation of ", size, " bytes failed");
+				block = nullptr;
+			}
+		}
+
+		for (unsigned i = 0; i < BLOCKS; i++)
+			if (blocks[i])
+				_alloc.free(blocks[i], 0);
+
+		if (_magazine_heap)
+			_magazine_heap->flush_thread_cache();
+	}
+};
+
+
+struct Main
+{
+	enum { MAX_WORKERS = 8 };
+
+	Env &_env;
+
+	Timer::Connection _timer { _env };
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	uint64_t _measure(Allocator &alloc, Magazine_heap *magazine_heap,
+	                  unsigned num_workers)
+	{
+		Affinity::Space space = _env.cpu().affinity_space();
+
+		Constructible<Worker> workers[MAX_WORKERS];
+
+		for (unsigned i = 0; i < num_workers; i++)
+			workers[i].construct(_env, alloc, magazine_heap,
+			                     space.location_of_index(i % space.total()));
+
+		uint64_t const start_ms = _timer.elapsed_ms();
+
+		for (unsigned i = 0; i < num_workers; i++)
+			workers[i]->start();
+
+		for (unsigned i = 0; i < num_workers; i++)
+			workers[i]->join();
+
+		return _timer.elapsed_ms() - start_ms;
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- heap benchmark started ---");
+
+		Magazine_heap magazine_heap { _heap };
+
+		for (unsigned threads = 1; threads <= MAX_WORKERS; threads *= 2) {
+
+			uint64_t const heap_ms     = _measure(_heap, nullptr, threads);
+			uint64_t const magazine_ms = _measure(magazine_heap, &magazine_heap, threads);
+
+			log("threads: ", threads, " "
+			    "heap: ", heap_ms, " ms "
+			    "magazine heap: ", magazine_ms, " ms");
+		}
+
+		log("--- heap benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
@@ -0,0 +1,152 @@
+/*
+ * \brief  Benchmark for walking large XML data with and without 'Xml_index'
+ * \author Genode Labs
+ * \date   2019-10-27
+ *
+ * The benchmark generates a state report of about 5 MiB, similar to the
+ * report of an init instance with many children. The report is evaluated
+ * once via plain 'Xml_node' objects and once via an 'Xml_index'. Both walks
+ * must produce the same result.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_ram_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+#include <util/xml_generator.h>
+#include <util/xml_index.h>
+
+using namespace Genode;
+
+
+struct Main
+{
+	enum { BUFFER_SIZE = 8*1024*1024, NUM_CHILDREN = 6200, NUM_SESSIONS = 6 };
+
+	Env &_env;
+
+	Timer::Connection _timer { _env };
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Attached_ram_dataspace _buffer { _env.ram(), _env.rm(), BUFFER_SIZE };
+
+	size_t _generate_report()
+	{
+		Xml_generator xml(_buffer.local_addr<char>(), BUFFER_SIZE, "state", [&] () {
+
+			xml.attribute("version", "1");
+
+			for (unsigned i = 0; i < NUM_CHILDREN; i++) {
+				xml.node("child", [&] () {
+					xml.attribute("name",   String<32>("child_", i));
+					xml.attribute("binary", String<32>("binary_", i % 13));
+					xml.attribute("id",     i);
+					xml.node("ram", [&] () {
+						xml.attribute("assigned", i*4096);
+						xml.attribute("quota",    i*4096 - 512);
+						xml.attribute("used",     i*1024);
+						xml.attribute("avail",    i*3072 - 512);
+					});
+					xml.node("caps", [&] () {
+						xml.attribute("assigned", 100 + i % 50);
+						xml.attribute("quota",    100 + i % 50);
+						xml.attribute("used",     i % 100);
+						xml.attribute("avail",    100 - i % 50);
+					});
+					xml.node("requested", [&] () {
+						for (unsigned j = 0; j < NUM_SESSIONS; j++)
+							xml.node("session", [&] () {
+								xml.attribute("service", "ROM");
+								xml.attribute("label",   String<64>("child_", i, " -> module_", j));
+								xml.attribute("state",   "CAP_HANDED_OUT");
+								xml.attribute("ram",     j*4096);
+								xml.attribute("caps",    j + 2);
+							});
+					});
+				});
+			}
+		});
+		return xml.used();
+	}
+
+	/**
+	 * Evaluate the report in the way a typical consumer does
+	 */
+	static unsigned long _evaluate(Xml_node state)
+	{
+		unsigned long result = 0;
+
+		state.for_each_sub_node("child", [&] (Xml_node child) {
+
+			result += child.attribute_value("id", 0UL);
+			result += child.attribute_value("name", String<32>()).length();
+
+			child.with_sub_node("ram", [&] (Xml_node ram) {
+				result += ram.attribute_value("avail", 0UL); });
+
+			if (child.has_sub_node("caps"))
+				result += child.sub_node("caps").attribute_value("used", 0UL);
+
+			child.with_sub_node("requested", [&] (Xml_node requested) {
+				requested.for_each_sub_node("session", [&] (Xml_node session) {
+					result += session.attribute_value("ram",  0UL);
+					result += session.attribute_value("caps", 0UL);
+				});
+			});
+		});
+		return result;
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- XML index benchmark started ---");
+
+		size_t const size = _generate_report();
+		char const * const report = _buffer.local_addr<char>();
+
+		log("report size: ", size/1024, " KiB");
+
+		uint64_t const plain_start_us = _timer.elapsed_us();
+
+		unsigned long const plain_result = _evaluate(Xml_node(report, size));
+
+		uint64_t const plain_us = _timer.elapsed_us() - plain_start_us;
+
+		size_t const heap_before = _heap.consumed();
+
+		uint64_t const index_start_us = _timer.elapsed_us();
+
+		Xml_index index(_heap, report, size);
+
+		uint64_t const walk_start_us = _timer.elapsed_us();
+
+		unsigned long const indexed_result = _evaluate(index.xml());
+
+		uint64_t const end_us = _timer.elapsed_us();
+
+		log("plain:   ", plain_us/1000, " ms");
+		log("indexed: ", (end_us - index_start_us)/1000, " ms "
+		    "(index ", (walk_start_us - index_start_us)/1000, " ms, "
+		    "walk ", (end_us - walk_start_us)/1000, " ms, ",
+		    index.num_nodes(), " nodes, ",
+		    (_heap.consumed() - heap_before)/1024, " KiB)");
+
+		if (plain_result != indexed_result)
+			error("indexed result ", indexed_result, " differs from ", plain_result);
+
+		log("--- XML index benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2014-2017 Genode Labs GmbH
+ * Copyright (C) 2014-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -23,6 +23,7 @@
 #include <os/pixel_rgb565.h>
 #include <os/pixel_alpha8.h>
 #include <os/pixel_rgb888.h>
+#include <os/pixel_kernels.h>
 
 /* gems includes */
 #include <gems/dither_painter.h>
@@ -107,13 +108,21 @@ struct Nitpicker_buffer
 		fn(pixel, alpha);
 	}
 
-	void reset_surface()
+	/**
+	 * Return rectangle covering the whole virtual framebuffer
+	 */
+	Rect _rect() const { return Rect(Point(0, 0), size()); }
+
+	/**
+	 * Reset the back buffer within 'rect'
+	 */
+	void reset_surface(Rect rect)
 	{
-		Pixel_surface pixel(pixel_surface_ds.local_addr<Pixel_rgb888>(), size());
-		Alpha_surface alpha(alpha_surface_ds.local_addr<Pixel_alpha8>(), size());
+		rect = Rect::intersect(rect, _rect());
+		if (!rect.valid())
+			return;
 
-		Genode::size_t const num_pixels = size().count();
-		Genode::memset(alpha.addr(), 0, num_pixels);
+		unsigned const w = size().w();
 
 		/*
 		 * Initialize color buffer with 50% gray
@@ -121,14 +130,21 @@ struct Nitpicker_buffer
 		 * We do not use black to limit the bleeding of black into antialiased
 		 * drawing operations applied onto an initially transparent background.
 		 */
-		Pixel_rgb888 *dst = pixel.addr();
-
 		Pixel_rgb888 const gray(127, 127, 127, 255);
 
-		for (unsigned n = num_pixels; n; n--)
-			*dst++ = gray;
+		Pixel_rgb888 *pixel = pixel_surface_ds.local_addr<Pixel_rgb888>()
+		                    + rect.y1()*w + rect.x1();
+		Pixel_alpha8 *alpha = alpha_surface_ds.local_addr<Pixel_alpha8>()
+		                    + rect.y1()*w + rect.x1();
+
+		for (unsigned y = rect.h(); y--; pixel += w, alpha += w) {
+			Genode::memset(alpha, 0, rect.w());
+			Genode::Pixel_kernels::fill(pixel, gray, rect.w());
+		}
 	}
 
+	void reset_surface() { reset_surface(_rect()); }
+
 	template <typename DST_PT, typename SRC_PT>
 	void _convert_back_to_front(DST_PT                        *front_base,
 	                            Genode::Texture<SRC_PT> const &texture,
@@ -141,17 +157,19 @@ struct Nitpicker_buffer
 		Dither_painter::paint(surface, texture, Point());
 	}
 
-	void _update_input_mask()
+	void _update_input_mask(Rect const rect)
 	{
 		unsigned const num_pixels = size().count();
+		unsigned const w          = size().w();
+		unsigned const offset     = rect.y1()*w + rect.x1();
 
 		unsigned char * const alpha_base = fb_ds.local_addr<unsigned char>()
 		                                 + mode.bytes_per_pixel()*num_pixels;
 
 		unsigned char * const input_base = alpha_base + num_pixels;
 
-		unsigned char const *src = alpha_base;
-		unsigned char       *dst = input_base;
+		unsigned char const *src = alpha_base + offset;
+		unsigned char       *dst = input_base + offset;
 
 		/*
 		 * Set input mask for all pixels where the alpha value is above a
@@ -160,30 +178,37 @@ struct Nitpicker_buffer
 		 */
 		unsigned char const threshold = 100;
 
-		for (unsigned i = 0; i < num_pixels; i++)
-			*dst++ = (*src++) > threshold;
+		for (unsigned y = rect.h(); y--; src += w, dst += w)
+			for (unsigned i = 0; i < rect.w(); i++)
+				dst[i] = src[i] > threshold;
 	}
 
-	void flush_surface()
+	/**
+	 * Transfer the back buffer within 'rect' to the virtual framebuffer
+	 */
+	void flush_surface(Rect rect)
 	{
+		rect = Rect::intersect(rect, _rect());
+		if (!rect.valid())
+			return;
+
 		/* represent back buffer as texture */
 		Genode::Texture<Pixel_rgb888>
 			texture(pixel_surface_ds.local_addr<Pixel_rgb888>(),
 			        alpha_surface_ds.local_addr<unsigned char>(),
 			        size());
 
-		// XXX track dirty rectangles
-		Rect const clip_rect(Genode::Surface_base::Point(0, 0), size());
-
 		Pixel_rgb565 *pixel_base = fb_ds.local_addr<Pixel_rgb565>();
 		Pixel_alpha8 *alpha_base = fb_ds.local_addr<Pixel_alpha8>()
 		                         + mode.bytes_per_pixel()*size().count();
 
-		_convert_back_to_front(pixel_base, texture, clip_rect);
-		_convert_back_to_front(alpha_base, texture, clip_rect);
+		_convert_back_to_front(pixel_base, texture, rect);
+		_convert_back_to_front(alpha_base, texture, rect);
 
-		_update_input_mask();
+		_update_input_mask(rect);
 	}
+
+	void flush_surface() { flush_surface(_rect()); }
 };
 
 #endif /* _INCLUDE__GEMS__NITPICKER_BUFFER_H_ */
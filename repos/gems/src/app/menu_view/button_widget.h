@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2014-2017 Genode Labs GmbH
+ * Copyright (C) 2014-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -163,10 +163,14 @@ struct Menu_view::Button_widget : Widget, Animator::Item
 		Icon_painter::paint(alpha_surface, Rect(at, _animated_geometry.area()),
 		                    scratch.texture(), 255);
 
-		if (_selected)
-			at = at + Point(0, 1);
+		_draw_children(pixel_surface, alpha_surface, at + _children_offset());
+	}
+
+	bool _animated() const override { return animated(); }
 
-		_draw_children(pixel_surface, alpha_surface, at);
+	Point _children_offset() const override
+	{
+		return _selected ? Point(0, 1) : Point(0, 0);
 	}
 
 	void _layout() override
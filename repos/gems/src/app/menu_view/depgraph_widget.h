@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2017 Genode Labs GmbH
+ * Copyright (C) 2017-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -643,6 +643,39 @@ struct Menu_view::Depgraph_widget : Widget
 
 	Area min_size() const override { return _bounding_box.area(); }
 
+	/*
+	 * The connections depend on the '<dep>' sub nodes and on the attributes
+	 * of the child nodes.
+	 */
+	unsigned long _node_checksum(Xml_node node) const override
+	{
+		unsigned long result = 0;
+		node.with_raw_node([&] (char const *start, size_t len) {
+			result = _checksum_of(start, len); });
+
+		return result;
+	}
+
+	/*
+	 * The connections follow the motion of the child widgets and fade
+	 * when their visibility changes.
+	 */
+	bool _animated() const override
+	{
+		bool result = false;
+
+		_children.for_each([&] (Widget const &w) {
+			if (w.in_motion())
+				result = true; });
+
+		_nodes.for_each([&] (Node const &node) {
+			node._deps.for_each([&] (Node::Dependency const &dep) {
+				if (dep.animated())
+					result = true; }); });
+
+		return result;
+	}
+
 	void _draw_connect(Surface<Pixel_rgb888> &pixel_surface,
 	                   Surface<Pixel_alpha8> &alpha_surface,
 	                   Point p1, Point p2, Color color, bool horizontal) const
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2014-2017 Genode Labs GmbH
+ * Copyright (C) 2014-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -181,6 +181,13 @@ struct Menu_view::Main
 	 */
 	unsigned _frame_cnt = 0;
 
+	/**
+	 * Log the number of redrawn pixels and the time spent per redraw
+	 */
+	bool _verbose_redraw = false;
+
+	void _redraw(Rect const rect);
+
 	Main(Env &env, Vfs::File_system &libc_vfs)
 	:
 		_env(env), _vfs_env(_env, _heap, libc_vfs)
@@ -274,6 +281,8 @@ void Menu_view::Main::_handle_config()
 		_hover_reporter.enabled(false);
 	}
 
+	_verbose_redraw = _config.xml().attribute_value("verbose_redraw", false);
+
 	_handle_dialog_update();
 }
 
@@ -341,22 +350,42 @@ void Menu_view::Main::_handle_frame_timer()
 		bool const size_increased = (max_size.w() > buffer_w)
 		                         || (max_size.h() > buffer_h);
 
-		if (!_buffer.constructed() || size_increased)
+		bool const full_redraw = !_buffer.constructed() || size_increased;
+
+		if (full_redraw)
 			_buffer.construct(_nitpicker, max_size, _env.ram(), _env.rm());
-		else
-			_buffer->reset_surface();
 
 		_root_widget.position(Point(0, 0));
 
-		// XXX restrict redraw to dirty regions
-		//     don't perform a full dialog update
-		_buffer->apply_to_surface([&] (Surface<Pixel_rgb888> &pixel,
-		                               Surface<Pixel_alpha8> &alpha) {
-			_root_widget.draw(pixel, alpha, Point(0, 0));
-		});
+		Genode::uint64_t const start_us = _verbose_redraw ? _timer.elapsed_us() : 0;
+
+		/* determine the areas affected by the dialog update */
+		Dirty_rect dirty { };
+		_root_widget.collect_damage(dirty, Point(0, 0));
+
+		unsigned       num_rects  = 0;
+		Genode::size_t num_pixels = 0;
+
+		auto redraw = [&] (Rect const &rect) {
+			Rect const clipped = Rect::intersect(rect, Rect(Point(0, 0), _buffer->size()));
+			if (!clipped.valid())
+				return;
+
+			_redraw(clipped);
+			num_rects++;
+			num_pixels += clipped.area().count();
+		};
+
+		if (full_redraw)
+			redraw(Rect(Point(0, 0), _buffer->size()));
+		else
+			dirty.flush(redraw);
+
+		if (_verbose_redraw)
+			log("redraw ", num_rects, " rect(s), ", num_pixels, " of ",
+			    _buffer->size().count(), " pixels, ",
+			    _timer.elapsed_us() - start_us, " us");
 
-		_buffer->flush_surface();
-		_nitpicker.framebuffer()->refresh(0, 0, _buffer->size().w(), _buffer->size().h());
 		_update_view(Rect(_position, size));
 
 		_schedule_redraw = false;
@@ -373,6 +402,22 @@ void Menu_view::Main::_handle_frame_timer()
 }
 
 
+void Menu_view::Main::_redraw(Rect const rect)
+{
+	_buffer->reset_surface(rect);
+
+	_buffer->apply_to_surface([&] (Surface<Pixel_rgb888> &pixel,
+	                               Surface<Pixel_alpha8> &alpha) {
+		pixel.clip(rect);
+		alpha.clip(rect);
+		_root_widget.draw(pixel, alpha, Point(0, 0));
+	});
+
+	_buffer->flush_surface(rect);
+	_nitpicker.framebuffer()->refresh(rect.x1(), rect.y1(), rect.w(), rect.h());
+}
+
+
 Menu_view::Widget *
 Menu_view::Widget_factory::create(Xml_node node)
 {
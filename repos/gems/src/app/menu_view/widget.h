@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2014-2017 Genode Labs GmbH
+ * Copyright (C) 2014-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -98,6 +98,39 @@ class Menu_view::Widget : List_model<Widget>::Element
 
 		Unique_id const _unique_id;
 
+		/*
+		 * Damage tracking
+		 *
+		 * '_drawn' is the absolute area covered by the widget at the time
+		 * of the last 'collect_damage' call. '_lost' accumulates the areas
+		 * of destroyed child widgets.
+		 */
+		Rect          _drawn        { };
+		Rect          _lost         { };
+		bool          _dirty        = true;
+		bool          _was_animated = false;
+		unsigned long _checksum     = 0;
+
+		static Rect _compound(Rect r1, Rect r2)
+		{
+			if (!r1.valid()) return r2;
+			if (!r2.valid()) return r1;
+			return Rect::compound(r1, r2);
+		}
+
+		/**
+		 * Update node checksum, mark widget as dirty if it changed
+		 */
+		void _update_checksum(Xml_node node)
+		{
+			unsigned long const checksum = _node_checksum(node);
+
+			if (checksum != _checksum)
+				_dirty = true;
+
+			_checksum = checksum;
+		}
+
 	protected:
 
 		Widget_factory &_factory;
@@ -107,10 +140,16 @@ class Menu_view::Widget : List_model<Widget>::Element
 		struct Model_update_policy : List_model<Widget>::Update_policy
 		{
 			Widget_factory &_factory;
+			Widget         &_owner;
 
-			Model_update_policy(Widget_factory &factory) : _factory(factory) { }
+			Model_update_policy(Widget_factory &factory, Widget &owner)
+			: _factory(factory), _owner(owner) { }
 
-			void destroy_element(Widget &w) { _factory.destroy(&w); }
+			void destroy_element(Widget &w)
+			{
+				_owner._lost = _compound(_owner._lost, w._drawn);
+				_factory.destroy(&w);
+			}
 
 			Widget &create_element(Xml_node elem_node)
 			{
@@ -120,7 +159,11 @@ class Menu_view::Widget : List_model<Widget>::Element
 				throw Unknown_element_type();
 			}
 
-			void update_element(Widget &w, Xml_node node) { w.update(node); }
+			void update_element(Widget &w, Xml_node node)
+			{
+				w._update_checksum(node);
+				w.update(node);
+			}
 
 			static bool element_matches_xml_node(Widget const &w, Xml_node node)
 			{
@@ -129,21 +172,74 @@ class Menu_view::Widget : List_model<Widget>::Element
 				    && node.attribute_value("version", Version()) == w._version;
 			}
 
-		} _model_update_policy { _factory };
+		} _model_update_policy { _factory, *this };
 
 		inline void _update_children(Xml_node node)
 		{
 			_children.update_from_xml(_model_update_policy, node);
 		}
 
+		/**
+		 * Draw child widgets that intersect the clipping area
+		 */
 		void _draw_children(Surface<Pixel_rgb888> &pixel_surface,
 		                    Surface<Pixel_alpha8> &alpha_surface,
 		                    Point at) const
 		{
+			Rect const clip = pixel_surface.clip();
+
 			_children.for_each([&] (Widget const &w) {
-				w.draw(pixel_surface, alpha_surface, at + w._animated_geometry.p1()); });
+
+				Point const child_at = at + w._animated_geometry.p1();
+				Rect  const child_rect(child_at, w._animated_geometry.area());
+
+				if (Rect::intersect(clip, child_rect).valid())
+					w.draw(pixel_surface, alpha_surface, child_at);
+			});
 		}
 
+		/**
+		 * Return checksum of the XML attributes that affect the drawing
+		 *
+		 * By default, only the start tag of the node is taken into account
+		 * because sub nodes are covered by the child widgets.
+		 */
+		virtual unsigned long _node_checksum(Xml_node node) const
+		{
+			char const *start = nullptr;
+			size_t      len   = 0;
+
+			node.with_raw_node([&] (char const *s, size_t l) {
+				start = s; len = l; });
+
+			node.with_raw_content([&] (char const *content, size_t) {
+				len = content - start; });
+
+			return _checksum_of(start, len);
+		}
+
+		/**
+		 * FNV-1a hash
+		 */
+		static unsigned long _checksum_of(char const *s, size_t len)
+		{
+			unsigned long result = 2166136261UL;
+			for (size_t i = 0; i < len; i++)
+				result = (result ^ (unsigned char)s[i])*16777619UL;
+
+			return result;
+		}
+
+		/**
+		 * Return true if the widget's appearance changes over time
+		 */
+		virtual bool _animated() const { return false; }
+
+		/**
+		 * Offset of the child widgets as applied by 'draw'
+		 */
+		virtual Point _children_offset() const { return Point(0, 0); }
+
 		virtual void _layout() { }
 
 		Rect _inner_geometry() const
@@ -177,6 +273,11 @@ class Menu_view::Widget : List_model<Widget>::Element
 
 		Rect animated_geometry() const { return _animated_geometry.rect(); }
 
+		/**
+		 * Return true while the geometry animation is in progress
+		 */
+		bool in_motion() const { return _animated_geometry.animated(); }
+
 		/*
 		 * Return x/y positions of the edges of the widget with the margin
 		 * applied
@@ -211,6 +312,42 @@ class Menu_view::Widget : List_model<Widget>::Element
 		                  Surface<Pixel_alpha8> &alpha_surface,
 		                  Point at) const = 0;
 
+		/**
+		 * Mark areas that changed since the previous call as dirty
+		 *
+		 * \param at  absolute position of the widget, as passed to 'draw'
+		 *
+		 * A widget is redrawn if its XML node changed, if it moved or
+		 * changed its size, or while it is animated. The area of each
+		 * redrawn widget is marked twice, at its old and new position.
+		 */
+		void collect_damage(Dirty_rect &dirty, Point at)
+		{
+			Rect const rect(at, _animated_geometry.area());
+
+			bool const moved    = rect.p1() != _drawn.p1() || rect.p2() != _drawn.p2();
+			bool const animated = _animated();
+
+			/* the final animation step must be drawn as well */
+			if (_dirty || moved || animated || _was_animated) {
+				if (_drawn.valid()) dirty.mark_as_dirty(_drawn);
+				if (rect.valid())   dirty.mark_as_dirty(rect);
+			}
+
+			if (_lost.valid())
+				dirty.mark_as_dirty(_lost);
+
+			_drawn        = rect;
+			_lost         = Rect();
+			_dirty        = false;
+			_was_animated = animated;
+
+			Point const children_at = at + _children_offset();
+
+			_children.for_each([&] (Widget &w) {
+				w.collect_damage(dirty, children_at + w._animated_geometry.p1()); });
+		}
+
 		/**
 		 * Set widget size and update the widget tree's layout accordingly
 		 */
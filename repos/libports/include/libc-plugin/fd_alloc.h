@@ -6,7 +6,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -39,6 +39,8 @@ namespace Libc {
 
 	enum { ANY_FD = -1 };
 
+	class Interest;
+
 	struct File_descriptor
 	{
 		Genode::Lock lock { };
@@ -56,6 +58,15 @@ namespace Libc {
 		int  flags   = 0;  /* for 'fcntl' */
 		bool cloexec = 0;  /* for 'fcntl' */
 
+		/* interest-set entries observing the descriptor */
+		Interest *interests = nullptr;
+
+		/*
+		 * Descriptor notified along with this one, e.g., the socket of a
+		 * socket-fs control file
+		 */
+		File_descriptor *readiness_owner = nullptr;
+
 		File_descriptor(Id_space &id_space, Plugin &plugin, Plugin_context &context)
 		: _elem(*this, id_space), plugin(&plugin), context(&context) { }
 
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -39,6 +39,14 @@ namespace Libc {
 
 	void resolve_symlinks(char const *path, Absolute_path &resolved_path);
 
+	/**
+	 * Report a possible change of the readiness of 'fd'
+	 *
+	 * Plugins call this function, e.g., from their I/O-signal handling,
+	 * to let interest sets re-check the descriptor.
+	 */
+	void notify_readiness(File_descriptor &fd);
+
 	class Plugin : public List<Plugin>::Element
 	{
 		protected:
@@ -76,6 +84,15 @@ namespace Libc {
 			virtual bool supports_unlink(const char *path);
 			virtual bool supports_mmap();
 
+			/**
+			 * Return true if the plugin reports readiness changes of 'fd'
+			 * via 'notify_readiness'
+			 *
+			 * Interest sets re-check descriptors of other plugins on each
+			 * wakeup.
+			 */
+			virtual bool notifies_readiness(File_descriptor &);
+
 			/*
 			 * Should be overwritten for plugins that require the Genode environment
 			 */
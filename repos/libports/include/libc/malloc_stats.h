@@ -0,0 +1,48 @@
+/*
+ * \brief  Statistics of the libc's malloc implementation
+ * \author Genode Labs
+ * \date   2019-10-16
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__LIBC__MALLOC_STATS_H_
+#define _INCLUDE__LIBC__MALLOC_STATS_H_
+
+/* Genode includes */
+#include <base/stdint.h>
+
+namespace Libc {
+
+	struct Malloc_stats;
+
+	/**
+	 * Return statistics of 'malloc', 'free', and 'realloc'
+	 *
+	 * The counters of other threads are sampled without synchronization
+	 * and may therefore be slightly off.
+	 */
+	Malloc_stats malloc_stats();
+}
+
+
+struct Libc::Malloc_stats
+{
+	unsigned long allocs;               /* allocated blocks */
+	unsigned long frees;                /* freed blocks */
+	unsigned long cached_allocs;        /* allocations served by thread caches */
+	unsigned long cached_frees;         /* frees absorbed by thread caches */
+	unsigned long reallocs_in_place;    /* reallocs that kept their block */
+	unsigned long reallocs_moved;       /* reallocs that copied the content */
+	unsigned long backing_store_allocs; /* blocks too large for the slabs */
+
+	Genode::size_t backing_store_bytes; /* bytes of large blocks in use */
+	Genode::size_t slab_bytes;          /* bytes consumed by the slabs */
+};
+
+#endif /* _INCLUDE__LIBC__MALLOC_STATS_H_ */
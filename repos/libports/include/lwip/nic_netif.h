@@ -319,8 +319,8 @@ class Lwip::Nic_netif
 			auto &tx = *_nic.tx();
 
 			/* flush acknowledgements */
-			while (tx.ack_avail())
-				tx.release_packet(tx.get_acked_packet());
+			tx.drain_acked_packets([&] (Nic::Packet_descriptor const &packet) {
+				tx.release_packet(packet); });
 
 			if (!tx.ready_to_submit()) {
 				Genode::error("lwIP: Nic packet queue congested, cannot send packet");
@@ -6,7 +6,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -26,6 +26,7 @@
 
 /* libc-internal includes */
 #include <libc_init.h>
+#include <readiness.h>
 #include <base/internal/unmanaged_singleton.h>
 
 using namespace Libc;
@@ -75,6 +76,8 @@ void File_descriptor_allocator::free(File_descriptor *fdo)
 	if (fdo->fd_path)
 		_alloc.free((void *)fdo->fd_path, ::strlen(fdo->fd_path) + 1);
 
+	release_interests(*fdo);
+
 	destroy(_alloc, fdo);
 }
 
@@ -416,7 +416,8 @@ __SYS_(void *, mmap, (void *addr, ::size_t length,
 	}
 
 	void *start = fd->plugin->mmap(addr, length, prot, flags, fd, offset);
-	mmap_registry()->insert(start, length, fd->plugin);
+	if (start != MAP_FAILED)
+		mmap_registry()->insert(start, length, fd->plugin);
 	return start;
 })
 
@@ -0,0 +1,402 @@
+/*
+ * \brief  kqueue() and kevent() implementation
+ * \author Genode Labs
+ * \date   2019-10-22
+ *
+ * The kqueue is built upon an interest set, which lets 'kevent' check only
+ * those descriptors that were notified by their plugins. Only the
+ * 'EVFILT_READ' and 'EVFILT_WRITE' filters are supported. The 'data' field
+ * of a reported event is a lower bound because plugins do not report the
+ * number of available bytes.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/lock.h>
+#include <base/log.h>
+
+/* Libc includes */
+#include <libc/allocator.h>
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/poll.h>
+#include <sys/time.h>
+
+/* libc-internal includes */
+#include "libc_errno.h"
+#include "libc_file.h"
+#include "readiness.h"
+#include "task.h"
+
+
+namespace Libc {
+
+	struct Knote;
+	class  Kqueue;
+	struct Kqueue_plugin;
+
+	Kqueue_plugin &kqueue_plugin();
+}
+
+
+static Libc::Allocator &kqueue_allocator()
+{
+	static Libc::Allocator alloc;
+	return alloc;
+}
+
+
+/**
+ * Registered event of a kqueue
+ */
+struct Libc::Knote : Interest
+{
+	int   const ident;
+	short const filter;
+
+	/* behaviour flags 'EV_ONESHOT', 'EV_CLEAR', and 'EV_DISPATCH' */
+	unsigned short flags;
+
+	void *udata;
+	bool  enabled { true };
+
+	Knote *hash_next { nullptr };
+
+	Knote(Interest_set &set, File_descriptor &fd, struct kevent const &kev)
+	:
+		Interest(set, fd, kev.filter == EVFILT_READ ? POLLIN : POLLOUT),
+		ident(fd.libc_fd), filter(kev.filter),
+		flags(kev.flags & (EV_ONESHOT | EV_CLEAR | EV_DISPATCH)),
+		udata(kev.udata)
+	{ }
+};
+
+
+class Libc::Kqueue : public Plugin_context
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Kqueue(Kqueue const &);
+		Kqueue &operator = (Kqueue const &);
+
+		enum { NUM_BUCKETS = 1024 };
+
+		Genode::Lock _lock { };
+
+		Interest_set _interests { };
+
+		Knote *_buckets[NUM_BUCKETS] { };
+
+		Knote *&_bucket(int ident) { return _buckets[ident % NUM_BUCKETS]; }
+
+		Knote *_lookup(int ident, short filter)
+		{
+			for (Knote *k = _bucket(ident); k; k = k->hash_next)
+				if (k->ident == ident && k->filter == filter)
+					return k;
+
+			return nullptr;
+		}
+
+		void _destroy(Knote &knote)
+		{
+			for (Knote **k = &_bucket(knote.ident); *k; k = &(*k)->hash_next) {
+				if (*k == &knote) {
+					*k = knote.hash_next;
+					break;
+				}
+			}
+
+			_interests.remove(knote);
+			destroy(kqueue_allocator(), &knote);
+		}
+
+		/**
+		 * Return errno value of change, or 0 on success
+		 */
+		int _apply(struct kevent const &kev)
+		{
+			if (kev.filter != EVFILT_READ && kev.filter != EVFILT_WRITE)
+				return EINVAL;
+
+			if (kev.ident >= MAX_NUM_FDS)
+				return EBADF;
+
+			int const ident = (int)kev.ident;
+
+			/* drop event of descriptor that was closed meanwhile */
+			Knote *knote = _lookup(ident, kev.filter);
+			if (knote && !knote->fd()) {
+				_destroy(*knote);
+				knote = nullptr;
+			}
+
+			if (kev.flags & EV_ADD) {
+
+				if (!knote) {
+					File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(ident);
+					if (!fd || !fd->plugin || !fd->plugin->supports_poll())
+						return EBADF;
+
+					try { knote = new (kqueue_allocator()) Knote(_interests, *fd, kev); }
+					catch (Genode::Out_of_ram)  { return ENOMEM; }
+					catch (Genode::Out_of_caps) { return ENOMEM; }
+
+					knote->hash_next = _bucket(ident);
+					_bucket(ident) = knote;
+					_interests.insert(*knote);
+				} else {
+					knote->flags = kev.flags & (EV_ONESHOT | EV_CLEAR | EV_DISPATCH);
+				}
+
+				knote->udata   = kev.udata;
+				knote->enabled = !(kev.flags & EV_DISABLE);
+
+				if (knote->enabled)
+					_interests.rearm(*knote);
+
+				return 0;
+			}
+
+			if (!knote)
+				return ENOENT;
+
+			if (kev.flags & EV_DELETE) {
+				_destroy(*knote);
+				return 0;
+			}
+
+			if (kev.flags & EV_ENABLE) {
+				knote->enabled = true;
+				_interests.rearm(*knote);
+			}
+
+			if (kev.flags & EV_DISABLE)
+				knote->enabled = false;
+
+			return 0;
+		}
+
+	public:
+
+		Kqueue() { }
+
+		~Kqueue()
+		{
+			for (unsigned i = 0; i < NUM_BUCKETS; i++)
+				while (_buckets[i])
+					_destroy(*_buckets[i]);
+		}
+
+		/**
+		 * Apply change list
+		 *
+		 * Errors and receipts are reported in the event list as long as
+		 * there is space left.
+		 *
+		 * \return number of reported events, or -1 if an error could not
+		 *         be reported
+		 */
+		int apply(struct kevent const *changes, int nchanges,
+		          struct kevent *events, int nevents)
+		{
+			Genode::Lock::Guard guard(_lock);
+
+			int n = 0;
+			for (int i = 0; i < nchanges; i++) {
+
+				int const error = _apply(changes[i]);
+
+				if (!error && !(changes[i].flags & EV_RECEIPT))
+					continue;
+
+				if (n >= nevents) {
+					if (error)
+						return Errno(error);
+					continue;
+				}
+
+				events[n]       = changes[i];
+				events[n].flags = EV_ERROR;
+				events[n].data  = error;
+				n++;
+			}
+			return n;
+		}
+
+		/**
+		 * Report ready events
+		 *
+		 * \return number of reported events
+		 */
+		int collect(struct kevent *events, int nevents)
+		{
+			Genode::Lock::Guard guard(_lock);
+
+			if (nevents <= 0)
+				return 0;
+
+			int n = 0;
+
+			_interests.check([&] (Interest &interest, short revents) {
+
+				Knote &knote = static_cast<Knote &>(interest);
+
+				/* the descriptor was closed */
+				if (!knote.fd()) {
+					_destroy(knote);
+					return true;
+				}
+
+				/* re-armed by 'EV_ENABLE' */
+				if (!knote.enabled)
+					return true;
+
+				unsigned short const flags =
+					(revents & (POLLHUP | POLLERR | POLLNVAL)) ? EV_EOF : 0;
+
+				EV_SET(&events[n++], knote.ident, knote.filter, flags, 0, 1,
+				       knote.udata);
+
+				if (knote.flags & EV_ONESHOT)
+					_destroy(knote);
+				else if (knote.flags & EV_DISPATCH)
+					knote.enabled = false;
+				else if (!(knote.flags & EV_CLEAR))
+					_interests.rearm(knote);
+
+				return n < nevents;
+			});
+
+			return n;
+		}
+};
+
+
+struct Libc::Kqueue_plugin : Plugin
+{
+	int close(File_descriptor *fd) override
+	{
+		Kqueue *kqueue = dynamic_cast<Kqueue *>(fd->context);
+		if (!kqueue) return Errno(EBADF);
+
+		destroy(kqueue_allocator(), kqueue);
+		file_descriptor_allocator()->free(fd);
+		return 0;
+	}
+};
+
+
+Libc::Kqueue_plugin &Libc::kqueue_plugin()
+{
+	static Kqueue_plugin inst;
+	return inst;
+}
+
+
+extern "C" __attribute__((weak))
+int kqueue(void)
+{
+	using namespace Libc;
+
+	Kqueue *kqueue = nullptr;
+	try { kqueue = new (kqueue_allocator()) Kqueue(); }
+	catch (Genode::Out_of_ram)  { return Errno(ENOMEM); }
+	catch (Genode::Out_of_caps) { return Errno(ENOMEM); }
+
+	File_descriptor *fd =
+		file_descriptor_allocator()->alloc(&kqueue_plugin(), kqueue);
+
+	if (!fd) {
+		destroy(kqueue_allocator(), kqueue);
+		return Errno(EMFILE);
+	}
+
+	return fd->libc_fd;
+}
+
+
+extern "C" __attribute__((weak))
+int kevent(int kq, struct kevent const *changelist, int nchanges,
+           struct kevent *eventlist, int nevents,
+           struct timespec const *timeout)
+{
+	using namespace Libc;
+
+	File_descriptor *fd = libc_fd_to_fd(kq, "kevent");
+	if (!fd || fd->plugin != &kqueue_plugin())
+		return Errno(EBADF);
+
+	Kqueue &kqueue = *static_cast<Kqueue *>(fd->context);
+
+	if (nchanges < 0 || nevents < 0)
+		return Errno(EINVAL);
+
+	if (nchanges > 0 && !changelist)
+		return Errno(EFAULT);
+
+	if (nevents > 0 && !eventlist)
+		return Errno(EFAULT);
+
+	int const nreported = kqueue.apply(changelist, nchanges, eventlist, nevents);
+	if (nreported != 0 || nevents == 0)
+		return nreported;
+
+	struct Check : Libc::Suspend_functor
+	{
+		Kqueue        &_kqueue;
+		struct kevent *_events;
+		int const      _nevents;
+
+		int nready { 0 };
+
+		Check(Kqueue &kqueue, struct kevent *events, int nevents)
+		: _kqueue(kqueue), _events(events), _nevents(nevents) { }
+
+		bool suspend() override
+		{
+			nready = _kqueue.collect(_events, _nevents);
+			return nready == 0;
+		}
+
+	} check (kqueue, eventlist, nevents);
+
+	check.suspend();
+
+	if (!timeout) {
+		while (check.nready == 0)
+			Libc::suspend(check, 0);
+
+		return check.nready;
+	}
+
+	/* round up to not turn a short timeout into polling */
+	Genode::uint64_t remaining_ms = timeout->tv_sec*1000
+	                              + (timeout->tv_nsec + 999999)/1000000;
+
+	while (check.nready == 0 && remaining_ms > 0)
+		remaining_ms = Libc::suspend(check, remaining_ms);
+
+	return check.nready;
+}
+
+
+extern "C" __attribute__((weak, alias("kevent")))
+int __sys_kevent(int kq, struct kevent const *changelist, int nchanges,
+                 struct kevent *eventlist, int nevents,
+                 struct timespec const *timeout);
+
+
+extern "C" __attribute__((weak, alias("kevent")))
+int _kevent(int kq, struct kevent const *changelist, int nchanges,
+            struct kevent *eventlist, int nevents,
+            struct timespec const *timeout);
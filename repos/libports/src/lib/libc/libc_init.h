@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2016-2017 Genode Labs GmbH
+ * Copyright (C) 2016-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -58,6 +58,11 @@ namespace Libc {
 	void init_malloc_cloned(Clone_connection &);
 	void reinit_malloc(Genode::Allocator &);
 
+	/**
+	 * Return blocks cached by the calling thread, used at thread exit
+	 */
+	void flush_malloc_thread_cache();
+
 	/**
 	 * Allow thread.cc to access the 'Genode::Env' (needed for the
 	 * implementation of condition variables with timeout)
@@ -6,7 +6,7 @@
  */
 
 /*
- * Copyright (C) 2006-2017 Genode Labs GmbH
+ * Copyright (C) 2006-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -16,6 +16,10 @@
 #include <base/env.h>
 #include <base/log.h>
 #include <base/slab.h>
+#include <base/thread.h>
+#include <cpu/atomic.h>
+#include <cpu/memory_barrier.h>
+#include <libc/malloc_stats.h>
 #include <util/reconstructible.h>
 #include <util/string.h>
 #include <util/misc_math.h>
@@ -72,6 +76,16 @@ class Libc::Slab_alloc : public Slab
 
 /**
  * Allocator that uses slabs for small objects sizes
+ *
+ * Each thread keeps a magazine of free slab blocks per size class, which
+ * serves most allocations and frees without taking the lock of the slabs.
+ * Magazines are exchanged with the slabs in batches. A block may be freed
+ * by any thread because all threads share the same slabs.
+ *
+ * The capacity of each block is recorded in its metadata so that 'realloc'
+ * can grow a block in place as long as the new size fits. Blocks from the
+ * backing store are rounded up for this purpose, and blocks that outgrew
+ * their capacity get some headroom for further growth.
  */
 class Libc::Malloc
 {
@@ -86,6 +100,13 @@ class Libc::Malloc
 			NUM_SLABS  = (SLAB_STOP - SLAB_START) + 1
 		};
 
+		enum {
+			MAGAZINE_ROUNDS = 16, /* cached blocks per thread and size class */
+			MAX_THREADS     = 32, /* number of thread caches */
+		};
+
+		enum { BIG_BLOCK_SIZE = 64*1024 };
+
 		struct Metadata
 		{
 			unsigned long long value; /* bits 63..5 size and 4..0 offset */
@@ -93,7 +114,7 @@ class Libc::Malloc
 			/**
 			 * Allocation metadata
 			 *
-			 * \param size    allocation size
+			 * \param size    capacity of the allocation
 			 * \param offset  offset of pointer from allocation
 			 */
 			Metadata(size_t size, unsigned offset)
@@ -118,12 +139,31 @@ class Libc::Malloc
 		 */
 		static constexpr size_t _room() { return sizeof(Metadata) + 15; }
 
+		struct Magazine
+		{
+			void    *rounds[MAGAZINE_ROUNDS];
+			unsigned count;
+		};
+
+		struct Thread_cache
+		{
+			int volatile     claimed;
+			Thread *volatile owner;
+			Magazine         magazines[NUM_SLABS];
+			Malloc_stats     stats;
+		};
+
 		Allocator &_backing_store; /* back-end allocator */
 
 		Constructible<Slab_alloc> _slabs[NUM_SLABS]; /* slab allocators */
 
 		Lock _lock;
 
+		Thread_cache _caches[MAX_THREADS] { };
+
+		/* statistics of threads without cache, protected by '_lock' */
+		Malloc_stats _stats { };
+
 		unsigned _slab_log2(size_t size) const
 		{
 			unsigned msb = Genode::log2(size);
@@ -139,34 +179,139 @@ class Libc::Malloc
 			return msb;
 		}
 
-	public:
-
-		Malloc(Allocator &backing_store) : _backing_store(backing_store)
+		/**
+		 * Return capacity of a block from the backing store
+		 *
+		 * Big blocks occupy whole pages of a dedicated dataspace anyway.
+		 * Smaller blocks are rounded to an eighth of their power of two.
+		 */
+		size_t _backing_store_capacity(size_t size) const
 		{
-			for (unsigned i = SLAB_START; i <= SLAB_STOP; i++)
-				_slabs[i - SLAB_START].construct(1U << i, backing_store);
-		}
+			if (size >= BIG_BLOCK_SIZE)
+				return align_addr(size, 12);
 
-		~Malloc() { warning(__func__, " unexpectedly called"); }
+			return align_addr(size, _slab_log2(size) - 3);
+		}
 
 		/**
-		 * Allocator interface
+		 * Return cache of calling thread, claim a free slot if needed
+		 *
+		 * \return  nullptr if no slot is available
 		 */
+		Thread_cache *_thread_cache()
+		{
+			Thread * const myself = Thread::myself();
+			if (!myself)
+				return nullptr;
+
+			/* start probing at a slot derived from the 'Thread' object address */
+			unsigned const start = (unsigned)(((addr_t)myself >> 6) % MAX_THREADS);
+
+			for (unsigned i = 0; i < MAX_THREADS; i++) {
+				Thread_cache &cache = _caches[(start + i) % MAX_THREADS];
+				if (cache.owner == myself)
+					return &cache;
+			}
+
+			for (unsigned i = 0; i < MAX_THREADS; i++) {
+				Thread_cache &cache = _caches[(start + i) % MAX_THREADS];
+				if (cache.claimed || !cmpxchg(&cache.claimed, 0, 1))
+					continue;
+
+				for (unsigned c = 0; c < NUM_SLABS; c++)
+					cache.magazines[c].count = 0;
+
+				cache.owner = myself;
+				return &cache;
+			}
+			return nullptr;
+		}
 
-		void * alloc(size_t size)
+		void _refill(unsigned c, Magazine &magazine)
 		{
 			Lock::Guard lock_guard(_lock);
 
-			size_t   const real_size = size + _room();
-			unsigned const msb       = _slab_log2(real_size);
+			while (magazine.count < MAGAZINE_ROUNDS/2) {
+				void * const block = _slabs[c]->alloc();
+				if (!block)
+					break;
+				magazine.rounds[magazine.count++] = block;
+			}
+		}
 
-			void *alloc_addr = nullptr;
+		void _spill(unsigned c, Magazine &magazine, unsigned count)
+		{
+			Lock::Guard lock_guard(_lock);
 
-			/* use backing store if requested memory is larger than largest slab */
-			if (msb > SLAB_STOP)
-				_backing_store.alloc(real_size, &alloc_addr);
+			for (; count && magazine.count; count--)
+				_slabs[c]->free(magazine.rounds[--magazine.count]);
+		}
+
+		void *_slab_alloc(unsigned c)
+		{
+			Thread_cache * const cache = _thread_cache();
+			if (!cache) {
+				Lock::Guard lock_guard(_lock);
+				_stats.allocs++;
+				return _slabs[c]->alloc();
+			}
+
+			cache->stats.allocs++;
+
+			Magazine &magazine = cache->magazines[c];
+			if (magazine.count)
+				cache->stats.cached_allocs++;
 			else
-				alloc_addr = _slabs[msb - SLAB_START]->alloc();
+				_refill(c, magazine);
+
+			return magazine.count ? magazine.rounds[--magazine.count] : nullptr;
+		}
+
+		void _slab_free(unsigned c, void *block)
+		{
+			Thread_cache * const cache = _thread_cache();
+			if (!cache) {
+				Lock::Guard lock_guard(_lock);
+				_stats.frees++;
+				_slabs[c]->free(block);
+				return;
+			}
+
+			cache->stats.frees++;
+
+			Magazine &magazine = cache->magazines[c];
+			if (magazine.count == MAGAZINE_ROUNDS)
+				_spill(c, magazine, MAGAZINE_ROUNDS/2);
+			else
+				cache->stats.cached_frees++;
+
+			magazine.rounds[magazine.count++] = block;
+		}
+
+		/**
+		 * Allocate block for at least 'real_size' bytes including overhead
+		 */
+		void *_alloc(size_t real_size)
+		{
+			unsigned const msb = _slab_log2(real_size);
+
+			void  *alloc_addr = nullptr;
+			size_t capacity   = 0;
+
+			/* use backing store if requested memory is larger than largest slab */
+			if (msb > SLAB_STOP) {
+				capacity = _backing_store_capacity(real_size);
+
+				Lock::Guard lock_guard(_lock);
+				if (_backing_store.alloc(capacity, &alloc_addr)) {
+					_stats.allocs++;
+					_stats.backing_store_allocs++;
+					_stats.backing_store_bytes += capacity;
+				}
+			} else {
+				capacity   = 1UL << msb;
+				alloc_addr = _slab_alloc(msb - SLAB_START);
+			}
 
 			if (!alloc_addr) return nullptr;
 
@@ -176,29 +321,80 @@ class Libc::Malloc
 
 			unsigned const offset = (addr_t)aligned_addr - (addr_t)alloc_addr;
 
-			*(aligned_addr - 1) = Metadata(real_size, offset);
+			*(aligned_addr - 1) = Metadata(capacity, offset);
 
 			return aligned_addr;
 		}
 
+		void _count_realloc(bool in_place)
+		{
+			Thread_cache * const cache = _thread_cache();
+			if (cache) {
+				in_place ? cache->stats.reallocs_in_place++
+				         : cache->stats.reallocs_moved++;
+				return;
+			}
+
+			Lock::Guard lock_guard(_lock);
+			in_place ? _stats.reallocs_in_place++ : _stats.reallocs_moved++;
+		}
+
+		static void _add(Malloc_stats &sum, Malloc_stats const &stats)
+		{
+			sum.allocs               += stats.allocs;
+			sum.frees                += stats.frees;
+			sum.cached_allocs        += stats.cached_allocs;
+			sum.cached_frees         += stats.cached_frees;
+			sum.reallocs_in_place    += stats.reallocs_in_place;
+			sum.reallocs_moved       += stats.reallocs_moved;
+			sum.backing_store_allocs += stats.backing_store_allocs;
+			sum.backing_store_bytes  += stats.backing_store_bytes;
+		}
+
+	public:
+
+		Malloc(Allocator &backing_store) : _backing_store(backing_store)
+		{
+			for (unsigned i = SLAB_START; i <= SLAB_STOP; i++)
+				_slabs[i - SLAB_START].construct(1U << i, backing_store);
+		}
+
+		~Malloc() { warning(__func__, " unexpectedly called"); }
+
+		/**
+		 * Allocator interface
+		 */
+
+		void * alloc(size_t size) { return _alloc(size + _room()); }
+
 		void *realloc(void *ptr, size_t size)
 		{
-			size_t const real_size     = size + _room();
-			size_t const old_real_size = ((Metadata *)ptr - 1)->size();
+			Metadata const &md = *((Metadata *)ptr - 1);
+
+			size_t const real_size = size + _room();
+			size_t const capacity  = md.size();
 
-			/* do not reallocate if new size is less than the current size */
-			if (real_size <= old_real_size)
+			/* keep the block if the new size fits */
+			if (real_size <= capacity) {
+				_count_realloc(true);
 				return ptr;
+			}
+
+			/* give blocks from the backing store room to grow in place */
+			size_t const grown_size = (real_size > (1UL << SLAB_STOP))
+			                        ? max(real_size, capacity + capacity/2)
+			                        : real_size;
 
-			/* allocate new block */
-			void *new_addr = alloc(size);
+			void *new_addr = _alloc(grown_size);
 
 			if (new_addr) {
 				/* copy content from old block into new block */
-				::memcpy(new_addr, ptr, old_real_size - _room());
+				::memcpy(new_addr, ptr, capacity - md.offset());
 
 				/* free old block */
 				free(ptr);
+
+				_count_realloc(false);
 			}
 
 			return new_addr;
@@ -206,21 +402,69 @@ class Libc::Malloc
 
 		void free(void *ptr)
 		{
-			Lock::Guard lock_guard(_lock);
-
 			Metadata *md = (Metadata *)ptr - 1;
 
-			size_t   const  real_size  = md->size();
-			unsigned const  msb        = _slab_log2(real_size);
+			size_t   const  capacity   = md->size();
+			unsigned const  msb        = _slab_log2(capacity);
 
 			void *alloc_addr = (void *)((addr_t)ptr - md->offset());
 
 			if (msb > SLAB_STOP) {
-				_backing_store.free(alloc_addr, real_size);
+				Lock::Guard lock_guard(_lock);
+				_stats.frees++;
+				_stats.backing_store_bytes -= capacity;
+				_backing_store.free(alloc_addr, capacity);
 			} else {
-				_slabs[msb - SLAB_START]->free(alloc_addr);
+				_slab_free(msb - SLAB_START, alloc_addr);
 			}
 		}
+
+		/**
+		 * Return cached blocks of the calling thread to the slabs
+		 *
+		 * The cache slot of the thread is released.
+		 */
+		void flush_thread_cache()
+		{
+			Thread * const myself = Thread::myself();
+			if (!myself)
+				return;
+
+			for (unsigned i = 0; i < MAX_THREADS; i++) {
+				Thread_cache &cache = _caches[i];
+				if (cache.owner != myself)
+					continue;
+
+				for (unsigned c = 0; c < NUM_SLABS; c++)
+					_spill(c, cache.magazines[c], MAGAZINE_ROUNDS);
+
+				Lock::Guard lock_guard(_lock);
+				_add(_stats, cache.stats);
+				cache.stats = Malloc_stats();
+
+				cache.owner = nullptr;
+				memory_barrier();
+				cache.claimed = 0;
+				return;
+			}
+		}
+
+		Malloc_stats stats()
+		{
+			Lock::Guard lock_guard(_lock);
+
+			Malloc_stats sum = _stats;
+
+			/* counters of other threads are read without synchronization */
+			for (unsigned i = 0; i < MAX_THREADS; i++)
+				if (_caches[i].claimed)
+					_add(sum, _caches[i].stats);
+
+			for (unsigned i = 0; i < NUM_SLABS; i++)
+				sum.slab_bytes += _slabs[i]->consumed();
+
+			return sum;
+		}
 };
 
 
@@ -267,6 +511,19 @@ static Genode::Constructible<Libc::Malloc> &constructible_malloc()
 }
 
 
+void Libc::flush_malloc_thread_cache()
+{
+	if (mallocator)
+		mallocator->flush_thread_cache();
+}
+
+
+Libc::Malloc_stats Libc::malloc_stats()
+{
+	return mallocator ? mallocator->stats() : Malloc_stats();
+}
+
+
 void Libc::init_malloc(Genode::Allocator &heap)
 {
 
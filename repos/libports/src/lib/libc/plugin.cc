@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -136,6 +136,12 @@ bool Plugin::supports_mmap()
 }
 
 
+bool Plugin::notifies_readiness(File_descriptor &)
+{
+	return false;
+}
+
+
 /**
  * Generate dummy member function of Plugin class
  */
@@ -12,17 +12,35 @@
  * under the terms of the GNU Affero General Public License version 3.
  */
 
+/* Genode includes */
+#include <util/construct_at.h>
+
 /* Libc includes */
 #include <libc-plugin/plugin_registry.h>
 #include <libc-plugin/plugin.h>
 #include <sys/poll.h>
+#include <stdlib.h>
 
 /* internal includes */
 #include "libc_errno.h"
 #include "libc_file.h"
+#include "readiness.h"
 #include "task.h"
 
 
+namespace Libc { struct Poll_interest; }
+
+
+struct Libc::Poll_interest : Interest
+{
+	unsigned const index;
+
+	Poll_interest(Interest_set &set, File_descriptor &fd, short events,
+	              unsigned index)
+	: Interest(set, fd, events), index(index) { }
+};
+
+
 extern "C" __attribute__((weak))
 int poll(struct pollfd fds[], nfds_t nfds, int timeout_ms)
 {
@@ -30,61 +48,84 @@ int poll(struct pollfd fds[], nfds_t nfds, int timeout_ms)
 
 	if (!fds || nfds == 0) return Errno(EINVAL);
 
+	Poll_interest *entries = (Poll_interest *)malloc(nfds*sizeof(Poll_interest));
+	if (!entries) return Errno(ENOMEM);
+
+	/*
+	 * Wakeups re-check only the descriptors that were notified by their
+	 * plugins since the last check, and those of plugins that do not
+	 * notify.
+	 */
+	Interest_set interests;
+
 	struct Check : Libc::Suspend_functor
 	{
+		Interest_set &_interests;
 		pollfd       *_fds;
-		nfds_t const  _nfds;
 
 		int nready { 0 };
 
-		Check(struct pollfd fds[], nfds_t nfds)
-		: _fds(fds), _nfds(nfds) { }
+		Check(Interest_set &interests, struct pollfd fds[])
+		: _interests(interests), _fds(fds) { }
 
 		bool suspend() override
 		{
-			bool polling = false;
-
-			for (unsigned i = 0; i < _nfds; ++i)
-			{
-				pollfd &pfd = _fds[i];
-				File_descriptor *libc_fd = libc_fd_to_fd(pfd.fd, "poll");
-				if (!libc_fd) {
-					pfd.revents |= POLLNVAL;
-					++nready;
-					continue;
-				}
-
-				if (!libc_fd->plugin || !libc_fd->plugin->supports_poll()) {
-					Genode::warning("poll not supported for file descriptor ", pfd.fd);
-					continue;
-				}
-
-				nready += libc_fd->plugin->poll(*libc_fd, pfd);
-				polling = true;
-			}
+			nready += _interests.check([&] (Interest &interest, short revents) {
+				_fds[static_cast<Poll_interest &>(interest).index].revents = revents;
+				return true;
+			});
 
-			return (polling && nready == 0);
+			return nready == 0;
 		}
 
-	} check (fds, nfds);
+	} check (interests, fds);
 
-	check.suspend();
+	unsigned nentries = 0;
 
-	if (timeout_ms == 0) {
-		return check.nready;
-	}
+	for (unsigned i = 0; i < nfds; ++i)
+	{
+		pollfd &pfd = fds[i];
+		pfd.revents = 0;
+
+		File_descriptor *libc_fd = libc_fd_to_fd(pfd.fd, "poll");
+		if (!libc_fd) {
+			pfd.revents |= POLLNVAL;
+			++check.nready;
+			continue;
+		}
 
-	if (timeout_ms == -1) {
-		while (check.nready == 0) {
-			Libc::suspend(check, 0);
+		if (!libc_fd->plugin || !libc_fd->plugin->supports_poll()) {
+			Genode::warning("poll not supported for file descriptor ", pfd.fd);
+			continue;
 		}
-	} else {
-		Genode::uint64_t remaining_ms = timeout_ms;
-		while (check.nready == 0 && remaining_ms > 0) {
-			remaining_ms = Libc::suspend(check, remaining_ms);
+
+		Poll_interest &entry = *Genode::construct_at<Poll_interest>(
+			&entries[nentries++], interests, *libc_fd, pfd.events, i);
+
+		interests.insert(entry);
+	}
+
+	check.suspend();
+
+	if (nentries > 0 && timeout_ms != 0) {
+		if (timeout_ms == -1) {
+			while (check.nready == 0) {
+				Libc::suspend(check, 0);
+			}
+		} else {
+			Genode::uint64_t remaining_ms = timeout_ms;
+			while (check.nready == 0 && remaining_ms > 0) {
+				remaining_ms = Libc::suspend(check, remaining_ms);
+			}
 		}
 	}
 
+	for (unsigned i = 0; i < nentries; ++i) {
+		interests.remove(entries[i]);
+		entries[i].~Poll_interest();
+	}
+	free(entries);
+
 	return check.nready;
 }
 
@@ -0,0 +1,165 @@
+/*
+ * \brief  Interest sets for the readiness of file descriptors
+ * \author Genode Labs
+ * \date   2019-10-22
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/lock.h>
+
+/* libc includes */
+#include <sys/poll.h>
+
+/* libc-internal includes */
+#include "readiness.h"
+
+using namespace Libc;
+
+
+/**
+ * Lock protecting the interest lists of all descriptors and the pending
+ * lists of all interest sets
+ */
+static Genode::Lock &readiness_lock()
+{
+	static Genode::Lock lock;
+	return lock;
+}
+
+
+void Libc::notify_readiness(File_descriptor &fd)
+{
+	Genode::Lock::Guard guard(readiness_lock());
+
+	for (File_descriptor *f = &fd; f; f = f->readiness_owner)
+		for (Interest *i = f->interests; i; i = i->_fd_next)
+			i->_set._mark_pending(*i);
+}
+
+
+void Libc::release_interests(File_descriptor &fd)
+{
+	Genode::Lock::Guard guard(readiness_lock());
+
+	while (Interest *i = fd.interests) {
+		fd.interests = i->_fd_next;
+
+		i->_fd_next  = nullptr;
+		i->_fd       = nullptr;
+		i->_notified = false;
+		i->_set._mark_pending(*i);
+	}
+}
+
+
+void Interest_set::_mark_pending(Interest &interest)
+{
+	if (interest._pending)
+		return;
+
+	interest._pending      = true;
+	interest._pending_next = _pending;
+	_pending = &interest;
+}
+
+
+Interest *Interest_set::_take_pending()
+{
+	Genode::Lock::Guard guard(readiness_lock());
+
+	Interest *list = _pending;
+	_pending = nullptr;
+	return list;
+}
+
+
+Interest *Interest_set::_next_taken(Interest *&list)
+{
+	Genode::Lock::Guard guard(readiness_lock());
+
+	Interest *i = list;
+	if (!i)
+		return nullptr;
+
+	list = i->_pending_next;
+
+	i->_pending_next = nullptr;
+	i->_pending      = false;
+	return i;
+}
+
+
+short Interest_set::_poll(Interest &interest)
+{
+	File_descriptor *fd = interest.fd();
+	if (!fd)
+		return POLLNVAL;
+
+	pollfd pfd { fd->libc_fd, interest.events, 0 };
+	fd->plugin->poll(*fd, pfd);
+
+	/* descriptors without notification are checked on each wakeup */
+	if (!interest._notified)
+		rearm(interest);
+
+	return pfd.revents;
+}
+
+
+void Interest_set::insert(Interest &interest)
+{
+	File_descriptor &fd = *interest._fd;
+
+	bool const notified = fd.plugin && fd.plugin->notifies_readiness(fd);
+
+	Genode::Lock::Guard guard(readiness_lock());
+
+	interest._notified = notified;
+	interest._fd_next  = fd.interests;
+	fd.interests = &interest;
+
+	_mark_pending(interest);
+}
+
+
+void Interest_set::remove(Interest &interest)
+{
+	Genode::Lock::Guard guard(readiness_lock());
+
+	if (interest._fd) {
+		for (Interest **i = &interest._fd->interests; *i; i = &(*i)->_fd_next) {
+			if (*i == &interest) {
+				*i = interest._fd_next;
+				break;
+			}
+		}
+		interest._fd_next = nullptr;
+	}
+
+	if (interest._pending) {
+		for (Interest **i = &_pending; *i; i = &(*i)->_pending_next) {
+			if (*i == &interest) {
+				*i = interest._pending_next;
+				interest._pending_next = nullptr;
+				interest._pending      = false;
+				break;
+			}
+		}
+	}
+}
+
+
+void Interest_set::rearm(Interest &interest)
+{
+	Genode::Lock::Guard guard(readiness_lock());
+
+	if (interest._fd)
+		_mark_pending(interest);
+}
@@ -0,0 +1,180 @@
+/*
+ * \brief  Interest sets for the readiness of file descriptors
+ * \author Genode Labs
+ * \date   2019-10-22
+ *
+ * An interest set holds one entry per observed descriptor. Plugins that
+ * report readiness changes via 'Libc::notify_readiness' mark the affected
+ * entries as pending, so that a wakeup costs time proportional to the
+ * number of notified descriptors instead of the number of observed ones.
+ * Descriptors of plugins without notification support are checked on each
+ * wakeup.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _LIBC__READINESS_H_
+#define _LIBC__READINESS_H_
+
+/* libc plugin interface */
+#include <libc-plugin/fd_alloc.h>
+
+namespace Libc {
+
+	class Interest;
+	class Interest_set;
+
+	/**
+	 * Detach the interest-set entries from a descriptor that is closed
+	 *
+	 * The entries are reported as invalid on the next check.
+	 */
+	void release_interests(File_descriptor &);
+}
+
+
+/**
+ * Entry of an interest set that observes one file descriptor
+ */
+class Libc::Interest
+{
+	private:
+
+		friend class Interest_set;
+		friend void notify_readiness(File_descriptor &);
+		friend void release_interests(File_descriptor &);
+
+		/*
+		 * Noncopyable
+		 */
+		Interest(Interest const &);
+		Interest &operator = (Interest const &);
+
+		Interest_set    &_set;
+		File_descriptor *_fd;
+
+		Interest *_fd_next      { nullptr };
+		Interest *_pending_next { nullptr };
+		bool      _pending      { false };
+		bool      _notified     { false };
+
+	public:
+
+		/**
+		 * Events of interest as defined for 'poll'
+		 */
+		short const events;
+
+		Interest(Interest_set &set, File_descriptor &fd, short events)
+		: _set(set), _fd(&fd), events(events) { }
+
+		virtual ~Interest() { }
+
+		/**
+		 * Return observed descriptor, or nullptr if it was closed
+		 */
+		File_descriptor *fd() const { return _fd; }
+};
+
+
+class Libc::Interest_set
+{
+	private:
+
+		friend void notify_readiness(File_descriptor &);
+		friend void release_interests(File_descriptor &);
+
+		/*
+		 * Noncopyable
+		 */
+		Interest_set(Interest_set const &);
+		Interest_set &operator = (Interest_set const &);
+
+		Interest *_pending { nullptr };
+
+		/**
+		 * Enqueue entry for the next check, the caller holds the lock
+		 */
+		void _mark_pending(Interest &);
+
+		/**
+		 * Take the list of pending entries
+		 */
+		Interest *_take_pending();
+
+		/**
+		 * Dequeue first entry of list returned by '_take_pending'
+		 */
+		Interest *_next_taken(Interest *&list);
+
+		/**
+		 * Return 'poll' events of the observed descriptor
+		 */
+		short _poll(Interest &);
+
+	public:
+
+		Interest_set() { }
+
+		/**
+		 * Start observing the descriptor of 'interest'
+		 *
+		 * The entry is checked on the next call of 'check'.
+		 */
+		void insert(Interest &interest);
+
+		/**
+		 * Stop observing the descriptor of 'interest'
+		 */
+		void remove(Interest &interest);
+
+		/**
+		 * Check entry again on the next call of 'check'
+		 *
+		 * This is used to implement level-triggered semantics for entries
+		 * that were reported as ready.
+		 */
+		void rearm(Interest &interest);
+
+		/**
+		 * Check the entries that may have become ready
+		 *
+		 * \param fn  functor called with each ready entry and its 'poll'
+		 *            events, returns false to stop checking
+		 *
+		 * \return number of ready entries
+		 *
+		 * Entries left unchecked remain pending.
+		 */
+		template <typename FN>
+		unsigned check(FN const &fn)
+		{
+			unsigned nready = 0;
+			bool     done   = false;
+
+			Interest *list = _take_pending();
+
+			for (Interest *i; (i = _next_taken(list)); ) {
+
+				if (done) {
+					rearm(*i);
+					continue;
+				}
+
+				short const revents = _poll(*i);
+				if (!revents)
+					continue;
+
+				nready++;
+				done = !fn(*i, revents);
+			}
+			return nready;
+		}
+};
+
+#endif /* _LIBC__READINESS_H_ */
@@ -14,7 +14,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -22,6 +22,7 @@
 
 /* Genode includes */
 #include <base/log.h>
+#include <util/construct_at.h>
 #include <util/reconstructible.h>
 
 /* Libc includes */
@@ -29,13 +30,16 @@
 #include <libc-plugin/plugin.h>
 #include <libc/select.h>
 #include <stdlib.h>
+#include <sys/poll.h>
 #include <sys/select.h>
 #include <signal.h>
 
+#include "readiness.h"
 #include "task.h"
 
 
 namespace Libc {
+	struct Select_interest;
 	struct Select_cb;
 	struct Select_cb_list;
 }
@@ -44,6 +48,15 @@ namespace Libc {
 void (*libc_select_notify)() __attribute__((weak));
 
 
+struct Libc::Select_interest : Interest
+{
+	int const libc_fd;
+
+	Select_interest(Interest_set &set, File_descriptor &fd, short events)
+	: Interest(set, fd, events), libc_fd(fd.libc_fd) { }
+};
+
+
 /** Description for a task waiting in select */
 struct Libc::Select_cb
 {
@@ -51,14 +64,43 @@ struct Libc::Select_cb
 
 	int const nfds;
 	int       nready = 0;
+
+	/* descriptors found ready by 'scan' */
 	fd_set    readfds;
 	fd_set    writefds;
 	fd_set    exceptfds;
 
-	Select_cb(int nfds, fd_set const &readfds, fd_set const &writefds, fd_set const &exceptfds)
-	:
-		nfds(nfds), readfds(readfds), writefds(writefds), exceptfds(exceptfds)
-	{ }
+	/*
+	 * Descriptors of plugins that support 'poll' are observed via an
+	 * interest set, so that a scan checks only descriptors that were
+	 * notified. The remaining descriptors are passed to the 'select'
+	 * implementations of their plugins on each scan.
+	 */
+	Interest_set     _interests   { };
+	Select_interest *_entries     { nullptr };
+	unsigned         _num_entries { 0 };
+
+	bool   _legacy { false };
+	fd_set _legacy_readfds;
+	fd_set _legacy_writefds;
+	fd_set _legacy_exceptfds;
+
+	/*
+	 * Noncopyable
+	 */
+	Select_cb(Select_cb const &);
+	Select_cb &operator = (Select_cb const &);
+
+	Select_cb(int nfds, fd_set const &readfds, fd_set const &writefds, fd_set const &exceptfds);
+
+	~Select_cb();
+
+	/**
+	 * Add newly ready descriptors to the result
+	 *
+	 * \return number of ready descriptors
+	 */
+	int scan();
 };
 
 
@@ -174,26 +216,134 @@ static int selscan(int nfds,
 }
 
 
+Libc::Select_cb::Select_cb(int nfds, fd_set const &in_readfds,
+                           fd_set const &in_writefds, fd_set const &in_exceptfds)
+:
+	nfds(nfds)
+{
+	FD_ZERO(&readfds);
+	FD_ZERO(&writefds);
+	FD_ZERO(&exceptfds);
+
+	FD_ZERO(&_legacy_readfds);
+	FD_ZERO(&_legacy_writefds);
+	FD_ZERO(&_legacy_exceptfds);
+
+	unsigned max_entries = 0;
+	for (int fd = 0; fd < nfds; fd++)
+		if (FD_ISSET(fd, &in_readfds) || FD_ISSET(fd, &in_writefds))
+			max_entries++;
+
+	if (max_entries)
+		_entries = (Select_interest *)malloc(max_entries*sizeof(Select_interest));
+
+	for (int fd = 0; fd < nfds; fd++) {
+
+		short events = 0;
+		if (FD_ISSET(fd, &in_readfds))  events |= POLLIN;
+		if (FD_ISSET(fd, &in_writefds)) events |= POLLOUT;
+
+		bool const except = FD_ISSET(fd, &in_exceptfds);
+
+		if (!events && !except)
+			continue;
+
+		File_descriptor *fdo = file_descriptor_allocator()->find_by_libc_fd(fd);
+
+		if (events && _entries && fdo && fdo->plugin && fdo->plugin->supports_poll()) {
+			Select_interest &entry = *Genode::construct_at<Select_interest>(
+				&_entries[_num_entries++], _interests, *fdo, events);
+			_interests.insert(entry);
+			events = 0;
+		}
+
+		if (events & POLLIN)  FD_SET(fd, &_legacy_readfds);
+		if (events & POLLOUT) FD_SET(fd, &_legacy_writefds);
+		if (except)           FD_SET(fd, &_legacy_exceptfds);
+
+		_legacy |= events || except;
+	}
+}
+
+
+Libc::Select_cb::~Select_cb()
+{
+	for (unsigned i = 0; i < _num_entries; i++) {
+		_interests.remove(_entries[i]);
+		_entries[i].~Select_interest();
+	}
+
+	if (_entries)
+		free(_entries);
+}
+
+
+int Libc::Select_cb::scan()
+{
+	/*
+	 * Like 'selscan', count each set bit, so that a descriptor ready for
+	 * reading and writing is counted twice.
+	 */
+	auto mark = [&] (int fd, fd_set &fds) {
+		if (!FD_ISSET(fd, &fds)) {
+			FD_SET(fd, &fds);
+			nready++;
+		}
+	};
+
+	_interests.check([&] (Interest &interest, short revents) {
+
+		int  const fd   = static_cast<Select_interest &>(interest).libc_fd;
+		bool const nval = revents & POLLNVAL;
+
+		/* let the subsequent operation on an invalid descriptor fail */
+		if ((interest.events & POLLIN)  && (nval || (revents & POLLIN)))
+			mark(fd, readfds);
+		if ((interest.events & POLLOUT) && (nval || (revents & POLLOUT)))
+			mark(fd, writefds);
+
+		return true;
+	});
+
+	if (_legacy) {
+		fd_set in_readfds   = _legacy_readfds;
+		fd_set in_writefds  = _legacy_writefds;
+		fd_set in_exceptfds = _legacy_exceptfds;
+		fd_set out_readfds, out_writefds, out_exceptfds;
+
+		int const legacy_nready = selscan(nfds,
+		                                  &in_readfds,  &in_writefds,  &in_exceptfds,
+		                                  &out_readfds, &out_writefds, &out_exceptfds);
+
+		for (int fd = 0; legacy_nready > 0 && fd < nfds; fd++) {
+			if (FD_ISSET(fd, &out_readfds))   FD_SET(fd, &readfds);
+			if (FD_ISSET(fd, &out_writefds))  FD_SET(fd, &writefds);
+			if (FD_ISSET(fd, &out_exceptfds)) FD_SET(fd, &exceptfds);
+		}
+		if (legacy_nready > 0)
+			nready += legacy_nready;
+	}
+
+	return nready;
+}
+
+
 /* this function gets called by plugin backends when file descripors become ready */
 static void select_notify()
 {
 	bool resume_all = false;
-	fd_set tmp_readfds, tmp_writefds, tmp_exceptfds;
 
 	/* check for each waiting select() function if one of its fds is ready now
 	 * and if so, wake all up */
 
 	select_cb_list.for_each([&] (Libc::Select_cb &scb) {
-		scb.nready = selscan(scb.nfds,
-		                     &scb.readfds, &scb.writefds, &scb.exceptfds,
-		                     &tmp_readfds,  &tmp_writefds,  &tmp_exceptfds);
-		if (scb.nready > 0) {
-			scb.readfds   = tmp_readfds;
-			scb.writefds  = tmp_writefds;
-			scb.exceptfds = tmp_exceptfds;
 
+		/* the result of a ready callback is not updated until it is removed */
+		if (scb.nready == 0)
+			scb.scan();
+
+		if (scb.nready > 0)
 			resume_all = true;
-		}
 	});
 
 	if (resume_all)
@@ -231,6 +381,14 @@ int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
 	if (writefds)  in_writefds  = *writefds;  else FD_ZERO(&in_writefds);
 	if (exceptfds) in_exceptfds = *exceptfds; else FD_ZERO(&in_exceptfds);
 
+	select_cb.construct(nfds, in_readfds, in_writefds, in_exceptfds);
+
+	auto copy_result = [&] () {
+		if (readfds)   *readfds   = select_cb->readfds;
+		if (writefds)  *writefds  = select_cb->writefds;
+		if (exceptfds) *exceptfds = select_cb->exceptfds;
+	};
+
 	{
 		/*
 		 * We use the guard directly to atomically check if any descripor is
@@ -238,22 +396,16 @@ int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
 		 */
 		Libc::Select_cb_list::Guard guard(select_cb_list);
 
-		int const nready = selscan(nfds,
-		                           &in_readfds, &in_writefds, &in_exceptfds,
-		                           readfds, writefds, exceptfds);
+		int const nready = select_cb->scan();
 
-		/* return if any descripor is ready */
-		if (nready)
+		/* return if any descripor is ready or on zero-timeout */
+		if (nready || (tv && (tv->tv_sec) == 0 && (tv->tv_usec == 0))) {
+			copy_result();
 			return nready;
-
-		/* return on zero-timeout */
-		if (tv && (tv->tv_sec) == 0 && (tv->tv_usec == 0))
-			return 0;
+		}
 
 		/* suspend as we don't have any immediate events */
 
-		select_cb.construct(nfds, in_readfds, in_writefds, in_exceptfds);
-
 		select_cb_list.unsynchronized_insert(&(*select_cb));
 	}
 
@@ -285,14 +437,16 @@ int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
 
 	select_cb_list.remove(&(*select_cb));
 
-	if (timeout.expired())
+	if (timeout.expired()) {
+		if (readfds)   FD_ZERO(readfds);
+		if (writefds)  FD_ZERO(writefds);
+		if (exceptfds) FD_ZERO(exceptfds);
 		return 0;
+	}
 
 	/* not timed out -> results have been stored in select_cb by select_notify() */
 
-	if (readfds)   *readfds   = select_cb->readfds;
-	if (writefds)  *writefds  = select_cb->writefds;
-	if (exceptfds) *exceptfds = select_cb->exceptfds;
+	copy_result();
 
 	return select_cb->nready;
 }
@@ -354,6 +508,8 @@ int Libc::Select_handler_base::select(int nfds, fd_set &readfds,
 	if (_select_cb->constructed())
 		select_cb_list.remove(&(**_select_cb));
 
+	_select_cb->construct(nfds, in_readfds, in_writefds, in_exceptfds);
+
 	{
 		/*
 		 * We use the guard directly to atomically check is any descripor is
@@ -361,18 +517,18 @@ int Libc::Select_handler_base::select(int nfds, fd_set &readfds,
 		 */
 		Libc::Select_cb_list::Guard guard(select_cb_list);
 
-		int const nready = selscan(nfds,
-		                           &in_readfds, &in_writefds, &in_exceptfds,
-		                           &readfds, &writefds, &exceptfds);
+		int const nready = (*_select_cb)->scan();
 
 		/* return if any descripor is ready */
-		if (nready)
+		if (nready) {
+			readfds   = (*_select_cb)->readfds;
+			writefds  = (*_select_cb)->writefds;
+			exceptfds = (*_select_cb)->exceptfds;
 			return nready;
+		}
 
 		/* suspend as we don't have any immediate events */
 
-		_select_cb->construct(nfds, in_readfds, in_writefds, in_exceptfds);
-
 		select_cb_list.unsynchronized_insert(&(**_select_cb));
 	}
 
@@ -398,7 +554,7 @@ void Libc::Select_handler_base::dispatch_select()
 
 Libc::Select_handler_base::Select_handler_base()
 :
-	_select_cb((Select_handler_cb*)malloc(sizeof(*_select_cb)))
+	_select_cb(Genode::construct_at<Select_handler_cb>(malloc(sizeof(Select_handler_cb))))
 { }
 
 Libc::Select_handler_base::~Select_handler_base()
@@ -143,6 +143,8 @@ struct Socket_fs::Context : Libc::Plugin_context
 
 		int  _fd_flags    = 0;
 
+		Libc::File_descriptor *_readiness_owner = nullptr;
+
 		Proto const _proto;
 
 		State _state { UNCONNECTED };
@@ -166,6 +168,9 @@ struct Socket_fs::Context : Libc::Plugin_context
 				}
 				_fd[type].num  = fd;
 				_fd[type].file = Libc::file_descriptor_allocator()->find_by_libc_fd(fd);
+
+				if (_fd[type].file)
+					_fd[type].file->readiness_owner = _readiness_owner;
 			}
 
 			return _fd[type].num;
@@ -192,6 +197,17 @@ struct Socket_fs::Context : Libc::Plugin_context
 
 		Proto proto() const { return _proto; }
 
+		/**
+		 * Forward readiness notifications of the socket files to 'fd'
+		 */
+		void readiness_owner(Libc::File_descriptor &fd)
+		{
+			_readiness_owner = &fd;
+
+			for (unsigned i = 0; i < Fd::MAX; ++i)
+				if (_fd[i].file) _fd[i].file->readiness_owner = &fd;
+		}
+
 		int fd_flags() const { return _fd_flags; }
 		void fd_flags(int flags)
 		{
@@ -300,6 +316,8 @@ struct Socket_fs::Plugin : Libc::Plugin
 	bool supports_poll() override { return true; }
 	bool supports_select(int, fd_set *, fd_set *, fd_set *, timeval *) override;
 
+	bool notifies_readiness(Libc::File_descriptor &) override { return true; }
+
 	ssize_t read(Libc::File_descriptor *, void *, ::size_t) override;
 	ssize_t write(Libc::File_descriptor *, const void *, ::size_t) override;
 	int fcntl(Libc::File_descriptor *, int, long) override;
@@ -549,6 +567,9 @@ extern "C" int socket_fs_accept(int libc_fd, sockaddr *addr, socklen_t *addrlen)
 	Libc::File_descriptor *accept_fd =
 		Libc::file_descriptor_allocator()->alloc(&plugin(), accept_context);
 
+	if (accept_fd)
+		accept_context->readiness_owner(*accept_fd);
+
 	/* inherit the O_NONBLOCK flag if set */
 	accept_context->fd_flags(listen_context->fd_flags());
 
@@ -969,6 +990,8 @@ extern "C" int socket_fs_socket(int domain, int type, int protocol)
 	Libc::File_descriptor *fd =
 		Libc::file_descriptor_allocator()->alloc(&plugin(), context);
 
+	context->readiness_owner(*fd);
+
 	return fd->libc_fd;
 }
 
@@ -6,7 +6,7 @@
  */
 
 /*
- * Copyright (C) 2012-2017 Genode Labs GmbH
+ * Copyright (C) 2012-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -210,6 +210,7 @@ extern "C" {
 
 	void pthread_exit(void *value_ptr)
 	{
+		Libc::flush_malloc_thread_cache();
 		pthread_self()->exit(value_ptr);
 		Genode::sleep_forever();
 	}
@@ -7,7 +7,7 @@
  */
 
 /*
- * Copyright (C) 2014-2017 Genode Labs GmbH
+ * Copyright (C) 2014-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -16,6 +16,7 @@
 /* Genode includes */
 #include <base/env.h>
 #include <base/log.h>
+#include <dataspace/client.h>
 #include <vfs/dir_file_system.h>
 
 /* libc includes */
@@ -234,7 +235,7 @@ Libc::File_descriptor *Libc::Vfs_plugin::open(char const *path, int flags,
 			return nullptr;
 		}
 
-		handle->handler(&_response_handler);
+		_install_response_handler(*fd, *handle);
 		fd->flags = flags & O_ACCMODE;
 
 		return fd;
@@ -315,10 +316,11 @@ Libc::File_descriptor *Libc::Vfs_plugin::open(char const *path, int flags,
 		return nullptr;
 	}
 
-	handle->handler(&_response_handler);
+	_install_response_handler(*fd, *handle);
 	fd->flags = flags & (O_ACCMODE|O_NONBLOCK|O_APPEND);
 
 	if ((flags & O_TRUNC) && (ftruncate(fd, 0) == -1)) {
+		_release_response_handler(*handle);
 		VFS_THREAD_SAFE(handle->close());
 		errno = EINVAL; /* XXX which error code fits best ? */
 		return nullptr;
@@ -328,6 +330,55 @@ Libc::File_descriptor *Libc::Vfs_plugin::open(char const *path, int flags,
 }
 
 
+void Libc::Vfs_plugin::_install_response_handler(File_descriptor &fd,
+                                                  Vfs::Vfs_handle &handle)
+{
+	Vfs::Io_response_handler *handler = &_response_handler;
+
+	/* without a handler of its own, the descriptor is polled on wakeup */
+	try { handler = new (_alloc) Fd_response_handler(fd, _response_handler); }
+	catch (Genode::Out_of_ram)  { }
+	catch (Genode::Out_of_caps) { }
+
+	VFS_THREAD_SAFE(handle.handler(handler));
+}
+
+
+void Libc::Vfs_plugin::_release_response_handler(Vfs::Vfs_handle &handle)
+{
+	Fd_response_handler *fd_handler = nullptr;
+
+	{
+		Genode::Lock::Guard guard(vfs_lock());
+
+		handle.apply_handler([&] (Vfs::Io_response_handler &h) {
+			fd_handler = dynamic_cast<Fd_response_handler *>(&h); });
+		handle.handler(&_response_handler);
+	}
+
+	if (fd_handler)
+		destroy(_alloc, fd_handler);
+}
+
+
+bool Libc::Vfs_plugin::notifies_readiness(File_descriptor &fd)
+{
+	Vfs::Vfs_handle *handle = vfs_handle(&fd);
+	if (!handle)
+		return false;
+
+	/* duplicated descriptors share the handler of the original one */
+	Genode::Lock::Guard guard(vfs_lock());
+
+	bool result = false;
+	handle->apply_handler([&] (Vfs::Io_response_handler &h) {
+		Fd_response_handler *fd_handler = dynamic_cast<Fd_response_handler *>(&h);
+		result = fd_handler && &fd_handler->fd == &fd; });
+
+	return result;
+}
+
+
 int Libc::Vfs_plugin::_vfs_sync(Vfs::Vfs_handle &vfs_handle)
 {
 	typedef Vfs::File_io_service::Sync_result Result;
@@ -401,6 +452,7 @@ int Libc::Vfs_plugin::close(Libc::File_descriptor *fd)
 	Vfs::Vfs_handle *handle = vfs_handle(fd);
 	/* XXX: mark the handle as requiring sync or not */
 	_vfs_sync(*handle);
+	_release_response_handler(*handle);
 	VFS_THREAD_SAFE(handle->close());
 	Libc::file_descriptor_allocator()->free(fd);
 	return 0;
@@ -1255,6 +1307,65 @@ int Libc::Vfs_plugin::rename(char const *from_path, char const *to_path)
 }
 
 
+void *Libc::Vfs_plugin::_mmap_dataspace(::size_t length, int prot,
+                                        Libc::File_descriptor &fd, ::off_t offset)
+{
+	char const * const path = fd.fd_path;
+
+	if (!path || (offset & ((1 << PAGE_SHIFT) - 1)))
+		return nullptr;
+
+	Genode::Dataspace_capability const ds =
+		VFS_THREAD_SAFE(_root_dir.dataspace(path));
+
+	if (!ds.valid())
+		return nullptr;
+
+	auto release = [&] () { VFS_THREAD_SAFE(_root_dir.release(path, ds)); };
+
+	/* accesses beyond the dataspace must not fault */
+	::size_t const size = Genode::align_addr(length, PAGE_SHIFT);
+	if ((Genode::size_t)offset + size > Genode::Dataspace_client(ds).size()) {
+		release();
+		return nullptr;
+	}
+
+	char *addr = nullptr;
+	try {
+		addr = _rm.attach(ds, size, offset, false, (Genode::addr_t)0,
+		                  false, false);
+	} catch (...) {
+		release();
+		return nullptr;
+	}
+
+	/*
+	 * A private writeable mapping gets its own copy, which is taken from
+	 * the mapped dataspace instead of reading the file.
+	 */
+	if (prot & PROT_WRITE) {
+		void *copy = Libc::mem_alloc()->alloc(length, PAGE_SHIFT);
+		if (copy)
+			Genode::memcpy(copy, addr, length);
+
+		_rm.detach(addr);
+		release();
+
+		return copy ? copy : (void *)-1;
+	}
+
+	try {
+		Genode::Lock::Guard guard(_mappings_lock);
+		_mappings.insert(new (_alloc) Mapping(addr, ds, path));
+	} catch (...) {
+		_rm.detach(addr);
+		release();
+		return nullptr;
+	}
+	return addr;
+}
+
+
 void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags,
                              Libc::File_descriptor *fd, ::off_t offset)
 {
@@ -1270,10 +1381,12 @@ void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags
 		return (void *)-1;
 	}
 
-	/*
-	 * XXX attempt to obtain memory mapping via
-	 *     'Vfs::Directory_service::dataspace'.
-	 */
+	/* map the file without copying if the file system provides a dataspace */
+	if (void *addr = _mmap_dataspace(length, prot, *fd, offset)) {
+		if (addr == (void *)-1)
+			errno = ENOMEM;
+		return addr;
+	}
 
 	void *addr = Libc::mem_alloc()->alloc(length, PAGE_SHIFT);
 	if (addr == (void *)-1) {
@@ -1306,7 +1419,26 @@ void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags
 
 int Libc::Vfs_plugin::munmap(void *addr, ::size_t)
 {
-	Libc::mem_alloc()->free(addr);
+	Mapping *mapping = nullptr;
+	{
+		Genode::Lock::Guard guard(_mappings_lock);
+
+		for (mapping = _mappings.first(); mapping; mapping = mapping->next())
+			if (mapping->addr == addr)
+				break;
+
+		if (mapping)
+			_mappings.remove(mapping);
+	}
+
+	if (!mapping) {
+		Libc::mem_alloc()->free(addr);
+		return 0;
+	}
+
+	_rm.detach(addr);
+	VFS_THREAD_SAFE(_root_dir.release(mapping->path.base(), mapping->ds));
+	destroy(_alloc, mapping);
 	return 0;
 }
 
@@ -1328,11 +1460,14 @@ bool Libc::Vfs_plugin::poll(File_descriptor &fd, struct pollfd &pfd)
 
 	bool res { false };
 
-	if ((pfd.events & POLLIN_MASK)
-	 && VFS_THREAD_SAFE(handle->fs().read_ready(handle)))
-	{
-		pfd.revents |= pfd.events & POLLIN_MASK;
-		res = true;
+	if (pfd.events & POLLIN_MASK) {
+		if (VFS_THREAD_SAFE(handle->fs().read_ready(handle))) {
+			pfd.revents |= pfd.events & POLLIN_MASK;
+			res = true;
+		} else {
+			/* request a response once the handle becomes readable */
+			Libc::notify_read_ready(handle);
+		}
 	}
 
 	if ((pfd.events & POLLOUT_MASK) /* XXX always writeable */)
@@ -18,6 +18,7 @@
 
 /* Genode includes */
 #include <libc/component.h>
+#include <util/list.h>
 
 /* libc includes */
 #include <fcntl.h>
@@ -40,21 +41,77 @@ class Libc::Vfs_plugin : public Libc::Plugin
 	private:
 
 		Genode::Allocator        &_alloc;
+		Genode::Region_map       &_rm;
 		Vfs::File_system         &_root_dir;
 		Vfs::Io_response_handler &_response_handler;
 
+		/**
+		 * File mapped via a dataspace provided by the VFS
+		 */
+		struct Mapping : Genode::List<Mapping>::Element
+		{
+			void                         * const addr;
+			Genode::Dataspace_capability   const ds;
+			Absolute_path                  const path;
+
+			Mapping(void *addr, Genode::Dataspace_capability ds, char const *path)
+			: addr(addr), ds(ds), path(path) { }
+		};
+
+		Genode::List<Mapping> _mappings { };
+		Genode::Lock          _mappings_lock { };
+
+		/**
+		 * Response handler of a VFS handle opened for a file descriptor
+		 *
+		 * Responses are reported to the interest sets observing the
+		 * descriptor before they are passed on to the libc kernel.
+		 */
+		struct Fd_response_handler : Vfs::Io_response_handler
+		{
+			File_descriptor          &fd;
+			Vfs::Io_response_handler &kernel;
+
+			Fd_response_handler(File_descriptor &fd, Vfs::Io_response_handler &kernel)
+			: fd(fd), kernel(kernel) { }
+
+			void read_ready_response() override
+			{
+				notify_readiness(fd);
+				kernel.read_ready_response();
+			}
+
+			void io_progress_response() override
+			{
+				notify_readiness(fd);
+				kernel.io_progress_response();
+			}
+		};
+
+		void _install_response_handler(File_descriptor &, Vfs::Vfs_handle &);
+		void _release_response_handler(Vfs::Vfs_handle &);
+
 		/**
 		 * Sync a handle and propagate errors
 		 */
 		int _vfs_sync(Vfs::Vfs_handle&);
 
+		/**
+		 * Map file via 'Vfs::Directory_service::dataspace'
+		 *
+		 * \return  mapped address, or nullptr if the file system cannot
+		 *          provide a dataspace for the requested range
+		 */
+		void *_mmap_dataspace(::size_t, int, Libc::File_descriptor &, ::off_t);
+
 	public:
 
 		Vfs_plugin(Libc::Env                &env,
 		           Genode::Allocator        &alloc,
 		           Vfs::Io_response_handler &handler)
 		:
-			_alloc(alloc), _root_dir(env.vfs()), _response_handler(handler)
+			_alloc(alloc), _rm(env.rm()), _root_dir(env.vfs()),
+			_response_handler(handler)
 		{ }
 
 		~Vfs_plugin() final { }
@@ -73,6 +130,8 @@ class Libc::Vfs_plugin : public Libc::Plugin
 		bool supports_unlink(const char *)                     override { return true; }
 		bool supports_mmap()                                   override { return true; }
 
+		bool notifies_readiness(File_descriptor &) override;
+
 		bool supports_select(int nfds,
 		                     fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
 		                     struct timeval *timeout) override;
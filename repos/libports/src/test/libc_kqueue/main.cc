@@ -0,0 +1,193 @@
+/*
+ * \brief  Test for kqueue() and kevent() in libc
+ * \author Genode Labs
+ * \date   2019-10-22
+ *
+ * The first part checks the kevent API on regular files, which are always
+ * ready. The second part waits for data on the terminal given as argument
+ * while many more descriptors are registered but disabled, which must not
+ * add to the cost of a wakeup.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+enum { NUM_IDLE = 500, MAX_COUNT = 10 };
+
+
+static void die(char const *msg)
+{
+	printf("Error: %s (errno=%d)\n", msg, errno);
+	exit(-1);
+}
+
+
+static int change(int kq, int fd, short filter, unsigned short flags, void *udata = 0)
+{
+	struct kevent kev;
+	EV_SET(&kev, fd, filter, flags, 0, 0, udata);
+	return kevent(kq, &kev, 1, 0, 0, 0);
+}
+
+
+static int wait_events(int kq, struct kevent *events, int nevents, long timeout_ms)
+{
+	struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000)*1000*1000 };
+	return kevent(kq, 0, 0, events, nevents, timeout_ms < 0 ? 0 : &ts);
+}
+
+
+static void test_api(char const *path)
+{
+	int const kq = kqueue();
+	int const fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (kq < 0 || fd < 0) die("kqueue or open failed");
+
+	struct kevent ev[4];
+
+	if (wait_events(kq, ev, 4, 0) != 0) die("empty kqueue reported events");
+
+	/* level-triggered events are reported on each call */
+	static int cookie;
+	if (change(kq, fd, EVFILT_READ, EV_ADD, &cookie) < 0) die("EV_ADD failed");
+	for (unsigned i = 0; i < 2; i++) {
+		if (wait_events(kq, ev, 4, 0) != 1) die("regular file not readable");
+		if (ev[0].ident != (uintptr_t)fd || ev[0].filter != EVFILT_READ
+		 || ev[0].udata != &cookie) die("wrong event reported");
+	}
+
+	/* disabled events are not reported */
+	if (change(kq, fd, EVFILT_READ, EV_DISABLE) < 0) die("EV_DISABLE failed");
+	if (wait_events(kq, ev, 4, 0) != 0) die("disabled event reported");
+	if (change(kq, fd, EVFILT_READ, EV_ENABLE) < 0) die("EV_ENABLE failed");
+	if (wait_events(kq, ev, 4, 0) != 1) die("enabled event not reported");
+
+	/* one-shot events are removed after being reported */
+	if (change(kq, fd, EVFILT_WRITE, EV_ADD | EV_ONESHOT) < 0) die("EV_ONESHOT failed");
+	if (wait_events(kq, ev, 4, 0) != 2) die("expected two events");
+	if (wait_events(kq, ev, 4, 0) != 1) die("one-shot event not removed");
+	if (change(kq, fd, EVFILT_WRITE, EV_DELETE) != -1 || errno != ENOENT)
+		die("deleting removed one-shot event did not fail with ENOENT");
+
+	/* errors are reported in the event list if there is space */
+	struct kevent bad;
+	EV_SET(&bad, fd, EVFILT_TIMER, EV_ADD, 0, 0, 0);
+	if (kevent(kq, &bad, 1, ev, 4, 0) != 1
+	 || !(ev[0].flags & EV_ERROR) || ev[0].data != EINVAL)
+		die("unsupported filter not reported as EINVAL");
+
+	if (change(kq, 1000, EVFILT_READ, EV_ADD) != -1 || errno != EBADF)
+		die("invalid descriptor not rejected with EBADF");
+
+	/* closing the descriptor removes its events */
+	close(fd);
+	if (wait_events(kq, ev, 4, 0) != 0) die("event of closed descriptor reported");
+
+	/* timeout expires on a kqueue without ready events */
+	struct timeval start, end;
+	gettimeofday(&start, 0);
+	if (wait_events(kq, ev, 4, 200) != 0) die("timeout did not expire");
+	gettimeofday(&end, 0);
+
+	long const elapsed_ms = (end.tv_sec - start.tv_sec)*1000
+	                      + (end.tv_usec - start.tv_usec)/1000;
+	if (elapsed_ms < 150) die("timeout expired too early");
+
+	close(kq);
+	printf("kevent API test succeeded\n");
+}
+
+
+static void test_wakeup(char const *terminal, char const *idle_path)
+{
+	int const kq = kqueue();
+	int const tfd = open(terminal, O_RDONLY | O_NONBLOCK);
+	if (kq < 0 || tfd < 0) die("kqueue or open of terminal failed");
+
+	static int idle[NUM_IDLE];
+	for (unsigned i = 0; i < NUM_IDLE; i++) {
+		idle[i] = open(idle_path, O_RDONLY);
+		if (idle[i] < 0) die("open of idle file failed");
+
+		if (change(kq, idle[i], EVFILT_READ, EV_ADD | EV_DISABLE) < 0)
+			die("registering idle descriptor failed");
+	}
+
+	if (change(kq, tfd, EVFILT_READ, EV_ADD) < 0) die("registering terminal failed");
+
+	unsigned wakeups = 0, count = 0;
+	long     check_us = 0;
+	char     buf[64];
+
+	while (count < MAX_COUNT) {
+
+		struct kevent ev[8];
+
+		int const n = wait_events(kq, ev, 8, 10*1000);
+		if (n <= 0) die("no data from terminal within 10 seconds");
+
+		for (int i = 0; i < n; i++) {
+			if (ev[i].ident != (uintptr_t)tfd) die("idle descriptor reported");
+
+			ssize_t const nbytes = read(tfd, buf, sizeof(buf) - 1);
+			if (nbytes < 0 && errno != EAGAIN) die("read from terminal failed");
+			if (nbytes <= 0) continue;
+
+			buf[nbytes] = 0;
+			for (char const *c = buf; *c; c++)
+				if (*c == '.') count++;
+
+			printf("received '%s'\n", buf);
+		}
+		wakeups++;
+
+		/* measure the cost of a check that finds nothing */
+		struct timeval start, end;
+		gettimeofday(&start, 0);
+		wait_events(kq, ev, 8, 0);
+		gettimeofday(&end, 0);
+
+		check_us += (end.tv_sec - start.tv_sec)*1000*1000
+		          + end.tv_usec - start.tv_usec;
+	}
+
+	printf("%u counts in %u wakeups with %u idle descriptors, %ld us per empty check\n",
+	       count, wakeups, (unsigned)NUM_IDLE, check_us / (long)wakeups);
+
+	for (unsigned i = 0; i < NUM_IDLE; i++)
+		close(idle[i]);
+
+	close(tfd);
+	close(kq);
+}
+
+
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		printf("usage: %s <file> <terminal>\n", argv[0]);
+		return -1;
+	}
+
+	test_api(argv[1]);
+	test_wakeup(argv[2], argv[1]);
+
+	printf("--- kqueue test finished ---\n");
+	return 0;
+}
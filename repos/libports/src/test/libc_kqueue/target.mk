@@ -0,0 +1,3 @@
+TARGET = test-libc_kqueue
+LIBS   = posix
+SRC_CC = main.cc
@@ -0,0 +1,192 @@
+/*
+ * \brief  Stress test and benchmark of the libc's malloc
+ * \author Genode Labs
+ * \date   2019-10-16
+ *
+ * Each pass runs a number of threads concurrently. Every thread keeps a
+ * set of live blocks of random small sizes, which it replaces in random
+ * order, grows a buffer via 'realloc', and frees blocks allocated by its
+ * neighbour thread.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <libc/malloc_stats.h>
+
+/* libc includes */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+	MAX_THREADS = 8,
+	LIVE_BLOCKS = 256,
+	ITERATIONS  = 200000,
+	MAX_SIZE    = 1024,
+	HANDOVER    = 64,
+};
+
+
+static unsigned long long now_us()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec*1000*1000 + ts.tv_nsec/1000;
+}
+
+
+struct Worker
+{
+	unsigned  id;
+	unsigned  seed;
+	bool      ok;
+	pthread_t thread;
+
+	/* blocks handed over to the next worker to be freed there */
+	void * volatile handover[HANDOVER];
+
+	unsigned _random()
+	{
+		seed = seed*1103515245 + 12345;
+		return seed >> 8;
+	}
+
+	static bool _check(unsigned char const *block, size_t size, unsigned char v)
+	{
+		for (size_t i = 0; i < size; i++)
+			if (block[i] != v)
+				return false;
+		return true;
+	}
+
+	void run(Worker &next)
+	{
+		unsigned char *blocks[LIVE_BLOCKS];
+		size_t         sizes [LIVE_BLOCKS];
+
+		for (unsigned i = 0; i < LIVE_BLOCKS; i++) {
+			sizes[i]  = 1 + _random() % MAX_SIZE;
+			blocks[i] = (unsigned char *)malloc(sizes[i]);
+			memset(blocks[i], i & 0xff, sizes[i]);
+		}
+
+		size_t         buffer_size = 0;
+		unsigned char *buffer      = nullptr;
+
+		for (unsigned n = 0; n < ITERATIONS; n++) {
+
+			unsigned const i = _random() % LIVE_BLOCKS;
+
+			if (!_check(blocks[i], sizes[i] < 16 ? sizes[i] : 16, i & 0xff)) {
+				printf("Error: block %u of worker %u corrupted\n", i, id);
+				ok = false;
+				return;
+			}
+
+			/* hand the block over to the next worker or free it directly */
+			unsigned const slot = _random() % HANDOVER;
+			if (!next.handover[slot])
+				next.handover[slot] = blocks[i];
+			else
+				free(blocks[i]);
+
+			sizes[i]  = 1 + _random() % MAX_SIZE;
+			blocks[i] = (unsigned char *)malloc(sizes[i]);
+			memset(blocks[i], i & 0xff, sizes[i]);
+
+			/* free blocks handed over by the previous worker */
+			if (void * const block = handover[n % HANDOVER]) {
+				handover[n % HANDOVER] = nullptr;
+				free(block);
+			}
+
+			/* grow a buffer in small steps, like appending to a string */
+			buffer_size = (buffer_size + 100) % (256*1024);
+			buffer = (unsigned char *)realloc(buffer, buffer_size + 1);
+			buffer[buffer_size] = 0xaa;
+		}
+
+		free(buffer);
+		for (unsigned i = 0; i < LIVE_BLOCKS; i++)
+			free(blocks[i]);
+
+		ok = true;
+	}
+};
+
+
+static Worker workers[MAX_THREADS];
+static unsigned num_workers;
+
+
+static void *worker_entry(void *arg)
+{
+	Worker &worker = *(Worker *)arg;
+	worker.run(workers[(worker.id + 1) % num_workers]);
+	return nullptr;
+}
+
+
+static bool pass(unsigned threads)
+{
+	num_workers = threads;
+
+	for (unsigned i = 0; i < threads; i++) {
+		memset(&workers[i], 0, sizeof(Worker));
+		workers[i].id   = i;
+		workers[i].seed = i + 1;
+	}
+
+	unsigned long long const start_us = now_us();
+
+	for (unsigned i = 0; i < threads; i++)
+		pthread_create(&workers[i].thread, 0, worker_entry, &workers[i]);
+
+	bool ok = true;
+	for (unsigned i = 0; i < threads; i++) {
+		pthread_join(workers[i].thread, 0);
+		ok = ok && workers[i].ok;
+	}
+
+	/* free blocks that were handed over but not yet freed */
+	for (unsigned i = 0; i < threads; i++)
+		for (unsigned j = 0; j < HANDOVER; j++)
+			free(workers[i].handover[j]);
+
+	unsigned long long const duration_us = now_us() - start_us;
+	unsigned long long const ops = (unsigned long long)threads*ITERATIONS*3;
+
+	printf("%u threads: %llu operations in %llu ms, %llu ns/operation\n",
+	       threads, ops, duration_us/1000, duration_us*1000/ops);
+	return ok;
+}
+
+
+int main(int, char **)
+{
+	printf("--- malloc benchmark started ---\n");
+
+	for (unsigned threads = 1; threads <= MAX_THREADS; threads *= 2)
+		if (!pass(threads))
+			return -1;
+
+	Libc::Malloc_stats const stats = Libc::malloc_stats();
+
+	printf("allocs %lu (cached %lu), frees %lu (cached %lu)\n",
+	       stats.allocs, stats.cached_allocs, stats.frees, stats.cached_frees);
+	printf("reallocs in place %lu, moved %lu\n",
+	       stats.reallocs_in_place, stats.reallocs_moved);
+	printf("backing store: %lu allocs, %zu bytes in use, slabs: %zu bytes\n",
+	       stats.backing_store_allocs, stats.backing_store_bytes, stats.slab_bytes);
+
+	printf("--- malloc benchmark finished ---\n");
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-libc_malloc
+LIBS   = posix
+SRC_CC = main.cc
@@ -0,0 +1,98 @@
+/*
+ * \brief  Test for mapping files via libc
+ * \author Genode Labs
+ * \date   2019-10-16
+ *
+ * Each file given as argument is mapped read-only and privately writeable.
+ * The content of the mappings is compared with the file content obtained
+ * via 'read', and modifications of the private mapping must neither show
+ * up in the file nor in other mappings.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+static bool test_file(char const *path)
+{
+	int const fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("Error: could not open %s\n", path);
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || st.st_size == 0) {
+		printf("Error: could not stat %s\n", path);
+		return false;
+	}
+
+	size_t const size = st.st_size;
+
+	char *content = (char *)malloc(size);
+	if (pread(fd, content, size, 0) != (ssize_t)size) {
+		printf("Error: could not read %s\n", path);
+		return false;
+	}
+
+	char *shared = (char *)mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+	char *priv   = (char *)mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	if (shared == MAP_FAILED || priv == MAP_FAILED) {
+		printf("Error: could not map %s\n", path);
+		return false;
+	}
+
+	if (memcmp(shared, content, size) || memcmp(priv, content, size)) {
+		printf("Error: mapped content of %s differs\n", path);
+		return false;
+	}
+
+	memset(priv, 0x55, size);
+
+	if (memcmp(shared, content, size)) {
+		printf("Error: write to private mapping of %s is visible\n", path);
+		return false;
+	}
+
+	char *again = (char *)mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (again == MAP_FAILED || memcmp(again, content, size)) {
+		printf("Error: private mapping of %s modified the file\n", path);
+		return false;
+	}
+
+	munmap(again, size);
+	munmap(priv, size);
+	munmap(shared, size);
+	free(content);
+	close(fd);
+
+	printf("%s: %zu bytes mapped\n", path, size);
+	return true;
+}
+
+
+int main(int argc, char **argv)
+{
+	printf("--- mmap test started ---\n");
+
+	for (int i = 1; i < argc; i++)
+		if (!test_file(argv[i]))
+			return -1;
+
+	printf("--- mmap test finished ---\n");
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-libc_mmap
+LIBS   = posix
+SRC_CC = main.cc
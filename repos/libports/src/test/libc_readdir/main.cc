@@ -0,0 +1,115 @@
+/*
+ * \brief  Benchmark of directory listings via libc
+ * \author Genode Labs
+ * \date   2019-10-14
+ *
+ * The test populates each directory given as argument with a number of
+ * empty files and measures the time needed to list the directory via
+ * 'readdir'.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum { ROUNDS = 3 };
+
+
+static unsigned long long now_us()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec*1000*1000 + ts.tv_nsec/1000;
+}
+
+
+static bool populate(char const *dir, unsigned num_files)
+{
+	char path[256];
+
+	for (unsigned i = 0; i < num_files; i++) {
+		snprintf(path, sizeof(path), "%s/file%05u", dir, i);
+
+		int const fd = open(path, O_CREAT | O_WRONLY, 0644);
+		if (fd < 0) {
+			printf("Error: could not create %s\n", path);
+			return false;
+		}
+		close(fd);
+	}
+	return true;
+}
+
+
+static bool list(char const *dir, unsigned num_files)
+{
+	unsigned long long const start_us = now_us();
+
+	DIR *d = opendir(dir);
+	if (!d) {
+		printf("Error: could not open directory %s\n", dir);
+		return false;
+	}
+
+	unsigned count = 0;
+	while (struct dirent *e = readdir(d))
+		if (strncmp(e->d_name, "file", 4) == 0)
+			count++;
+
+	closedir(d);
+
+	unsigned long long const duration_us = now_us() - start_us;
+
+	if (count != num_files) {
+		printf("Error: listed %u of %u entries of %s\n", count, num_files, dir);
+		return false;
+	}
+
+	printf("%s: listed %u entries in %llu us (%llu ns/entry)\n",
+	       dir, count, duration_us, duration_us*1000/(count ? count : 1));
+	return true;
+}
+
+
+int main(int argc, char **argv)
+{
+	printf("--- readdir benchmark started ---\n");
+
+	if (argc < 3) {
+		printf("usage: %s <number of entries> <directory>...\n", argv[0]);
+		return -1;
+	}
+
+	unsigned const num_files = atoi(argv[1]);
+
+	for (int i = 2; i < argc; i++) {
+
+		char const *dir = argv[i];
+
+		unsigned long long const start_us = now_us();
+		if (!populate(dir, num_files))
+			return -1;
+
+		printf("%s: created %u entries in %llu us\n",
+		       dir, num_files, now_us() - start_us);
+
+		for (unsigned r = 0; r < ROUNDS; r++)
+			if (!list(dir, num_files))
+				return -1;
+	}
+
+	printf("--- readdir benchmark finished ---\n");
+	return 0;
+}
@@ -76,6 +76,7 @@ class Block::Session_component : public Block::Session_component_base,
 		bool                              _ack_queue_full = false;
 		Packet_descriptor                 _p_to_handle { };
 		unsigned                          _p_in_fly;
+		bool                              _in_signal = false;
 		Info                        const _info { _driver.info() };
 		bool                        const _writeable;
 
@@ -87,7 +88,13 @@ class Block::Session_component : public Block::Session_component_base,
 			if (!tx_sink()->ready_to_ack())
 				error("not ready to ack!");
 
-			tx_sink()->acknowledge_packet(packet);
+			/*
+			 * Acknowledgements issued while handling a signal are
+			 * signalled to the client at once at the end of '_signal'
+			 */
+			if (!_in_signal || !tx_sink()->try_ack_packet(packet))
+				tx_sink()->acknowledge_packet(packet);
+
 			_p_in_fly--;
 		}
 
@@ -184,6 +191,9 @@ class Block::Session_component : public Block::Session_component_base,
 		 */
 		void _signal()
 		{
+			bool const nested = _in_signal;
+			_in_signal = true;
+
 			/*
 			 * as long as more packets are available, and we're able to ack
 			 * them, and the driver's request queue isn't full,
@@ -194,6 +204,12 @@ class Block::Session_component : public Block::Session_component_base,
 			     && tx_sink()->packet_avail();
 				 _ack_queue_full = (++_p_in_fly >= tx_sink()->ack_slots_free()))
 				_handle_packet(tx_sink()->get_packet());
+
+			if (nested)
+				return;
+
+			_in_signal = false;
+			tx_sink()->wakeup(true);
 		}
 
 	public:
@@ -247,14 +247,14 @@ class Block::Request_stream : Genode::Noncopyable
 
 				friend class Request_stream;
 
-				Tx_sink &_tx_sink;
+				Block::Packet_descriptor &_packet;
 
 				bool _submitted = false;
 
 				Genode::size_t const _block_size;
 
-				Ack(Tx_sink &tx_sink, Genode::size_t block_size)
-				: _tx_sink(tx_sink), _block_size(block_size) { }
+				Ack(Block::Packet_descriptor &packet, Genode::size_t block_size)
+				: _packet(packet), _block_size(block_size) { }
 
 			public:
 
@@ -270,11 +270,9 @@ class Block::Request_stream : Genode::Noncopyable
 						payload { .offset = request.offset,
 						          .bytes  = request.operation.count * _block_size };
 
-					Packet_descriptor packet(request.operation, payload, request.tag);
+					_packet = Packet_descriptor(request.operation, payload, request.tag);
+					_packet.succeeded(request.success);
 
-					packet.succeeded(request.success);
-
-					_tx_sink.try_ack_packet(packet);
 					_submitted = true;
 				}
 		};
@@ -285,20 +283,36 @@ class Block::Request_stream : Genode::Noncopyable
 		 * The method repeatedly calls the functor 'fn' with an 'Ack' reference,
 		 * which provides an interface to 'submit' one acknowledgement. The
 		 * iteration stops when the acknowledgement queue is fully populated or if
-		 * the functor does not call 'Ack::submit'.
+		 * the functor does not call 'Ack::submit'. The acknowledgements are
+		 * placed into the acknowledgement queue in batches.
 		 */
 		template <typename FN>
 		void try_acknowledge(FN const &fn)
 		{
+			enum { BATCH = 32 };
+
 			Tx_sink &tx_sink = *_tx.sink();
 
-			while (tx_sink.ack_slots_free()) {
+			Block::Packet_descriptor packets[BATCH];
+
+			for (;;) {
+
+				unsigned const slots = Genode::min(tx_sink.ack_slots_free(),
+				                                   (unsigned)BATCH);
+				unsigned n = 0;
+				for (; n < slots; n++) {
+
+					Ack ack(packets[n], _payload._info.block_size);
 
-				Ack ack(tx_sink, _payload._info.block_size);
+					fn(ack);
+
+					if (!ack._submitted)
+						break;
+				}
 
-				fn(ack);
+				tx_sink.try_ack_packets(packets, n);
 
-				if (!ack._submitted)
+				if (n == 0 || n < slots)
 					break;
 			}
 		}
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2012-2018 Genode Labs GmbH
+ * Copyright (C) 2012-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -54,6 +54,9 @@ struct File_system::Connection : Genode::Connection<Session>, Session_client
 			UPGRADE_ATTEMPTS);
 	}
 
+	static size_t _tx_buf_size(size_t requested) {
+		return Genode::max(requested, Session::min_tx_buf_size()); }
+
 	/**
 	 * Constructor
 	 *
@@ -63,6 +66,10 @@ struct File_system::Connection : Genode::Connection<Session>, Session_client
 	 * \param root             root directory of session
 	 * \param writeable        session is writable
 	 * \param tx_buf_size      size of transmission buffer in bytes
+	 *
+	 * The transmission buffer is enlarged to 'Session::min_tx_buf_size' if
+	 * needed. The server may grant a smaller buffer than requested if the
+	 * session quota is insufficient.
 	 */
 	Connection(Genode::Env             &env,
 	           Genode::Range_allocator &tx_block_alloc,
@@ -79,9 +86,9 @@ struct File_system::Connection : Genode::Connection<Session>, Session_client
 			        "label=\"%s\", "
 			        "root=\"%s\", "
 			        "writeable=%d",
-			        8*1024*sizeof(long) + tx_buf_size,
+			        8*1024*sizeof(long) + _tx_buf_size(tx_buf_size),
 			        CAP_QUOTA,
-			        tx_buf_size,
+			        _tx_buf_size(tx_buf_size),
 			        label, root, writeable)),
 		Session_client(cap(), tx_block_alloc, env.rm())
 	{ }
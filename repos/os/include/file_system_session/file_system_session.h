@@ -7,7 +7,7 @@
  */
 
 /*
- * Copyright (C) 2012-2018 Genode Labs GmbH
+ * Copyright (C) 2012-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -237,6 +237,11 @@ struct File_system::Control { /* to manipulate the executable bit */ };
 
 /**
  * Data structure returned when reading from a directory node
+ *
+ * The position of a directory read is the index of the first requested
+ * entry multiplied by the size of this structure. The server fills the
+ * packet with as many consecutive entries as fit but may return fewer.
+ * A read beyond the last entry returns no data.
  */
 struct File_system::Directory_entry
 {
@@ -250,7 +255,14 @@ struct File_system::Directory_entry
 
 struct File_system::Session : public Genode::Session
 {
-	enum { TX_QUEUE_SIZE = 16 };
+	/**
+	 * Capacity of the packet queues
+	 *
+	 * This is the upper bound of packets in flight. How many of them a
+	 * client can use depends on the size of the packet buffer, which is
+	 * negotiated at session creation.
+	 */
+	enum { TX_QUEUE_SIZE = 64 };
 
 	typedef Genode::Packet_stream_policy<File_system::Packet_descriptor,
 	                                     TX_QUEUE_SIZE, TX_QUEUE_SIZE,
@@ -258,6 +270,40 @@ struct File_system::Session : public Genode::Session
 
 	typedef Packet_stream_tx::Channel<Tx_policy> Tx;
 
+	/**
+	 * Return smallest packet buffer that holds the packet queues and a
+	 * page of payload
+	 */
+	static Genode::size_t min_tx_buf_size()
+	{
+		return Genode::align_addr(sizeof(Tx_policy::Submit_queue) +
+		                          sizeof(Tx_policy::Ack_queue), 12) + 4096;
+	}
+
+	/**
+	 * Return size of the packet buffer granted to a session request
+	 *
+	 * \param requested  'tx_buf_size' argument of the session request
+	 * \param avail      RAM quota left for the buffer after deducting the
+	 *                   server-side session costs
+	 *
+	 * \return  buffer size, or 0 if the quota does not suffice for a
+	 *          minimal buffer
+	 *
+	 * The buffer is reduced to what the donated quota covers. The client
+	 * obtains the granted size via the 'bulk_buffer_size' of its packet
+	 * source.
+	 */
+	static Genode::size_t granted_tx_buf_size(Genode::size_t requested,
+	                                          Genode::size_t avail)
+	{
+		Genode::size_t const size =
+			Genode::min(Genode::align_addr(requested, 12),
+			            avail & ~(Genode::size_t)0xfff);
+
+		return size < min_tx_buf_size() ? 0 : size;
+	}
+
 	/**
 	 * \noapi
 	 */
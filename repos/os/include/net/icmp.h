@@ -17,6 +17,7 @@
 /* Genode includes */
 #include <util/endian.h>
 #include <base/exception.h>
+#include <net/internet_checksum.h>
 
 namespace Genode { class Output; }
 
@@ -57,6 +58,12 @@ class Net::Icmp_packet
 
 		void update_checksum(Genode::size_t data_sz);
 
+		/**
+		 * Adapt checksum to modified header fields
+		 */
+		void update_checksum(Internet_checksum_diff const &icd) {
+			_checksum = icd.apply_to(_checksum); }
+
 		bool checksum_error(Genode::size_t data_sz) const;
 
 
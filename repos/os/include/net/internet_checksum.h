@@ -20,10 +20,23 @@
 
 namespace Net {
 
+	class Internet_checksum_diff;
+
 	Genode::uint16_t internet_checksum(Genode::uint16_t const *addr,
 	                                   Genode::size_t          size,
 	                                   Genode::addr_t          init_sum = 0);
 
+	/**
+	 * Copy 'size' bytes from 'src' to 'dst' and return their checksum
+	 *
+	 * This is cheaper than copying the data and computing the checksum
+	 * separately as the data is read only once.
+	 */
+	Genode::uint16_t internet_checksum_copy(void                   *dst,
+	                                        Genode::uint16_t const *src,
+	                                        Genode::size_t          size,
+	                                        Genode::addr_t          init_sum = 0);
+
 	Genode::uint16_t internet_checksum_pseudo_ip(Genode::uint16_t const *addr,
 	                                             Genode::size_t          size,
 	                                             Genode::uint16_t        size_be,
@@ -32,4 +45,52 @@ namespace Net {
 	                                             Ipv4_address           &ip_dst);
 }
 
+
+/**
+ * Difference between the original and the modified data of a checksummed
+ * packet, used to adapt the checksum without reading the whole packet
+ * (RFC 1624)
+ *
+ * Data and checksums are given in network byte order as they are stored
+ * in the packet.
+ */
+class Net::Internet_checksum_diff
+{
+	private:
+
+		Genode::addr_t _sum { 0 };
+
+	public:
+
+		/**
+		 * Account for the replacement of 'old_data' with 'new_data'
+		 *
+		 * \param size  size of the data in bytes, must be even and the data
+		 *              must start at an even offset within the packet
+		 */
+		void add_up_diff(void const *new_data, void const *old_data,
+		                 Genode::size_t size)
+		{
+			Genode::uint16_t const *new_words = (Genode::uint16_t const *)new_data;
+			Genode::uint16_t const *old_words = (Genode::uint16_t const *)old_data;
+
+			/* subtracting in one's complement is adding the complement */
+			for (; size > 1; size -= 2)
+				_sum += (Genode::uint16_t)~*old_words++ + *new_words++;
+		}
+
+		/**
+		 * Return 'checksum' adapted to the accumulated difference
+		 */
+		Genode::uint16_t apply_to(Genode::uint16_t checksum) const
+		{
+			Genode::addr_t sum = (Genode::uint16_t)~checksum + _sum;
+
+			while (Genode::addr_t const sum_rsh = sum >> 16)
+				sum = (sum & 0xffff) + sum_rsh;
+
+			return ~sum;
+		}
+};
+
 #endif /* _NET__INTERNET_CHECKSUM_H_ */
@@ -20,6 +20,7 @@
 #include <util/endian.h>
 #include <net/ethernet.h>
 #include <net/ipv4.h>
+#include <net/internet_checksum.h>
 #include <util/register.h>
 #include <net/port.h>
 
@@ -74,6 +75,12 @@ class Net::Tcp_packet
 		                     Ipv4_address ip_dst,
 		                     size_t       tcp_size);
 
+		/**
+		 * Adapt checksum to modified header fields and pseudo-header
+		 */
+		void update_checksum(Internet_checksum_diff const &icd) {
+			_checksum = icd.apply_to(_checksum); }
+
 
 		/***************
 		 ** Accessors **
@@ -21,6 +21,7 @@
 #include <util/endian.h>
 #include <net/ethernet.h>
 #include <net/ipv4.h>
+#include <net/internet_checksum.h>
 
 namespace Net { class Udp_packet; }
 
@@ -75,6 +76,22 @@ class Net::Udp_packet
 		void update_checksum(Ipv4_address ip_src,
 		                     Ipv4_address ip_dst);
 
+		/**
+		 * Adapt checksum to modified header fields and pseudo-header
+		 *
+		 * A packet without checksum keeps having no checksum.
+		 */
+		void update_checksum(Internet_checksum_diff const &icd)
+		{
+			if (!_checksum)
+				return;
+
+			/* a checksum of 0 is transmitted as all ones (RFC 768) */
+			_checksum = icd.apply_to(_checksum);
+			if (!_checksum)
+				_checksum = 0xffff;
+		}
+
 		bool checksum_error(Ipv4_address ip_src,
 		                    Ipv4_address ip_dst) const;
 
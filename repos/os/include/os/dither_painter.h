@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2014-2017 Genode Labs GmbH
+ * Copyright (C) 2014-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -18,6 +18,7 @@
 #include <util/dither_matrix.h>
 #include <os/surface.h>
 #include <os/texture.h>
+#include <os/pixel_kernels.h>
 
 
 struct Dither_painter
@@ -46,49 +47,22 @@ struct Dither_painter
 		unsigned const src_line_len = texture.size().w();
 		unsigned const src_offset = src_line_len*clipped.y1() + clipped.x1();
 
-		DST_PT              *dst,       *dst_line       = surface.addr()  + dst_offset;
-		SRC_PT        const *src_pixel, *src_pixel_line = texture.pixel() + src_offset;
-		unsigned char const *src_alpha, *src_alpha_line = texture.alpha() + src_offset;
-		bool          const  src_has_alpha = texture.alpha() != nullptr;
+		DST_PT              *dst_line       = surface.addr()  + dst_offset;
+		SRC_PT        const *src_pixel_line = texture.pixel() + src_offset;
+		unsigned char const *src_alpha_line = texture.alpha() + src_offset;
+		bool          const  src_has_alpha  = texture.alpha() != nullptr;
 
 		unsigned const x_max = min((unsigned)clipped.x2(), dst_x + texture.size().w() - 1);
 		unsigned const y_max = min((unsigned)clipped.y2(), dst_y + texture.size().h() - 1);
 
-		for (unsigned y = dst_y; y <= y_max; y++) {
-
-			src_pixel = src_pixel_line;
-			src_alpha = src_alpha_line;
-			dst       = dst_line;
-
-			if (src_has_alpha) {
-				for (unsigned x = dst_x; x <= x_max; x++) {
-
-					int const v = Genode::Dither_matrix::value(x, y) >> 4;
-
-					SRC_PT        const pixel = *src_pixel++;
-					unsigned char const alpha = *src_alpha++;
+		if (x_max < dst_x) return;
 
-					int const r = pixel.r() - v;
-					int const g = pixel.g() - v;
-					int const b = pixel.b() - v;
-					int const a = alpha ? (int)alpha - v : 0;
-
-					*dst++ = DST_PT(max(0, r), max(0, g), max(0, b), max(0, a));
-				}
-			} else {
-				for (unsigned x = dst_x; x <= x_max; x++) {
-
-					int const v = Genode::Dither_matrix::value(x, y) >> 4;
-
-					SRC_PT const pixel = *src_pixel++;
-
-					int const r = pixel.r() - v;
-					int const g = pixel.g() - v;
-					int const b = pixel.b() - v;
+		for (unsigned y = dst_y; y <= y_max; y++) {
 
-					*dst++ = DST_PT(max(0, r), max(0, g), max(0, b));
-				}
-			}
+			Genode::Pixel_kernels::dither(dst_line, src_pixel_line,
+			                              src_has_alpha ? src_alpha_line : nullptr,
+			                              Genode::Dither_matrix::row(y),
+			                              dst_x, x_max - dst_x + 1);
 
 			src_pixel_line += src_line_len;
 			src_alpha_line += src_line_len;
@@ -6,7 +6,7 @@
  */
 
 /*
- * Copyright (C) 2012-2017 Genode Labs GmbH
+ * Copyright (C) 2012-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -16,7 +16,8 @@
 #define _INCLUDE__OS__PACKET_ALLOCATOR__
 
 #include <base/allocator.h>
-#include <util/bit_array.h>
+#include <util/misc_math.h>
+#include <util/string.h>
 
 namespace Genode { class Packet_allocator; }
 
@@ -25,7 +26,9 @@ namespace Genode { class Packet_allocator; }
  * This allocator is designed to be used as packet allocator for the
  * packet stream interface. It uses a minimal block size, which is the
  * granularity packets will be allocated with. As backend, it uses a
- * simple bit array to manage free, and allocated blocks.
+ * bitmap with one bit per block, which is scanned a machine word at a
+ * time. A second-level bitmap marks words without any free block, which
+ * lets the allocator skip fully allocated parts of the packet buffer.
  */
 class Genode::Packet_allocator : public Genode::Range_allocator
 {
@@ -37,23 +40,216 @@ class Genode::Packet_allocator : public Genode::Range_allocator
 		Packet_allocator(Packet_allocator const &);
 		Packet_allocator &operator = (Packet_allocator const &);
 
-		Allocator      *_md_alloc;         /* meta-data allocator                 */
-		size_t          _block_size;       /* granularity of packet allocations   */
-		void           *_bits  = nullptr;  /* memory chunk containing the bits    */
-		Bit_array_base *_array = nullptr;  /* bit array managing available blocks */
-		addr_t          _base = 0;         /* allocation base                     */
-		addr_t          _next = 0;         /* next free bit index                 */
+		enum { BITS_PER_WORD = sizeof(addr_t)*8 };
+
+		Allocator *_md_alloc;         /* meta-data allocator                */
+		size_t     _block_size;       /* granularity of packet allocations  */
+		addr_t    *_bits  = nullptr;  /* bit set for each allocated block   */
+		addr_t    *_full  = nullptr;  /* bit set for each fully used word   */
+		size_t     _words = 0;        /* number of words in '_bits'         */
+		addr_t     _base  = 0;        /* allocation base                    */
+		size_t     _next  = 0;        /* word index where to start scanning */
 
 		/*
 		 * Returns the count of blocks fitting the given size
 		 *
 		 * The block count returned is aligned to the bit count
-		 * of a machine word to fit the needs of the used bit array.
+		 * of a machine word.
 		 */
 		inline size_t _block_cnt(size_t bytes)
 		{
 			bytes /= _block_size;
-			return bytes - (bytes % (sizeof(addr_t)*8));
+			return bytes - (bytes % BITS_PER_WORD);
+		}
+
+		size_t _full_words() const {
+			return (_words + BITS_PER_WORD - 1) / BITS_PER_WORD; }
+
+		size_t _meta_data_size(size_t words) const {
+			return (words + (words + BITS_PER_WORD - 1) / BITS_PER_WORD)
+			       * sizeof(addr_t); }
+
+		size_t _blocks(size_t size) const {
+			return (size % _block_size) ? size / _block_size + 1
+			                            : size / _block_size; }
+
+		static unsigned _first_set(addr_t word) { return __builtin_ctzl(word); }
+
+		/**
+		 * Return bit mask of positions in 'free' starting 'cnt' free blocks
+		 */
+		static addr_t _run_mask(addr_t free, size_t cnt)
+		{
+			for (size_t len = 1; len < cnt && free; ) {
+				size_t const shift = min(len, cnt - len);
+				free &= free >> shift;
+				len  += shift;
+			}
+			return free;
+		}
+
+		static addr_t _mask(unsigned first, size_t cnt)
+		{
+			return (cnt == BITS_PER_WORD) ? ~0UL
+			                              : ((1UL << cnt) - 1) << first;
+		}
+
+		void _update_full(size_t word)
+		{
+			addr_t const bit = 1UL << (word % BITS_PER_WORD);
+			if (_bits[word] == ~0UL)
+				_full[word / BITS_PER_WORD] |= bit;
+			else
+				_full[word / BITS_PER_WORD] &= ~bit;
+		}
+
+		/**
+		 * Mark 'cnt' blocks starting at block index 'i' as used or free
+		 */
+		void _set(size_t i, size_t cnt, bool used)
+		{
+			while (cnt) {
+				size_t   const word  = i / BITS_PER_WORD;
+				unsigned const first = i % BITS_PER_WORD;
+				size_t   const n     = min(cnt, (size_t)(BITS_PER_WORD - first));
+				addr_t   const mask  = _mask(first, n);
+
+				if (used) _bits[word] |=  mask;
+				else      _bits[word] &= ~mask;
+
+				_update_full(word);
+				i += n; cnt -= n;
+			}
+		}
+
+		/**
+		 * Return alignment of a run of 'cnt' blocks
+		 *
+		 * Runs are naturally aligned to the largest power of two not
+		 * exceeding 'cnt', which keeps the packet buffer from fragmenting.
+		 */
+		static size_t _alignment(size_t cnt) { return 1UL << log2(cnt); }
+
+		/**
+		 * Return bit mask of the aligned block positions within a word
+		 */
+		static addr_t _align_mask(size_t align)
+		{
+			return (align >= BITS_PER_WORD) ? 1UL
+			                                : ~0UL / ((1UL << align) - 1);
+		}
+
+		static size_t _align_up(size_t i, size_t align) {
+			return (i + align - 1) & ~(align - 1); }
+
+		/**
+		 * Find 'cnt' free blocks within a single word
+		 *
+		 * 
+eturn  true if blocks were found, the index of the first block
+		 *          is returned in 'out_index'
+		 */
+		bool _find_in_word(size_t cnt, size_t &out_index)
+		{
+			addr_t const aligned = _align_mask(_alignment(cnt));
+
+			for (size_t n = 0; n < _words; ) {
+
+				size_t const word = (_next + n) % _words;
+
+				/* skip fully used words quickly */
+				addr_t const full = _full[word / BITS_PER_WORD];
+				if (full == ~0UL && word % BITS_PER_WORD == 0) {
+					n += BITS_PER_WORD;
+					continue;
+				}
+
+				if (!(full & (1UL << (word % BITS_PER_WORD)))) {
+					addr_t const run = _run_mask(~_bits[word], cnt) & aligned;
+					if (run) {
+						_next     = word;
+						out_index = word*BITS_PER_WORD + _first_set(run);
+						return true;
+					}
+				}
+				n++;
+			}
+			return false;
+		}
+
+		/**
+		 * Find 'cnt' free blocks starting at an index within [from, to)
+		 *
+		 * The candidate run is checked word by word. At the first used
+		 * block found, the scan continues behind the last used block of
+		 * the inspected word. Fully used words are skipped via '_full'.
+		 */
+		bool _find_run_in(size_t from, size_t to, size_t cnt, size_t align,
+		                  size_t &out_index)
+		{
+			size_t const blocks = _words*BITS_PER_WORD;
+
+			for (size_t i = _align_up(from, align); i < to && i + cnt <= blocks; ) {
+
+				size_t const word = i / BITS_PER_WORD;
+				addr_t const full = _full[word / BITS_PER_WORD];
+
+				if (full == ~0UL) {
+					i = _align_up((word / BITS_PER_WORD + 1)*BITS_PER_WORD*BITS_PER_WORD,
+					              align);
+					continue;
+				}
+
+				if (full & (1UL << (word % BITS_PER_WORD))) {
+					i = _align_up((word + 1)*BITS_PER_WORD, align);
+					continue;
+				}
+
+				/* check all words covered by the candidate run */
+				size_t j = i, left = cnt;
+				for (; left; ) {
+					size_t   const w     = j / BITS_PER_WORD;
+					unsigned const first = j % BITS_PER_WORD;
+					size_t   const n     = min(left, (size_t)(BITS_PER_WORD - first));
+					addr_t   const used  = _bits[w] & _mask(first, n);
+
+					if (used) {
+						unsigned const last = BITS_PER_WORD - 1 - __builtin_clzl(used);
+						j = w*BITS_PER_WORD + last + 1;
+						break;
+					}
+					j += n; left -= n;
+				}
+
+				if (!left) {
+					out_index = i;
+					return true;
+				}
+
+				i = _align_up(j, align);
+			}
+			return false;
+		}
+
+		/**
+		 * Find 'cnt' free blocks at any position
+		 *
+		 * This scan serves allocations larger than a word and requests
+		 * that cannot be satisfied within a single word. It starts at the
+		 * word where the last allocation or release took place and wraps
+		 * around at the end of the packet buffer.
+		 */
+		bool _find_run(size_t cnt, size_t &out_index)
+		{
+			size_t const align = _alignment(cnt);
+			size_t const start = _next*BITS_PER_WORD;
+
+			if (!_find_run_in(start, _words*BITS_PER_WORD, cnt, align, out_index)
+			 && !_find_run_in(0, start, cnt, align, out_index))
+				return false;
+
+			_next = ((out_index + cnt) / BITS_PER_WORD) % _words;
+			return true;
 		}
 
 	public:
@@ -74,31 +270,32 @@ class Genode::Packet_allocator : public Genode::Range_allocator
 
 		int add_range(addr_t base, size_t size) override
 		{
-			if (_base || _array) return -1;
+			if (_base || _bits) return -1;
+
+			size_t const words = _block_cnt(size) / BITS_PER_WORD;
+			size_t const bytes = _meta_data_size(words);
+
+			if (!words || !_md_alloc->alloc(bytes, (void **)&_bits))
+				return -1;
+
+			memset(_bits, 0, bytes);
 
 			_base  = base;
-			_bits  = _md_alloc->alloc(_block_cnt(size)/8);
-			_array = new (_md_alloc) Bit_array_base(_block_cnt(size),
-			                                        (addr_t*)_bits,
-			                                        true);
+			_words = words;
+			_full  = _bits + words;
+			_next  = 0;
 			return 0;
 		}
 
-		int remove_range(addr_t base, size_t size) override
+		int remove_range(addr_t base, size_t) override
 		{
 			if (_base != base) return -1;
 
-			_base = _next = 0;
+			if (_bits)
+				_md_alloc->free(_bits, _meta_data_size(_words));
 
-			if (_array) {
-				destroy(_md_alloc, _array);
-				_array = nullptr;
-			}
-
-			if (_bits)  {
-				_md_alloc->free(_bits, _block_cnt(size)/8);
-				_bits = nullptr;
-			}
+			_base  = _next = _words = 0;
+			_bits  = _full = nullptr;
 
 			return 0;
 		}
@@ -112,40 +309,32 @@ class Genode::Packet_allocator : public Genode::Range_allocator
 
 		bool alloc(size_t size, void **out_addr) override
 		{
-			addr_t const cnt = (size % _block_size) ? size / _block_size + 1
-			                                        : size / _block_size;
-			addr_t max = ~0UL;
-
-			do {
-				try {
-					/* throws exception if array is accessed outside bounds */
-					for (addr_t i = _next & ~(cnt - 1); i < max; i += cnt) {
-						if (_array->get(i, cnt))
-							continue;
-
-						_array->set(i, cnt);
-						_next = i + cnt;
-						*out_addr = reinterpret_cast<void *>(i * _block_size
-						                                     + _base);
-						return true;
-					}
-				} catch (typename Bit_array_base::Invalid_index_access) { }
+			size_t const cnt = _blocks(size);
+			size_t index     = 0;
 
-				max = _next;
-				_next = 0;
+			if (!_bits || cnt == 0)
+				return false;
 
-			} while (max != 0);
+			bool const found = (cnt <= BITS_PER_WORD && _find_in_word(cnt, index))
+			                 || _find_run(cnt, index);
+			if (!found)
+				return false;
 
-			return false;
+			_set(index, cnt, true);
+			*out_addr = reinterpret_cast<void *>(index * _block_size + _base);
+			return true;
 		}
 
 		void free(void *addr, size_t size) override
 		{
-			addr_t i   = (((addr_t)addr) - _base) / _block_size;
-			size_t cnt = (size % _block_size) ? size / _block_size + 1
-			                                  : size / _block_size;
-			try { _array->clear(i, cnt); } catch(...) { }
-			_next = i;
+			size_t const i   = (((addr_t)addr) - _base) / _block_size;
+			size_t const cnt = _blocks(size);
+
+			if (!_bits || ((addr_t)addr < _base) || (i + cnt > _words*BITS_PER_WORD))
+				return;
+
+			_set(i, cnt, false);
+			_next = i / BITS_PER_WORD;
 		}
 
 
@@ -211,6 +211,25 @@ class Genode::Packet_descriptor_queue
 			return true;
 		}
 
+		/**
+		 * Place up to 'count' packet descriptors into queue
+		 *
+		 * The packets are published to the consumer by a single update of
+		 * the queue head.
+		 *
+		 * \return number of packets added
+		 */
+		unsigned add(PACKET_DESCRIPTOR const *packets, unsigned count)
+		{
+			unsigned const n = Genode::min(count, slots_free());
+
+			for (unsigned i = 0; i < n; i++)
+				_queue[(_head + i)%QUEUE_SIZE] = packets[i];
+
+			_head = (_head + n)%QUEUE_SIZE;
+			return n;
+		}
+
 		/**
 		 * Take packet descriptor from queue
 		 *
@@ -223,6 +242,22 @@ class Genode::Packet_descriptor_queue
 			return packet;
 		}
 
+		/**
+		 * Take up to 'max' packet descriptors from queue
+		 *
+		 * \return number of packets taken
+		 */
+		unsigned get(PACKET_DESCRIPTOR *packets, unsigned max)
+		{
+			unsigned const n = Genode::min(max, count());
+
+			for (unsigned i = 0; i < n; i++)
+				packets[i] = _queue[(_tail + i)%QUEUE_SIZE];
+
+			_tail = (_tail + n)%QUEUE_SIZE;
+			return n;
+		}
+
 		/**
 		 * Return current packet descriptor
 		 */
@@ -258,6 +293,11 @@ class Genode::Packet_descriptor_queue
 		unsigned slots_free() {
 			return ((_tail > _head) ? _tail - _head
 			                        : QUEUE_SIZE - _head + _tail) - 1; }
+
+		/**
+		 * Return number of packet descriptors stored in the queue
+		 */
+		unsigned count() { return QUEUE_SIZE - 1 - slots_free(); }
 };
 
 
@@ -283,6 +323,36 @@ class Genode::Packet_descriptor_transmitter
 		TX_QUEUE    *_tx_queue;
 		bool         _tx_wakeup_needed = false;
 
+		/*
+		 * Number of packets to accumulate before a deferred wakeup is
+		 * signalled, and number of packets accumulated so far
+		 */
+		unsigned     _tx_wakeup_threshold = 1;
+		unsigned     _tx_wakeup_pending   = 0;
+
+		void _tx_added(bool was_empty, unsigned count)
+		{
+			if (count && was_empty)
+				_tx_wakeup_needed = true;
+
+			if (_tx_wakeup_needed)
+				_tx_wakeup_pending += count;
+		}
+
+		/*
+		 * Submit a deferred wakeup before blocking on a full queue,
+		 * otherwise the receiver may never drain the queue
+		 */
+		void _flush_deferred_wakeup()
+		{
+			if (!_tx_wakeup_needed)
+				return;
+
+			_rx_ready.submit();
+			_tx_wakeup_needed  = false;
+			_tx_wakeup_pending = 0;
+		}
+
 		/*
 		 * Noncopyable
 		 */
@@ -335,8 +405,10 @@ class Genode::Packet_descriptor_transmitter
 
 			do {
 				/* block for signal if tx queue is full */
-				if (_tx_queue->full())
+				if (_tx_queue->full()) {
+					_flush_deferred_wakeup();
 					_tx_ready.wait_for_signal();
+				}
 
 				/*
 				 * It could happen that pending signals do not refer to the
@@ -359,25 +431,98 @@ class Genode::Packet_descriptor_transmitter
 
 			_tx_queue->add(packet);
 
-			if (_tx_queue->single_element())
-				_tx_wakeup_needed = true;
+			_tx_added(_tx_queue->single_element(), 1);
 
 			return true;
 		}
 
-		bool tx_wakeup()
+		/**
+		 * Transmit all 'count' packets, block while the queue is full
+		 */
+		void tx(typename TX_QUEUE::Packet_descriptor const *packets, unsigned count)
 		{
 			Genode::Lock::Guard lock_guard(_tx_queue_lock);
 
-			bool signal_submitted = false;
+			while (count) {
 
-			if (_tx_wakeup_needed) {
-				_rx_ready.submit();
-				signal_submitted = true;
+				/* block for signal if tx queue is full */
+				if (_tx_queue->full()) {
+					_flush_deferred_wakeup();
+					_tx_ready.wait_for_signal();
+				}
+
+				bool     const was_empty = _tx_queue->empty();
+				unsigned const n         = _tx_queue->add(packets, count);
+
+				if (n && was_empty)
+					_rx_ready.submit();
+
+				packets += n;
+				count   -= n;
 			}
+		}
 
-			_tx_wakeup_needed = false;
-			return signal_submitted;
+		/**
+		 * Transmit up to 'count' packets without blocking
+		 *
+		 * The wakeup of the receiver is deferred to 'tx_wakeup'.
+		 *
+		 * \return number of transmitted packets
+		 */
+		unsigned try_tx(typename TX_QUEUE::Packet_descriptor const *packets,
+		                unsigned count)
+		{
+			Genode::Lock::Guard lock_guard(_tx_queue_lock);
+
+			bool     const was_empty = _tx_queue->empty();
+			unsigned const n         = _tx_queue->add(packets, count);
+
+			_tx_added(was_empty, n);
+
+			return n;
+		}
+
+		/**
+		 * Signal the receiver about packets transmitted via 'try_tx'
+		 *
+		 * \param force  signal even if fewer packets than the wakeup
+		 *               threshold are pending
+		 *
+		 * \return true if a signal was submitted
+		 */
+		bool tx_wakeup(bool force = false)
+		{
+			Genode::Lock::Guard lock_guard(_tx_queue_lock);
+
+			if (!_tx_wakeup_needed)
+				return false;
+
+			if (!force && _tx_wakeup_pending < _tx_wakeup_threshold)
+				return false;
+
+			_rx_ready.submit();
+
+			_tx_wakeup_needed  = false;
+			_tx_wakeup_pending = 0;
+			return true;
+		}
+
+		/**
+		 * Return true if a wakeup of the receiver is deferred
+		 */
+		bool tx_wakeup_deferred()
+		{
+			Genode::Lock::Guard lock_guard(_tx_queue_lock);
+			return _tx_wakeup_needed;
+		}
+
+		/**
+		 * Set number of packets to accumulate before 'tx_wakeup' signals
+		 */
+		void tx_wakeup_threshold(unsigned packets)
+		{
+			Genode::Lock::Guard lock_guard(_tx_queue_lock);
+			_tx_wakeup_threshold = Genode::max(packets, 1U);
 		}
 
 		/**
@@ -483,6 +628,27 @@ class Genode::Packet_descriptor_receiver
 			return packet;
 		}
 
+		/**
+		 * Receive up to 'max' packets without blocking
+		 *
+		 * The wakeup of the transmitter is deferred to 'rx_wakeup'.
+		 *
+		 * \return number of received packets
+		 */
+		unsigned try_rx(typename RX_QUEUE::Packet_descriptor *packets,
+		                unsigned max)
+		{
+			Genode::Lock::Guard lock_guard(_rx_queue_lock);
+
+			bool     const was_full = _rx_queue->full();
+			unsigned const n        = _rx_queue->get(packets, max);
+
+			if (n && was_full)
+				_rx_wakeup_needed = true;
+
+			return n;
+		}
+
 		bool rx_wakeup()
 		{
 			Genode::Lock::Guard lock_guard(_rx_queue_lock);
@@ -811,18 +977,57 @@ class Genode::Packet_stream_source : private Packet_stream_base
 			return _submit_transmitter.try_tx(packet);
 		}
 
+		/**
+		 * Tell sink about 'count' packets to process
+		 *
+		 * This method blocks until all packets are submitted.
+		 */
+		void submit_packets(Packet_descriptor const *packets, unsigned count)
+		{
+			_submit_transmitter.tx(packets, count);
+		}
+
+		/**
+		 * Submit as many of the specified packets as possible
+		 *
+		 * \return number of submitted packets
+		 *
+		 * This method never blocks. The sink is woken up by a single signal
+		 * on the next call of 'wakeup'.
+		 */
+		unsigned try_submit_packets(Packet_descriptor const *packets,
+		                            unsigned count)
+		{
+			return _submit_transmitter.try_tx(packets, count);
+		}
+
 		/**
 		 * Wake up the packet sink if needed
 		 *
 		 * This method assumes that the same signal handler is used for
 		 * the submit transmitter and the ack receiver.
 		 */
-		void wakeup()
+		bool wakeup(bool force = false)
 		{
 			/* submit only one signal */
-			_submit_transmitter.tx_wakeup() || _ack_receiver.rx_wakeup();
+			return _submit_transmitter.tx_wakeup(force) || _ack_receiver.rx_wakeup();
 		}
 
+		/**
+		 * Return true if the wakeup of the sink is deferred
+		 */
+		bool wakeup_deferred() { return _submit_transmitter.tx_wakeup_deferred(); }
+
+		/**
+		 * Defer the wakeup of the sink until 'packets' packets are submitted
+		 *
+		 * The threshold applies to packets submitted via 'try_submit_packet'
+		 * and 'try_submit_packets'. A deferred wakeup can be forced by
+		 * calling 'wakeup(true)'.
+		 */
+		void signal_moderation(unsigned packets) {
+			_submit_transmitter.tx_wakeup_threshold(packets); }
+
 		/**
 		 * Returns true if one or more packet acknowledgements are available
 		 */
@@ -848,6 +1053,43 @@ class Genode::Packet_stream_source : private Packet_stream_base
 			return _ack_receiver.try_rx();
 		}
 
+		/**
+		 * Get up to 'max' acknowledgements from sink
+		 *
+		 * \return number of packets stored at 'packets'
+		 *
+		 * This method never blocks.
+		 */
+		unsigned try_get_acked_packets(Packet_descriptor *packets, unsigned max)
+		{
+			return _ack_receiver.try_rx(packets, max);
+		}
+
+		/**
+		 * Call 'fn' for each acknowledgement available from the sink
+		 *
+		 * The acknowledgements are taken from the ack queue in batches.
+		 * The functor is called with a 'Packet_descriptor const &' argument.
+		 * This method never blocks.
+		 *
+		 * \return number of processed acknowledgements
+		 */
+		template <typename FN>
+		unsigned drain_acked_packets(FN const &fn)
+		{
+			enum { BATCH = 32 };
+
+			Packet_descriptor packets[BATCH];
+			unsigned          total = 0;
+
+			for (unsigned n; (n = try_get_acked_packets(packets, BATCH)); ) {
+				for (unsigned i = 0; i < n; i++)
+					fn(packets[i]);
+				total += n;
+			}
+			return total;
+		}
+
 		/**
 		 * Release bulk-buffer space consumed by the packet
 		 */
@@ -971,18 +1213,45 @@ class Genode::Packet_stream_sink : private Packet_stream_base
 			return _submit_receiver.try_rx();
 		}
 
+		/**
+		 * Get up to 'max' packets from source
+		 *
+		 * \return number of packets stored at 'packets'
+		 *
+		 * This method never blocks.
+		 */
+		unsigned try_get_packets(Packet_descriptor *packets, unsigned max)
+		{
+			return _submit_receiver.try_rx(packets, max);
+		}
+
 		/**
 		 * Wake up the packet source if needed
 		 *
 		 * This method assumes that the same signal handler is used for
 		 * the submit receiver and the ack transmitter.
 		 */
-		void wakeup()
+		bool wakeup(bool force = false)
 		{
 			/* submit only one signal */
-			_submit_receiver.rx_wakeup() || _ack_transmitter.tx_wakeup();
+			return _submit_receiver.rx_wakeup() || _ack_transmitter.tx_wakeup(force);
 		}
 
+		/**
+		 * Return true if the wakeup of the source is deferred
+		 */
+		bool wakeup_deferred() { return _ack_transmitter.tx_wakeup_deferred(); }
+
+		/**
+		 * Defer the wakeup of the source until 'packets' packets are acked
+		 *
+		 * The threshold applies to packets acknowledged via 'try_ack_packet'
+		 * and 'try_ack_packets'. A deferred wakeup can be forced by calling
+		 * 'wakeup(true)'.
+		 */
+		void signal_moderation(unsigned packets) {
+			_ack_transmitter.tx_wakeup_threshold(packets); }
+
 		/**
 		 * Return but do not dequeue next packet
 		 *
@@ -1035,6 +1304,29 @@ class Genode::Packet_stream_sink : private Packet_stream_base
 			return _ack_transmitter.try_tx(packet);
 		}
 
+		/**
+		 * Acknowledge all 'count' packets
+		 *
+		 * This method blocks if the acknowledgement queue is full.
+		 */
+		void acknowledge_packets(Packet_descriptor const *packets, unsigned count)
+		{
+			_ack_transmitter.tx(packets, count);
+		}
+
+		/**
+		 * Acknowledge as many of the specified packets as possible
+		 *
+		 * \return number of acknowledged packets
+		 *
+		 * This method never blocks. The source is woken up by a single
+		 * signal on the next call of 'wakeup'.
+		 */
+		unsigned try_ack_packets(Packet_descriptor const *packets, unsigned count)
+		{
+			return _ack_transmitter.try_tx(packets, count);
+		}
+
 		void debug_print_buffers() {
 			Packet_stream_base::_debug_print_buffers(); }
 
@@ -0,0 +1,119 @@
+/*
+ * \brief  Moderation of packet-stream wakeup signals
+ * \author Genode Labs
+ * \date   2019-10-04
+ *
+ * Similar to the interrupt coalescing of network cards, the wakeup signal
+ * for the peer of a packet stream is deferred until either a number of
+ * packets is pending or a maximum latency has passed. If the stream was idle
+ * for at least the maximum latency, the peer is signalled right away.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__OS__PACKET_STREAM_MODERATION_H_
+#define _INCLUDE__OS__PACKET_STREAM_MODERATION_H_
+
+/* Genode includes */
+#include <timer_session/connection.h>
+
+namespace Genode { template <typename> class Packet_stream_moderation; }
+
+
+/**
+ * Signal moderation for a 'Packet_stream_source' or 'Packet_stream_sink'
+ *
+ * Packets must be submitted or acknowledged via the non-blocking 'try_'
+ * methods of the stream, followed by a call of 'wakeup' of this object.
+ */
+template <typename STREAM>
+class Genode::Packet_stream_moderation
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Packet_stream_moderation(Packet_stream_moderation const &);
+		Packet_stream_moderation &operator = (Packet_stream_moderation const &);
+
+		STREAM            &_stream;
+		Timer::Connection &_timer;
+		uint64_t           _max_latency_us = 0;
+		uint64_t           _last_signal_us = 0;
+
+		Timer::One_shot_timeout<Packet_stream_moderation> _timeout {
+			_timer, *this, &Packet_stream_moderation::_handle_timeout };
+
+		uint64_t _now_us() {
+			return _timer.curr_time().trunc_to_plain_us().value; }
+
+		void _signalled(uint64_t now_us)
+		{
+			_last_signal_us = now_us;
+			if (_timeout.scheduled())
+				_timeout.discard();
+		}
+
+		void _handle_timeout(Duration)
+		{
+			if (_stream.wakeup(true))
+				_last_signal_us = _now_us();
+		}
+
+	public:
+
+		Packet_stream_moderation(STREAM &stream, Timer::Connection &timer)
+		: _stream(stream), _timer(timer) { }
+
+		/**
+		 * Configure moderation
+		 *
+		 * \param max_latency_us  maximum delay of a wakeup signal, 0
+		 *                        disables the moderation
+		 * \param packets         number of pending packets that trigger
+		 *                        a wakeup signal before the latency passed
+		 */
+		void configure(uint64_t max_latency_us, unsigned packets)
+		{
+			_max_latency_us = max_latency_us;
+			_stream.signal_moderation(max_latency_us ? packets : 1);
+
+			/* do not hold back signals deferred under the old setting */
+			if (!max_latency_us)
+				wakeup();
+		}
+
+		bool enabled() const { return _max_latency_us != 0; }
+
+		/**
+		 * Wake up the peer if needed, or defer the wakeup
+		 */
+		void wakeup()
+		{
+			if (!_max_latency_us) {
+				_stream.wakeup();
+				return;
+			}
+
+			uint64_t const now_us = _now_us();
+
+			/* signal immediately if the stream was idle */
+			bool const idle = now_us - _last_signal_us >= _max_latency_us;
+
+			if (_stream.wakeup(idle)) {
+				_signalled(now_us);
+				return;
+			}
+
+			if (_stream.wakeup_deferred() && !_timeout.scheduled())
+				_timeout.schedule(Microseconds(_max_latency_us));
+		}
+};
+
+#endif /* _INCLUDE__OS__PACKET_STREAM_MODERATION_H_ */
@@ -0,0 +1,364 @@
+/*
+ * \brief  Pixel operations applied to rows of pixels
+ * \author Genode Labs
+ * \date   2019-10-25
+ *
+ * The painters apply the per-pixel operations of the pixel types to whole
+ * rows by using the functions below. For the RGB565 and RGB888 formats,
+ * several pixels are processed per instruction if the compiler targets a
+ * CPU with SSE2 or NEON. The results are identical to those of the
+ * per-pixel operations.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__OS__PIXEL_KERNELS_H_
+#define _INCLUDE__OS__PIXEL_KERNELS_H_
+
+/* Genode includes */
+#include <util/dither_matrix.h>
+#include <util/misc_math.h>
+#include <os/pixel_rgb565.h>
+#include <os/pixel_rgb888.h>
+
+namespace Genode { namespace Pixel_kernels {
+
+	/**
+	 * Fill row with pixel value
+	 */
+	template <typename PT>
+	static inline void fill(PT *dst, PT pixel, unsigned n)
+	{
+		for (; n--; dst++)
+			*dst = pixel;
+	}
+
+	/**
+	 * Mix row with pixel value at the ratio 'alpha'
+	 */
+	template <typename PT>
+	static inline void mix(PT *dst, PT pixel, int alpha, unsigned n)
+	{
+		for (; n--; dst++)
+			*dst = PT::mix(*dst, pixel, alpha);
+	}
+
+	/**
+	 * Blend row of texture pixels with their alpha values onto row
+	 *
+	 * Pixels with an alpha value of 0 are left untouched. All other alpha
+	 * values are incremented by one such that 255 denotes an opaque pixel.
+	 */
+	template <typename PT>
+	static inline void mix(PT *dst, PT const *src, unsigned char const *alpha,
+	                       unsigned n)
+	{
+		for (; n--; dst++, src++, alpha++)
+			if (__builtin_expect(*alpha != 0, true))
+				*dst = PT::mix(*dst, *src, *alpha + 1);
+	}
+
+	/**
+	 * Replace row by the average of row of texture pixels and pixel value
+	 */
+	template <typename PT>
+	static inline void avr(PT *dst, PT const *src, PT pixel, unsigned n)
+	{
+		for (; n--; dst++, src++)
+			*dst = PT::avr(pixel, *src);
+	}
+
+	/**
+	 * Convert row of pixels and its alpha values by applying dithering
+	 *
+	 * \param alpha  alpha values, or nullptr if 'src' has no alpha channel
+	 * \param row    row of the dither matrix for the destination row
+	 * \param x      horizontal destination position of the first pixel
+	 */
+	template <typename DST_PT, typename SRC_PT>
+	static inline void dither(DST_PT *dst, SRC_PT const *src,
+	                          unsigned char const *alpha,
+	                          Dither_matrix::Row row, unsigned x, unsigned n)
+	{
+		for (; n--; x++) {
+
+			int const v = row.value(x) >> 4;
+
+			SRC_PT const pixel = *src++;
+
+			int const r = max(0, pixel.r() - v);
+			int const g = max(0, pixel.g() - v);
+			int const b = max(0, pixel.b() - v);
+
+			if (alpha) {
+				int const a = *alpha ? (int)*alpha - v : 0;
+				*dst++ = DST_PT(r, g, b, max(0, a));
+				alpha++;
+			} else {
+				*dst++ = DST_PT(r, g, b);
+			}
+		}
+	}
+
+
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+	/*
+	 * The vector kernels below process 8 RGB565 pixels or 4 RGB888 pixels
+	 * at a time and leave the remainder to the generic functions. They are
+	 * expressed as GCC vector types because the intrinsics headers of the
+	 * compiler depend on the C library.
+	 *
+	 * RGB565 pixels are split into channels that are multiplied in 16-bit
+	 * lanes. Like 'Pixel_rgb565::blend', the red and blue channels are
+	 * weighted with 'alpha >> 3' and the green channel is reduced to its
+	 * upper 5 bits. RGB888 pixels are widened to 16 bits per channel. In
+	 * both cases, no product exceeds 16 bits and no channel sum overflows.
+	 */
+
+	typedef uint8_t  __attribute__((vector_size(16))) Vector_8;
+	typedef uint16_t __attribute__((vector_size(16))) Vector_16;
+	typedef uint32_t __attribute__((vector_size(16))) Vector_32;
+
+	enum { RGB565_STEP = 8, RGB888_STEP = 4 };
+
+	template <typename V>
+	static inline V _load(void const *src, size_t len = sizeof(V))
+	{
+		V v { };
+		__builtin_memcpy(&v, src, len);
+		return v;
+	}
+
+	template <typename V>
+	static inline void _store(void *dst, V v, size_t len = sizeof(V)) {
+		__builtin_memcpy(dst, &v, len); }
+
+	/**
+	 * Zero-extend the lower or upper 8 bytes of 'v' to 16-bit lanes
+	 */
+	static inline Vector_16 _widen_lo(Vector_8 v)
+	{
+		return (Vector_16)__builtin_shuffle(v, Vector_8 { },
+			Vector_8 { 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23 });
+	}
+
+	static inline Vector_16 _widen_hi(Vector_8 v)
+	{
+		return (Vector_16)__builtin_shuffle(v, Vector_8 { },
+			Vector_8 { 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31 });
+	}
+
+	/**
+	 * Narrow 16-bit lanes with values below 256 to bytes
+	 */
+	static inline Vector_8 _narrow(Vector_16 lo, Vector_16 hi)
+	{
+		return __builtin_shuffle((Vector_8)lo, (Vector_8)hi,
+			Vector_8 { 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30 });
+	}
+
+	/**
+	 * Return 'v' where 'keep' is zero and 'd' elsewhere
+	 */
+	template <typename V>
+	static inline V _select(V keep, V v, V d) { return (keep & d) | (~keep & v); }
+
+	/**
+	 * Mix 8 RGB565 pixels with the weights 'ia' and 'a'
+	 */
+	static inline Vector_16 _mix_565(Vector_16 d, Vector_16 s, Vector_16 ia, Vector_16 a)
+	{
+		Vector_16 const ia3 = ia >> 3, a3 = a >> 3;
+
+		Vector_16 const r = ((ia3*(d >> 11)) >> 5)        + ((a3*(s >> 11)) >> 5);
+		Vector_16 const g = ((ia *((d >> 6) & 0x1f)) >> 8) + ((a *((s >> 6) & 0x1f)) >> 8);
+		Vector_16 const b = ((ia3*(d & 0x1f)) >> 5)       + ((a3*(s & 0x1f)) >> 5);
+
+		return (Vector_16)((r << 11) + (g << 6) + b);
+	}
+
+	/**
+	 * Mix 4 RGB888 pixels with weights given per channel
+	 *
+	 * The weights 'ia_lo' and 'a_lo' apply to the first two pixels,
+	 * 'ia_hi' and 'a_hi' to the last two pixels.
+	 */
+	static inline Vector_32 _mix_888(Vector_8 d, Vector_8 s,
+	                                 Vector_16 ia_lo, Vector_16 a_lo,
+	                                 Vector_16 ia_hi, Vector_16 a_hi)
+	{
+		Vector_16 const lo = ((_widen_lo(d)*ia_lo) >> 8) + ((_widen_lo(s)*a_lo) >> 8);
+		Vector_16 const hi = ((_widen_hi(d)*ia_hi) >> 8) + ((_widen_hi(s)*a_hi) >> 8);
+
+		return (Vector_32)_narrow(lo, hi) & 0xffffff;
+	}
+
+	static inline void fill(Pixel_rgb565 *dst, Pixel_rgb565 pixel, unsigned n)
+	{
+		Vector_16 const p = Vector_16 { } + pixel.pixel;
+
+		for (; n >= RGB565_STEP; n -= RGB565_STEP, dst += RGB565_STEP)
+			_store(dst, p);
+
+		fill<Pixel_rgb565>(dst, pixel, n);
+	}
+
+	static inline void fill(Pixel_rgb888 *dst, Pixel_rgb888 pixel, unsigned n)
+	{
+		Vector_32 const p = Vector_32 { } + pixel.pixel;
+
+		for (; n >= RGB888_STEP; n -= RGB888_STEP, dst += RGB888_STEP)
+			_store(dst, p);
+
+		fill<Pixel_rgb888>(dst, pixel, n);
+	}
+
+	static inline void mix(Pixel_rgb565 *dst, Pixel_rgb565 pixel, int alpha,
+	                       unsigned n)
+	{
+		Vector_16 const s  = Vector_16 { } + pixel.pixel;
+		Vector_16 const a  = Vector_16 { } + (uint16_t)alpha;
+		Vector_16 const ia = Vector_16 { } + (uint16_t)(264 - alpha);
+
+		for (; n >= RGB565_STEP; n -= RGB565_STEP, dst += RGB565_STEP)
+			_store(dst, _mix_565(_load<Vector_16>(dst), s, ia, a));
+
+		mix<Pixel_rgb565>(dst, pixel, alpha, n);
+	}
+
+	static inline void mix(Pixel_rgb888 *dst, Pixel_rgb888 pixel, int alpha,
+	                       unsigned n)
+	{
+		Vector_8  const s  = (Vector_8)(Vector_32 { } + pixel.pixel);
+		Vector_16 const a  = Vector_16 { } + (uint16_t)alpha;
+		Vector_16 const ia = Vector_16 { } + (uint16_t)(256 - alpha);
+
+		for (; n >= RGB888_STEP; n -= RGB888_STEP, dst += RGB888_STEP)
+			_store(dst, _mix_888(_load<Vector_8>(dst), s, ia, a, ia, a));
+
+		mix<Pixel_rgb888>(dst, pixel, alpha, n);
+	}
+
+	static inline void mix(Pixel_rgb565 *dst, Pixel_rgb565 const *src,
+	                       unsigned char const *alpha, unsigned n)
+	{
+		for (; n >= RGB565_STEP; n -= RGB565_STEP, dst += RGB565_STEP,
+		                         src += RGB565_STEP, alpha += RGB565_STEP) {
+
+			/* skip transparent pixels */
+			if (_load<uint64_t>(alpha) == 0)
+				continue;
+
+			Vector_16 const a = _widen_lo(_load<Vector_8>(alpha, RGB565_STEP));
+			Vector_16 const d = _load<Vector_16>(dst);
+
+			Vector_16 const v = _mix_565(d, _load<Vector_16>(src), 263 - a, a + 1);
+
+			_store(dst, _select((Vector_16)(a == 0), v, d));
+		}
+
+		mix<Pixel_rgb565>(dst, src, alpha, n);
+	}
+
+	static inline void mix(Pixel_rgb888 *dst, Pixel_rgb888 const *src,
+	                       unsigned char const *alpha, unsigned n)
+	{
+		for (; n >= RGB888_STEP; n -= RGB888_STEP, dst += RGB888_STEP,
+		                         src += RGB888_STEP, alpha += RGB888_STEP) {
+
+			/* skip transparent pixels */
+			if (_load<uint32_t>(alpha) == 0)
+				continue;
+
+			Vector_8 const a = _load<Vector_8>(alpha, RGB888_STEP);
+
+			/* alpha value of each pixel repeated for its channels */
+			Vector_16 const a_lo = (Vector_16)__builtin_shuffle(a, Vector_8 { },
+				Vector_8 { 0, 16, 0, 16, 0, 16, 0, 16, 1, 16, 1, 16, 1, 16, 1, 16 });
+			Vector_16 const a_hi = (Vector_16)__builtin_shuffle(a, Vector_8 { },
+				Vector_8 { 2, 16, 2, 16, 2, 16, 2, 16, 3, 16, 3, 16, 3, 16, 3, 16 });
+			Vector_32 const a_32 = (Vector_32)__builtin_shuffle(a, Vector_8 { },
+				Vector_8 { 0, 16, 16, 16, 1, 16, 16, 16, 2, 16, 16, 16, 3, 16, 16, 16 });
+
+			Vector_8 const d = _load<Vector_8>(dst);
+
+			Vector_32 const v = _mix_888(d, _load<Vector_8>(src),
+			                             255 - a_lo, a_lo + 1, 255 - a_hi, a_hi + 1);
+
+			_store(dst, _select((Vector_32)(a_32 == 0), v, (Vector_32)d));
+		}
+
+		mix<Pixel_rgb888>(dst, src, alpha, n);
+	}
+
+	static inline void avr(Pixel_rgb565 *dst, Pixel_rgb565 const *src,
+	                       Pixel_rgb565 pixel, unsigned n)
+	{
+		Vector_16 const p = (Vector_16 { } + pixel.pixel) & 0xf7df;
+
+		for (; n >= RGB565_STEP; n -= RGB565_STEP, dst += RGB565_STEP, src += RGB565_STEP)
+			_store(dst, (Vector_16)((p >> 1) + ((_load<Vector_16>(src) & 0xf7df) >> 1)));
+
+		avr<Pixel_rgb565>(dst, src, pixel, n);
+	}
+
+	static inline void avr(Pixel_rgb888 *dst, Pixel_rgb888 const *src,
+	                       Pixel_rgb888 pixel, unsigned n)
+	{
+		Vector_32 const p = (Vector_32 { } + pixel.pixel) & 0xfefefe;
+
+		for (; n >= RGB888_STEP; n -= RGB888_STEP, dst += RGB888_STEP, src += RGB888_STEP)
+			_store(dst, (p >> 1) + ((_load<Vector_32>(src) & 0xfefefe) >> 1));
+
+		avr<Pixel_rgb888>(dst, src, pixel, n);
+	}
+
+	/*
+	 * The alpha channel does not matter for RGB565 destination pixels.
+	 */
+	static inline void dither(Pixel_rgb565 *dst, Pixel_rgb888 const *src,
+	                          unsigned char const *alpha,
+	                          Dither_matrix::Row row, unsigned x, unsigned n)
+	{
+		/* dither values of the matrix columns repeated for the channels */
+		enum { COLUMNS = 16 + RGB888_STEP - 1 };
+		uint32_t values[COLUMNS];
+		for (unsigned i = 0; i < COLUMNS; i++)
+			values[i] = (row.value(i) >> 4)*0x01010101U;
+
+		unsigned const n_vec = n & ~(RGB888_STEP - 1);
+
+		for (unsigned i = 0; i < n_vec; i += RGB888_STEP) {
+
+			Vector_8 const s = _load<Vector_8>(src + i);
+			Vector_8 const v = _load<Vector_8>(values + ((x + i) & 15));
+
+			/* subtract dither values, saturated at zero */
+			Vector_32 const p = (Vector_32)((s - v) & (Vector_8)(s >= v));
+
+			Vector_32 const c = ((p >> 8) & 0xf800) | ((p >> 5) & 0x07e0)
+			                  | ((p >> 3) & 0x001f);
+
+			Vector_16 const c16 = __builtin_shuffle((Vector_16)c,
+			                                        Vector_16 { 0, 2, 4, 6, 0, 2, 4, 6 });
+
+			_store(dst + i, c16, RGB888_STEP*sizeof(Pixel_rgb565));
+		}
+
+		dither<Pixel_rgb565, Pixel_rgb888>(dst + n_vec, src + n_vec,
+		                                   alpha ? alpha + n_vec : nullptr,
+		                                   row, x + n_vec, n - n_vec);
+	}
+
+#endif /* __SSE2__ || __ARM_NEON */
+
+} }
+
+#endif /* _INCLUDE__OS__PIXEL_KERNELS_H_ */
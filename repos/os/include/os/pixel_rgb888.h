@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2014-2017 Genode Labs GmbH
+ * Copyright (C) 2014-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -22,6 +22,16 @@ namespace Genode {
 	                  0xff0000, 16, 0xff00, 8, 0xff, 0, 0, 0>
 	        Pixel_rgb888;
 
+
+	template <>
+	inline Pixel_rgb888 Pixel_rgb888::avr(Pixel_rgb888 p1, Pixel_rgb888 p2)
+	{
+		Pixel_rgb888 res;
+		res.pixel = ((p1.pixel&0xfefefe)>>1) + ((p2.pixel&0xfefefe)>>1);
+		return res;
+	}
+
+
 	template <>
 	inline Pixel_rgb888 Pixel_rgb888::blend(Pixel_rgb888 src, int alpha)
 	{
@@ -37,7 +47,12 @@ namespace Genode {
 	{
 		Pixel_rgb888 res;
 
-		res.pixel = blend(p1, 255 - alpha).pixel + blend(p2, alpha).pixel;
+		/*
+		 * The weights add up to 256 to preserve the brightness. With 255,
+		 * the fully opaque alpha value 256 passed by the texture painter
+		 * results in a negative weight that garbles the pixel.
+		 */
+		res.pixel = blend(p1, 256 - alpha).pixel + blend(p2, alpha).pixel;
 		return res;
 	}
 }
@@ -0,0 +1,271 @@
+/*
+ * \brief  Extent-based data structure for storing sparse files in RAM
+ * \author Genode Labs
+ * \date   2019-10-24
+ *
+ * A file is represented by a tree of non-overlapping extents, each covering
+ * a contiguous range of the file. Regions not covered by any extent read as
+ * zeros and consume no memory. When appending, the extent size grows
+ * geometrically up to a maximum, which keeps the number of extents of large
+ * files low and lets reads and writes copy each extent with one 'memcpy'.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__RAM_FS__EXTENT_H_
+#define _INCLUDE__RAM_FS__EXTENT_H_
+
+/* Genode includes */
+#include <util/avl_tree.h>
+#include <util/noncopyable.h>
+#include <util/string.h>
+#include <base/allocator.h>
+#include <file_system_session/file_system_session.h>
+
+namespace File_system {
+
+	using namespace Genode;
+
+	template <size_t, size_t> class Extent_store;
+}
+
+
+/**
+ * Sparse byte store consisting of extents
+ *
+ * \param MIN_EXTENT_SIZE  size of the first extent of a contiguous range,
+ *                         must be a power of two
+ * \param MAX_EXTENT_SIZE  size limit of extents allocated for appending
+ */
+template <Genode::size_t MIN_EXTENT_SIZE, Genode::size_t MAX_EXTENT_SIZE>
+class File_system::Extent_store : Noncopyable
+{
+	private:
+
+		struct Extent : Avl_node<Extent>
+		{
+			/*
+			 * Noncopyable
+			 */
+			Extent(Extent const &);
+			Extent &operator = (Extent const &);
+
+			file_size_t const offset;
+			size_t      const capacity;
+
+			char * const data;
+
+			/* bytes in use, the remaining capacity has undefined content */
+			size_t length = 0;
+
+			Extent(file_size_t offset, size_t capacity, char *data)
+			: offset(offset), capacity(capacity), data(data) { }
+
+			file_size_t end()      const { return offset + capacity; }
+			file_size_t used_end() const { return offset + length; }
+
+			bool higher(Extent *e) { return e->offset >= offset; }
+		};
+
+		Allocator &_alloc;
+
+		Avl_tree<Extent> _tree { };
+
+		/**
+		 * Return extent containing 'pos' or the first extent behind 'pos'
+		 */
+		Extent *_find(file_size_t pos) const
+		{
+			Extent *result = nullptr;
+
+			for (Extent *e = _tree.first(); e; ) {
+				if (e->end() <= pos) {
+					e = e->child(Extent::RIGHT);
+				} else {
+					result = e;
+					e = e->child(Extent::LEFT);
+				}
+			}
+			return result;
+		}
+
+		/**
+		 * Return last extent, or nullptr if there is none
+		 */
+		Extent *_last() const
+		{
+			Extent *e = _tree.first();
+			while (e && e->child(Extent::RIGHT))
+				e = e->child(Extent::RIGHT);
+			return e;
+		}
+
+		/**
+		 * Allocate extent starting at 'pos' for writing 'len' bytes
+		 */
+		Extent &_alloc_extent(file_size_t pos, size_t len)
+		{
+			/* grow extents of a contiguous range geometrically */
+			size_t size = MIN_EXTENT_SIZE;
+			if (pos > 0) {
+				Extent const *prev = _find(pos - 1);
+				if (prev && prev->offset < pos && prev->end() == pos)
+					size = min(prev->capacity*2, MAX_EXTENT_SIZE);
+			}
+
+			/* cover the whole write if possible */
+			while (size < len && size < MAX_EXTENT_SIZE)
+				size *= 2;
+
+			/* do not overlap the following extent */
+			if (Extent const *next = _find(pos))
+				size = min(size, (size_t)(next->offset - pos));
+
+			char *data = (char *)_alloc.alloc(size);
+
+			Extent *extent = nullptr;
+			try { extent = new (_alloc) Extent(pos, size, data); }
+			catch (...) {
+				_alloc.free(data, size);
+				throw;
+			}
+
+			_tree.insert(extent);
+			return *extent;
+		}
+
+		void _destroy(Extent &extent)
+		{
+			_tree.remove(&extent);
+			_alloc.free(extent.data, extent.capacity);
+			destroy(_alloc, &extent);
+		}
+
+	public:
+
+		Extent_store(Allocator &alloc) : _alloc(alloc) { }
+
+		~Extent_store() { truncate(0); }
+
+		/**
+		 * Return position after the highest byte stored
+		 *
+		 * The file length may exceed this value if the file has a sparse
+		 * tail.
+		 */
+		file_size_t used_size() const
+		{
+			Extent const *last = _last();
+			return last ? last->used_end() : 0;
+		}
+
+		/**
+		 * Write data
+		 *
+		 * \return number of bytes written, which is lower than 'len' if
+		 *         the allocator is exhausted
+		 */
+		size_t write(char const *src, size_t len, file_size_t pos)
+		{
+			size_t written = 0;
+
+			while (written < len) {
+
+				Extent *e = _find(pos);
+
+				if (!e || e->offset > pos) {
+					try { e = &_alloc_extent(pos, len - written); }
+					catch (Allocator::Out_of_memory) { break; }
+					catch (Out_of_caps)              { break; }
+				}
+
+				size_t const local = (size_t)(pos - e->offset);
+				size_t const n     = min(len - written, e->capacity - local);
+
+				/* zero the gap between the used part and the written range */
+				if (local > e->length)
+					memset(e->data + e->length, 0, local - e->length);
+
+				memcpy(e->data + local, src + written, n);
+				e->length = max(e->length, local + n);
+
+				written += n;
+				pos     += n;
+			}
+			return written;
+		}
+
+		/**
+		 * Read data, regions without extents are read as zeros
+		 */
+		void read(char *dst, size_t len, file_size_t pos) const
+		{
+			while (len > 0) {
+
+				Extent const *e = _find(pos);
+
+				/* sparse region in front of the next extent */
+				size_t gap = len;
+				if (e && e->offset > pos)
+					gap = (size_t)min((file_size_t)len, e->offset - pos);
+				else if (e)
+					gap = 0;
+
+				if (gap) {
+					memset(dst, 0, gap);
+					dst += gap; pos += gap; len -= gap;
+					continue;
+				}
+
+				size_t const local = (size_t)(pos - e->offset);
+				size_t const n     = min(len, e->capacity - local);
+
+				/* unused tail of the extent reads as zeros */
+				size_t const used = local < e->length ? min(n, e->length - local) : 0;
+
+				memcpy(dst, e->data + local, used);
+				memset(dst + used, 0, n - used);
+
+				dst += n; pos += n; len -= n;
+			}
+		}
+
+		/**
+		 * Release data behind 'size'
+		 */
+		void truncate(file_size_t size)
+		{
+			while (Extent *last = _last()) {
+
+				if (last->offset >= size) {
+					_destroy(*last);
+					continue;
+				}
+
+				if (last->used_end() > size)
+					last->length = (size_t)(size - last->offset);
+
+				break;
+			}
+		}
+
+		/**
+		 * Call 'fn' for each extent in ascending order
+		 *
+		 * The functor is called with the file offset, the data, and the
+		 * number of used bytes of each extent.
+		 */
+		template <typename FN>
+		void for_each_extent(FN const &fn) const
+		{
+			_tree.for_each([&] (Extent const &e) {
+				fn(e.offset, (char const *)e.data, e.length); });
+		}
+};
+
+#endif /* _INCLUDE__RAM_FS__EXTENT_H_ */
@@ -1,5 +1,5 @@
 /*
- * \brief  Dimensioning of the hierarchic 'Chunk' structure for the RAM fs
+ * \brief  Dimensioning of the file data structures of the RAM fs
  * \author Norman Feske
  * \date   2019-03-17
  */
@@ -36,6 +36,12 @@ namespace Ram_fs
 	static constexpr size_t num_level_1_entries() { return num_level_0_entries(); }
 	static constexpr size_t num_level_2_entries() { return 128; }
 	static constexpr size_t num_level_3_entries() { return 4096; }
+
+	/*
+	 * Extents of files grow from one page up to 1 MiB when appending
+	 */
+	static constexpr size_t min_extent_size() { return 4096; }
+	static constexpr size_t max_extent_size() { return 1024*1024; }
 }
 
 #endif /* _INCLUDE__RAM_FS__PARAM_H_ */
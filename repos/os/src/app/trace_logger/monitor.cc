@@ -136,6 +136,10 @@ void Monitor::print(bool activity, bool affinity)
 		log("   </buffer>");
 	else
 		log("   <buffer />");
+
+	/* report that entries got lost because the writer overtook us */
+	if (_buffer.overruns())
+		log("   <overruns count=\"", _buffer.overruns(), "\"/>");
 	log("</subject>");
 }
 
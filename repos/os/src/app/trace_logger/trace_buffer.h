@@ -25,9 +25,8 @@ class Trace_buffer
 {
 	private:
 
-		Genode::Trace::Buffer        &_buffer;
-		Genode::Trace::Buffer::Entry  _curr          { _buffer.first() };
-		unsigned                      _wrapped_count { 0 };
+		Genode::Trace::Buffer         &_buffer;
+		Genode::Trace::Buffer::Reader  _reader { };
 
 	public:
 
@@ -39,35 +38,16 @@ class Trace_buffer
 		template <typename FUNC>
 		void for_each_new_entry(FUNC && functor)
 		{
-			using namespace Genode;
-
-			bool wrapped = _buffer.wrapped() != _wrapped_count;
-			if (wrapped)
-				_wrapped_count = _buffer.wrapped();
-
-			/* initialize _curr if _buffer was empty until now */
-			if (_curr.last())
-				_curr = _buffer.first();
-
-			/* iterate over all entries that were not processed yet */
-			     Trace::Buffer::Entry e1 = _curr;
-			for (Trace::Buffer::Entry e2 = _curr; wrapped || !e2.last();
-			                          e2 = _buffer.next(e2))
-			{
-				/* if buffer wrapped, we pass the last entry once and continue at first entry */
-				if (wrapped && e2.last()) {
-					wrapped = false;
-					e2 = _buffer.first();
-					if (e2.last())
-						break;
-				}
-
-				e1 = e2;
-				functor(e1);
-			}
-			/* remember the last processed entry in _curr */
-			_curr = e1;
+			_reader.for_each_new_entry(_buffer,
+				[&] (Genode::Trace::Buffer::Entry const &entry) {
+					functor(entry);
+					return true; });
 		}
+
+		/**
+		 * Return how often entries got lost because the writer was faster
+		 */
+		unsigned overruns() const { return _reader.overruns(); }
 };
 
 
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -26,7 +26,8 @@ void Init::Child::destroy_services()
 
 
 Init::Child::Apply_config_result
-Init::Child::apply_config(Xml_node start_node)
+Init::Child::apply_config(Xml_node start_node, uint64_t checksum,
+                          bool routing_changed)
 {
 	if (_state == STATE_ABANDONED || _exited)
 		return NO_SIDE_EFFECTS;
@@ -56,10 +57,29 @@ Init::Child::apply_config(Xml_node start_node)
 
 	Config_update config_update = CONFIG_UNCHANGED;
 
+	bool const start_node_changed = (checksum != _start_node_checksum)
+	                             || (start_node.size() != _start_node->xml().size());
+
 	/*
 	 * Import new start node if it differs
 	 */
-	if (start_node.differs_from(_start_node->xml())) {
+	if (start_node_changed) {
+
+		/*
+		 * Buffer the new start node along with its routing rules before
+		 * applying any change. If this fails, the child keeps its former
+		 * start node.
+		 */
+		unsigned const slot = _start_node_buffers[0].constructed() ? 1 : 0;
+
+		Start_node_buffer *new_start_node = nullptr;
+		try { new_start_node = _buffer_start_node(slot, start_node); }
+		catch (Out_of_ram) {
+			warning(name(), ": start node not updated, out of RAM");
+			return NO_SIDE_EFFECTS; }
+		catch (Out_of_caps) {
+			warning(name(), ": start node not updated, out of caps");
+			return NO_SIDE_EFFECTS; }
 
 		/*
 		 * Start node changed
@@ -130,7 +150,9 @@ Init::Child::apply_config(Xml_node start_node)
 		_heartbeat_enabled = start_node.has_sub_node("heartbeat");
 
 		/* import new start node */
-		_start_node.construct(_alloc, start_node);
+		_start_node = new_start_node;
+		_start_node_buffers[!slot].destruct();
+		_start_node_checksum = checksum;
 	}
 
 	/*
@@ -146,14 +168,18 @@ Init::Child::apply_config(Xml_node start_node)
 	case CONFIG_VANISHED: _config_rom_service->abandon();        break;
 	}
 
-	/* validate that the routes of all existing sessions remain intact */
-	{
-		bool routing_changed = false;
+	/*
+	 * Validate that the routes of all existing sessions remain intact. The
+	 * routes can only change with the start node or with the routing
+	 * environment.
+	 */
+	if (start_node_changed || routing_changed) {
+		bool routes_invalid = false;
 		_child.for_each_session([&] (Session_state const &session) {
 			if (!_route_valid(session))
-				routing_changed = true; });
+				routes_invalid = true; });
 
-		if (routing_changed) {
+		if (routes_invalid) {
 			abandon();
 			return MAY_HAVE_SIDE_EFFECTS;
 		}
@@ -507,89 +533,72 @@ Init::Child::Route Init::Child::resolve_session_request(Service::Name const &ser
 		return Route { _session_requester.service(),
 		               Session::Label(), Session::Diag{false} };
 
-	try {
-		Xml_node route_node = _default_route_accessor.default_route();
-		try {
-			route_node = _start_node->xml().sub_node("route"); }
-		catch (...) { }
-		Xml_node service_node = route_node.sub_node();
-
-		for (; ; service_node = service_node.next()) {
+	Route_model const &route_model = _start_node->route_model.constructed()
+	                               ? *_start_node->route_model
+	                               : _default_route_accessor.default_route();
 
-			bool service_wildcard = service_node.has_type("any-service");
+	for (unsigned i = 0; i < route_model.num_rules(); i++) {
 
-			if (!service_node_matches(service_node, label, name(), service_name))
-				continue;
+		Route_model::Rule const &rule = route_model.rule(i);
 
-			Xml_node target = service_node.sub_node();
-			for (; ; target = target.next()) {
+		if (!rule.matches(label, name(), service_name))
+			continue;
 
-				/*
-				 * Determine session label to be provided to the server
-				 *
-				 * By default, the client's identity (accompanied with the a
-				 * client-provided label) is presented as session label to the
-				 * server. However, the target node can explicitly override the
-				 * client's identity by a custom label via the 'label'
-				 * attribute.
-				 */
-				typedef String<Session_label::capacity()> Label;
-				Label const target_label =
-					target.attribute_value("label", Label(label.string()));
+		/* a matching service node without targets ends the lookup */
+		if (rule.num_targets == 0)
+			break;
 
-				Session::Diag const
-					target_diag { target.attribute_value("diag", false) };
+		for (unsigned j = 0; j < rule.num_targets; j++) {
 
-				auto no_filter = [] (Service &) -> bool { return false; };
+			Route_model::Target const &target = route_model.target(rule, j);
 
-				if (target.has_type("parent")) {
+			Route_model::Label const target_label = target.label(label);
 
-					try {
-						return Route { find_service(_parent_services, service_name, no_filter),
-						               target_label, target_diag };
-					} catch (Service_denied) { }
-				}
+			auto no_filter = [] (Service &) -> bool { return false; };
 
-				if (target.has_type("child")) {
+			if (target.type == Route_model::Target::PARENT) {
 
-					typedef Name_registry::Name Name;
-					Name server_name = target.attribute_value("name", Name());
-					server_name = _name_registry.deref_alias(server_name);
+				try {
+					return Route { find_service(_parent_services, service_name, no_filter),
+					               target_label, target.diag };
+				} catch (Service_denied) { }
+			}
 
-					auto filter_server_name = [&] (Routed_service &s) -> bool {
-						return s.child_name() != server_name; };
+			if (target.type == Route_model::Target::CHILD) {
 
-					try {
-						return Route { find_service(_child_services, service_name, filter_server_name),
-						               target_label, target_diag };
+				Name_registry::Name const server_name =
+					_name_registry.deref_alias(target.name);
 
-					} catch (Service_denied) { }
-				}
+				auto filter_server_name = [&] (Routed_service &s) -> bool {
+					return s.child_name() != server_name; };
 
-				if (target.has_type("any-child")) {
+				try {
+					return Route { find_service(_child_services, service_name, filter_server_name),
+					               target_label, target.diag };
 
-					if (is_ambiguous(_child_services, service_name)) {
-						error(name(), ": ambiguous routes to "
-						      "service \"", service_name, "\"");
-						throw Service_denied();
-					}
-					try {
-						return Route { find_service(_child_services, service_name, no_filter),
-						               target_label, target_diag };
+				} catch (Service_denied) { }
+			}
 
-					} catch (Service_denied) { }
-				}
+			if (target.type == Route_model::Target::ANY_CHILD) {
 
-				if (!service_wildcard) {
-					warning(name(), ": lookup for service \"", service_name, "\" failed");
+				if (is_ambiguous(_child_services, service_name)) {
+					error(name(), ": ambiguous routes to "
+					      "service \"", service_name, "\"");
 					throw Service_denied();
 				}
+				try {
+					return Route { find_service(_child_services, service_name, no_filter),
+					               target_label, target.diag };
 
-				if (target.last())
-					break;
+				} catch (Service_denied) { }
+			}
+
+			if (!rule.any_service) {
+				warning(name(), ": lookup for service \"", service_name, "\" failed");
+				throw Service_denied();
 			}
 		}
-	} catch (Xml_node::Nonexistent_sub_node) { }
+	}
 
 	warning(name(), ": no route to service \"", service_name, "\" (label=\"", label, "\")");
 	throw Service_denied();
@@ -727,7 +736,8 @@ Init::Child::Child(Env                      &env,
 	_env(env), _alloc(alloc), _verbose(verbose), _id(id),
 	_report_update_trigger(report_update_trigger),
 	_list_element(this),
-	_start_node(_alloc, start_node),
+	_start_node(_buffer_start_node(0, start_node)),
+	_start_node_checksum(checksum(start_node)),
 	_default_route_accessor(default_route_accessor),
 	_default_caps_accessor(default_caps_accessor),
 	_ram_limit_accessor(ram_limit_accessor),
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -20,6 +20,7 @@
 #include <os/session_requester.h>
 #include <os/session_policy.h>
 #include <os/buffered_xml.h>
+#include <util/avl_string.h>
 
 /* local includes */
 #include <types.h>
@@ -28,6 +29,7 @@
 #include <name_registry.h>
 #include <service.h>
 #include <utils.h>
+#include <route_model.h>
 
 namespace Init { class Child; }
 
@@ -48,7 +50,7 @@ class Init::Child : Child_policy, Routed_service::Wakeup
 		 */
 		struct Id { unsigned value; };
 
-		struct Default_route_accessor : Interface { virtual Xml_node default_route() = 0; };
+		struct Default_route_accessor : Interface { virtual Route_model const &default_route() = 0; };
 		struct Default_caps_accessor  : Interface { virtual Cap_quota default_caps() = 0; };
 
 		template <typename QUOTA>
@@ -67,6 +69,12 @@ class Init::Child : Child_policy, Routed_service::Wakeup
 
 		friend class Child_registry;
 
+		/*
+		 * Noncopyable
+		 */
+		Child(Child const &);
+		Child &operator = (Child const &);
+
 		Env &_env;
 
 		Allocator &_alloc;
@@ -84,7 +92,62 @@ class Init::Child : Child_policy, Routed_service::Wakeup
 
 		List_element<Child> _list_element;
 
-		Reconstructible<Buffered_xml> _start_node;
+		/**
+		 * Buffered start node along with the routing rules of its '<route>'
+		 * node, which refer to the buffered XML data
+		 *
+		 * If no '<route>' node is present, session requests are routed
+		 * according to the default route.
+		 */
+		struct Start_node_buffer : Noncopyable
+		{
+			Buffered_xml const buffered_xml;
+
+			Constructible<Route_model> route_model { };
+
+			/**
+			 * Constructor
+			 *
+			 * \throw Out_of_ram
+			 * \throw Out_of_caps
+			 */
+			Start_node_buffer(Allocator &alloc, Xml_node start_node)
+			:
+				buffered_xml(alloc, start_node)
+			{
+				Xml_node const node = buffered_xml.xml();
+				if (node.has_sub_node("route"))
+					route_model.construct(alloc, node.sub_node("route"));
+			}
+
+			Xml_node xml() const { return buffered_xml.xml(); }
+
+			/**
+			 * Return number of bytes allocated for the buffer
+			 */
+			size_t allocated_size() const
+			{
+				return xml().size() + (route_model.constructed()
+				                    ? route_model->allocated_size() : 0);
+			}
+		};
+
+		/*
+		 * A changed start node is buffered in the unused slot while the
+		 * current one stays intact. Only one slot is in use otherwise.
+		 */
+		Constructible<Start_node_buffer> _start_node_buffers[2] { };
+
+		Start_node_buffer *_buffer_start_node(unsigned slot, Xml_node start_node)
+		{
+			_start_node_buffers[slot].construct(_alloc, start_node);
+			return &*_start_node_buffers[slot];
+		}
+
+		Start_node_buffer *_start_node;
+
+		/* checksum of the start node, used to detect config changes */
+		uint64_t _start_node_checksum;
 
 		/*
 		 * Version attribute of the start node, used to force child restarts.
@@ -121,6 +184,18 @@ class Init::Child : Child_policy, Routed_service::Wakeup
 		typedef String<64> Name;
 		Name const _unique_name { _name_from_xml(_start_node->xml()) };
 
+		/*
+		 * Entry of the name index of the 'Child_registry'
+		 */
+		struct Registry_name : Avl_string_base
+		{
+			Child &child;
+
+			Registry_name(Child &child)
+			: Avl_string_base(child._unique_name.string()), child(child) { }
+
+		} _registry_name { *this };
+
 		static Binary_name _binary_from_xml(Xml_node start_node,
 		                                    Name const &unique_name)
 		{
@@ -494,6 +569,12 @@ class Init::Child : Child_policy, Routed_service::Wakeup
 		Ram_quota ram_quota() const { return _resources.assigned_ram_quota; }
 		Cap_quota cap_quota() const { return _resources.assigned_cap_quota; }
 
+		/**
+		 * Return number of bytes allocated for the buffered start node
+		 * and its routing rules
+		 */
+		size_t start_node_size() const { return _start_node->allocated_size(); }
+
 		void initiate_env_pd_session()
 		{
 			if (_state == STATE_INITIAL) {
@@ -542,10 +623,19 @@ class Init::Child : Child_policy, Routed_service::Wakeup
 		/**
 		 * Apply new configuration to child
 		 *
+		 * \param checksum         checksum of 'start_node'
+		 * \param routing_changed  true if the routes of the child's sessions
+		 *                         may have changed independent from the
+		 *                         start node
+		 *
+		 * If neither the start node nor the routing changed, the child is
+		 * not affected by the new configuration.
+		 *
 		 * \throw Allocator::Out_of_memory  unable to allocate buffer for new
 		 *                                  config
 		 */
-		Apply_config_result apply_config(Xml_node start_node);
+		Apply_config_result apply_config(Xml_node start_node, uint64_t checksum,
+		                                 bool routing_changed);
 
 		/* common code for upgrading RAM and caps */
 		template <typename QUOTA, typename LIMIT_ACCESSOR>
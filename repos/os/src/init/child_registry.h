@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -29,13 +29,43 @@ class Init::Child_registry : public Name_registry, Child_list
 
 		List<Alias> _aliases { };
 
+		/*
+		 * Index of all children by name
+		 *
+		 * Besides a regular child, abandoned children with the same name
+		 * may exist until their environment sessions are closed.
+		 */
+		Avl_tree<Avl_string_base> _names { };
+
+		template <typename FN>
+		static void _for_each_named(Avl_string_base *node, char const *name,
+		                            FN const &fn)
+		{
+			while (node) {
+
+				int const cmp = strcmp(name, node->name());
+
+				/* nodes with equal names may reside in both subtrees */
+				if (cmp == 0) {
+					_for_each_named(node->child(Avl_string_base::LEFT), name, fn);
+					fn(static_cast<Child::Registry_name *>(node)->child);
+					node = node->child(Avl_string_base::RIGHT);
+					continue;
+				}
+
+				node = node->child(cmp > 0);
+			}
+		}
+
 		bool _unique(const char *name) const
 		{
 			/* check for name clash with an existing child */
-			Genode::List_element<Init::Child> const *curr = first();
-			for (; curr; curr = curr->next())
-				if (curr->object()->has_name(name))
-					return false;
+			bool child_exists = false;
+			_for_each_named(_names.first(), name, [&] (Child const &) {
+				child_exists = true; });
+
+			if (child_exists)
+				return false;
 
 			/* check for name clash with an existing alias */
 			for (Alias const *a = _aliases.first(); a; a = a->next()) {
@@ -59,6 +89,7 @@ class Init::Child_registry : public Name_registry, Child_list
 		void insert(Child *child)
 		{
 			Child_list::insert(&child->_list_element);
+			_names.insert(&child->_registry_name);
 		}
 
 		/**
@@ -67,6 +98,7 @@ class Init::Child_registry : public Name_registry, Child_list
 		void remove(Child *child)
 		{
 			Child_list::remove(&child->_list_element);
+			_names.remove(&child->_registry_name);
 		}
 
 		/**
@@ -123,6 +155,16 @@ class Init::Child_registry : public Name_registry, Child_list
 			}
 		}
 
+		/**
+		 * Call 'fn' for each child with the specified name
+		 */
+		template <typename FN>
+		void for_each_child_named(Child_policy::Name const &name, FN const &fn) const
+		{
+			_for_each_named(_names.first(), name.string(), [&] (Child const &child) {
+				fn(child); });
+		}
+
 		void report_state(Xml_generator &xml, Report_detail const &detail) const
 		{
 			for_each_child([&] (Child &child) { child.report_state(xml, detail); });
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -14,9 +14,11 @@
 /* Genode includes */
 #include <base/component.h>
 #include <base/attached_rom_dataspace.h>
+#include <util/xml_index.h>
 
 /* local includes */
 #include <child.h>
+#include <start_node_index.h>
 #include <alias.h>
 #include <server.h>
 #include <heartbeat.h>
@@ -38,11 +40,37 @@ struct Init::Main : State_reporter::Producer,
 
 	Attached_rom_dataspace _config { _env, "config" };
 
+	/* index for the repeated lookups within the config */
+	Constructible<Xml_index> _config_index { };
+
 	Xml_node _config_xml = _config.xml();
 
 	Reconstructible<Verbose> _verbose { _config_xml };
 
-	Constructible<Buffered_xml> _default_route { };
+	Constructible<Route_model> _default_route { };
+
+	Route_model const _empty_route { _heap, Xml_node("<empty/>") };
+
+	/*
+	 * Checksum of the config nodes besides the start nodes, which may affect
+	 * the routing of the children's sessions
+	 */
+	uint64_t _routing_checksum = 0;
+
+	/*
+	 * True if the routes of all children must be revalidated, e.g., because
+	 * a child appeared or vanished as potential server
+	 */
+	bool _routing_changed = true;
+
+	static uint64_t _routing_checksum_from_config(Xml_node config)
+	{
+		uint64_t result = CHECKSUM_SEED;
+		config.for_each_sub_node([&] (Xml_node node) {
+			if (!node.has_type("start"))
+				result = checksum(node, result); });
+		return result;
+	}
 
 	Cap_quota _default_caps { 0 };
 
@@ -127,10 +155,9 @@ struct Init::Main : State_reporter::Producer,
 	/**
 	 * Default_route_accessor interface
 	 */
-	Xml_node default_route() override
+	Route_model const &default_route() override
 	{
-		return _default_route.constructed() ? _default_route->xml()
-		                                    : Xml_node("<empty/>");
+		return _default_route.constructed() ? *_default_route : _empty_route;
 	}
 
 	/**
@@ -147,8 +174,8 @@ struct Init::Main : State_reporter::Producer,
 
 	void _update_aliases_from_config();
 	void _update_parent_services_from_config();
-	void _abandon_obsolete_children();
-	void _update_children_config();
+	void _abandon_obsolete_children(Start_node_index const &);
+	void _update_children_config(Start_node_index const &);
 	void _destroy_abandoned_parent_services();
 	void _handle_config();
 
@@ -245,23 +272,28 @@ void Init::Main::_update_aliases_from_config()
 }
 
 
-void Init::Main::_abandon_obsolete_children()
+void Init::Main::_abandon_obsolete_children(Start_node_index const &start_nodes)
 {
 	_children.for_each_child([&] (Child &child) {
 
 		bool obsolete = true;
-		_config_xml.for_each_sub_node("start", [&] (Xml_node node) {
-			if (child.has_name   (node.attribute_value("name", Child_policy::Name()))
-			 && child.has_version(node.attribute_value("version", Child::Version())))
+		start_nodes.for_each_start_node(child.name(), [&] (Start_node_index::Start_node const &node) {
+			if (child.has_version(node.xml.attribute_value("version", Child::Version())))
 				obsolete = false; });
 
-		if (obsolete)
-			child.abandon();
+		if (!obsolete)
+			return;
+
+		/* the services provided by the child vanish */
+		if (!child.abandoned())
+			_routing_changed = true;
+
+		child.abandon();
 	});
 }
 
 
-void Init::Main::_update_children_config()
+void Init::Main::_update_children_config(Start_node_index const &start_nodes)
 {
 	for (;;) {
 
@@ -273,24 +305,27 @@ void Init::Main::_update_children_config()
 		 */
 		bool side_effects = false;
 
-		_config_xml.for_each_sub_node("start", [&] (Xml_node node) {
+		_children.for_each_child([&] (Child &child) {
 
-			Child_policy::Name const start_node_name =
-				node.attribute_value("name", Child_policy::Name());
+			if (child.abandoned())
+				return;
 
-			_children.for_each_child([&] (Child &child) {
-				if (!child.abandoned() && child.name() == start_node_name) {
-					switch (child.apply_config(node)) {
-					case Child::NO_SIDE_EFFECTS: break;
-					case Child::MAY_HAVE_SIDE_EFFECTS: side_effects = true; break;
-					};
-				}
+			start_nodes.for_each_start_node(child.name(), [&] (Start_node_index::Start_node const &node) {
+				switch (child.apply_config(node.xml, node.checksum, _routing_changed)) {
+				case Child::NO_SIDE_EFFECTS: break;
+				case Child::MAY_HAVE_SIDE_EFFECTS: side_effects = true; break;
+				};
 			});
 		});
 
 		if (!side_effects)
 			break;
+
+		/* the side effects may affect the routes of any child */
+		_routing_changed = true;
 	}
+
+	_routing_changed = false;
 }
 
 
@@ -298,9 +333,18 @@ void Init::Main::_handle_config()
 {
 	bool update_state_report = false;
 
+	/* the index and the default route refer to the data of the old config */
+	_config_index.destruct();
+	_default_route.destruct();
+
 	_config.update();
 
-	_config_xml = _config.xml();
+	try { _config_index.construct(_heap, _config.xml()); }
+	catch (Out_of_ram)  { warning("config not indexed, out of RAM"); }
+	catch (Out_of_caps) { warning("config not indexed, out of caps"); }
+
+	_config_xml = _config_index.constructed() ? _config_index->xml()
+	                                          : _config.xml();
 
 	_verbose.construct(_config_xml);
 	_state_reporter.apply_config(_config_xml);
@@ -320,10 +364,18 @@ void Init::Main::_handle_config()
 	Prio_levels     const prio_levels    = prio_levels_from_xml(_config_xml);
 	Affinity::Space const affinity_space = affinity_space_from_xml(_config_xml);
 
+	uint64_t const routing_checksum = _routing_checksum_from_config(_config_xml);
+	if (routing_checksum != _routing_checksum) {
+		_routing_checksum = routing_checksum;
+		_routing_changed  = true;
+	}
+
+	Start_node_index const start_nodes(_heap, _config_xml);
+
 	_update_aliases_from_config();
 	_update_parent_services_from_config();
-	_abandon_obsolete_children();
-	_update_children_config();
+	_abandon_obsolete_children(start_nodes);
+	_update_children_config(start_nodes);
 
 	/* kill abandoned children */
 	_children.for_each_child([&] (Child &child) {
@@ -361,13 +413,14 @@ void Init::Main::_handle_config()
 
 			unsigned num_abandoned = 0;
 
-			_children.for_each_child([&] (Child const &child) {
-				if (child.name() == start_node.attribute_value("name", Child_policy::Name())) {
-					if (child.abandoned())
-						num_abandoned++;
-					else
-						exists = true;
-				}
+			Child_policy::Name const name =
+				start_node.attribute_value("name", Child_policy::Name());
+
+			_children.for_each_child_named(name, [&] (Child const &child) {
+				if (child.abandoned())
+					num_abandoned++;
+				else
+					exists = true;
 			});
 
 			/* skip start node if corresponding child already exists */
@@ -401,8 +454,14 @@ void Init::Main::_handle_config()
 
 				update_state_report = true;
 
-				/* account for the start XML node buffered in the child */
-				size_t const metadata_overhead = start_node.size()
+				/* the services of the new child may serve other children */
+				_routing_changed = true;
+
+				/*
+				 * Account for the start XML node and its routing rules
+				 * buffered in the child
+				 */
+				size_t const metadata_overhead = child.start_node_size()
 				                               + sizeof(Init::Child);
 				/* track used memory and RAM limit */
 				used_ram = Ram_quota { used_ram.value
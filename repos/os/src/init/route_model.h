@@ -0,0 +1,268 @@
+/*
+ * \brief  Routing rules prepared for the lookup of session routes
+ * \author Genode Labs
+ * \date   2019-10-28
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__INIT__ROUTE_MODEL_H_
+#define _SRC__INIT__ROUTE_MODEL_H_
+
+/* Genode includes */
+#include <base/child.h>
+#include <os/session_policy.h>
+#include <util/construct_at.h>
+
+/* local includes */
+#include <types.h>
+#include <utils.h>
+
+namespace Init { class Route_model; }
+
+
+/**
+ * Sub nodes of a '<route>' node in a form that can be matched against session
+ * requests without parsing the XML data
+ *
+ * The model refers to the XML data of the route node, which must outlive the
+ * model. The XML data is consulted only for the label attributes of matching
+ * rules.
+ */
+class Init::Route_model : Noncopyable
+{
+	public:
+
+		typedef String<Session_label::capacity()> Label;
+
+		struct Target
+		{
+			enum Type { PARENT, CHILD, ANY_CHILD, UNKNOWN };
+
+			Xml_node           const node;
+			Type               const type;
+			Child_policy::Name const name;  /* server of a '<child>' target */
+			Session::Diag      const diag;
+			bool               const has_label;
+
+			static Type _type(Xml_node node)
+			{
+				if (node.has_type("parent"))    return PARENT;
+				if (node.has_type("child"))     return CHILD;
+				if (node.has_type("any-child")) return ANY_CHILD;
+				return UNKNOWN;
+			}
+
+			Target(Xml_node node)
+			:
+				node(node), type(_type(node)),
+				name(node.attribute_value("name", Child_policy::Name())),
+				diag { node.attribute_value("diag", false) },
+				has_label(node.has_attribute("label"))
+			{ }
+
+			/**
+			 * Return session label to be provided to the server
+			 *
+			 * By default, the client's identity (accompanied with a
+			 * client-provided label) is presented as session label to the
+			 * server. However, the target node can explicitly override the
+			 * client's identity by a custom label via the 'label' attribute.
+			 */
+			Label label(Session_label const &client_label) const
+			{
+				return has_label ? node.attribute_value("label", Label())
+				                 : Label(client_label.string());
+			}
+		};
+
+		struct Rule
+		{
+			enum Label_match { ANY_LABEL, UNSCOPED_LABEL, LAST_LABEL, SCOPED_LABEL };
+
+			Xml_node      const node;
+			bool          const any_service;
+			Service::Name const service;
+			Label_match   const label_match;
+			unsigned      const first_target;
+			unsigned      const num_targets;
+
+			static Label_match _label_match(Xml_node node)
+			{
+				bool const scoped = node.has_attribute("label")
+				                 || node.has_attribute("label_prefix")
+				                 || node.has_attribute("label_suffix")
+				                 || node.has_attribute("label_last");
+
+				/*
+				 * If an 'unscoped_label' attribute is provided, don't consider
+				 * any scoped label attribute.
+				 */
+				if (node.has_attribute("unscoped_label")) {
+					if (scoped)
+						warning("service node contains both scoped and unscoped label attributes");
+					return UNSCOPED_LABEL;
+				}
+
+				if (node.has_attribute("label_last"))
+					return LAST_LABEL;
+
+				return scoped ? SCOPED_LABEL : ANY_LABEL;
+			}
+
+			Rule(Xml_node node, unsigned first_target, unsigned num_targets)
+			:
+				node(node),
+				any_service(node.has_type("any-service")),
+				service(node.attribute_value("name", Service::Name())),
+				label_match(_label_match(node)),
+				first_target(first_target),
+				num_targets(num_targets)
+			{ }
+
+			/**
+			 * Return true if the rule matches the session request
+			 *
+			 * \param label         session label
+			 * \param child_name    name of the originator of the session request
+			 * \param service_name  name of the requested service
+			 */
+			bool matches(Session_label      const &label,
+			             Child_policy::Name const &child_name,
+			             Service::Name      const &service_name) const
+			{
+				if (!any_service && service != service_name)
+					return false;
+
+				switch (label_match) {
+
+				case ANY_LABEL:
+					return true;
+
+				case UNSCOPED_LABEL:
+					return label == node.attribute_value("unscoped_label", Label());
+
+				case LAST_LABEL:
+					return node.attribute_value("label_last", Label()) == label.last_element();
+
+				case SCOPED_LABEL:
+					break;
+				}
+
+				char const * const scoped_label = skip_label_prefix(
+					child_name.string(), label.string());
+
+				if (!scoped_label)
+					return false;
+
+				Session_label const session_label(scoped_label);
+
+				return !Xml_node_label_score(node, session_label).conflict();
+			}
+		};
+
+	private:
+
+		Allocator &_alloc;
+
+		Xml_node const _route;
+
+		static bool _service_node(Xml_node node)
+		{
+			return node.has_type("service") || node.has_type("any-service");
+		}
+
+		unsigned _count_rules() const
+		{
+			unsigned result = 0;
+			_route.for_each_sub_node([&] (Xml_node node) {
+				result += _service_node(node); });
+			return result;
+		}
+
+		unsigned _count_targets() const
+		{
+			unsigned result = 0;
+			_route.for_each_sub_node([&] (Xml_node node) {
+				if (_service_node(node))
+					node.for_each_sub_node([&] (Xml_node) { result++; }); });
+			return result;
+		}
+
+		unsigned const _num_rules   = _count_rules();
+		unsigned const _num_targets = _count_targets();
+
+		/* rules and targets are stored in one allocation */
+		size_t const _size = sizeof(Rule)*_num_rules + sizeof(Target)*_num_targets;
+
+		void * const _block = _size ? _alloc.alloc(_size) : nullptr;
+
+		Rule   * const _rules   = (Rule *)_block;
+		Target * const _targets = (Target *)(_rules + _num_rules);
+
+		/*
+		 * Noncopyable
+		 */
+		Route_model(Route_model const &);
+		Route_model &operator = (Route_model const &);
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Allocator::Out_of_memory
+		 */
+		Route_model(Allocator &alloc, Xml_node route)
+		:
+			_alloc(alloc), _route(route)
+		{
+			unsigned rule = 0, target = 0;
+
+			_route.for_each_sub_node([&] (Xml_node node) {
+
+				/* other nodes never match a session request */
+				if (!_service_node(node))
+					return;
+
+				unsigned const first_target = target;
+
+				node.for_each_sub_node([&] (Xml_node target_node) {
+					construct_at<Target>(&_targets[target++], target_node); });
+
+				construct_at<Rule>(&_rules[rule++], node, first_target,
+				                   target - first_target);
+			});
+		}
+
+		~Route_model()
+		{
+			if (_block)
+				_alloc.free(_block, _size);
+		}
+
+		/**
+		 * Return number of rules, which are numbered in the order of the
+		 * route node
+		 */
+		unsigned num_rules() const { return _num_rules; }
+
+		/**
+		 * Return number of bytes allocated for the rules and targets
+		 */
+		size_t allocated_size() const { return _size; }
+
+		Rule const &rule(unsigned i) const { return _rules[i]; }
+
+		Target const &target(Rule const &rule, unsigned i) const
+		{
+			return _targets[rule.first_target + i];
+		}
+};
+
+#endif /* _SRC__INIT__ROUTE_MODEL_H_ */
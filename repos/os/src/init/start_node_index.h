@@ -0,0 +1,156 @@
+/*
+ * \brief  Lookup of the start nodes of the config by child name
+ * \author Genode Labs
+ * \date   2019-10-28
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__INIT__START_NODE_INDEX_H_
+#define _SRC__INIT__START_NODE_INDEX_H_
+
+/* Genode includes */
+#include <base/child.h>
+#include <util/avl_string.h>
+#include <util/construct_at.h>
+
+/* local includes */
+#include <types.h>
+#include <utils.h>
+
+namespace Init { class Start_node_index; }
+
+
+/**
+ * Start nodes of one config version, keyed by the child name
+ *
+ * The index refers to the XML data of the config, which must outlive the
+ * index. Start nodes with the same name are chained in the order of the
+ * config.
+ */
+class Init::Start_node_index : Noncopyable
+{
+	public:
+
+		class Start_node : public Avl_string<Child_policy::Name::capacity()>
+		{
+			private:
+
+				/*
+				 * Noncopyable
+				 */
+				Start_node(Start_node const &);
+				Start_node &operator = (Start_node const &);
+
+			public:
+
+				Xml_node const xml;
+
+				/* checksum for detecting changes of the start node */
+				uint64_t const checksum;
+
+				/* next start node with the same name */
+				Start_node *duplicate = nullptr;
+
+				Start_node(Child_policy::Name const &name, Xml_node xml)
+				:
+					Avl_string(name.string()), xml(xml), checksum(Init::checksum(xml))
+				{ }
+		};
+
+	private:
+
+		Allocator &_alloc;
+
+		static unsigned _count(Xml_node config)
+		{
+			unsigned result = 0;
+			config.for_each_sub_node("start", [&] (Xml_node) { result++; });
+			return result;
+		}
+
+		unsigned const _max_nodes;
+
+		Start_node * const _nodes = _max_nodes
+		                          ? (Start_node *)_alloc.alloc(sizeof(Start_node)*_max_nodes)
+		                          : nullptr;
+		unsigned _num_nodes = 0;
+
+		Avl_tree<Avl_string_base> _tree { };
+
+		/*
+		 * Noncopyable
+		 */
+		Start_node_index(Start_node_index const &);
+		Start_node_index &operator = (Start_node_index const &);
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Allocator::Out_of_memory
+		 */
+		Start_node_index(Allocator &alloc, Xml_node config)
+		:
+			_alloc(alloc), _max_nodes(_count(config))
+		{
+			config.for_each_sub_node("start", [&] (Xml_node node) {
+
+				Child_policy::Name const name =
+					node.attribute_value("name", Child_policy::Name());
+
+				/* nameless start nodes cannot correspond to a child */
+				if (!name.valid() || _num_nodes == _max_nodes)
+					return;
+
+				Start_node &start_node =
+					*construct_at<Start_node>(&_nodes[_num_nodes++], name, node);
+
+				Avl_string_base * const existing = _tree.first()
+					? _tree.first()->find_by_name(name.string()) : nullptr;
+
+				if (!existing) {
+					_tree.insert(&start_node);
+					return;
+				}
+
+				Start_node *last = static_cast<Start_node *>(existing);
+				if (!last->duplicate)
+					warning("config contains multiple start nodes named \"", name, "\"");
+
+				for (; last->duplicate; last = last->duplicate);
+				last->duplicate = &start_node;
+			});
+		}
+
+		~Start_node_index()
+		{
+			if (_nodes)
+				_alloc.free(_nodes, sizeof(Start_node)*_max_nodes);
+		}
+
+		/**
+		 * Call 'fn' for each start node of the specified child
+		 *
+		 * The start nodes are passed in the order of the config.
+		 */
+		template <typename FN>
+		void for_each_start_node(Child_policy::Name const &name, FN const &fn) const
+		{
+			Avl_string_base * const node = _tree.first()
+			                             ? _tree.first()->find_by_name(name.string())
+			                             : nullptr;
+
+			for (Start_node const *s = static_cast<Start_node const *>(node);
+			     s; s = s->duplicate)
+				fn(*s);
+		}
+};
+
+#endif /* _SRC__INIT__START_NODE_INDEX_H_ */
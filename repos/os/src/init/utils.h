@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2010-2017 Genode Labs GmbH
+ * Copyright (C) 2010-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -49,64 +49,23 @@ namespace Init {
 	}
 
 
+	enum : uint64_t { CHECKSUM_SEED = 0xcbf29ce484222325ULL };
+
 	/**
-	 * Return true if service XML node matches service request
+	 * Return FNV-1a checksum of the data of an XML node
 	 *
-	 * \param args          session arguments, inspected for the session label
-	 * \param child_name    name of the originator of the session request
-	 * \param service_name  name of the requested service
+	 * \param seed  checksum of preceding data, used for combining the
+	 *              checksums of multiple nodes
 	 */
-	inline bool service_node_matches(Xml_node           const  service_node,
-	                                 Session_label      const &label,
-	                                 Child_policy::Name const &child_name,
-	                                 Service::Name      const &service_name)
+	inline uint64_t checksum(Xml_node node, uint64_t seed = CHECKSUM_SEED)
 	{
-		bool const service_matches =
-			service_node.has_type("any-service") ||
-			(service_node.has_type("service") &&
-			 service_node.attribute_value("name", Service::Name()) == service_name);
-
-		if (!service_matches)
-			return false;
-
-		typedef String<Session_label::capacity()> Label;
-
-		char const *unscoped_attr   = "unscoped_label";
-		char const *label_last_attr = "label_last";
-
-		bool const route_depends_on_child_provided_label =
-			service_node.has_attribute("label") ||
-			service_node.has_attribute("label_prefix") ||
-			service_node.has_attribute("label_suffix") ||
-			service_node.has_attribute(label_last_attr);
-
-		if (service_node.has_attribute(unscoped_attr)) {
-
-			/*
-			 * If an 'unscoped_label' attribute is provided, don't consider any
-			 * scoped label attribute.
-			 */
-			if (route_depends_on_child_provided_label)
-				warning("service node contains both scoped and unscoped label attributes");
-
-			return label == service_node.attribute_value(unscoped_attr, Label());
-		}
-
-		if (service_node.has_attribute(label_last_attr))
-			return service_node.attribute_value(label_last_attr, Label()) == label.last_element();
-
-		if (!route_depends_on_child_provided_label)
-			return true;
-
-		char const * const scoped_label = skip_label_prefix(
-			child_name.string(), label.string());
-
-		if (!scoped_label)
-			return false;
+		uint64_t result = seed;
 
-		Session_label const session_label(scoped_label);
+		node.with_raw_node([&] (char const *start, size_t length) {
+			for (size_t i = 0; i < length; i++)
+				result = (result ^ (unsigned char)start[i])*0x100000001b3ULL; });
 
-		return !Xml_node_label_score(service_node, session_label).conflict();
+		return result;
 	}
 
 
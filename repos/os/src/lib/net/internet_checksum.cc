@@ -14,29 +14,74 @@
 /* Genode includes */
 #include <net/internet_checksum.h>
 
+/* local includes */
+#include <internet_checksum_helper.h>
+
 using namespace Net;
 using namespace Genode;
 
 
-uint16_t Net::internet_checksum(uint16_t const *addr,
-                                size_t          size,
-                                addr_t          init_sum)
+/**
+ * Add up the remainder of the data that does not fill a block
+ */
+static uint64_t add_up_tail(uint8_t const *src, size_t size)
 {
+	typedef uint16_t __attribute__((aligned(1), may_alias)) word_t;
+
 	/* add up bytes in pairs */
-	addr_t sum = init_sum;
-	for (; size > 1; size -= 2)
-		sum += *addr++;
+	uint64_t sum = 0;
+	for (; size > 1; size -= 2, src += 2)
+		sum += *(word_t const *)src;
 
 	/* add left-over byte, if any */
 	if (size > 0)
-		sum += *(uint8_t *)addr;
+		sum += *src;
 
-	/* fold sum to 16-bit value */
-	while (addr_t const sum_rsh = sum >> 16)
+	return sum;
+}
+
+
+/**
+ * Fold sum to 16-bit value and return its one's complement
+ */
+static uint16_t fold(uint64_t sum)
+{
+	while (uint64_t const sum_rsh = sum >> 16)
 		sum = (sum & 0xffff) + sum_rsh;
 
-	/* return one's complement */
-	return ~sum;
+	return (uint16_t)~sum;
+}
+
+
+uint16_t Net::internet_checksum(uint16_t const *addr,
+                                size_t          size,
+                                addr_t          init_sum)
+{
+	uint8_t const *src        = (uint8_t const *)addr;
+	size_t  const  block_size = size & ~(size_t)(CHECKSUM_BLOCK_SIZE - 1);
+
+	return fold((uint64_t)init_sum + add_up_blocks(src, block_size)
+	                               + add_up_tail(src + block_size, size - block_size));
+}
+
+
+uint16_t Net::internet_checksum_copy(void           *dst,
+                                     uint16_t const *src,
+                                     size_t          size,
+                                     addr_t          init_sum)
+{
+	uint8_t       *d          = (uint8_t       *)dst;
+	uint8_t const *s          = (uint8_t const *)src;
+	size_t  const  block_size = size & ~(size_t)(CHECKSUM_BLOCK_SIZE - 1);
+
+	uint64_t const sum = copy_and_add_up_blocks(d, s, block_size);
+
+	/* copy remainder before adding it up from the destination */
+	for (size_t i = block_size; i < size; i++)
+		d[i] = s[i];
+
+	return fold((uint64_t)init_sum + sum
+	                               + add_up_tail(d + block_size, size - block_size));
 }
 
 
@@ -0,0 +1,152 @@
+/*
+ * \brief  Checksum kernels for the Internet Checksum
+ * \author Genode Labs
+ * \date   2019-10-09
+ *
+ * The kernels add up the data in 32-bit words. Because 2^16 is congruent to
+ * 1 modulo 2^16 - 1, the folded sum of 32-bit words equals the one's
+ * complement sum of the 16-bit words independent of the byte order.
+ *
+ * If the compiler targets a CPU with SSE2 or NEON, each 16-byte vector is
+ * split into four 32-bit words that are zero-extended and added to two
+ * 64-bit accumulators, which never overflow for packet-sized data. The
+ * vectors are expressed as GCC vector types because the intrinsics headers
+ * of the compiler depend on the C library.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _LIB__NET__INTERNET_CHECKSUM_HELPER_H_
+#define _LIB__NET__INTERNET_CHECKSUM_HELPER_H_
+
+/* Genode includes */
+#include <base/stdint.h>
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+/**
+ * Number of bytes processed at once by the kernels
+ */
+enum { CHECKSUM_BLOCK_SIZE = 32 };
+
+/* the data is not necessarily aligned */
+typedef Genode::uint32_t __attribute__((vector_size(16), aligned(1), may_alias))
+        checksum_vector_t;
+
+typedef Genode::uint64_t __attribute__((vector_size(16))) checksum_sum_t;
+
+
+static inline checksum_sum_t _add_up_vector(checksum_sum_t sum, checksum_vector_t v)
+{
+	typedef Genode::uint32_t __attribute__((vector_size(16))) index_t;
+
+	checksum_vector_t const zero = { 0, 0, 0, 0 };
+
+	sum += (checksum_sum_t)__builtin_shuffle(v, zero, (index_t){ 0, 4, 1, 5 });
+	return sum + (checksum_sum_t)__builtin_shuffle(v, zero, (index_t){ 2, 6, 3, 7 });
+}
+
+
+/**
+ * Add up 'size' bytes at 'src' in 32-bit words
+ *
+ * \param size  multiple of 'CHECKSUM_BLOCK_SIZE'
+ */
+static inline Genode::uint64_t add_up_blocks(void const *src, Genode::size_t size)
+{
+	checksum_vector_t const *s = (checksum_vector_t const *)src;
+
+	checksum_sum_t sum0 = { 0, 0 }, sum1 = { 0, 0 };
+	for (; size; size -= CHECKSUM_BLOCK_SIZE, s += 2) {
+		sum0 = _add_up_vector(sum0, s[0]);
+		sum1 = _add_up_vector(sum1, s[1]);
+	}
+
+	checksum_sum_t const sum = sum0 + sum1;
+	return sum[0] + sum[1];
+}
+
+
+/**
+ * Copy 'size' bytes from 'src' to 'dst' and add them up in 32-bit words
+ *
+ * \param size  multiple of 'CHECKSUM_BLOCK_SIZE'
+ */
+static inline Genode::uint64_t copy_and_add_up_blocks(void *dst, void const *src,
+                                                      Genode::size_t size)
+{
+	checksum_vector_t const *s = (checksum_vector_t const *)src;
+	checksum_vector_t       *d = (checksum_vector_t       *)dst;
+
+	checksum_sum_t sum0 = { 0, 0 }, sum1 = { 0, 0 };
+	for (; size; size -= CHECKSUM_BLOCK_SIZE, s += 2, d += 2) {
+		checksum_vector_t const v0 = s[0], v1 = s[1];
+		d[0] = v0;
+		d[1] = v1;
+		sum0 = _add_up_vector(sum0, v0);
+		sum1 = _add_up_vector(sum1, v1);
+	}
+
+	checksum_sum_t const sum = sum0 + sum1;
+	return sum[0] + sum[1];
+}
+
+#else
+
+/**
+ * Number of bytes processed at once by the kernels
+ */
+enum { CHECKSUM_BLOCK_SIZE = 8 };
+
+/* the data is not necessarily aligned */
+typedef Genode::uint32_t __attribute__((aligned(1), may_alias)) checksum_word_t;
+
+
+/**
+ * Add up 'size' bytes at 'src' in 32-bit words
+ *
+ * \param size  multiple of 'CHECKSUM_BLOCK_SIZE'
+ */
+static inline Genode::uint64_t add_up_blocks(void const *src, Genode::size_t size)
+{
+	checksum_word_t const *s = (checksum_word_t const *)src;
+
+	Genode::uint64_t sum0 = 0, sum1 = 0;
+	for (; size; size -= CHECKSUM_BLOCK_SIZE, s += 2) {
+		sum0 += s[0];
+		sum1 += s[1];
+	}
+	return sum0 + sum1;
+}
+
+
+/**
+ * Copy 'size' bytes from 'src' to 'dst' and add them up in 32-bit words
+ *
+ * \param size  multiple of 'CHECKSUM_BLOCK_SIZE'
+ */
+static inline Genode::uint64_t copy_and_add_up_blocks(void *dst, void const *src,
+                                                      Genode::size_t size)
+{
+	checksum_word_t const *s = (checksum_word_t const *)src;
+	checksum_word_t       *d = (checksum_word_t       *)dst;
+
+	Genode::uint64_t sum0 = 0, sum1 = 0;
+	for (; size; size -= CHECKSUM_BLOCK_SIZE, s += 2, d += 2) {
+		Genode::uint32_t const w0 = s[0], w1 = s[1];
+		d[0] = w0;
+		d[1] = w1;
+		sum0 += w0;
+		sum1 += w1;
+	}
+	return sum0 + sum1;
+}
+
+#endif /* __SSE2__ || __ARM_NEON */
+
+#endif /* _LIB__NET__INTERNET_CHECKSUM_HELPER_H_ */
@@ -20,6 +20,8 @@
 #include <base/allocator_avl.h>
 #include <base/id_space.h>
 #include <file_system_session/connection.h>
+#include <timer_session/connection.h>
+#include <util/construct_at.h>
 
 namespace Vfs { class Fs_file_system; }
 
@@ -53,6 +55,336 @@ class Vfs::Fs_file_system : public File_system
 		Handle_space _handle_space { };
 		Handle_space _watch_handle_space { };
 
+		/**
+		 * Cache of node attributes looked up by path
+		 *
+		 * The cache holds the results of 'stat', 'leaf_path', 'directory',
+		 * and 'num_dirent' lookups, including failed lookups. An entry is
+		 * dropped if it is older than the staleness bound, if the node is
+		 * modified via this file system, or if the server reports a change
+		 * of a watched directory containing the node. Without a staleness
+		 * bound, only nodes within watched directories are cached.
+		 */
+		class Metadata_cache
+		{
+			public:
+
+				typedef Genode::String<MAX_PATH_LEN> Path_string;
+
+				static unsigned hash(char const *path)
+				{
+					/* the root directory may be referred to as "" or "/" */
+					if (!path[0]) path = "/";
+
+					unsigned h = 2166136261U;
+					for (; *path; path++)
+						h = (h ^ (unsigned char)*path) * 16777619U;
+					return h;
+				}
+
+			private:
+
+				/*
+				 * Noncopyable
+				 */
+				Metadata_cache(Metadata_cache const &);
+				Metadata_cache &operator = (Metadata_cache const &);
+
+				enum { MAX_DIR_WATCHES = 64, STATS_INTERVAL = 1024 };
+
+				struct Entry
+				{
+					Path_string           path    { };
+					unsigned              hash    = 0;
+					bool                  used    = false;
+					bool                  exists  = false;
+					::File_system::Status status  { };
+					Genode::uint64_t      time_ms = 0;
+					Entry                *next    = nullptr;
+				};
+
+				struct Dir_watch
+				{
+					Path_string                 path   { };
+					::File_system::Watch_handle handle { ~0U };
+				};
+
+				Genode::Lock _lock { };
+
+				Genode::Allocator         &_alloc;
+				::File_system::Connection &_fs;
+
+				unsigned         const _capacity;
+				Genode::uint64_t const _max_age_ms;
+				bool             const _verbose;
+
+				Genode::Constructible<Timer::Connection> _timer { };
+
+				Entry   *_entries     = nullptr;
+				Entry  **_buckets     = nullptr;
+				unsigned _num_buckets = 1;
+				unsigned _victim      = 0;
+
+				Dir_watch _dir_watches[MAX_DIR_WATCHES];
+				unsigned  _num_dir_watches = 0;
+
+				unsigned long _hits = 0, _misses = 0;
+
+				Genode::uint64_t _now_ms()
+				{
+					return _timer.constructed()
+					     ? _timer->curr_time().trunc_to_plain_ms().value : 0;
+				}
+
+				Entry *&_bucket(unsigned hash) {
+					return _buckets[hash & (_num_buckets - 1)]; }
+
+				static bool _same(Path_string const &a, char const *b) {
+					return a == (b[0] ? b : "/"); }
+
+				Entry *_find(char const *path, unsigned hash)
+				{
+					for (Entry *e = _bucket(hash); e; e = e->next)
+						if (e->hash == hash && _same(e->path, path))
+							return e;
+					return nullptr;
+				}
+
+				void _drop(Entry &entry)
+				{
+					for (Entry **link = &_bucket(entry.hash); *link; link = &(*link)->next) {
+						if (*link == &entry) {
+							*link = entry.next;
+							break;
+						}
+					}
+					entry.used = false;
+					entry.next = nullptr;
+				}
+
+				static bool _within(Path_string const &path, Path_string const &dir)
+				{
+					if (dir == "/" || path == dir)
+						return true;
+
+					Genode::size_t const len = dir.length() - 1;
+					return !Genode::strcmp(path.string(), dir.string(), len)
+					    && path.string()[len] == '/';
+				}
+
+				void _drop_within(Path_string const &dir)
+				{
+					for (unsigned i = 0; i < _capacity; i++)
+						if (_entries[i].used && _within(_entries[i].path, dir))
+							_drop(_entries[i]);
+				}
+
+				bool _watched(Path_string const &dir) const
+				{
+					for (unsigned i = 0; i < _num_dir_watches; i++)
+						if (_dir_watches[i].path == dir)
+							return true;
+					return false;
+				}
+
+				void _count(bool hit)
+				{
+					hit ? _hits++ : _misses++;
+
+					if (_verbose && (_hits + _misses) % STATS_INTERVAL == 0)
+						Genode::log("metadata cache: ", _hits, " hits, ",
+						            _misses, " misses");
+				}
+
+			public:
+
+				Metadata_cache(Genode::Env &env, Genode::Allocator &alloc,
+				               ::File_system::Connection &fs,
+				               unsigned capacity, Genode::uint64_t max_age_ms,
+				               bool verbose)
+				:
+					_alloc(alloc), _fs(fs), _capacity(capacity),
+					_max_age_ms(max_age_ms), _verbose(verbose)
+				{
+					if (_max_age_ms)
+						_timer.construct(env);
+
+					while (_num_buckets < _capacity)
+						_num_buckets <<= 1;
+
+					_entries = (Entry *)_alloc.alloc(_capacity*sizeof(Entry));
+					for (unsigned i = 0; i < _capacity; i++)
+						Genode::construct_at<Entry>(&_entries[i]);
+
+					_buckets = (Entry **)_alloc.alloc(_num_buckets*sizeof(Entry *));
+					for (unsigned i = 0; i < _num_buckets; i++)
+						_buckets[i] = nullptr;
+				}
+
+				~Metadata_cache()
+				{
+					for (unsigned i = 0; i < _num_dir_watches; i++)
+						_fs.close(_dir_watches[i].handle);
+
+					_alloc.free(_buckets, _num_buckets*sizeof(Entry *));
+					_alloc.free(_entries, _capacity*sizeof(Entry));
+				}
+
+				/**
+				 * Look up cached attributes of node at 'path'
+				 *
+				 * \param exists  false if the node is known to not exist
+				 * \return        true on cache hit
+				 */
+				bool lookup(char const *path, ::File_system::Status &status,
+				            bool &exists)
+				{
+					Genode::Lock::Guard guard(_lock);
+
+					Entry *e = _find(path, hash(path));
+
+					if (e && _max_age_ms && _now_ms() - e->time_ms > _max_age_ms) {
+						_drop(*e);
+						e = nullptr;
+					}
+
+					_count(e != nullptr);
+
+					if (!e)
+						return false;
+
+					exists = e->exists;
+					status = e->status;
+					return true;
+				}
+
+				/**
+				 * Watch directory containing 'path' for changes
+				 *
+				 * Must be called before the attributes of the node are
+				 * requested from the server so that no change is missed.
+				 *
+				 * \return true if the lookup result may be cached
+				 */
+				bool prepare_insert(char const *path)
+				{
+					Absolute_path dir(path);
+					dir.strip_last_element();
+
+					Path_string const dir_string(dir.string());
+
+					{
+						Genode::Lock::Guard guard(_lock);
+
+						if (_watched(dir_string))
+							return true;
+
+						if (_num_dir_watches == MAX_DIR_WATCHES)
+							return _max_age_ms != 0;
+					}
+
+					::File_system::Watch_handle handle { ~0U };
+					try { handle = _fs.watch(dir.base()); }
+					catch (...) { return _max_age_ms != 0; }
+
+					Genode::Lock::Guard guard(_lock);
+
+					if (_num_dir_watches == MAX_DIR_WATCHES || _watched(dir_string)) {
+						_fs.close(handle);
+						return true;
+					}
+
+					_dir_watches[_num_dir_watches].path   = dir_string;
+					_dir_watches[_num_dir_watches].handle = handle;
+					_num_dir_watches++;
+					return true;
+				}
+
+				void insert(char const *path, bool exists,
+				            ::File_system::Status const &status)
+				{
+					Genode::Lock::Guard guard(_lock);
+
+					unsigned const h = hash(path);
+
+					Entry *e = _find(path, h);
+					if (!e) {
+						/* replace entries in round-robin order */
+						e = &_entries[_victim];
+						_victim = (_victim + 1) % _capacity;
+
+						if (e->used)
+							_drop(*e);
+
+						e->path = Path_string(path[0] ? path : "/");
+						e->hash = h;
+						e->used = true;
+						e->next = _bucket(h);
+						_bucket(h) = e;
+					}
+
+					e->exists  = exists;
+					e->status  = status;
+					e->time_ms = _now_ms();
+				}
+
+				/**
+				 * Drop entries of all nodes with the given path hash
+				 */
+				void invalidate(unsigned hash)
+				{
+					Genode::Lock::Guard guard(_lock);
+
+					for (Entry *e = _bucket(hash), *next = nullptr; e; e = next) {
+						next = e->next;
+						if (e->hash == hash)
+							_drop(*e);
+					}
+				}
+
+				/**
+				 * Drop entries of the node at 'path' and its parent directory
+				 */
+				void invalidate_with_parent(char const *path)
+				{
+					Absolute_path dir(path);
+					dir.strip_last_element();
+
+					invalidate(hash(path));
+					invalidate(hash(dir.base()));
+				}
+
+				/**
+				 * Drop entries of the node at 'path' and all nodes below
+				 */
+				void invalidate_subtree(char const *path)
+				{
+					Genode::Lock::Guard guard(_lock);
+
+					_drop_within(Path_string(path[0] ? path : "/"));
+				}
+
+				/**
+				 * Handle change notification
+				 *
+				 * \return false if the watch handle does not belong to the
+				 *         cache
+				 */
+				bool watch_triggered(::File_system::Watch_handle handle)
+				{
+					Genode::Lock::Guard guard(_lock);
+
+					for (unsigned i = 0; i < _num_dir_watches; i++) {
+						if (_dir_watches[i].handle.value != handle.value)
+							continue;
+
+						_drop_within(_dir_watches[i].path);
+						return true;
+					}
+					return false;
+				}
+		};
+
 		struct Handle_state
 		{
 			enum class Read_ready_state { IDLE, PENDING, READY };
@@ -87,6 +419,9 @@ class Vfs::Fs_file_system : public File_system
 
 			::File_system::Connection &_fs;
 
+			/* hash of the node path if the node may be modified via the handle */
+			unsigned path_hash = 0;
+
 			bool _queue_read(file_size count, file_size const seek_offset)
 			{
 				if (queued_read_state != Handle_state::Queued_state::IDLE)
@@ -175,6 +510,24 @@ class Vfs::Fs_file_system : public File_system
 				return READ_ERR_INVALID;
 			}
 
+			/**
+			 * Take acknowledged read packet
+			 *
+			 * \return false if the packet is not expected anymore and
+			 *         must be released by the caller
+			 */
+			virtual bool read_acked(::File_system::Packet_descriptor const &packet)
+			{
+				queued_read_packet = packet;
+				queued_read_state  = Handle_state::Queued_state::ACK;
+				return true;
+			}
+
+			/**
+			 * Drop data read in advance because the file was modified
+			 */
+			virtual void invalidate_read_ahead() { }
+
 			bool queue_sync()
 			{
 				if (queued_sync_state != Handle_state::Queued_state::IDLE)
@@ -227,35 +580,274 @@ class Vfs::Fs_file_system : public File_system
 			}
 		};
 
+		/**
+		 * File handle that keeps reads in flight ahead of a sequential reader
+		 *
+		 * Each read is served from a window of read packets. When a read
+		 * continues where the previous one ended, the window is extended by
+		 * packets for the following file ranges so that the server can
+		 * process them while the reader consumes the data. A read at any
+		 * other offset discards the window.
+		 */
 		struct Fs_vfs_file_handle : Fs_vfs_handle
 		{
-			using Fs_vfs_handle::Fs_vfs_handle;
+			enum { MAX_READ_AHEAD = 8 };
+
+			struct Read_slot
+			{
+				::File_system::Packet_descriptor packet { };
+
+				file_size position = 0; /* file offset of the packet */
+				file_size size     = 0; /* number of requested bytes */
+				file_size consumed = 0; /* bytes returned to the reader */
+				bool      acked    = false;
+			};
+
+			enum { NUM_SLOTS = MAX_READ_AHEAD + 1 };
+
+			Read_slot _slots[NUM_SLOTS];
+			unsigned  _first = 0;
+			unsigned  _count = 0;
+
+			unsigned const _read_ahead;
+
+			/* offset where the previous read ended */
+			file_size _stream_offset = ~(file_size)0;
+			bool      _sequential    = false;
+
+			::File_system::Session::Tx::Source &_source() { return *_fs.tx(); }
+
+			Read_slot &_slot(unsigned i) { return _slots[(_first + i) % NUM_SLOTS]; }
+
+			bool _submit_read(file_size position, file_size size)
+			{
+				if (_count == NUM_SLOTS || !_source().ready_to_submit())
+					return false;
+
+				::File_system::Packet_descriptor p;
+				try {
+					p = _source().alloc_packet(size);
+				} catch (::File_system::Session::Tx::Source::Packet_alloc_failed) {
+					return false;
+				}
+
+				Read_slot &slot = _slot(_count++);
+				slot.packet   = ::File_system::Packet_descriptor(
+					p, file_handle(), ::File_system::Packet_descriptor::READ,
+					size, position);
+				slot.position = position;
+				slot.size     = size;
+				slot.consumed = 0;
+				slot.acked    = false;
+
+				_source().submit_packet(slot.packet);
+				return true;
+			}
+
+			void _retire_first()
+			{
+				Read_slot &slot = _slot(0);
+				if (slot.acked)
+					_source().release_packet(slot.packet);
+
+				/* a packet still in flight is released when acknowledged */
+				slot   = Read_slot();
+				_first = (_first + 1) % NUM_SLOTS;
+				_count--;
+			}
+
+			void _discard_window()
+			{
+				while (_count)
+					_retire_first();
+			}
+
+			/**
+			 * Submit read-ahead packets up to the configured depth
+			 *
+			 * The window occupies at most half of the packet buffer so
+			 * that other handles can still make progress.
+			 */
+			void _fill_window(file_size size)
+			{
+				file_size const max_bytes = _source().bulk_buffer_size() / 2;
+
+				file_size bytes = 0;
+				for (unsigned i = 0; i < _count; i++)
+					bytes += _slot(i).size;
+
+				while (_count < 1 + _read_ahead && bytes + size <= max_bytes) {
+
+					file_size const position = _count
+						? _slot(_count - 1).position + _slot(_count - 1).size
+						: _stream_offset;
+
+					if (!_submit_read(position, size))
+						return;
+
+					bytes += size;
+				}
+			}
+
+			Fs_vfs_file_handle(File_system &fs, Allocator &alloc,
+			                   int status_flags, Handle_space &space,
+			                   ::File_system::Node_handle node_handle,
+			                   ::File_system::Connection &fs_connection,
+			                   unsigned read_ahead)
+			:
+				Fs_vfs_handle(fs, alloc, status_flags, space, node_handle,
+				              fs_connection),
+				_read_ahead(Genode::min(read_ahead, (unsigned)MAX_READ_AHEAD))
+			{ }
+
+			~Fs_vfs_file_handle() { _discard_window(); }
 
 			bool queue_read(file_size count) override
 			{
-				return _queue_read(count, seek());
+				file_size const offset = seek();
+
+				if (_count && _slot(0).position + _slot(0).consumed != offset)
+					_discard_window();
+
+				_sequential = (offset == _stream_offset);
+
+				file_size const size =
+					min((file_size)_source().bulk_buffer_size() / 2, count);
+
+				if (!_count && !_submit_read(offset, size))
+					return false;
+
+				if (_sequential)
+					_fill_window(size);
+
+				read_ready_state = Fs_file_system::Handle_state::Read_ready_state::IDLE;
+				return true;
 			}
 
 			Read_result complete_read(char *dst, file_size count,
 			                          file_size &out_count) override
 			{
-				return _complete_read(dst, count, out_count);
+				if (!_count)
+					return READ_ERR_INVALID;
+
+				Read_slot &slot = _slot(0);
+				if (!slot.acked)
+					return READ_QUEUED;
+
+				file_size const length = slot.packet.length();
+				file_size const avail  = length > slot.consumed
+				                       ? length - slot.consumed : 0;
+				file_size const n      = min(avail, count);
+
+				memcpy(dst, _source().packet_content(slot.packet) + slot.consumed, n);
+
+				slot.consumed += n;
+				out_count      = n;
+				_stream_offset = slot.position + slot.consumed;
+
+				if (slot.consumed >= length) {
+
+					/* a short read hit the end of the file */
+					bool const end_of_file = length < slot.size;
+					file_size const size   = slot.size;
+
+					_retire_first();
+
+					if (end_of_file)
+						_discard_window();
+					else if (_sequential)
+						_fill_window(size);
+				}
+				return READ_OK;
+			}
+
+			bool read_acked(::File_system::Packet_descriptor const &packet) override
+			{
+				for (unsigned i = 0; i < _count; i++) {
+					Read_slot &slot = _slot(i);
+					if (slot.acked || slot.packet.offset() != packet.offset())
+						continue;
+
+					slot.packet = packet;
+					slot.acked  = true;
+					return true;
+				}
+				return false;
+			}
+
+			void invalidate_read_ahead() override
+			{
+				_discard_window();
+				_stream_offset = ~(file_size)0;
 			}
 		};
 
+		/**
+		 * Directory handle that fetches entries in batches
+		 *
+		 * A directory read requests as many entries as fit into a packet.
+		 * Subsequent reads of entries of the batch are served locally. The
+		 * batch is refetched when the reader starts over at its first entry,
+		 * e.g., after 'rewinddir'.
+		 */
 		struct Fs_vfs_dir_handle : Fs_vfs_handle
 		{
 			enum { DIRENT_SIZE = sizeof(::File_system::Directory_entry) };
 
+			enum { MAX_BATCH = 64 };
+
+			::File_system::Packet_descriptor _batch { };
+
+			bool      _batch_valid = false;
+			file_size _batch_index = 0; /* index of first entry of batch */
+			file_size _batch_count = 0; /* number of entries in batch */
+
+			/* index of the entry requested by the current read */
+			file_size _index = 0;
+
 			using Fs_vfs_handle::Fs_vfs_handle;
 
+			~Fs_vfs_dir_handle() { _release_batch(); }
+
+			void _release_batch()
+			{
+				if (_batch_valid)
+					_fs.tx()->release_packet(_batch);
+
+				_batch       = ::File_system::Packet_descriptor();
+				_batch_valid = false;
+			}
+
+			file_size _batch_entries()
+			{
+				file_size const bulk_entries =
+					_fs.tx()->bulk_buffer_size() / 4 / DIRENT_SIZE;
+
+				return Genode::max((file_size)1, min(bulk_entries, (file_size)MAX_BATCH));
+			}
+
+			bool _in_batch(file_size index) const
+			{
+				return _batch_valid && index >= _batch_index
+				                    && index <  _batch_index + _batch_count;
+			}
+
 			bool queue_read(file_size count) override
 			{
 				if (count < sizeof(Dirent))
 					return true;
 
-				return _queue_read(DIRENT_SIZE,
-				                   (seek() / sizeof(Dirent) * DIRENT_SIZE));
+				_index = seek() / sizeof(Dirent);
+
+				if (_in_batch(_index) && _index != _batch_index)
+					return true;
+
+				if (queued_read_state != Fs_file_system::Handle_state::Queued_state::IDLE)
+					return false;
+
+				_release_batch();
+
+				return _queue_read(_batch_entries()*DIRENT_SIZE, _index*DIRENT_SIZE);
 			}
 
 			Read_result complete_read(char *dst, file_size count,
@@ -266,24 +858,32 @@ class Vfs::Fs_file_system : public File_system
 
 				using ::File_system::Directory_entry;
 
-				Directory_entry entry;
-				file_size       entry_out_count;
+				if (!_batch_valid) {
+					if (queued_read_state != Fs_file_system::Handle_state::Queued_state::ACK)
+						return READ_QUEUED;
 
-				Read_result read_result =
-					_complete_read(&entry, DIRENT_SIZE, entry_out_count);
+					_batch       = queued_read_packet;
+					_batch_valid = true;
+					_batch_index = _index;
+					_batch_count = _batch.length() / DIRENT_SIZE;
 
-				if (read_result != READ_OK)
-					return read_result;
+					queued_read_state  = Fs_file_system::Handle_state::Queued_state::IDLE;
+					queued_read_packet = ::File_system::Packet_descriptor();
+				}
 
 				Dirent *dirent = (Dirent*)dst;
+				out_count = sizeof(Dirent);
 
-				if (entry_out_count < DIRENT_SIZE) {
+				if (!_in_batch(_index)) {
 					/* no entry found for the given index, or error */
 					*dirent = Dirent();
-					out_count = sizeof(Dirent);
 					return READ_OK;
 				}
 
+				Directory_entry const &entry =
+					((Directory_entry const *)_fs.tx()->packet_content(_batch))
+						[_index - _batch_index];
+
 				/*
 				 * The default value has no meaning because the switch below
 				 * assigns a value in each possible branch. But it is needed to
@@ -302,8 +902,6 @@ class Vfs::Fs_file_system : public File_system
 				dirent->type   = type;
 				strncpy(dirent->name, entry.name, sizeof(dirent->name));
 
-				out_count = sizeof(Dirent);
-
 				return READ_OK;
 			}
 		};
@@ -483,6 +1081,8 @@ class Vfs::Fs_file_system : public File_system
 
 				Handle_space::Id const id(packet.handle());
 
+				bool release = (packet.operation() == Packet_descriptor::WRITE);
+
 				auto handle_read = [&] (Fs_vfs_handle &handle) {
 
 					if (!packet.succeeded())
@@ -495,12 +1095,20 @@ class Vfs::Fs_file_system : public File_system
 						break;
 
 					case Packet_descriptor::READ:
-						handle.queued_read_packet = packet;
-						handle.queued_read_state  = Handle_state::Queued_state::ACK;
-						handle.io_progress_response();
+						if (handle.read_acked(packet))
+							handle.io_progress_response();
+						else
+							release = true;
 						break;
 
 					case Packet_descriptor::WRITE:
+
+						/* a status obtained while the write was in flight is stale */
+						{
+							Lock::Guard guard(_lock);
+							_invalidate_metadata(handle.path_hash);
+						}
+
 						/*
 						 * Notify anyone who might have failed on
 						 * 'alloc_packet()'
@@ -522,6 +1130,11 @@ class Vfs::Fs_file_system : public File_system
 
 				try {
 					if (packet.operation() == Packet_descriptor::CONTENT_CHANGED) {
+						::File_system::Watch_handle const watch { packet.handle().value };
+						if (_metadata_cache.constructed()
+						 && _metadata_cache->watch_triggered(watch))
+							continue;
+
 						_watch_handle_space.apply<Fs_vfs_watch_handle>(id, [&] (Fs_vfs_watch_handle &handle) {
 							handle.watch_response(); });
 					} else {
@@ -529,9 +1142,15 @@ class Vfs::Fs_file_system : public File_system
 					}
 				}
 				catch (Handle_space::Unknown_id) {
-					Genode::warning("ack for unknown File_system handle ", id); }
 
-				if (packet.operation() == Packet_descriptor::WRITE) {
+					/* read-ahead packets may outlive their handle */
+					if (packet.operation() == Packet_descriptor::READ)
+						release = true;
+					else
+						Genode::warning("ack for unknown File_system handle ", id);
+				}
+
+				if (release) {
 					Lock::Guard guard(_lock);
 					source.release_packet(packet);
 				}
@@ -559,6 +1178,49 @@ class Vfs::Fs_file_system : public File_system
 			return config.attribute_value("buffer_size", fs_default);
 		}
 
+		/* number of packets read ahead of a sequential reader */
+		unsigned const _read_ahead;
+
+		Genode::Constructible<Metadata_cache> _metadata_cache { };
+
+		void _invalidate_metadata(unsigned path_hash)
+		{
+			if (_metadata_cache.constructed() && path_hash)
+				_metadata_cache->invalidate(path_hash);
+		}
+
+		/**
+		 * Obtain status of node at 'path'
+		 *
+		 * \return false if there is no such node
+		 */
+		bool _node_status(char const *path, ::File_system::Status &status)
+		{
+			bool exists = false;
+
+			if (_metadata_cache.constructed()
+			 && _metadata_cache->lookup(path, status, exists))
+				return exists;
+
+			bool const cacheable = _metadata_cache.constructed()
+			                    && _metadata_cache->prepare_insert(path);
+
+			try {
+				::File_system::Node_handle node = _fs.node(path);
+				Fs_handle_guard node_guard(*this, _fs, node, _handle_space, _fs);
+				status = _fs.status(node);
+				exists = true;
+			}
+			catch (::File_system::Lookup_failed) { }
+			catch (::File_system::Invalid_name)  { }
+			catch (::File_system::Name_too_long) { }
+
+			if (cacheable)
+				_metadata_cache->insert(path, exists, status);
+
+			return exists;
+		}
+
 	public:
 
 		Fs_file_system(Vfs::Env &env, Genode::Xml_node config)
@@ -569,10 +1231,20 @@ class Vfs::Fs_file_system : public File_system
 			_fs(_env.env(), _fs_packet_alloc,
 			    _label.string(), _root.string(),
 			    config.attribute_value("writeable", true),
-			    buffer_size(config))
+			    buffer_size(config)),
+			_read_ahead(config.attribute_value("read_ahead", 4U))
 		{
 			_fs.sigh_ack_avail(_ack_handler);
 			_fs.sigh_ready_to_submit(_ready_handler);
+
+			unsigned const cache_entries =
+				config.attribute_value("metadata_cache", 0U);
+
+			if (cache_entries)
+				_metadata_cache.construct(
+					_env.env(), _env.alloc(), _fs, cache_entries,
+					config.attribute_value("metadata_max_age_ms", (Genode::uint64_t)1000),
+					config.attribute_value("verbose", false));
 		}
 
 		/*********************************
@@ -592,9 +1264,8 @@ class Vfs::Fs_file_system : public File_system
 			::File_system::Status status;
 
 			try {
-				::File_system::Node_handle node = _fs.node(path);
-				Fs_handle_guard node_guard(*this, _fs, node, _handle_space, _fs);
-				status = _fs.status(node);
+				if (!_node_status(path, status))
+					return STAT_ERR_NO_ENTRY;
 			}
 			catch (Genode::Out_of_ram)  {
 				Genode::error("out-of-ram during stat");
@@ -637,6 +1308,9 @@ class Vfs::Fs_file_system : public File_system
 				Fs_handle_guard dir_guard(*this, _fs, dir, _handle_space, _fs);
 
 				_fs.unlink(dir, file_name.base() + 1);
+
+				if (_metadata_cache.constructed())
+					_metadata_cache->invalidate_with_parent(path);
 			}
 			catch (::File_system::Invalid_handle)    { return UNLINK_ERR_NO_ENTRY;  }
 			catch (::File_system::Invalid_name)      { return UNLINK_ERR_NO_ENTRY;  }
@@ -679,6 +1353,13 @@ class Vfs::Fs_file_system : public File_system
 
 				_fs.move(from_dir, from_file_name.base() + 1,
 				         to_dir,   to_file_name.base() + 1);
+
+				if (_metadata_cache.constructed()) {
+					_metadata_cache->invalidate_subtree(from_path);
+					_metadata_cache->invalidate_subtree(to_path);
+					_metadata_cache->invalidate_with_parent(from_path);
+					_metadata_cache->invalidate_with_parent(to_path);
+				}
 			}
 			catch (::File_system::Lookup_failed) { return RENAME_ERR_NO_ENTRY; }
 			catch (...)                          { return RENAME_ERR_NO_PERM; }
@@ -692,13 +1373,9 @@ class Vfs::Fs_file_system : public File_system
 				path = "/";
 
 			try {
-				::File_system::Node_handle node = _fs.node(path);
-				Fs_handle_guard node_guard(*this, _fs, node,
-				                           _handle_space, _fs);
-
-				::File_system::Status status = _fs.status(node);
-
-				return status.size / sizeof(::File_system::Directory_entry);
+				::File_system::Status status;
+				if (_node_status(path, status))
+					return status.size / sizeof(::File_system::Directory_entry);
 			}
 			catch (...) { }
 			return 0;
@@ -707,12 +1384,9 @@ class Vfs::Fs_file_system : public File_system
 		bool directory(char const *path) override
 		{
 			try {
-				::File_system::Node_handle node = _fs.node(path);
-				Fs_handle_guard node_guard(*this, _fs, node, _handle_space, _fs);
-
-				::File_system::Status status = _fs.status(node);
-
-				return status.directory();
+				::File_system::Status status;
+				if (_node_status(path, status))
+					return status.directory();
 			}
 			catch (...) { }
 			return false;
@@ -720,6 +1394,12 @@ class Vfs::Fs_file_system : public File_system
 
 		char const *leaf_path(char const *path) override
 		{
+			if (_metadata_cache.constructed()) {
+				::File_system::Status status;
+				try { return _node_status(path, status) ? path : 0; }
+				catch (...) { return 0; }
+			}
+
 			/* check if node at path exists within file system */
 			try {
 				::File_system::Node_handle node = _fs.node(path);
@@ -760,8 +1440,22 @@ class Vfs::Fs_file_system : public File_system
 				                                           file_name.base() + 1,
 				                                           mode, create);
 
-				*out_handle = new (alloc)
-					Fs_vfs_file_handle(*this, alloc, vfs_mode, _handle_space, file, _fs);
+				Fs_vfs_file_handle &handle = *new (alloc)
+					Fs_vfs_file_handle(*this, alloc, vfs_mode, _handle_space,
+					                   file, _fs, _read_ahead);
+
+				if (_metadata_cache.constructed()) {
+					if (create)
+						_metadata_cache->invalidate_with_parent(path);
+
+					if (mode == ::File_system::WRITE_ONLY
+					 || mode == ::File_system::READ_WRITE) {
+						handle.path_hash = Metadata_cache::hash(path);
+						_invalidate_metadata(handle.path_hash);
+					}
+				}
+
+				*out_handle = &handle;
 			}
 			catch (::File_system::Lookup_failed)       { return OPEN_ERR_UNACCESSIBLE;  }
 			catch (::File_system::Permission_denied)   { return OPEN_ERR_NO_PERM;       }
@@ -790,6 +1484,9 @@ class Vfs::Fs_file_system : public File_system
 				*out_handle = new (alloc)
 					Fs_vfs_dir_handle(*this, alloc, ::File_system::READ_ONLY,
 					                  _handle_space, dir, _fs);
+
+				if (create && _metadata_cache.constructed())
+					_metadata_cache->invalidate_with_parent(path);
 			}
 			catch (::File_system::Lookup_failed)       { return OPENDIR_ERR_LOOKUP_FAILED;       }
 			catch (::File_system::Name_too_long)       { return OPENDIR_ERR_NAME_TOO_LONG;       }
@@ -826,11 +1523,18 @@ class Vfs::Fs_file_system : public File_system
 				::File_system::Symlink_handle symlink_handle =
 				    _fs.symlink(dir_handle, symlink_name.base() + 1, create);
 
-				*out_handle = new (alloc)
+				Fs_vfs_symlink_handle &handle = *new (alloc)
 					Fs_vfs_symlink_handle(*this, alloc,
 					                      ::File_system::READ_ONLY,
 					                      _handle_space, symlink_handle, _fs);
 
+				if (create && _metadata_cache.constructed()) {
+					handle.path_hash = Metadata_cache::hash(path);
+					_metadata_cache->invalidate_with_parent(path);
+				}
+
+				*out_handle = &handle;
+
 				return OPENLINK_OK;
 			}
 			catch (::File_system::Invalid_handle)      { return OPENLINK_ERR_LOOKUP_FAILED; }
@@ -853,6 +1557,7 @@ class Vfs::Fs_file_system : public File_system
 				_congested_handles.remove(*fs_handle);
 
 			_fs.close(fs_handle->file_handle());
+			_invalidate_metadata(fs_handle->path_hash);
 			destroy(fs_handle->alloc(), fs_handle);
 		}
 
@@ -912,7 +1617,12 @@ class Vfs::Fs_file_system : public File_system
 
 			Fs_vfs_handle &handle = static_cast<Fs_vfs_handle &>(*vfs_handle);
 
+			handle.invalidate_read_ahead();
+
 			out_count = _write(handle, buf, buf_size, handle.seek());
+
+			/* the status changes once the server processed the write */
+			_invalidate_metadata(handle.path_hash);
 			return WRITE_OK;
 		}
 
@@ -981,7 +1691,13 @@ class Vfs::Fs_file_system : public File_system
 
 		Ftruncate_result ftruncate(Vfs_handle *vfs_handle, file_size len) override
 		{
-			Fs_vfs_handle const *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+
+			{
+				Lock::Guard guard(_lock);
+				handle->invalidate_read_ahead();
+				_invalidate_metadata(handle->path_hash);
+			}
 
 			try {
 				_fs.truncate(handle->file_handle(), len);
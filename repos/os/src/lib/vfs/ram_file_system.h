@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2015-2018 Genode Labs GmbH
+ * Copyright (C) 2015-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -14,9 +14,11 @@
 #ifndef _INCLUDE__VFS__RAM_FILE_SYSTEM_H_
 #define _INCLUDE__VFS__RAM_FILE_SYSTEM_H_
 
-#include <ram_fs/chunk.h>
+#include <ram_fs/extent.h>
 #include <ram_fs/param.h>
 #include <vfs/file_system.h>
+#include <base/attached_ram_dataspace.h>
+#include <base/registry.h>
 #include <dataspace/client.h>
 #include <util/avl_tree.h>
 
@@ -27,8 +29,7 @@ namespace Vfs_ram {
 	using namespace Genode;
 	using namespace Vfs;
 	using namespace Ram_fs;
-	using File_system::Chunk;
-	using File_system::Chunk_index;
+	using File_system::Extent_store;
 
 	struct Io_handle;
 	struct Watch_handle;
@@ -37,11 +38,14 @@ namespace Vfs_ram {
 	class File;
 	class Symlink;
 	class Directory;
+	class Export;
 
 	enum { MAX_NAME_LEN = 128 };
 
 	typedef Genode::Allocator::Out_of_memory Out_of_memory;
 
+	typedef Genode::Registry<Export> Exports;
+
 	/**
 	 * Return base-name portion of null-terminated path string
 	 */
@@ -232,53 +236,122 @@ class Vfs_ram::Node : private Genode::Avl_node<Node>, private Genode::Lock
 };
 
 
-class Vfs_ram::File : public Vfs_ram::Node
+/**
+ * Dataspace holding the content of a file handed out via 'dataspace'
+ *
+ * While the file is not modified, the dataspace is the storage of the file
+ * and is shared by all users. On the first modification, the file takes a
+ * private copy of its content and drops its reference. The dataspace is
+ * freed when the last user released it.
+ */
+class Vfs_ram::Export : Genode::Noncopyable
 {
 	private:
 
-		typedef Chunk      <num_level_3_entries()>                Chunk_level_3;
-		typedef Chunk_index<num_level_2_entries(), Chunk_level_3> Chunk_level_2;
-		typedef Chunk_index<num_level_1_entries(), Chunk_level_2> Chunk_level_1;
-		typedef Chunk_index<num_level_0_entries(), Chunk_level_1> Chunk_level_0;
+		Allocator &_alloc;
+
+		Exports::Element _element;
 
-		Chunk_level_0 _chunk;
-		file_size     _length = 0;
+		Attached_ram_dataspace _ds;
+
+		/* references of the file and of the users of the dataspace */
+		unsigned _refs = 1;
+
+		static Lock &_lock()
+		{
+			static Lock lock;
+			return lock;
+		}
 
 	public:
 
-		File(char const *name, Allocator &alloc)
-		: Node(name), _chunk(alloc, 0) { }
+		Export(Exports &exports, Allocator &alloc, Ram_allocator &ram,
+		       Region_map &rm, size_t size)
+		:
+			_alloc(alloc), _element(exports, *this), _ds(ram, rm, size)
+		{ }
 
-		size_t read(char *dst, size_t len, file_size seek_offset) override
+		char *local_addr() { return _ds.local_addr<char>(); }
+
+		Dataspace_capability cap() const { return _ds.cap(); }
+
+		void acquire()
 		{
-			file_size const chunk_used_size = _chunk.used_size();
+			Lock::Guard guard(_lock());
+			_refs++;
+		}
 
-			if (seek_offset >= _length)
-				return 0;
+		static void release(Export &e)
+		{
+			bool unused = false;
+			{
+				Lock::Guard guard(_lock());
+				unused = (--e._refs == 0);
+			}
 
-			/*
-			 * Constrain read transaction to available chunk data
-			 *
-			 * Note that 'chunk_used_size' may be lower than '_length'
-			 * because 'Chunk' may have truncated tailing zeros.
-			 */
-			if (seek_offset + len >= _length)
-				len = _length - seek_offset;
+			if (unused)
+				destroy(e._alloc, &e);
+		}
+};
+
+
+class Vfs_ram::File : public Vfs_ram::Node
+{
+	private:
 
-			file_size read_len = len;
+		/*
+		 * Noncopyable
+		 */
+		File(File const &);
+		File &operator = (File const &);
+
+		Extent_store<min_extent_size(), max_extent_size()> _extents;
+
+		file_size _length = 0;
 
-			if (seek_offset + read_len > chunk_used_size) {
-				if (chunk_used_size >= seek_offset)
-					read_len = chunk_used_size - seek_offset;
-				else
-					read_len = 0;
+		/* exported dataspace holding the content instead of '_extents' */
+		Export *_export = nullptr;
+
+		/**
+		 * Move the first 'len' bytes of the exported content to '_extents'
+		 *
+		 * \return false if the file is out of memory
+		 */
+		bool _unshare(file_size len)
+		{
+			if (!_export)
+				return true;
+
+			len = min(len, _length);
+			if (_extents.write(_export->local_addr(), (size_t)len, 0) < len) {
+				_extents.truncate(0);
+				return false;
 			}
 
-			_chunk.read(dst, read_len, seek_offset);
+			Export::release(*_export);
+			_export = nullptr;
+			return true;
+		}
+
+	public:
+
+		File(char const *name, Allocator &alloc)
+		: Node(name), _extents(alloc) { }
+
+		~File() { _unshare(0); }
+
+		size_t read(char *dst, size_t len, file_size seek_offset) override
+		{
+			if (seek_offset >= _length)
+				return 0;
+
+			len = (size_t)min((file_size)len, _length - seek_offset);
 
-			/* add zero padding if needed */
-			if (read_len < len)
-				memset(dst + read_len, 0, len - read_len);
+			if (_export)
+				memcpy(dst, _export->local_addr() + seek_offset, len);
+			else
+				/* regions without extents are read as zeros */
+				_extents.read(dst, len, seek_offset);
 
 			return len;
 		}
@@ -295,20 +368,19 @@ class Vfs_ram::File : public Vfs_ram::Node
 		size_t write(char const *src, size_t len, file_size seek_offset) override
 		{
 			if (seek_offset == (file_size)(~0))
-				seek_offset = _chunk.used_size();
+				seek_offset = _length;
 
-			if (seek_offset + len >= Chunk_level_0::SIZE)
-				len = Chunk_level_0::SIZE - (seek_offset + len);
+			if (!_unshare(_length))
+				return 0;
 
-			try { _chunk.write(src, len, (size_t)seek_offset); }
-			catch (Out_of_memory) { return 0; }
+			len = _extents.write(src, len, seek_offset);
 
 			/*
-			 * Keep track of file length. We cannot use 'chunk.used_size()'
-			 * as file length because trailing zeros may by represented
-			 * by zero chunks, which do not contribute to 'used_size()'.
+			 * Keep track of file length. We cannot use 'used_size()' as
+			 * file length because the file may have a sparse tail.
 			 */
-			_length = max(_length, seek_offset + len);
+			if (len)
+				_length = max(_length, seek_offset + len);
 
 			return len;
 		}
@@ -317,11 +389,35 @@ class Vfs_ram::File : public Vfs_ram::Node
 
 		void truncate(file_size size) override
 		{
-			if (size < _chunk.used_size())
-				_chunk.truncate(size);
+			if (!_unshare(size))
+				throw Out_of_memory();
+
+			_extents.truncate(size);
 
 			_length = size;
 		}
+
+		/**
+		 * Return dataspace with the file content
+		 *
+		 * On the first call, the content is moved to a new dataspace.
+		 * Further calls return the same dataspace until the file is
+		 * modified. Each call must be paired with a call of 'Export::release'.
+		 */
+		Export &export_content(Exports &exports, Allocator &alloc,
+		                       Ram_allocator &ram, Region_map &rm)
+		{
+			if (!_export) {
+				Export *e = new (alloc) Export(exports, alloc, ram, rm, (size_t)_length);
+
+				_extents.read(e->local_addr(), (size_t)_length, 0);
+				_extents.truncate(0);
+				_export = e;
+			}
+
+			_export->acquire();
+			return *_export;
+		}
 };
 
 
@@ -481,6 +577,7 @@ class Vfs::Ram_file_system : public Vfs::File_system
 		friend class Genode::List<Vfs_ram::Watch_handle>;
 
 		Vfs::Env           &_env;
+		Vfs_ram::Exports    _exports { };
 		Vfs_ram::Directory  _root = { "" };
 
 		Vfs_ram::Node *lookup(char const *path, bool return_parent = false)
@@ -547,7 +644,21 @@ class Vfs::Ram_file_system : public Vfs::File_system
 
 		Ram_file_system(Vfs::Env &env, Genode::Xml_node) : _env(env) { }
 
-		~Ram_file_system() { _root.empty(_env.alloc()); }
+		~Ram_file_system()
+		{
+			_root.empty(_env.alloc());
+
+			/* free dataspaces that were not released by their users */
+			for (;;) {
+				Vfs_ram::Export *export_ptr = nullptr;
+				_exports.for_each([&] (Vfs_ram::Export &e) { export_ptr = &e; });
+
+				if (!export_ptr)
+					break;
+
+				destroy(_env.alloc(), export_ptr);
+			}
+		}
 
 
 		/*********************************
@@ -876,36 +987,34 @@ class Vfs::Ram_file_system : public Vfs::File_system
 		{
 			using namespace Vfs_ram;
 
-			Ram_dataspace_capability ds_cap;
-
 			Node *node = lookup(path);
-			if (!node) return ds_cap;
+			if (!node) return Dataspace_capability();
 			Node::Guard guard(node);
 
 			File *file = dynamic_cast<File *>(node);
-			if (!file) return ds_cap;
-
-			size_t len = file->length();
+			if (!file || !file->length()) return Dataspace_capability();
 
-			char *local_addr = nullptr;
 			try {
-				ds_cap = _env.env().ram().alloc(len);
-
-				local_addr = _env.env().rm().attach(ds_cap);
-				file->read(local_addr, file->length(), 0);
-				_env.env().rm().detach(local_addr);
-
-			} catch(...) {
-				_env.env().rm().detach(local_addr);
-				_env.env().ram().free(ds_cap);
-				return Dataspace_capability();
+				return file->export_content(_exports, _env.alloc(),
+				                            _env.env().ram(),
+				                            _env.env().rm()).cap();
 			}
-			return ds_cap;
+			catch (Genode::Out_of_ram)  { }
+			catch (Genode::Out_of_caps) { }
+
+			return Dataspace_capability();
 		}
 
-		void release(char const *, Dataspace_capability ds_cap) override {
-			_env.env().ram().free(
-				static_cap_cast<Genode::Ram_dataspace>(ds_cap)); }
+		void release(char const *, Dataspace_capability ds_cap) override
+		{
+			Vfs_ram::Export *export_ptr = nullptr;
+			_exports.for_each([&] (Vfs_ram::Export &e) {
+				if (e.cap() == ds_cap)
+					export_ptr = &e; });
+
+			if (export_ptr)
+				Vfs_ram::Export::release(*export_ptr);
+		}
 
 
 		Watch_result watch(char const      *path,
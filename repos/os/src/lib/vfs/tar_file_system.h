@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2011-2017 Genode Labs GmbH
+ * Copyright (C) 2011-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -200,7 +200,9 @@ class Vfs::Tar_file_system : public File_system
 
 			file_offset index = seek() / sizeof(Dirent);
 
-			Node const *node = _node->lookup_child(index);
+			Tar_file_system &tar_fs = static_cast<Tar_file_system&>(fs());
+
+			Node const *node = tar_fs._dirent(*_node, index);
 
 			if (!node)
 				return READ_OK;
@@ -210,7 +212,6 @@ class Vfs::Tar_file_system : public File_system
 			Record const *record = node->record;
 
 			while (record && (record->type() == Record::TYPE_HARDLINK)) {
-				Tar_file_system &tar_fs = static_cast<Tar_file_system&>(fs());
 				Node const *target = tar_fs.dereference(record->linked_name());
 				record = target ? target->record : 0;
 			}
@@ -274,67 +275,204 @@ class Vfs::Tar_file_system : public File_system
 
 	struct Node : List<Node>, List<Node>::Element
 	{
-		char const *name;
+		/*
+		 * Noncopyable
+		 */
+		Node(Node const &);
+		Node &operator = (Node const &);
+
+		char   const *name;
 		Record const *record;
+		Node   const *parent;
+
+		unsigned const hash;
+
+		Node *hash_next { nullptr };
+
+		unsigned num_children { 0 };
 
-		Node(char const *name, Record const *record) : name(name), record(record) { }
+		/*
+		 * Children in directory-entry order, created on the first
+		 * directory read so that directories never listed cost no memory
+		 */
+		mutable Node const **dirents { nullptr };
 
-		Node *lookup(char const *name)
+		Node(char const *name, Record const *record, Node const *parent)
+		:
+			name(name), record(record), parent(parent),
+			hash(hash_value(parent, name, strlen(name)))
+		{ }
+
+		/**
+		 * Return hash of the directory entry 'name' of 'parent'
+		 */
+		static unsigned hash_value(Node const *parent, char const *name,
+		                           Genode::size_t len)
 		{
-			Absolute_path lookup_path(name);
+			/* FNV-1a, seeded with the parent node */
+			unsigned h = 2166136261u ^ (unsigned)((Genode::addr_t)parent >> 4);
+			for (Genode::size_t i = 0; i < len; i++)
+				h = (h ^ (unsigned char)name[i])*16777619u;
+			return h;
+		}
+
+		void insert_child(Node &child)
+		{
+			insert(&child);
+			num_children++;
+		}
+	};
 
-			Node *parent_node = this;
-			Node *child_node;
 
-			Path_element_token t(lookup_path.base());
+	/**
+	 * Hash table of all nodes keyed by parent node and name
+	 */
+	class Node_index
+	{
+		private:
 
-			while (t) {
+			/*
+			 * Noncopyable
+			 */
+			Node_index(Node_index const &);
+			Node_index &operator = (Node_index const &);
 
-				if (t.type() != Path_element_token::IDENT) {
-						t = t.next();
-						continue;
-				}
+			enum { INITIAL_NUM_BUCKETS = 256 };
 
-				char path_element[MAX_PATH_LEN];
+			Genode::Allocator &_alloc;
+
+			unsigned _num_buckets = INITIAL_NUM_BUCKETS;
+			unsigned _num_nodes   = 0;
+
+			Node **_buckets = _alloc_buckets(_num_buckets);
 
-				t.string(path_element, sizeof(path_element));
+			Node **_alloc_buckets(unsigned num)
+			{
+				Node **buckets = (Node **)_alloc.alloc(num*sizeof(Node *));
+				for (unsigned i = 0; i < num; i++)
+					buckets[i] = nullptr;
+				return buckets;
+			}
 
-				for (child_node = parent_node->first(); child_node; child_node = child_node->next()) {
-					if (strcmp(child_node->name, path_element) == 0) {
-						parent_node = child_node;
-						break;
+			/**
+			 * Double the number of buckets to keep chains short
+			 */
+			void _grow()
+			{
+				unsigned const num     = _num_buckets*2;
+				Node         **buckets = _alloc_buckets(num);
+
+				for (unsigned i = 0; i < _num_buckets; i++) {
+					while (Node *node = _buckets[i]) {
+						_buckets[i] = node->hash_next;
+						node->hash_next = buckets[node->hash & (num - 1)];
+						buckets[node->hash & (num - 1)] = node;
 					}
 				}
 
-				if (!child_node)
-					return 0;
+				_alloc.free(_buckets, _num_buckets*sizeof(Node *));
+				_buckets     = buckets;
+				_num_buckets = num;
+			}
+
+		public:
+
+			Node_index(Genode::Allocator &alloc) : _alloc(alloc) { }
 
-				t = t.next();
+			void insert(Node &node)
+			{
+				if (_num_nodes >= _num_buckets)
+					_grow();
+
+				Node *&bucket = _buckets[node.hash & (_num_buckets - 1)];
+				node.hash_next = bucket;
+				bucket = &node;
+				_num_nodes++;
 			}
 
-			return parent_node;
-		}
+			/**
+			 * Look up child of 'parent' named by the first 'len' characters
+			 * of 'name'
+			 */
+			Node *lookup(Node const &parent, char const *name,
+			             Genode::size_t len) const
+			{
+				unsigned const hash = Node::hash_value(&parent, name, len);
 
+				for (Node *node = _buckets[hash & (_num_buckets - 1)];
+				     node; node = node->hash_next) {
 
-		Node const *lookup_child(int index) const
-		{
-			for (Node const *child_node = first(); child_node; child_node = child_node->next(), index--) {
-				if (index == 0)
-					return child_node;
+					if (node->hash == hash && node->parent == &parent
+					 && strcmp(node->name, name, len) == 0
+					 && node->name[len] == 0)
+						return node;
+				}
+				return nullptr;
 			}
+	};
 
-			return 0;
-		}
+	Node_index _index { _alloc };
 
+	Node _root_node { "", nullptr, nullptr };
 
-		file_size num_dirent()
-		{
-			file_size count = 0;
-			for (Node *child_node = first(); child_node; child_node = child_node->next(), count++) ;
-			return count;
+	Lock _dirents_lock { };
+
+	/**
+	 * Look up node by path
+	 */
+	Node *_lookup(char const *path)
+	{
+		Absolute_path lookup_path(path);
+
+		Node *node = &_root_node;
+
+		for (Path_element_token t(lookup_path.base()); t; t = t.next()) {
+
+			if (t.type() != Path_element_token::IDENT)
+				continue;
+
+			node = _index.lookup(*node, t.start(), t.len());
+			if (!node)
+				return nullptr;
 		}
+		return node;
+	}
+
+	/**
+	 * Return directory entry of 'dir' at 'index'
+	 */
+	Node const *_dirent(Node const &dir, file_offset index)
+	{
+		if (index >= dir.num_children)
+			return nullptr;
+
+		Lock::Guard guard(_dirents_lock);
+
+		if (!dir.dirents) {
 
-	} _root_node;
+			Node const **dirents = nullptr;
+			try {
+				dirents = (Node const **)
+					_alloc.alloc(dir.num_children*sizeof(Node *)); }
+			catch (Genode::Out_of_ram)  { }
+			catch (Genode::Out_of_caps) { }
+
+			if (!dirents) {
+
+				/* fall back to walking the list of children */
+				Node const *child = dir.first();
+				for (; child && index; child = child->next(), index--);
+				return child;
+			}
+
+			unsigned i = 0;
+			for (Node const *child = dir.first(); child; child = child->next())
+				dirents[i++] = child;
+
+			dir.dirents = dirents;
+		}
+		return dir.dirents[index];
+	}
 
 
 	/*
@@ -346,13 +484,15 @@ class Vfs::Tar_file_system : public File_system
 
 			Genode::Allocator &_alloc;
 
-			Node &_root_node;
+			Node_index &_index;
+			Node       &_root_node;
 
 		public:
 
 			Add_node_action(Genode::Allocator &alloc,
+			                Node_index        &index,
 			                Node              &root_node)
-			: _alloc(alloc), _root_node(root_node) { }
+			: _alloc(alloc), _index(index), _root_node(root_node) { }
 
 			void operator()(Record const *record)
 			{
@@ -383,44 +523,41 @@ class Vfs::Tar_file_system : public File_system
 							continue;
 					}
 
-					Absolute_path remaining_path(t.start());
+					Path_element_token next = t.next();
+					while (next && next.type() != Path_element_token::IDENT)
+						next = next.next();
 
-					t.string(path_element, sizeof(path_element));
+					bool const last_element = !next;
 
-					for (child_node = parent_node->first(); child_node; child_node = child_node->next()) {
-						if (strcmp(child_node->name, path_element) == 0)
-							break;
-					}
+					child_node = _index.lookup(*parent_node, t.start(), t.len());
 
 					if (child_node) {
 
-						if (remaining_path.has_single_element()) {
+						if (last_element) {
 							/* Found a node for the record to be inserted.
 							 * This is usually a directory node without
 							 * record. */
 							child_node->record = record;
 						}
 					} else {
-						if (remaining_path.has_single_element()) {
-
-							/*
-							 * TODO: find 'path_element' in 'record->name'
-							 * and use the location in the record as name
-							 * pointer to save some memory
-							 */
-							Genode::size_t name_size = strlen(path_element) + 1;
-							char *name = (char*)_alloc.alloc(name_size);
-							strncpy(name, path_element, name_size);
-							child_node = new (_alloc) Node(name, record);
-						} else {
-
-							/* create a directory node without record */
-							Genode::size_t name_size = strlen(path_element) + 1;
-							char *name = (char*)_alloc.alloc(name_size);
-							strncpy(name, path_element, name_size);
-							child_node = new (_alloc) Node(name, 0);
-						}
-						parent_node->insert(child_node);
+
+						t.string(path_element, sizeof(path_element));
+
+						/*
+						 * TODO: find 'path_element' in 'record->name'
+						 * and use the location in the record as name
+						 * pointer to save some memory
+						 */
+						Genode::size_t name_size = strlen(path_element) + 1;
+						char *name = (char*)_alloc.alloc(name_size);
+						strncpy(name, path_element, name_size);
+
+						/* intermediate directories are created without record */
+						child_node = new (_alloc)
+							Node(name, last_element ? record : nullptr, parent_node);
+
+						parent_node->insert_child(*child_node);
+						_index.insert(*child_node);
 					}
 
 					parent_node = child_node;
@@ -463,40 +600,13 @@ class Vfs::Tar_file_system : public File_system
 	}
 
 
-	struct Num_dirent_cache
-	{
-		Lock             lock { };
-		Node            &root_node;
-		bool             valid;              /* true after first lookup */
-		char             key[256];           /* key used for lookup */
-		file_size        cached_num_dirent;  /* cached value */
-
-		Num_dirent_cache(Node &root_node)
-		: root_node(root_node), valid(false), cached_num_dirent(0) { }
-
-		file_size num_dirent(char const *path)
-		{
-			Lock::Guard guard(lock);
-
-			/* check for cache miss */
-			if (!valid || strcmp(path, key) != 0) {
-				Node *node = root_node.lookup(path);
-				if (!node)
-					return 0;
-				strncpy(key, path, sizeof(key));
-				cached_num_dirent = node->num_dirent();
-				valid = true;
-			}
-			return cached_num_dirent;
-		}
-	} _cached_num_dirent;
 
 	/**
 	 * Walk hardlinks until we reach a file
 	 */
 	Node const *dereference(char const *path)
 	{
-		Node const *node = _root_node.lookup(path);
+		Node const *node = _lookup(path);
 		Node const *slow_node = node;
 		int i = 0;
 		while (node) {
@@ -510,9 +620,9 @@ class Vfs::Tar_file_system : public File_system
 			 * loop then eventually we catch it as the faster
 			 * laps the slower.
 			 */
-			node = _root_node.lookup(record->linked_name());
+			node = _lookup(record->linked_name());
 			if (i++ & 1) {
-				slow_node = _root_node.lookup(slow_node->record->linked_name());
+				slow_node = _lookup(slow_node->record->linked_name());
 				if (node == slow_node) {
 					Genode::error(_rom_name, " contains a hard-link loop at '", path, "'");
 					node = nullptr;
@@ -527,14 +637,12 @@ class Vfs::Tar_file_system : public File_system
 		Tar_file_system(Vfs::Env &env, Genode::Xml_node config)
 		:
 			_env(env.env()), _alloc(env.alloc()),
-			_rom_name(config.attribute_value("name", Rom_name())),
-			_root_node("", 0),
-			_cached_num_dirent(_root_node)
+			_rom_name(config.attribute_value("name", Rom_name()))
 		{
 			Genode::log("tar archive '", _rom_name, "' "
 			            "local at ", (void *)_tar_base, ", size is ", _tar_size);
 
-			_for_each_tar_record_do(Add_node_action(_alloc, _root_node));
+			_for_each_tar_record_do(Add_node_action(_alloc, _index, _root_node));
 		}
 
 		/*********************************
@@ -620,14 +728,15 @@ class Vfs::Tar_file_system : public File_system
 
 		Rename_result rename(char const *from, char const *to) override
 		{
-			if (_root_node.lookup(from) || _root_node.lookup(to))
+			if (_lookup(from) || _lookup(to))
 				return RENAME_ERR_NO_PERM;
 			return RENAME_ERR_NO_ENTRY;
 		}
 
 		file_size num_dirent(char const *path) override
 		{
-			return _cached_num_dirent.num_dirent(path);
+			Node const *node = _lookup(path);
+			return node ? node->num_children : 0;
 		}
 
 		bool directory(char const *path) override
@@ -649,7 +758,7 @@ class Vfs::Tar_file_system : public File_system
 			 * case, return the whole path, which is relative to the root
 			 * of this file system.
 			 */
-			Node *node = _root_node.lookup(path);
+			Node *node = _lookup(path);
 			return node ? path : 0;
 		}
 
@@ -0,0 +1,178 @@
+/*
+ * \brief  Adaptive replacement cache strategy
+ * \author Genode Labs
+ * \date   2019-10-10
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include "arc.h"
+#include "driver.h"
+
+typedef Driver<Arc_policy>::Chunk_level_4 Chunk;
+
+/*
+ * Accesses to a chunk within this number of chunk accesses are regarded as
+ * correlated, e.g., reading the blocks of a chunk one after another, and do
+ * not count as re-use.
+ */
+enum { CORRELATED_ACCESSES = 64 };
+
+static Cache::Policy_list t1;         /* chunks accessed once */
+static Cache::Policy_list t2;         /* chunks accessed repeatedly */
+static Cache::Ghost_list  b1;         /* chunks evicted from 't1' */
+static Cache::Ghost_list  b2;         /* chunks evicted from 't2' */
+static Cache::size_t      capacity = ~0ULL;
+static Cache::size_t      target_t1;  /* adaptive target size of 't1' */
+static unsigned long      access_clock;
+
+
+static Chunk &chunk(Cache::Policy_element &e) {
+	return static_cast<Chunk &>(static_cast<Arc_policy::Element &>(e)); }
+
+
+static void access(const Arc_policy::Element *e)
+{
+	Arc_policy::Element &elem = *const_cast<Arc_policy::Element *>(e);
+
+	if (!elem.list()) {
+		Arc_policy::insert(e);
+		return;
+	}
+
+	unsigned long const last_access = elem.last_access;
+	elem.last_access = ++access_clock;
+
+	if (elem.list() == &t2) {
+		t2.move_to_head(elem);
+		return;
+	}
+
+	if (access_clock - last_access > CORRELATED_ACCESSES) {
+		t1.remove(elem);
+		t2.insert_head(elem);
+	}
+}
+
+
+/**
+ * Evict least-recently-used chunk of 'list' that can be freed
+ */
+static bool evict_from(Cache::Policy_list &list, Cache::Ghost_list &ghosts)
+{
+	for (Cache::Policy_element *e = list.tail(); e; e = e->prev()) {
+
+		Chunk &c = chunk(*e);
+		if (!Driver<Arc_policy>::write_back(c))
+			continue;
+
+		list.remove(c);
+		ghosts.insert_head(c.base_offset());
+		if (ghosts.count() > capacity)
+			ghosts.remove_tail();
+
+		c.free(Driver<Arc_policy>::CACHE_BLK_SIZE, c.base_offset());
+		return true;
+	}
+	return false;
+}
+
+
+static bool evict_one()
+{
+	bool const prefer_t1 = t1.count() && (t1.count() > target_t1 || !t2.count());
+
+	if (prefer_t1)
+		return evict_from(t1, b1) || evict_from(t2, b2);
+
+	return evict_from(t2, b2) || evict_from(t1, b1);
+}
+
+
+static Cache::size_t evict(Cache::size_t count)
+{
+	Cache::size_t freed = 0;
+	for (; freed < count && evict_one(); freed++);
+	return freed;
+}
+
+
+void Arc_policy::init(Genode::Allocator &alloc, Cache::size_t chunks)
+{
+	capacity  = chunks;
+	target_t1 = 0;
+	b1.init(alloc, chunks);
+	b2.init(alloc, chunks);
+}
+
+
+void Arc_policy::insert(const Arc_policy::Element *e)
+{
+	Arc_policy::Element &elem = *const_cast<Arc_policy::Element *>(e);
+
+	if (elem.list()) {
+		access(e);
+		return;
+	}
+
+	elem.last_access = ++access_clock;
+
+	Cache::offset_t const off = chunk(elem).base_offset();
+
+	/* hit in history of 't1', favor recency */
+	Cache::size_t const b1_count = b1.count(), b2_count = b2.count();
+	if (b1.remove(off)) {
+		Cache::size_t const delta = b1_count >= b2_count ? 1 : b2_count / b1_count;
+		target_t1 = Genode::min(target_t1 + delta, capacity);
+		t2.insert_head(elem);
+		return;
+	}
+
+	/* hit in history of 't2', favor frequency */
+	if (b2.remove(off)) {
+		Cache::size_t const delta = b2_count >= b1_count ? 1 : b1_count / b2_count;
+		target_t1 = target_t1 > delta ? target_t1 - delta : 0;
+		t2.insert_head(elem);
+		return;
+	}
+
+	/* bound the history to the cache size */
+	if (t1.count() + b1.count() >= capacity)
+		b1.remove_tail();
+	else if (t1.count() + t2.count() + b1.count() + b2.count() >= 2*capacity)
+		b2.remove_tail();
+
+	t1.insert_head(elem);
+}
+
+
+void Arc_policy::read(const Arc_policy::Element  *e) {
+	access(e); }
+
+
+void Arc_policy::write(const Arc_policy::Element *e) {
+	access(e); }
+
+
+void Arc_policy::make_room(Cache::size_t chunks)
+{
+	Cache::size_t const resident = t1.count() + t2.count();
+
+	if (resident + chunks > capacity)
+		evict(resident + chunks - capacity);
+}
+
+
+void Arc_policy::flush(Cache::size_t size)
+{
+	Cache::size_t const chunks = size ? (size + sizeof(Chunk) - 1) / sizeof(Chunk)
+	                                  : ~0ULL;
+
+	if (evict(chunks) * sizeof(Chunk) < size)
+		throw Block::Driver::Request_congestion();
+}
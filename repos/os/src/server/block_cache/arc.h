@@ -0,0 +1,38 @@
+/*
+ * \brief  Adaptive replacement cache strategy
+ * \author Genode Labs
+ * \date   2019-10-10
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _ARC_H_
+#define _ARC_H_
+
+#include "policy.h"
+
+/**
+ * ARC strategy after Megiddo and Modha
+ *
+ * The cache is split into chunks accessed once recently and chunks accessed
+ * at least twice. The target size of both parts adapts to the workload by
+ * remembering the offsets of recently evicted chunks of each part.
+ */
+struct Arc_policy
+{
+	class Element : public Cache::Policy_element {};
+
+	static void init(Genode::Allocator &alloc, Cache::size_t capacity);
+	static void insert(const Element *e);
+	static void read(const Element  *e);
+	static void write(const Element *e);
+	static void make_room(Cache::size_t chunks);
+	static void flush(Cache::size_t size = 0);
+};
+
+#endif /* _ARC_H_ */
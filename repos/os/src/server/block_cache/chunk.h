@@ -8,7 +8,7 @@
  */
 
 /*
- * Copyright (C) 2014-2017 Genode Labs GmbH
+ * Copyright (C) 2014-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -118,7 +118,8 @@ namespace Cache {
 		private:
 
 			char        _data[CHUNK_SIZE];
-			unsigned    _writes;
+			bool        _valid;   /* content read from or written by client */
+			bool        _dirty;   /* content not yet written to the device */
 
 		public:
 
@@ -136,12 +137,12 @@ namespace Cache {
 			 * of 'Chunk_index'.
 			 */
 			Chunk(Genode::Allocator &, offset_t base_offset, Chunk_base *p)
-			: Chunk_base(base_offset, p), _writes(0) { }
+			: Chunk_base(base_offset, p), _valid(false), _dirty(false) { }
 
 			/**
 			 * Construct zero chunk
 			 */
-			Chunk() : _writes(0) { }
+			Chunk() : _valid(false), _dirty(false) { }
 
 			/**
 			 * Return number of used entries
@@ -165,7 +166,37 @@ namespace Cache {
 
 				_num_entries = Genode::max(_num_entries, local_offset + len);
 
-				_writes++;
+				_valid = true;
+				if (!_dirty) {
+					_dirty = true;
+					POLICY::dirty(this);
+				}
+			}
+
+			/**
+			 * Populate chunk with data read from the device
+			 *
+			 * The content of a valid chunk is at least as recent as the
+			 * device content and thereby kept. This way, a read request
+			 * that was issued before the client wrote the chunk cannot
+			 * revert the chunk, even if the chunk was written back in the
+			 * meantime.
+			 */
+			void fill(char const *src, size_t len, offset_t seek_offset)
+			{
+				if (zero() || _valid)
+					return;
+
+				assert_valid_range(seek_offset, len, SIZE);
+
+				offset_t const local_offset = seek_offset - base_offset();
+
+				Genode::memcpy(&_data[local_offset], src, len);
+
+				_num_entries = Genode::max(_num_entries, local_offset + len);
+
+				_valid = true;
+				POLICY::insert(this);
 			}
 
 			void read(char *dst, size_t len, offset_t seek_offset) const
@@ -181,15 +212,15 @@ namespace Cache {
 			{
 				assert_valid_range(seek_offset, len, SIZE);
 
-				if (_writes == 0)
+				if (!_valid)
 					throw Range_incomplete(base_offset(), SIZE);
 			}
 
 			void sync(size_t len, offset_t seek_offset)
 			{
-				if (_writes > 1) {
+				if (_dirty) {
 					POLICY::sync(this, (char*)_data);
-					_writes = 1;
+					_dirty = false;
 				}
 			}
 
@@ -215,7 +246,7 @@ namespace Cache {
 
 			void free(size_t, offset_t)
 			{
-				if (_writes > 1) throw Dirty_chunk(_base_offset, SIZE);
+				if (_dirty) throw Dirty_chunk(_base_offset, SIZE);
 
 				_num_entries = 0;
 				if (_parent) _parent->free(SIZE, _base_offset);
@@ -409,6 +440,21 @@ namespace Cache {
 				}
 			};
 
+			struct Fill_func
+			{
+				typedef ENTRY_TYPE Entry;
+
+				/* chunks evicted in the meantime are not needed anymore */
+				static Entry &lookup(Chunk_index const &chunk, unsigned i) {
+					return chunk._entry_for_syncing(i); }
+
+				void operator () (Entry &entry, char const *src, size_t len,
+				                  offset_t seek_offset) const
+				{
+					entry.fill(src, len, seek_offset);
+				}
+			};
+
 			struct Read_func
 			{
 				typedef ENTRY_TYPE const Entry;
@@ -515,6 +561,13 @@ namespace Cache {
 			void write(char const *src, size_t len, offset_t seek_offset) {
 				_range_op(*this, src, len, seek_offset, Write_func()); }
 
+			/**
+			 * Populate chunks with data read from the device
+			 */
+			void fill(char const *src, size_t len, offset_t seek_offset) {
+				if (zero()) return;
+				_range_op(*this, src, len, seek_offset, Fill_func()); }
+
 			/**
 			 * Allocate needed chunks
 			 */
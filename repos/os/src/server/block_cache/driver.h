@@ -5,16 +5,20 @@
  */
 
 /*
- * Copyright (C) 2013-2017 Genode Labs GmbH
+ * Copyright (C) 2013-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
  */
 
+#include <base/heap.h>
 #include <base/log.h>
 #include <block_session/connection.h>
 #include <block/component.h>
 #include <os/packet_allocator.h>
+#include <timer_session/connection.h>
+#include <util/reconstructible.h>
+#include <util/xml_node.h>
 
 #include "chunk.h"
 
@@ -75,6 +79,8 @@ class Driver : public Block::Driver
 		};
 
 
+	public:
+
 		/**
 		 * Write failed exception at a specific device offset,
 		 * can be triggered whenever the backend device is not ready
@@ -87,13 +93,16 @@ class Driver : public Block::Driver
 			Write_failed(Cache::offset_t o) : off(o) {}
 		};
 
+	private:
 
 		/*
-		 * The given policy class is extended by a synchronization routine,
-		 * used by the cache chunk structure
+		 * The given policy class is extended by a synchronization routine
+		 * and a notification about chunks becoming dirty, used by the cache
+		 * chunk structure
 		 */
 		struct Policy : POLICY {
-			static void sync(const typename POLICY::Element *e, char *src); };
+			static void sync(const typename POLICY::Element *e, char *src);
+			static void dirty(const typename POLICY::Element *e); };
 
 	public:
 
@@ -114,7 +123,51 @@ class Driver : public Block::Driver
 
 	private:
 
+		/*
+		 * Configuration
+		 */
+		struct Config
+		{
+			Genode::size_t   read_ahead;     /* in bytes                   */
+			unsigned         dirty_ratio;    /* in percent of the capacity */
+			Genode::uint64_t write_back_ms;  /* period of write-back, or 0 */
+			Genode::size_t   cache_size;     /* in bytes, or 0 for all RAM */
+			bool             verbose;
+
+			Config(Genode::Xml_node node)
+			:
+				read_ahead(node.attribute_value("read_ahead",
+				                                Genode::Number_of_bytes(64*1024))),
+				dirty_ratio(Genode::min(node.attribute_value("dirty_ratio", 20U), 100U)),
+				write_back_ms(node.attribute_value("write_back_ms", (Genode::uint64_t)0)),
+				cache_size(node.attribute_value("cache_size",
+				                                Genode::Number_of_bytes(0))),
+				verbose(node.attribute_value("verbose", false))
+			{ }
+		};
+
+		/*
+		 * Amount of data transferred, for assessing the cache efficiency
+		 */
+		struct Stats
+		{
+			Genode::uint64_t client_read  = 0;
+			Genode::uint64_t client_write = 0;
+			Genode::uint64_t device_read  = 0;
+			Genode::uint64_t device_write = 0;
+
+			void print(Genode::Output &out) const
+			{
+				Genode::print(out, "client read ",   client_read  / 1024, " KiB, "
+				                   "client written ", client_write / 1024, " KiB, "
+				                   "device read ",   device_read  / 1024, " KiB, "
+				                   "device written ", device_write / 1024, " KiB");
+			}
+		};
+
 		Genode::Env                      &_env;
+		Genode::Heap                     &_heap;
+		Config                      const _config;
 		Genode::Tslab<Request, SLAB_SZ>   _r_slab;    /* slab for requests  */
 		Genode::List<Request>             _r_list;    /* list of requests   */
 		Genode::Packet_allocator          _alloc;     /* packet allocator   */
@@ -124,6 +177,28 @@ class Driver : public Block::Driver
 		Genode::Io_signal_handler<Driver> _source_ack;
 		Genode::Io_signal_handler<Driver> _source_submit;
 		Genode::Io_signal_handler<Driver> _yield;
+		Genode::Io_signal_handler<Driver> _write_back_timeout;
+
+		Genode::Constructible<Timer::Connection> _timer { };
+
+		Cache::size_t const _capacity;        /* in chunks */
+		Cache::size_t const _dirty_limit;     /* in chunks */
+
+		/*
+		 * Offsets of dirty chunks in the order they became dirty
+		 *
+		 * The ring merely points the write-back to the oldest dirty
+		 * chunks. A chunk that is synchronized otherwise may stay in the
+		 * ring and is skipped by the write-back.
+		 */
+		Cache::offset_t * const _dirty_ring;
+		Cache::size_t           _dirty_head  = 0;
+		Cache::size_t           _dirty_count = 0;
+
+		/* block following the last read request, to detect sequential reads */
+		Block::sector_t _next_sequential = ~(Block::sector_t)0;
+
+		Stats _stats { };
 
 		Driver(Driver const&);            /* singleton pattern */
 		Driver& operator=(Driver const&); /* singleton pattern */
@@ -180,9 +255,9 @@ class Driver : public Block::Driver
 
 				/* when reading, write result into cache */
 				if (p.operation() == Block::Packet_descriptor::READ)
-					_cache.write(_blk.tx()->packet_content(p),
-					             p.block_count() * _info.block_size,
-					             p.block_number() * _info.block_size);
+					_cache.fill(_blk.tx()->packet_content(p),
+					            p.block_count() * _info.block_size,
+					            p.block_number() * _info.block_size);
 
 				/* loop through the list of requests, and ack all related */
 				for (Request *r = _r_list.first(), *r_to_handle = r; r;
@@ -202,7 +277,73 @@ class Driver : public Block::Driver
 		/*
 		 * Handle that the backend device is ready to receive again
 		 */
-		void _ready_to_submit() { }
+		void _ready_to_submit()
+		{
+			/* resume write-back stopped by the congested device */
+			if (_dirty_count > _dirty_limit)
+				_write_back(_dirty_count - _dirty_limit / 2);
+		}
+
+		/*
+		 * Return number of chunks available for the cache
+		 */
+		Cache::size_t _init_capacity()
+		{
+			if (_config.cache_size)
+				return Genode::max(_config.cache_size / CACHE_BLK_SIZE, (Genode::size_t)16);
+
+			/*
+			 * Leave an eighth of the RAM to the chunk indices, requests, and
+			 * the replacement history
+			 */
+			Genode::size_t const avail = _env.pd().avail_ram().value;
+			Genode::size_t const usable = avail - avail / 8;
+
+			return Genode::max(usable / (sizeof(Chunk_level_4) + 64), (Genode::size_t)16);
+		}
+
+		/*
+		 * Remember chunk at offset 'off' for being written back
+		 */
+		void _mark_dirty(Cache::offset_t off)
+		{
+			/* forget oldest entry, the chunk is written back on eviction */
+			if (_dirty_count == _capacity) {
+				_dirty_head = (_dirty_head + 1) % _capacity;
+				_dirty_count--;
+			}
+			_dirty_ring[(_dirty_head + _dirty_count) % _capacity] = off;
+			_dirty_count++;
+		}
+
+		/*
+		 * Write back up to 'count' of the oldest dirty chunks
+		 *
+		 * The write-back stops as soon as the backend device is congested
+		 * and is resumed once it becomes ready again.
+		 */
+		void _write_back(Cache::size_t count)
+		{
+			for (; count && _dirty_count; count--) {
+				try {
+					_cache.sync(CACHE_BLK_SIZE, _dirty_ring[_dirty_head]);
+				} catch (Write_failed) { return; }
+
+				_dirty_head = (_dirty_head + 1) % _capacity;
+				_dirty_count--;
+			}
+		}
+
+		/*
+		 * Limit the share of dirty chunks in the cache
+		 */
+		void _limit_dirty()
+		{
+			if (_dirty_count > _dirty_limit)
+				_write_back(_dirty_count - _dirty_limit / 2);
+		}
+
+		void _handle_write_back_timeout() { _write_back(_dirty_count); }
 
 		/*
 		 * Setup a request to the backend device
@@ -210,11 +351,13 @@ class Driver : public Block::Driver
 		 * \param block_number block number offset
 		 * \param block_count  number of blocks
 		 * \param packet       original packet request received from the client
+		 * \param read_ahead   number of blocks to read beyond the request
 		 */
 		void _request(Block::sector_t           block_number,
 		              Genode::size_t            block_count,
 		              char * const              buffer,
-		              Block::Packet_descriptor &packet)
+		              Block::Packet_descriptor &packet,
+		              Genode::size_t            read_ahead = 0)
 		{
 			Block::Packet_descriptor p_to_dev;
 
@@ -237,24 +380,38 @@ class Driver : public Block::Driver
 				/* read ahead CACHE_BLK_SIZE */
 				Block::sector_t nr = _cache_blk_round_off(block_number);
 				Genode::size_t cnt = _cache_blk_round_up(block_count +
-				                                         (block_number - nr));
-
-				/* ensure all memory is available before sending the request */
-				_cache.alloc(cnt * _info.block_size, nr * _info.block_size);
+				                                         (block_number - nr) +
+				                                         read_ahead);
+				cnt = Genode::min(cnt, (Genode::size_t)(_info.block_count - nr));
 
-				/* construct and send the packet */
+				/* construct the packet */
 				p_to_dev =
 					Block::Packet_descriptor(_blk.alloc_packet(_info.block_size*cnt),
 					                         Block::Packet_descriptor::READ,
 					                         nr, cnt);
+
+				/* ensure all memory is available before sending the request */
+				POLICY::make_room(cnt * _info.block_size / CACHE_BLK_SIZE);
+				_cache.alloc(cnt * _info.block_size, nr * _info.block_size);
+
 				_r_list.insert(new (&_r_slab) Request(p_to_dev, packet, buffer));
 				_blk.tx()->submit_packet(p_to_dev);
+				_stats.device_read += p_to_dev.size();
 			} catch(Block::Session::Tx::Source::Packet_alloc_failed) {
+
+				/* the read-ahead is optional */
+				if (read_ahead) {
+					_request(block_number, block_count, buffer, packet);
+					return;
+				}
 				throw Request_congestion();
 			} catch(Genode::Allocator::Out_of_memory) {
 				/* clean up */
-				_blk.tx()->release_packet(p_to_dev);
+				if (p_to_dev.size()) _blk.tx()->release_packet(p_to_dev);
 				throw Request_congestion();
+			} catch(Request_congestion) {
+				if (p_to_dev.size()) _blk.tx()->release_packet(p_to_dev);
+				throw;
 			}
 		}
 
@@ -290,7 +447,8 @@ class Driver : public Block::Driver
 		 * \param p    client side packet, which triggered this operation
 		 */
 		bool _stat(Block::sector_t nr, Genode::size_t cnt,
-		           char * const buffer, Block::Packet_descriptor &p)
+		           char * const buffer, Block::Packet_descriptor &p,
+		           Genode::size_t read_ahead = 0)
 		{
 			Cache::offset_t off   = nr  * _info.block_size;
 			Cache::size_t   size  = cnt * _info.block_size;
@@ -302,7 +460,8 @@ class Driver : public Block::Driver
 			} catch(Cache::Chunk_base::Range_incomplete &e) {
 				off  = Genode::max(off, e.off);
 				size = Genode::min(end - off, e.size);
-				_request(off / _info.block_size, size / _info.block_size, buffer, p);
+				_request(off / _info.block_size, size / _info.block_size, buffer, p,
+				         read_ahead);
 			}
 			return false;
 		}
@@ -319,7 +478,10 @@ class Driver : public Block::Driver
 				Arg_string::find_arg(args.string(), "ram_quota").ulong_value(0);
 
 			/* flush the requested amount of RAM from cache */
-			POLICY::flush(requested_ram_quota);
+			try { POLICY::flush(requested_ram_quota); }
+			catch (Request_congestion) {
+				warning("could not free the requested amount of RAM"); }
+
 			_env.parent().yield_response();
 		}
 
@@ -330,9 +492,11 @@ class Driver : public Block::Driver
 		 *
 		 * \param ep  server entrypoint
 		 */
-		Driver(Genode::Env &env, Genode::Heap &heap)
+		Driver(Genode::Env &env, Genode::Heap &heap, Genode::Xml_node config)
 		: Block::Driver(env.ram()),
 		  _env(env),
+		  _heap(heap),
+		  _config(config),
 		  _r_slab(&heap),
 		  _alloc(&heap, CACHE_BLK_SIZE),
 		  _blk(_env, &_alloc, Block::Session::TX_QUEUE_SIZE*CACHE_BLK_SIZE),
@@ -340,7 +504,12 @@ class Driver : public Block::Driver
 		  _cache(heap, 0),
 		  _source_ack(env.ep(), *this, &Driver::_ack_avail),
 		  _source_submit(env.ep(), *this, &Driver::_ready_to_submit),
-		  _yield(env.ep(), *this, &Driver::_parent_yield)
+		  _yield(env.ep(), *this, &Driver::_parent_yield),
+		  _write_back_timeout(env.ep(), *this, &Driver::_handle_write_back_timeout),
+		  _capacity(_init_capacity()),
+		  _dirty_limit(Genode::max(_capacity * _config.dirty_ratio / 100, 1ULL)),
+		  _dirty_ring((Cache::offset_t *)static_cast<Genode::Allocator &>(heap)
+		              .alloc((Genode::size_t)(_capacity*sizeof(Cache::offset_t))))
 		{
 			using namespace Genode;
 
@@ -348,6 +517,14 @@ class Driver : public Block::Driver
 			_blk.tx_channel()->sigh_ready_to_submit(_source_submit);
 			env.parent().yield_sigh(_yield);
 
+			POLICY::init(heap, _capacity);
+
+			if (_config.write_back_ms) {
+				_timer.construct(env);
+				_timer->sigh(_write_back_timeout);
+				_timer->trigger_periodic(_config.write_back_ms*1000);
+			}
+
 			if (CACHE_BLK_SIZE % _info.block_size) {
 				error("only devices that block size is divider of ",
 				      Hex(CACHE_BLK_SIZE, Hex::OMIT_PREFIX) ," supported");
@@ -363,11 +540,29 @@ class Driver : public Block::Driver
 			/* when session gets closed, synchronize and flush the cache */
 			_sync();
 			POLICY::flush();
+
+			if (_config.verbose)
+				Genode::log("session closed: ", _stats);
+
+			_heap.free(_dirty_ring, (Genode::size_t)(_capacity*sizeof(Cache::offset_t)));
 		}
 
 		Block::Session_client* blk()    { return &_blk;   }
 		Genode::size_t         blk_sz() { return _info.block_size; }
 
+		/**
+		 * Write back chunk before it gets evicted
+		 *
+		 * \return false if the backend device is congested
+		 */
+		static bool write_back(Chunk_level_4 &chunk)
+		{
+			try {
+				chunk.sync(CACHE_BLK_SIZE, chunk.base_offset());
+				return true;
+			} catch (Write_failed) { return false; }
+		}
+
 
 		/****************************
 		 ** Block-driver interface **
@@ -380,7 +575,14 @@ class Driver : public Block::Driver
 		          char*                     buffer,
 		          Block::Packet_descriptor &packet)
 		{
-			if (!_stat(block_number, block_count, buffer, packet))
+			/* read ahead if the request continues the previous one */
+			Genode::size_t const read_ahead =
+				(block_number == _next_sequential)
+				? _config.read_ahead / _info.block_size : 0;
+
+			_next_sequential = block_number + block_count;
+
+			if (!_stat(block_number, block_count, buffer, packet, read_ahead))
 				return;
 
 			_cache.read(buffer,
@@ -388,6 +590,7 @@ class Driver : public Block::Driver
 			            block_number*_info.block_size);
 
 			ack_packet(packet);
+			_stats.client_read += block_count * _info.block_size;
 		}
 
 		void write(Block::sector_t           block_number,
@@ -398,8 +601,18 @@ class Driver : public Block::Driver
 			if (!_info.writeable)
 				throw Io_error();
 
-			_cache.alloc(block_count  * _info.block_size,
-			             block_number * _info.block_size);
+			Cache::size_t   const size = block_count  * _info.block_size;
+			Cache::offset_t const off  = block_number * _info.block_size;
+
+			/* evict chunks only if the written range is not cached yet */
+			bool cached = true;
+			try { _cache.stat(size, off); }
+			catch (Cache::Chunk_base::Range_incomplete) { cached = false; }
+
+			if (!cached) {
+				POLICY::make_room(block_count * _info.block_size / CACHE_BLK_SIZE + 1);
+				_cache.alloc(size, off);
+			}
 
 			if ((block_number % _cache_blk_mod()) &&
 			    !_stat(block_number, 1, const_cast<char* const>(buffer), packet))
@@ -415,6 +628,9 @@ class Driver : public Block::Driver
 			             block_number * _info.block_size);
 
 			ack_packet(packet);
+			_stats.client_write += block_count * _info.block_size;
+
+			_limit_dirty();
 		}
 
 		void sync() { _sync(); }
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2013-2017 Genode Labs GmbH
+ * Copyright (C) 2013-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -16,21 +16,51 @@
 
 typedef Driver<Lru_policy>::Chunk_level_4 Chunk;
 
-static const Lru_policy::Element        *lru = 0;
-static Genode::List<Lru_policy::Element> lru_list;
+static Cache::Policy_list lru_list;
+static Cache::size_t      lru_capacity = ~0ULL;
 
 
 static void lru_access(const Lru_policy::Element *e)
 {
-	if (e == lru) return;
+	Lru_policy::Element &elem = *const_cast<Lru_policy::Element *>(e);
 
-	if (e->next()) lru_list.remove(e);
+	if (elem.list()) lru_list.move_to_head(elem);
+	else             lru_list.insert_head(elem);
+}
+
+
+/**
+ * Evict up to 'count' least-recently-used chunks
+ *
+ * \return number of evicted chunks
+ */
+static Cache::size_t lru_evict(Cache::size_t count)
+{
+	Cache::size_t freed = 0;
+	for (Cache::Policy_element *e = lru_list.tail(); e && freed < count; ) {
+
+		Chunk &chunk = static_cast<Chunk &>(static_cast<Lru_policy::Element &>(*e));
+		e = e->prev();
+
+		if (!Driver<Lru_policy>::write_back(chunk))
+			continue;
 
-	lru_list.insert(e, lru);
-	lru = e;
+		lru_list.remove(chunk);
+		chunk.free(Driver<Lru_policy>::CACHE_BLK_SIZE, chunk.base_offset());
+		freed++;
+	}
+	return freed;
 }
 
 
+void Lru_policy::init(Genode::Allocator &, Cache::size_t capacity) {
+	lru_capacity = capacity; }
+
+
+void Lru_policy::insert(const Lru_policy::Element *e) {
+	lru_access(e); }
+
+
 void Lru_policy::read(const Lru_policy::Element  *e) {
 	lru_access(e); }
 
@@ -39,24 +69,18 @@ void Lru_policy::write(const Lru_policy::Element *e) {
 	lru_access(e); }
 
 
-void Lru_policy::flush(Cache::size_t size)
+void Lru_policy::make_room(Cache::size_t chunks)
 {
-	Cache::size_t s = 0;
-	for (Lru_policy::Element *e = lru_list.first();
-		 e && ((size == 0) || (s < size));
-		 e = lru_list.first(), s += sizeof(Chunk)) {
-		Chunk *cb = static_cast<Chunk*>(e);
-		e = e->next();
-		try {
-			cb->free(Driver<Lru_policy>::CACHE_BLK_SIZE,
-			         cb->base_offset());
-			lru_list.remove(cb);
-		} catch(Chunk::Dirty_chunk &e) {
-			cb->sync(e.size, e.off);
-		}
-	}
+	if (lru_list.count() + chunks > lru_capacity)
+		lru_evict(lru_list.count() + chunks - lru_capacity);
+}
+
 
-	if (!lru_list.first()) lru = 0;
+void Lru_policy::flush(Cache::size_t size)
+{
+	Cache::size_t const chunks = size ? (size + sizeof(Chunk) - 1) / sizeof(Chunk)
+	                                  : ~0ULL;
 
-	if (s < size) throw Block::Driver::Request_congestion();
+	if (lru_evict(chunks) * sizeof(Chunk) < size)
+		throw Block::Driver::Request_congestion();
 }
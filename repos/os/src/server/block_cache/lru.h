@@ -5,21 +5,27 @@
  */
 
 /*
- * Copyright (C) 2013-2017 Genode Labs GmbH
+ * Copyright (C) 2013-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
  */
 
-#include <util/list.h>
+#ifndef _LRU_H_
+#define _LRU_H_
 
-#include "chunk.h"
+#include "policy.h"
 
 struct Lru_policy
 {
-	class Element : public Genode::List<Element>::Element {};
+	class Element : public Cache::Policy_element {};
 
+	static void init(Genode::Allocator &alloc, Cache::size_t capacity);
+	static void insert(const Element *e);
 	static void read(const Element  *e);
 	static void write(const Element *e);
+	static void make_room(Cache::size_t chunks);
 	static void flush(Cache::size_t size = 0);
 };
+
+#endif /* _LRU_H_ */
@@ -5,59 +5,83 @@
  */
 
 /*
- * Copyright (C) 2013-2017 Genode Labs GmbH
+ * Copyright (C) 2013-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
  */
 
 #include <base/component.h>
+#include <base/attached_rom_dataspace.h>
 
 #include "lru.h"
+#include "two_q.h"
+#include "arc.h"
 #include "driver.h"
 
-using Policy = Lru_policy;
-static Driver<Policy> * driver = nullptr;
+static Block::Driver * driver = nullptr;
 
 
 /**
  * Synchronize a chunk with the backend device
  */
 template <typename POLICY>
-void Driver<POLICY>::Policy::sync(const typename POLICY::Element *e, char *dst)
+void Driver<POLICY>::Policy::sync(const typename POLICY::Element *e, char *src)
 {
 	Cache::offset_t off =
 		static_cast<const Driver<POLICY>::Chunk_level_4*>(e)->base_offset();
 
-	if (!driver) throw Write_failed(off);
+	Driver<POLICY> * const drv = static_cast<Driver<POLICY> *>(driver);
 
-	if (!driver->blk()->tx()->ready_to_submit())
+	if (!drv) throw Write_failed(off);
+
+	if (!drv->blk()->tx()->ready_to_submit())
 		throw Write_failed(off);
 	try {
 		Block::Packet_descriptor
-			p(driver->blk()->alloc_packet(Driver::CACHE_BLK_SIZE),
-		      Block::Packet_descriptor::WRITE, off / driver->blk_sz(),
-		      Driver::CACHE_BLK_SIZE / driver->blk_sz());
-		driver->blk()->tx()->submit_packet(p);
+			p(drv->blk()->alloc_packet(Driver::CACHE_BLK_SIZE),
+		      Block::Packet_descriptor::WRITE, off / drv->blk_sz(),
+		      Driver::CACHE_BLK_SIZE / drv->blk_sz());
+		Genode::memcpy(drv->blk()->tx()->packet_content(p), src,
+		               Driver::CACHE_BLK_SIZE);
+		drv->blk()->tx()->submit_packet(p);
+		drv->_stats.device_write += p.size();
 	} catch(Block::Session::Tx::Source::Packet_alloc_failed) {
 		throw Write_failed(off);
 	}
 }
 
 
+/**
+ * Register a chunk for the write-back
+ */
+template <typename POLICY>
+void Driver<POLICY>::Policy::dirty(const typename POLICY::Element *e)
+{
+	Driver<POLICY> * const drv = static_cast<Driver<POLICY> *>(driver);
+
+	if (drv)
+		drv->_mark_dirty(static_cast<const Driver<POLICY>::Chunk_level_4*>(e)->base_offset());
+}
+
+
 struct Main
 {
 	template <typename T>
 	struct Factory : Block::Driver_factory
 	{
-		Genode::Env  &env;
-		Genode::Heap &heap;
+		Genode::Env                    &env;
+		Genode::Heap                   &heap;
+		Genode::Attached_rom_dataspace &config;
 
-		Factory(Genode::Env &env, Genode::Heap &heap) : env(env), heap(heap) {}
+		Factory(Genode::Env &env, Genode::Heap &heap,
+		        Genode::Attached_rom_dataspace &config)
+		: env(env), heap(heap), config(config) {}
 
 		Block::Driver *create()
 		{
-			driver = new (&heap) ::Driver<T>(env, heap);
+			config.update();
+			driver = new (&heap) ::Driver<T>(env, heap, config.xml());
 			return driver;
 		}
 
@@ -67,10 +91,34 @@ struct Main
 
 	void resource_handler() { }
 
-	Genode::Env                 &env;
-	Genode::Heap                 heap    { env.ram(), env.rm()     };
-	Factory<Lru_policy>          factory { env, heap               };
-	Block::Root                  root    { env.ep(), heap, env.rm(), factory, true };
+	typedef Genode::String<8> Policy_name;
+
+	Genode::Env                   &env;
+	Genode::Heap                   heap          { env.ram(), env.rm() };
+	Genode::Attached_rom_dataspace config        { env, "config" };
+	Factory<Lru_policy>            lru_factory   { env, heap, config };
+	Factory<Two_q_policy>          two_q_factory { env, heap, config };
+	Factory<Arc_policy>            arc_factory   { env, heap, config };
+
+	/*
+	 * The replacement strategy is fixed at startup because the cache
+	 * structure depends on it
+	 */
+	Block::Driver_factory &_factory()
+	{
+		Policy_name const policy =
+			config.xml().attribute_value("policy", Policy_name("lru"));
+
+		if (policy == "2q")  return two_q_factory;
+		if (policy == "arc") return arc_factory;
+
+		if (policy != "lru")
+			Genode::warning("unknown policy \"", policy, "\", using lru");
+
+		return lru_factory;
+	}
+
+	Block::Root                  root    { env.ep(), heap, env.rm(), _factory(), true };
 	Genode::Signal_handler<Main> resource_dispatcher {
 		env.ep(), *this, &Main::resource_handler };
 
@@ -0,0 +1,278 @@
+/*
+ * \brief  Building blocks of cache replacement strategies
+ * \author Genode Labs
+ * \date   2019-10-10
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _POLICY_H_
+#define _POLICY_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <util/string.h>
+
+#include "chunk.h"
+
+namespace Cache {
+
+	class Policy_list;
+	class Policy_element;
+	class Ghost_list;
+}
+
+
+/**
+ * Chunk as seen by a replacement strategy
+ */
+class Cache::Policy_element
+{
+	private:
+
+		friend class Policy_list;
+
+		/*
+		 * Noncopyable
+		 */
+		Policy_element(Policy_element const &);
+		Policy_element &operator = (Policy_element const &);
+
+		Policy_element *_prev { nullptr };
+		Policy_element *_next { nullptr };
+		Policy_list    *_list { nullptr };
+
+	public:
+
+		/**
+		 * Access counter of the strategy at the last access of the element
+		 */
+		unsigned long last_access { 0 };
+
+		Policy_element() { }
+
+		/**
+		 * Return list the element is on, or nullptr if not yet tracked
+		 */
+		Policy_list *list() const { return _list; }
+
+		Policy_element *prev() const { return _prev; }
+};
+
+
+/**
+ * List of chunks ordered by recency, with constant-time removal
+ *
+ * The head holds the most recently used element, the tail the candidate
+ * for eviction.
+ */
+class Cache::Policy_list
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Policy_list(Policy_list const &);
+		Policy_list &operator = (Policy_list const &);
+
+		Policy_element *_head  { nullptr };
+		Policy_element *_tail  { nullptr };
+		size_t          _count { 0 };
+
+	public:
+
+		Policy_list() { }
+
+		Policy_element *tail()  const { return _tail; }
+		size_t          count() const { return _count; }
+
+		void insert_head(Policy_element &e)
+		{
+			e._prev = nullptr;
+			e._next = _head;
+			e._list = this;
+
+			if (_head) _head->_prev = &e;
+			else       _tail = &e;
+
+			_head = &e;
+			_count++;
+		}
+
+		void remove(Policy_element &e)
+		{
+			if (e._prev) e._prev->_next = e._next;
+			else         _head = e._next;
+
+			if (e._next) e._next->_prev = e._prev;
+			else         _tail = e._prev;
+
+			e._prev = e._next = nullptr;
+			e._list = nullptr;
+			_count--;
+		}
+
+		void move_to_head(Policy_element &e)
+		{
+			remove(e);
+			insert_head(e);
+		}
+};
+
+
+/**
+ * Recency-ordered set of offsets of recently evicted chunks
+ *
+ * Ghost entries remember the history of chunks that are no longer cached
+ * at the cost of a few words each.
+ */
+class Cache::Ghost_list
+{
+	private:
+
+		struct Entry
+		{
+			offset_t const off;
+			Entry         *hash_next { nullptr };
+			Entry         *prev      { nullptr };
+			Entry         *next      { nullptr };
+
+			Entry(offset_t off) : off(off) { }
+		};
+
+		/*
+		 * Noncopyable
+		 */
+		Ghost_list(Ghost_list const &);
+		Ghost_list &operator = (Ghost_list const &);
+
+		Genode::Allocator *_alloc       { nullptr };
+		Entry            **_buckets     { nullptr };
+		unsigned long      _num_buckets { 0 };
+		Entry             *_head        { nullptr };
+		Entry             *_tail        { nullptr };
+		size_t             _count       { 0 };
+
+		Entry *&_bucket(offset_t off)
+		{
+			/* chunk offsets are multiples of the chunk size */
+			return _buckets[(off >> 12) & (_num_buckets - 1)];
+		}
+
+		void _unlink(Entry &e)
+		{
+			if (e.prev) e.prev->next = e.next;
+			else        _head = e.next;
+
+			if (e.next) e.next->prev = e.prev;
+			else        _tail = e.prev;
+
+			for (Entry **link = &_bucket(e.off); *link; link = &(*link)->hash_next) {
+				if (*link == &e) {
+					*link = e.hash_next;
+					break;
+				}
+			}
+			_count--;
+		}
+
+	public:
+
+		Ghost_list() { }
+
+		~Ghost_list() { clear(); }
+
+		/**
+		 * Prepare list for holding about 'capacity' entries
+		 */
+		void init(Genode::Allocator &alloc, size_t capacity)
+		{
+			clear();
+			if (_buckets)
+				_alloc->free(_buckets, _num_buckets*sizeof(Entry *));
+
+			_alloc       = &alloc;
+			_num_buckets = 64;
+			while (_num_buckets < capacity && _num_buckets < (1UL << 20))
+				_num_buckets <<= 1;
+
+			_buckets = (Entry **)alloc.alloc(_num_buckets*sizeof(Entry *));
+			Genode::memset(_buckets, 0, _num_buckets*sizeof(Entry *));
+		}
+
+		size_t count() const { return _count; }
+
+		/**
+		 * Record offset as most recently evicted
+		 *
+		 * The history is incomplete if there is no memory left, which
+		 * affects only the quality of replacement decisions.
+		 */
+		void insert_head(offset_t off)
+		{
+			if (!_buckets)
+				return;
+
+			Entry *e = nullptr;
+			try { e = new (_alloc) Entry(off); }
+			catch (Genode::Out_of_ram)  { return; }
+			catch (Genode::Out_of_caps) { return; }
+
+			e->next = _head;
+			if (_head) _head->prev = e;
+			else       _tail = e;
+			_head = e;
+
+			e->hash_next = _bucket(off);
+			_bucket(off) = e;
+			_count++;
+		}
+
+		/**
+		 * Remove offset from the list
+		 *
+		 * \return true if the offset was recorded
+		 */
+		bool remove(offset_t off)
+		{
+			if (!_buckets)
+				return false;
+
+			for (Entry *e = _bucket(off); e; e = e->hash_next) {
+				if (e->off != off)
+					continue;
+
+				_unlink(*e);
+				Genode::destroy(_alloc, e);
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		 * Forget the least recently evicted offset
+		 */
+		void remove_tail()
+		{
+			if (!_tail)
+				return;
+
+			Entry &e = *_tail;
+			_unlink(e);
+			Genode::destroy(_alloc, &e);
+		}
+
+		void clear()
+		{
+			while (_tail)
+				remove_tail();
+		}
+};
+
+#endif /* _POLICY_H_ */
@@ -1,5 +1,5 @@
 TARGET = block_cache
 LIBS   = base
-SRC_CC = main.cc lru.cc
+SRC_CC = main.cc lru.cc two_q.cc arc.cc
 
 CC_CXX_WARN_STRICT =
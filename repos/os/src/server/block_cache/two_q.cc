@@ -0,0 +1,137 @@
+/*
+ * \brief  2Q cache replacement strategy
+ * \author Genode Labs
+ * \date   2019-10-10
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include "two_q.h"
+#include "driver.h"
+
+typedef Driver<Two_q_policy>::Chunk_level_4 Chunk;
+
+static Cache::Policy_list a1_in;      /* FIFO of chunks accessed once */
+static Cache::Policy_list a_m;        /* LRU of chunks accessed again */
+static Cache::Ghost_list  a1_out;     /* chunks evicted from 'a1_in' */
+static Cache::size_t      capacity  = ~0ULL;
+static Cache::size_t      max_a1_in = ~0ULL;
+static Cache::size_t      max_a1_out;
+
+
+static Chunk &chunk(Cache::Policy_element &e) {
+	return static_cast<Chunk &>(static_cast<Two_q_policy::Element &>(e)); }
+
+
+static void access(const Two_q_policy::Element *e)
+{
+	Two_q_policy::Element &elem = *const_cast<Two_q_policy::Element *>(e);
+
+	if (!elem.list()) {
+		Two_q_policy::insert(e);
+		return;
+	}
+
+	/* accesses while in the FIFO are regarded as correlated */
+	if (elem.list() == &a_m)
+		a_m.move_to_head(elem);
+}
+
+
+/**
+ * Evict least-recently-used chunk of 'list' that can be freed
+ */
+static bool evict_from(Cache::Policy_list &list, Cache::Ghost_list *ghosts)
+{
+	for (Cache::Policy_element *e = list.tail(); e; e = e->prev()) {
+
+		Chunk &c = chunk(*e);
+		if (!Driver<Two_q_policy>::write_back(c))
+			continue;
+
+		list.remove(c);
+		if (ghosts) {
+			ghosts->insert_head(c.base_offset());
+			if (ghosts->count() > max_a1_out)
+				ghosts->remove_tail();
+		}
+		c.free(Driver<Two_q_policy>::CACHE_BLK_SIZE, c.base_offset());
+		return true;
+	}
+	return false;
+}
+
+
+static bool evict_one()
+{
+	if (a1_in.count() > max_a1_in || !a_m.count())
+		return evict_from(a1_in, &a1_out) || evict_from(a_m, nullptr);
+
+	return evict_from(a_m, nullptr) || evict_from(a1_in, &a1_out);
+}
+
+
+static Cache::size_t evict(Cache::size_t count)
+{
+	Cache::size_t freed = 0;
+	for (; freed < count && evict_one(); freed++);
+	return freed;
+}
+
+
+void Two_q_policy::init(Genode::Allocator &alloc, Cache::size_t chunks)
+{
+	capacity   = chunks;
+	max_a1_in  = Genode::max(chunks / 4, 1ULL);
+	max_a1_out = Genode::max(chunks / 2, 1ULL);
+	a1_out.init(alloc, max_a1_out);
+}
+
+
+void Two_q_policy::insert(const Two_q_policy::Element *e)
+{
+	Two_q_policy::Element &elem = *const_cast<Two_q_policy::Element *>(e);
+
+	if (elem.list()) {
+		access(e);
+		return;
+	}
+
+	/* a chunk evicted from the FIFO and accessed again is hot */
+	if (a1_out.remove(chunk(elem).base_offset()))
+		a_m.insert_head(elem);
+	else
+		a1_in.insert_head(elem);
+}
+
+
+void Two_q_policy::read(const Two_q_policy::Element  *e) {
+	access(e); }
+
+
+void Two_q_policy::write(const Two_q_policy::Element *e) {
+	access(e); }
+
+
+void Two_q_policy::make_room(Cache::size_t chunks)
+{
+	Cache::size_t const resident = a1_in.count() + a_m.count();
+
+	if (resident + chunks > capacity)
+		evict(resident + chunks - capacity);
+}
+
+
+void Two_q_policy::flush(Cache::size_t size)
+{
+	Cache::size_t const chunks = size ? (size + sizeof(Chunk) - 1) / sizeof(Chunk)
+	                                  : ~0ULL;
+
+	if (evict(chunks) * sizeof(Chunk) < size)
+		throw Block::Driver::Request_congestion();
+}
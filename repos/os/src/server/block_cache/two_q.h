@@ -0,0 +1,39 @@
+/*
+ * \brief  2Q cache replacement strategy
+ * \author Genode Labs
+ * \date   2019-10-10
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _TWO_Q_H_
+#define _TWO_Q_H_
+
+#include "policy.h"
+
+/**
+ * 2Q strategy after Johnson and Shasha
+ *
+ * Chunks enter a FIFO queue on their first access and are promoted to the
+ * LRU-managed main queue only if they are accessed again after they were
+ * evicted from the FIFO. Chunks that are used only once, e.g., during a
+ * sequential scan, thereby do not displace the working set.
+ */
+struct Two_q_policy
+{
+	class Element : public Cache::Policy_element {};
+
+	static void init(Genode::Allocator &alloc, Cache::size_t capacity);
+	static void insert(const Element *e);
+	static void read(const Element  *e);
+	static void write(const Element *e);
+	static void make_room(Cache::size_t chunks);
+	static void flush(Cache::size_t size = 0);
+};
+
+#endif /* _TWO_Q_H_ */
@@ -6,7 +6,7 @@
  */
 
 /*
- * Copyright (C) 2013-2017 Genode Labs GmbH
+ * Copyright (C) 2013-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -50,6 +50,9 @@ class Lx_fs::Directory : public Node
 		Path       _path;
 		Allocator &_alloc;
 
+		/* index of the entry returned next by 'readdir' */
+		mutable seek_off_t _next_index = 0;
+
 		unsigned long _inode(char const *path, bool create)
 		{
 			int ret;
@@ -94,6 +97,7 @@ class Lx_fs::Directory : public Node
 			rewinddir(_fd);
 			while (readdir(_fd)) ++num;
 
+			_next_index = num;
 			return num;
 		}
 
@@ -182,31 +186,45 @@ class Lx_fs::Directory : public Node
 
 			seek_off_t index = seek_offset / sizeof(Directory_entry);
 
-			/* seek to index and read entry */
-			struct dirent *dent;
-			rewinddir(_fd);
-			for (unsigned i = 0; i <= index; ++i) {
-				dent = readdir(_fd);
+			/*
+			 * Seek to index unless a sequential listing continues where
+			 * the previous read stopped
+			 */
+			if (index != _next_index) {
+				rewinddir(_fd);
+				for (_next_index = 0; _next_index < index; _next_index++)
+					if (!readdir(_fd))
+						return 0;
 			}
 
-			if (!dent)
-				return 0;
+			/* return as many consecutive entries as fit into 'dst' */
+			size_t const max_count = len / sizeof(Directory_entry);
+			size_t       count     = 0;
 
-			Directory_entry *e = (Directory_entry *)(dst);
+			for (; count < max_count; count++) {
 
-			switch (dent->d_type) {
-			case DT_REG: e->type = Directory_entry::TYPE_FILE;      break;
-			case DT_DIR: e->type = Directory_entry::TYPE_DIRECTORY; break;
-			case DT_LNK: e->type = Directory_entry::TYPE_SYMLINK;   break;
-			default:
-				return 0;
-			}
+				struct dirent *dent = readdir(_fd);
+				if (!dent)
+					break;
+
+				_next_index++;
+
+				Directory_entry *e = (Directory_entry *)(dst) + count;
 
-			e->inode = dent->d_ino;
+				switch (dent->d_type) {
+				case DT_REG: e->type = Directory_entry::TYPE_FILE;      break;
+				case DT_DIR: e->type = Directory_entry::TYPE_DIRECTORY; break;
+				case DT_LNK: e->type = Directory_entry::TYPE_SYMLINK;   break;
+				default:
+					return count*sizeof(Directory_entry);
+				}
+
+				e->inode = dent->d_ino;
 
-			strncpy(e->name, dent->d_name, sizeof(e->name));
+				strncpy(e->name, dent->d_name, sizeof(e->name));
+			}
 
-			return sizeof(Directory_entry);
+			return count*sizeof(Directory_entry);
 		}
 
 		size_t write(char const *, size_t, seek_off_t) override
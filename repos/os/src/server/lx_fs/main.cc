@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2012-2017 Genode Labs GmbH
+ * Copyright (C) 2012-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -455,22 +455,29 @@ class Lx_fs::Root : public Root_component<Session_component>
 
 			size_t ram_quota =
 				Arg_string::find_arg(args, "ram_quota"  ).ulong_value(0);
-			size_t tx_buf_size =
+			size_t const requested_tx_buf_size =
 				Arg_string::find_arg(args, "tx_buf_size").ulong_value(0);
 
-			if (!tx_buf_size) {
+			if (!requested_tx_buf_size) {
 				Genode::error(label, " requested a session with a zero length transmission buffer");
 				throw Genode::Service_denied();
 			}
 
 			/*
 			 * Check if donated ram quota suffices for session data,
-			 * and communication buffer.
+			 * and shrink the communication buffer to the remainder.
 			 */
-			size_t session_size = sizeof(Session_component) + tx_buf_size;
-			if (max((size_t)4096, session_size) > ram_quota) {
-				Genode::error("insufficient 'ram_quota', "
-				              "got ", ram_quota, ", need ", session_size);
+			size_t const session_costs =
+				max((size_t)4096, sizeof(Session_component));
+
+			size_t const tx_buf_size = ram_quota > session_costs
+				? File_system::Session::granted_tx_buf_size(
+					requested_tx_buf_size, ram_quota - session_costs)
+				: 0;
+
+			if (!tx_buf_size) {
+				Genode::error("insufficient 'ram_quota', got ", ram_quota, ", "
+				              "need ", session_costs + File_system::Session::min_tx_buf_size());
 				throw Insufficient_ram_quota();
 			}
 
@@ -44,8 +44,8 @@ void Packet_handler::_ready_to_submit()
 void Packet_handler::_ready_to_ack()
 {
 	/* check for acknowledgements */
-	while (source()->ack_avail())
-		source()->release_packet(source()->get_acked_packet());
+	source()->drain_acked_packets([&] (Packet_descriptor const &packet) {
+		source()->release_packet(packet); });
 }
 
 
@@ -67,6 +67,8 @@ Configuration::Configuration(Env               &env,
 :
 	_alloc                  { alloc },
 	_max_packets_per_signal { node.attribute_value("max_packets_per_signal",    (unsigned long)DEFAULT_MAX_PACKETS_PER_SIGNAL) },
+	_signal_moderation_us   { node.attribute_value("signal_moderation_us",      0UL) },
+	_signal_moderation_pkts { node.attribute_value("signal_moderation_packets", (unsigned)DEFAULT_SIGNAL_MODERATION_PKTS) },
 	_verbose                { node.attribute_value("verbose",                   false) },
 	_verbose_packets        { node.attribute_value("verbose_packets",           false) },
 	_verbose_packet_drop    { node.attribute_value("verbose_packet_drop",       false) },
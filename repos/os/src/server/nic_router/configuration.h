@@ -35,6 +35,8 @@ class Net::Configuration
 
 		Genode::Allocator          &_alloc;
 		unsigned long        const  _max_packets_per_signal  { 0 };
+		unsigned long        const  _signal_moderation_us    { 0 };
+		unsigned             const  _signal_moderation_pkts  { DEFAULT_SIGNAL_MODERATION_PKTS };
 		bool                 const  _verbose                 { false };
 		bool                 const  _verbose_packets         { false };
 		bool                 const  _verbose_packet_drop     { false };
@@ -70,6 +72,7 @@ class Net::Configuration
 		enum { DEFAULT_TCP_IDLE_TIMEOUT_SEC      = 600 };
 		enum { DEFAULT_TCP_MAX_SEGM_LIFETIME_SEC =  30 };
 		enum { DEFAULT_MAX_PACKETS_PER_SIGNAL    =  32 };
+		enum { DEFAULT_SIGNAL_MODERATION_PKTS    =  16 };
 
 		Configuration(Genode::Xml_node const  node,
 		              Genode::Allocator      &alloc);
@@ -90,6 +93,8 @@ class Net::Configuration
 		 ***************/
 
 		unsigned long         max_packets_per_signal() const { return _max_packets_per_signal; }
+		unsigned long         signal_moderation_us()   const { return _signal_moderation_us; }
+		unsigned              signal_moderation_pkts() const { return _signal_moderation_pkts; }
 		bool                  verbose()                const { return _verbose; }
 		bool                  verbose_packets()        const { return _verbose_packets; }
 		bool                  verbose_packet_drop()    const { return _verbose_packet_drop; }
@@ -16,6 +16,7 @@
 
 /* local includes */
 #include <ipv4_address_prefix.h>
+#include <ipv4_prefix_trie.h>
 #include <list.h>
 
 /* Genode includes */
@@ -69,34 +70,46 @@ struct Net::Direct_rule : Direct_rule_base,
 
 
 template <typename T>
-struct Net::Direct_rule_list : List<T>
+class Net::Direct_rule_list : public List<T>
 {
-	using Base = List<T>;
+	private:
 
-	struct No_match : Genode::Exception { };
+		using Base = List<T>;
 
-	T const &longest_prefix_match(Ipv4_address const &ip) const
-	{
-		/* first match is sufficient as the list is prefix-size-sorted */
-		for (T const *curr = Base::first(); curr; curr = curr->next()) {
-			if (curr->dst().prefix_matches(ip)) {
-				return *curr; }
+		Ipv4_prefix_trie<T const> _trie { };
+
+	public:
+
+		struct No_match : Genode::Exception { };
+
+		T const &longest_prefix_match(Ipv4_address const &ip) const
+		{
+			T const *const rule = _trie.longest_prefix_match(ip);
+			if (!rule) {
+				throw No_match(); }
+
+			return *rule;
+		}
+
+		void insert(T &rule, Genode::Allocator &alloc)
+		{
+			/* ensure that the list stays prefix-size-sorted (descending) */
+			T *behind = nullptr;
+			for (T *curr = Base::first(); curr; curr = curr->next()) {
+				if (rule.dst().prefix >= curr->dst().prefix) {
+					break; }
+
+				behind = curr;
+			}
+			_trie.insert(alloc, rule.dst(), rule);
+			Base::insert(&rule, behind);
 		}
-		throw No_match();
-	}
-
-	void insert(T &rule)
-	{
-		/* ensure that the list stays prefix-size-sorted (descending) */
-		T *behind = nullptr;
-		for (T *curr = Base::first(); curr; curr = curr->next()) {
-			if (rule.dst().prefix >= curr->dst().prefix) {
-				break; }
-
-			behind = curr;
+
+		void destroy_each(Genode::Deallocator &dealloc)
+		{
+			_trie.destroy_each(dealloc);
+			Base::destroy_each(dealloc);
 		}
-		Base::insert(&rule, behind);
-	}
 };
 
 #endif /* _RULE_H_ */
@@ -0,0 +1,103 @@
+/*
+ * \brief  Doubly linked list with constant-time removal
+ * \author Genode Labs
+ * \date   2019-10-06
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DLIST_H_
+#define _DLIST_H_
+
+namespace Net { template <typename> class Dlist; }
+
+
+/**
+ * Intrusive list that, unlike 'Genode::List', removes elements without
+ * walking the list
+ */
+template <typename T>
+class Net::Dlist
+{
+	public:
+
+		class Element
+		{
+			friend class Dlist;
+
+			private:
+
+				T *_next { nullptr };
+				T *_prev { nullptr };
+
+				/*
+				 * Noncopyable
+				 */
+				Element(Element const &);
+				Element &operator = (Element const &);
+
+			public:
+
+				Element() { }
+
+				T *next() const { return _next; }
+		};
+
+	private:
+
+		T *_first { nullptr };
+
+		static Element &_elem(T &obj) { return static_cast<Element &>(obj); }
+
+	public:
+
+		T *first() const { return _first; }
+
+		bool empty() const { return !_first; }
+
+		/**
+		 * Insert 'obj' at the head of the list
+		 */
+		void insert(T *obj)
+		{
+			Element &elem = _elem(*obj);
+			elem._prev = nullptr;
+			elem._next = _first;
+			if (_first) {
+				_elem(*_first)._prev = obj; }
+
+			_first = obj;
+		}
+
+		void remove(T *obj)
+		{
+			Element &elem = _elem(*obj);
+			if (elem._prev) {
+				_elem(*elem._prev)._next = elem._next; }
+			else {
+				_first = elem._next; }
+
+			if (elem._next) {
+				_elem(*elem._next)._prev = elem._prev; }
+
+			elem._next = nullptr;
+			elem._prev = nullptr;
+		}
+
+		template <typename FUNC>
+		void for_each(FUNC && functor)
+		{
+			for (T *obj = _first; obj; ) {
+				T *const next = _elem(*obj)._next;
+				functor(*obj);
+				obj = next;
+			}
+		}
+};
+
+#endif /* _DLIST_H_ */
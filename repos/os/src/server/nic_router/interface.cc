@@ -134,27 +134,34 @@ static void _link_packet(L3_protocol  const  prot,
 }
 
 
-static void _update_checksum(L3_protocol   const prot,
-                             void         *const prot_base,
-                             size_t        const prot_size,
-                             Ipv4_address  const src,
-                             Ipv4_address  const dst,
-                             size_t        const ip_size)
+/**
+ * Adapt the checksum of a transport packet to the rewriting of its headers
+ *
+ * The checksum is adapted incrementally instead of being recomputed over
+ * the whole packet. Only a UDP packet without checksum gets a fully
+ * recomputed checksum.
+ */
+static void _update_checksum(L3_protocol            const  prot,
+                             void                  *const  prot_base,
+                             Ipv4_packet           const  &ip,
+                             Internet_checksum_diff const &icd)
 {
 	switch (prot) {
 	case L3_protocol::TCP:
-		((Tcp_packet *)prot_base)->update_checksum(src, dst, prot_size);
+		((Tcp_packet *)prot_base)->update_checksum(icd);
 		return;
 	case L3_protocol::UDP:
-		((Udp_packet *)prot_base)->update_checksum(src, dst);
-		return;
-	case L3_protocol::ICMP:
 		{
-			Icmp_packet &icmp = *(Icmp_packet *)prot_base;
-			icmp.update_checksum(ip_size - sizeof(Ipv4_packet) -
-			                               sizeof(Icmp_packet));
+			Udp_packet &udp = *(Udp_packet *)prot_base;
+			if (udp.checksum()) {
+				udp.update_checksum(icd); }
+			else {
+				udp.update_checksum(ip.src(), ip.dst()); }
 			return;
 		}
+	case L3_protocol::ICMP:
+		((Icmp_packet *)prot_base)->update_checksum(icd);
+		return;
 	default: throw Interface::Bad_transport_protocol(); }
 }
 
@@ -203,6 +210,58 @@ static void _src_port(L3_protocol  const prot,
 }
 
 
+static void _src_port(L3_protocol             const  prot,
+                      void                   *const  prot_base,
+                      Port                    const  port,
+                      Internet_checksum_diff        &icd)
+{
+	Genode::uint16_t const old_port = host_to_big_endian(_src_port(prot, prot_base).value);
+	Genode::uint16_t const new_port = host_to_big_endian(port.value);
+	_src_port(prot, prot_base, port);
+	icd.add_up_diff(&new_port, &old_port, sizeof(new_port));
+}
+
+
+static void _dst_port(L3_protocol             const  prot,
+                      void                   *const  prot_base,
+                      Port                    const  port,
+                      Internet_checksum_diff        &icd)
+{
+	Genode::uint16_t const old_port = host_to_big_endian(_dst_port(prot, prot_base).value);
+	Genode::uint16_t const new_port = host_to_big_endian(port.value);
+	_dst_port(prot, prot_base, port);
+	icd.add_up_diff(&new_port, &old_port, sizeof(new_port));
+}
+
+
+/*
+ * Only the checksums of TCP and UDP cover the IP addresses (pseudo header)
+ */
+
+static void _src_ip(L3_protocol     const  prot,
+                    Ipv4_packet           &ip,
+                    Ipv4_address    const &src,
+                    Internet_checksum_diff &icd)
+{
+	if (prot != L3_protocol::ICMP) {
+		icd.add_up_diff(src.addr, ip.src().addr, Ipv4_packet::ADDR_LEN); }
+
+	ip.src(src);
+}
+
+
+static void _dst_ip(L3_protocol     const  prot,
+                    Ipv4_packet           &ip,
+                    Ipv4_address    const &dst,
+                    Internet_checksum_diff &icd)
+{
+	if (prot != L3_protocol::ICMP) {
+		icd.add_up_diff(dst.addr, ip.dst().addr, Ipv4_packet::ADDR_LEN); }
+
+	ip.dst(dst);
+}
+
+
 static void *_prot_base(L3_protocol const  prot,
                         Size_guard        &size_guard,
                         Ipv4_packet       &ip)
@@ -273,15 +332,11 @@ void Interface::_destroy_link(Link &link)
 }
 
 
-void Interface::_pass_prot(Ethernet_frame       &eth,
-                           Size_guard           &size_guard,
-                           Ipv4_packet          &ip,
-                           L3_protocol    const  prot,
-                           void          *const  prot_base,
-                           size_t         const  prot_size)
+void Interface::_pass_prot(Ethernet_frame &eth,
+                           Size_guard     &size_guard,
+                           Ipv4_packet    &ip)
 {
 	eth.src(_router_mac);
-	_update_checksum(prot, prot_base, prot_size, ip.src(), ip.dst(), ip.total_length());
 	_pass_ip(eth, size_guard, ip);
 }
 
@@ -444,7 +499,7 @@ Interface::_new_link(L3_protocol             const  protocol,
 		try {
 			new (_alloc)
 				Tcp_link { *this, local, remote_port_alloc, remote_domain,
-				           remote, _timer, _config(), protocol, _tcp_stats };
+				           remote, _link_timeouts, _config(), protocol, _tcp_stats };
 		}
 		catch (Out_of_ram)  { throw Free_resources_and_retry_handle_eth(L3_protocol::TCP); }
 		catch (Out_of_caps) { throw Free_resources_and_retry_handle_eth(L3_protocol::TCP); }
@@ -454,7 +509,7 @@ Interface::_new_link(L3_protocol             const  protocol,
 		try {
 			new (_alloc)
 				Udp_link { *this, local, remote_port_alloc, remote_domain,
-				           remote, _timer, _config(), protocol, _udp_stats };
+				           remote, _link_timeouts, _config(), protocol, _udp_stats };
 		}
 		catch (Out_of_ram)  { throw Free_resources_and_retry_handle_eth(L3_protocol::UDP); }
 		catch (Out_of_caps) { throw Free_resources_and_retry_handle_eth(L3_protocol::UDP); }
@@ -464,7 +519,7 @@ Interface::_new_link(L3_protocol             const  protocol,
 		try {
 			new (_alloc)
 				Icmp_link { *this, local, remote_port_alloc, remote_domain,
-				            remote, _timer, _config(), protocol, _icmp_stats };
+				            remote, _link_timeouts, _config(), protocol, _icmp_stats };
 		}
 		catch (Out_of_ram)  { throw Free_resources_and_retry_handle_eth(L3_protocol::ICMP); }
 		catch (Out_of_caps) { throw Free_resources_and_retry_handle_eth(L3_protocol::ICMP); }
@@ -525,15 +580,15 @@ void Interface::_adapt_eth(Ethernet_frame          &eth,
 }
 
 
-void Interface::_nat_link_and_pass(Ethernet_frame        &eth,
-                                   Size_guard            &size_guard,
-                                   Ipv4_packet           &ip,
-                                   L3_protocol     const  prot,
-                                   void           *const  prot_base,
-                                   size_t          const  prot_size,
-                                   Link_side_id    const &local_id,
-                                   Domain                &local_domain,
-                                   Domain                &remote_domain)
+void Interface::_nat_link_and_pass(Ethernet_frame         &eth,
+                                   Size_guard             &size_guard,
+                                   Ipv4_packet            &ip,
+                                   L3_protocol      const  prot,
+                                   void            *const  prot_base,
+                                   Link_side_id     const &local_id,
+                                   Domain                 &local_domain,
+                                   Domain                 &remote_domain,
+                                   Internet_checksum_diff &icd)
 {
 	try {
 		Pointer<Port_allocator_guard> remote_port_alloc;
@@ -542,16 +597,17 @@ void Interface::_nat_link_and_pass(Ethernet_frame        &eth,
 			if(_config().verbose()) {
 				log("[", local_domain, "] using NAT rule: ", nat); }
 
-			_src_port(prot, prot_base, nat.port_alloc(prot).alloc());
-			ip.src(remote_domain.ip_config().interface.address);
+			_src_port(prot, prot_base, nat.port_alloc(prot).alloc(), icd);
+			_src_ip(prot, ip, remote_domain.ip_config().interface.address, icd);
 			remote_port_alloc = nat.port_alloc(prot);
 		}
 		catch (Nat_rule_tree::No_match) { }
 		Link_side_id const remote_id = { ip.dst(), _dst_port(prot, prot_base),
 		                                 ip.src(), _src_port(prot, prot_base) };
 		_new_link(prot, local_id, remote_port_alloc, remote_domain, remote_id);
+		_update_checksum(prot, prot_base, ip, icd);
 		remote_domain.interfaces().for_each([&] (Interface &interface) {
-			interface._pass_prot(eth, size_guard, ip, prot, prot_base, prot_size);
+			interface._pass_prot(eth, size_guard, ip);
 		});
 	} catch (Port_allocator_guard::Out_of_indices) {
 		switch (prot) {
@@ -906,7 +962,6 @@ void Interface::_handle_icmp_query(Ethernet_frame          &eth,
                                    Packet_descriptor const &pkt,
                                    L3_protocol              prot,
                                    void                    *prot_base,
-                                   size_t                   prot_size,
                                    Domain                  &local_domain)
 {
 	Link_side_id const local_id = { ip.src(), _src_port(prot, prot_base),
@@ -924,18 +979,20 @@ void Interface::_handle_icmp_query(Ethernet_frame          &eth,
 			    " link: ", link);
 		}
 		_adapt_eth(eth, remote_side.src_ip(), pkt, remote_domain);
-		ip.src(remote_side.dst_ip());
-		ip.dst(remote_side.src_ip());
-		_src_port(prot, prot_base, remote_side.dst_port());
-		_dst_port(prot, prot_base, remote_side.src_port());
+		Internet_checksum_diff icd { };
+		_src_ip(prot, ip, remote_side.dst_ip(), icd);
+		_dst_ip(prot, ip, remote_side.src_ip(), icd);
+		_src_port(prot, prot_base, remote_side.dst_port(), icd);
+		_dst_port(prot, prot_base, remote_side.src_port(), icd);
+		_update_checksum(prot, prot_base, ip, icd);
 
 		remote_domain.interfaces().for_each([&] (Interface &interface) {
-			interface._pass_prot(eth, size_guard, ip, prot, prot_base, prot_size);
+			interface._pass_prot(eth, size_guard, ip);
 		});
 		_link_packet(prot, prot_base, link, client);
 		return;
 	}
-	catch (Link_side_tree::No_match) { }
+	catch (Link_side_table::No_match) { }
 
 	/* try to route via ICMP rules */
 	try {
@@ -947,8 +1004,9 @@ void Interface::_handle_icmp_query(Ethernet_frame          &eth,
 
 		Domain &remote_domain = rule.domain();
 		_adapt_eth(eth, local_id.dst_ip, pkt, remote_domain);
-		_nat_link_and_pass(eth, size_guard, ip, prot, prot_base, prot_size,
-		                   local_id, local_domain, remote_domain);
+		Internet_checksum_diff icd { };
+		_nat_link_and_pass(eth, size_guard, ip, prot, prot_base,
+		                   local_id, local_domain, remote_domain, icd);
 
 		return;
 	}
@@ -1016,7 +1074,7 @@ void Interface::_handle_icmp_error(Ethernet_frame          &eth,
 			_link_packet(embed_prot, embed_prot_base, link, client); }
 	}
 	/* drop packet if there is no matching link */
-	catch (Link_side_tree::No_match) {
+	catch (Link_side_table::No_match) {
 		throw Drop_packet("no link that matches packet embedded in ICMP error"); }
 }
 
@@ -1050,7 +1108,7 @@ void Interface::_handle_icmp(Ethernet_frame            &eth,
 	/* try to act as ICMP router */
 	switch (icmp.type()) {
 	case Icmp_packet::Type::ECHO_REPLY:
-	case Icmp_packet::Type::ECHO_REQUEST:    _handle_icmp_query(eth, size_guard, ip, pkt, prot, prot_base, prot_size, local_domain); break;
+	case Icmp_packet::Type::ECHO_REQUEST:    _handle_icmp_query(eth, size_guard, ip, pkt, prot, prot_base, local_domain); break;
 	case Icmp_packet::Type::DST_UNREACHABLE: _handle_icmp_error(eth, size_guard, ip, pkt, local_domain, icmp, prot_size); break;
 	default: Drop_packet("unhandled type in ICMP"); }
 }
@@ -1124,18 +1182,20 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 				    " link: ", link);
 			}
 			_adapt_eth(eth, remote_side.src_ip(), pkt, remote_domain);
-			ip.src(remote_side.dst_ip());
-			ip.dst(remote_side.src_ip());
-			_src_port(prot, prot_base, remote_side.dst_port());
-			_dst_port(prot, prot_base, remote_side.src_port());
+			Internet_checksum_diff icd { };
+			_src_ip(prot, ip, remote_side.dst_ip(), icd);
+			_dst_ip(prot, ip, remote_side.src_ip(), icd);
+			_src_port(prot, prot_base, remote_side.dst_port(), icd);
+			_dst_port(prot, prot_base, remote_side.src_port(), icd);
+			_update_checksum(prot, prot_base, ip, icd);
 
 			remote_domain.interfaces().for_each([&] (Interface &interface) {
-				interface._pass_prot(eth, size_guard, ip, prot, prot_base, prot_size);
+				interface._pass_prot(eth, size_guard, ip);
 			});
 			_link_packet(prot, prot_base, link, client);
 			return;
 		}
-		catch (Link_side_tree::No_match) { }
+		catch (Link_side_table::No_match) { }
 
 		/* try to route via forward rules */
 		if (local_id.dst_ip == local_intf.address) {
@@ -1149,12 +1209,13 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 				}
 				Domain &remote_domain = rule.domain();
 				_adapt_eth(eth, rule.to_ip(), pkt, remote_domain);
-				ip.dst(rule.to_ip());
+				Internet_checksum_diff icd { };
+				_dst_ip(prot, ip, rule.to_ip(), icd);
 				if (!(rule.to_port() == Port(0))) {
-					_dst_port(prot, prot_base, rule.to_port());
+					_dst_port(prot, prot_base, rule.to_port(), icd);
 				}
 				_nat_link_and_pass(eth, size_guard, ip, prot, prot_base,
-				                   prot_size, local_id, local_domain, remote_domain);
+				                   local_id, local_domain, remote_domain, icd);
 				return;
 			}
 			catch (Forward_rule_tree::No_match) { }
@@ -1173,8 +1234,9 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 			}
 			Domain &remote_domain = permit_rule.domain();
 			_adapt_eth(eth, local_id.dst_ip, pkt, remote_domain);
-			_nat_link_and_pass(eth, size_guard, ip, prot, prot_base, prot_size,
-			                   local_id, local_domain, remote_domain);
+			Internet_checksum_diff icd { };
+			_nat_link_and_pass(eth, size_guard, ip, prot, prot_base,
+			                   local_id, local_domain, remote_domain, icd);
 			return;
 		}
 		catch (Transport_rule_list::No_match) { }
@@ -1425,8 +1487,8 @@ void Interface::_continue_handle_eth(Domain            const &domain,
 
 void Interface::_ready_to_ack()
 {
-	while (_source.ack_avail()) {
-		_source.release_packet(_source.get_acked_packet()); }
+	_source.drain_acked_packets([&] (Packet_descriptor const &pkt) {
+		_source.release_packet(pkt); });
 }
 
 
@@ -1613,6 +1675,10 @@ void Interface::_send_submit_pkt(Packet_descriptor &pkt,
 		}
 		catch (Size_guard::Exceeded) { log("[", local_domain, "] snd ?"); }
 	}
+	if (_source_moderation.enabled() && _source.try_submit_packet(pkt)) {
+		_source_moderation.wakeup();
+		return;
+	}
 	_source.submit_packet(pkt);
 }
 
@@ -1644,10 +1710,21 @@ Interface::Interface(Genode::Entrypoint     &ep,
 	_alloc              { alloc },
 	_interfaces         { interfaces }
 {
+	_configure_signal_moderation();
 	_interfaces.insert(this);
 }
 
 
+void Interface::_configure_signal_moderation()
+{
+	Configuration const &config = _config();
+	_sink_moderation.configure(config.signal_moderation_us(),
+	                           config.signal_moderation_pkts());
+	_source_moderation.configure(config.signal_moderation_us(),
+	                             config.signal_moderation_pkts());
+}
+
+
 void Interface::_dismiss_link_log(Link       &link,
                                   char const *reason)
 {
@@ -1867,6 +1944,7 @@ void Interface::handle_config_1(Configuration &config)
 {
 	/* update config and policy */
 	_config = config;
+	_configure_signal_moderation();
 	_policy.handle_config(config);
 	Domain_name const &new_domain_name = _policy.determine_domain_name();
 	try {
@@ -1987,6 +2065,10 @@ void Interface::_ack_packet(Packet_descriptor const &pkt)
 		}
 		return;
 	}
+	if (_sink_moderation.enabled() && _sink.try_ack_packet(pkt)) {
+		_sink_moderation.wakeup();
+		return;
+	}
 	_sink.acknowledge_packet(pkt);
 }
 
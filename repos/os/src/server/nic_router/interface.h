@@ -25,6 +25,7 @@
 
 /* Genode includes */
 #include <nic_session/nic_session.h>
+#include <os/packet_stream_moderation.h>
 #include <net/dhcp.h>
 #include <net/icmp.h>
 
@@ -35,6 +36,8 @@ namespace Net {
 	using Packet_descriptor    = ::Nic::Packet_descriptor;
 	using Packet_stream_sink   = ::Nic::Packet_stream_sink< ::Nic::Session::Policy>;
 	using Packet_stream_source = ::Nic::Packet_stream_source< ::Nic::Session::Policy>;
+	using Sink_moderation      = Genode::Packet_stream_moderation<Packet_stream_sink>;
+	using Source_moderation    = Genode::Packet_stream_moderation<Packet_stream_source>;
 	using Domain_name          = Genode::String<160>;
 	class Ipv4_config;
 	class Forward_rule_tree;
@@ -140,9 +143,12 @@ class Net::Interface : private Interface_list::Element
 		Reference<Configuration>              _config;
 		Interface_policy                     &_policy;
 		Timer::Connection                    &_timer;
+		Sink_moderation                       _sink_moderation           { _sink, _timer };
+		Source_moderation                     _source_moderation         { _source, _timer };
 		Genode::Allocator                    &_alloc;
 		Pointer<Domain>                       _domain                    { };
 		Arp_waiter_list                       _own_arp_waiters           { };
+		Link_timeout_wheel                    _link_timeouts             { _timer };
 		Link_list                             _tcp_links                 { };
 		Link_list                             _udp_links                 { };
 		Link_list                             _icmp_links                { };
@@ -232,7 +238,6 @@ class Net::Interface : private Interface_list::Element
 		                        Packet_descriptor const &pkt,
 		                        L3_protocol              prot,
 		                        void                    *prot_base,
-		                        Genode::size_t           prot_size,
 		                        Domain                  &local_domain);
 
 		void _handle_icmp_error(Ethernet_frame          &eth,
@@ -263,10 +268,10 @@ class Net::Interface : private Interface_list::Element
 		                        Ipv4_packet            &ip,
 		                        L3_protocol      const  prot,
 		                        void            *const  prot_base,
-		                        Genode::size_t   const  prot_size,
 		                        Link_side_id     const &local_id,
 		                        Domain                 &local_domain,
-		                        Domain                 &remote_domain);
+		                        Domain                 &remote_domain,
+		                        Internet_checksum_diff &icd);
 
 		void _broadcast_arp_request(Ipv4_address const &src_ip,
 		                            Ipv4_address const &dst_ip);
@@ -275,12 +280,9 @@ class Net::Interface : private Interface_list::Element
 		                       Size_guard     &size_guard,
 		                       Domain         &local_domain);
 
-		void _pass_prot(Ethernet_frame         &eth,
-		                Size_guard             &size_guard,
-		                Ipv4_packet            &ip,
-		                L3_protocol      const  prot,
-		                void            *const  prot_base,
-		                Genode::size_t   const  prot_size);
+		void _pass_prot(Ethernet_frame &eth,
+		                Size_guard     &size_guard,
+		                Ipv4_packet    &ip);
 
 		void _pass_ip(Ethernet_frame       &eth,
 		              Size_guard           &size_guard,
@@ -304,6 +306,8 @@ class Net::Interface : private Interface_list::Element
 
 		void _ack_packet(Packet_descriptor const &pkt);
 
+		void _configure_signal_moderation();
+
 		void _send_alloc_pkt(Genode::Packet_descriptor   &pkt,
 		                     void                      * &pkt_base,
 		                     Genode::size_t               pkt_size);
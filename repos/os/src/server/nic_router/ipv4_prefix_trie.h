@@ -0,0 +1,174 @@
+/*
+ * \brief  Path-compressed binary trie for IPv4 longest-prefix matching
+ * \author Genode Labs
+ * \date   2019-10-05
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _IPV4_PREFIX_TRIE_H_
+#define _IPV4_PREFIX_TRIE_H_
+
+/* local includes */
+#include <ipv4_address_prefix.h>
+
+/* Genode includes */
+#include <base/allocator.h>
+
+namespace Net { template <typename> class Ipv4_prefix_trie; }
+
+
+/**
+ * Map of IPv4 address prefixes to objects of type 'T'
+ *
+ * Each node covers the prefix that all addresses in its sub-trie have in
+ * common. Chains of nodes with only one child are skipped, so a lookup
+ * visits at most one node per distinct prefix length on the path to the
+ * address, regardless of the number of prefixes in the trie.
+ */
+template <typename T>
+class Net::Ipv4_prefix_trie
+{
+	private:
+
+		using uint32_t = Genode::uint32_t;
+
+		struct Node
+		{
+			uint32_t const  key;
+			unsigned const  length;
+			T              *object   { nullptr };
+			Node           *child[2] { nullptr, nullptr };
+
+			Node(uint32_t key, unsigned length, T *object)
+			: key(key), length(length), object(object) { }
+		};
+
+		Node *_root { nullptr };
+
+		static uint32_t _key(Ipv4_address const &ip)
+		{
+			return (uint32_t)ip.addr[0] << 24 | (uint32_t)ip.addr[1] << 16 |
+			       (uint32_t)ip.addr[2] <<  8 | (uint32_t)ip.addr[3];
+		}
+
+		static uint32_t _mask(unsigned length) {
+			return length ? ~0U << (32 - length) : 0; }
+
+		static unsigned _bit(uint32_t key, unsigned index) {
+			return (key >> (31 - index)) & 1; }
+
+		static unsigned _common_length(uint32_t a, uint32_t b, unsigned max)
+		{
+			unsigned length = 0;
+			for (uint32_t diff = a ^ b; length < max; length++) {
+				if (diff & (1U << (31 - length))) {
+					break; }
+			}
+			return length;
+		}
+
+		static void _destroy(Genode::Deallocator &dealloc, Node *node)
+		{
+			if (!node) {
+				return; }
+
+			_destroy(dealloc, node->child[0]);
+			_destroy(dealloc, node->child[1]);
+			destroy(dealloc, node);
+		}
+
+		/*
+		 * Noncopyable
+		 */
+		Ipv4_prefix_trie(Ipv4_prefix_trie const &);
+		Ipv4_prefix_trie &operator = (Ipv4_prefix_trie const &);
+
+	public:
+
+		Ipv4_prefix_trie() { }
+
+		/**
+		 * Map 'prefix' to 'object'
+		 *
+		 * An object that was mapped to the same prefix before is replaced.
+		 */
+		void insert(Genode::Allocator         &alloc,
+		            Ipv4_address_prefix const &prefix,
+		            T                         &object)
+		{
+			unsigned const length = prefix.prefix < 32 ? prefix.prefix : 32;
+			uint32_t const key    = _key(prefix.address) & _mask(length);
+
+			for (Node **link = &_root; ; ) {
+
+				Node *const node = *link;
+				if (!node) {
+					*link = new (alloc) Node(key, length, &object);
+					return;
+				}
+				unsigned const common =
+					_common_length(key, node->key, Genode::min(length, node->length));
+
+				/* the node covers the prefix, descend */
+				if (common == node->length) {
+					if (length == node->length) {
+						node->object = &object;
+						return;
+					}
+					link = &node->child[_bit(key, node->length)];
+					continue;
+				}
+				/* the prefix covers the node, insert it above the node */
+				if (common == length) {
+					Node &parent = *new (alloc) Node(key, length, &object);
+					parent.child[_bit(node->key, length)] = node;
+					*link = &parent;
+					return;
+				}
+				/* the prefix and the node diverge, insert a branch */
+				Node &branch = *new (alloc) Node(key & _mask(common), common, nullptr);
+				branch.child[_bit(key, common)]       = new (alloc) Node(key, length, &object);
+				branch.child[_bit(node->key, common)] = node;
+				*link = &branch;
+				return;
+			}
+		}
+
+		/**
+		 * Return object with the longest prefix matching 'ip' or nullptr
+		 */
+		T *longest_prefix_match(Ipv4_address const &ip) const
+		{
+			uint32_t const key  = _key(ip);
+			T             *best = nullptr;
+
+			for (Node const *node = _root; node; ) {
+
+				if ((key ^ node->key) & _mask(node->length)) {
+					break; }
+
+				if (node->object) {
+					best = node->object; }
+
+				if (node->length == 32) {
+					break; }
+
+				node = node->child[_bit(key, node->length)];
+			}
+			return best;
+		}
+
+		void destroy_each(Genode::Deallocator &dealloc)
+		{
+			_destroy(dealloc, _root);
+			_root = nullptr;
+		}
+};
+
+#endif /* _IPV4_PREFIX_TRIE_H_ */
@@ -62,44 +62,239 @@ Link_side::Link_side(Domain             &domain,
 }
 
 
-Link_side const &Link_side::find_by_id(Link_side_id const &id) const
+void Link_side::print(Output &output) const
 {
-	if (id == _id) {
-		return *this; }
+	Genode::print(output, "src ", src_ip(), ":", src_port(),
+	                     " dst ", dst_ip(), ":", dst_port());
+}
 
-	bool const side = id > _id;
-	Link_side *const link_side = Avl_node<Link_side>::child(side);
-	if (!link_side) {
-		throw Link_side_tree::No_match(); }
 
-	return link_side->find_by_id(id);
+bool Link_side::is_client() const
+{
+	return this == &_link.client();
 }
 
 
-void Link_side::print(Output &output) const
+/*********************
+ ** Link_side_table **
+ *********************/
+
+static inline uint32_t mix_hash(uint32_t hash, uint32_t value)
 {
-	Genode::print(output, "src ", src_ip(), ":", src_port(),
-	                     " dst ", dst_ip(), ":", dst_port());
+	value *= 0xcc9e2d51;
+	value  = (value << 15) | (value >> 17);
+	value *= 0x1b873593;
+	hash  ^= value;
+	hash   = (hash << 13) | (hash >> 19);
+	return hash * 5 + 0xe6546b64;
 }
 
 
-bool Link_side::is_client() const
+static inline uint32_t ip_to_uint32(Ipv4_address const &ip)
 {
-	return this == &_link.client();
+	return (uint32_t)ip.addr[0]       | (uint32_t)ip.addr[1] <<  8 |
+	       (uint32_t)ip.addr[2] << 16 | (uint32_t)ip.addr[3] << 24;
+}
+
+
+uint32_t Link_side_table::_hash(Link_side_id const &id)
+{
+	uint32_t hash = 0;
+	hash = mix_hash(hash, ip_to_uint32(id.src_ip));
+	hash = mix_hash(hash, ip_to_uint32(id.dst_ip));
+	hash = mix_hash(hash, (uint32_t)id.src_port.value << 16 | id.dst_port.value);
+
+	/* final avalanche, the bucket index is taken from the low bits */
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+
+void Link_side_table::_resize(size_t num_buckets)
+{
+	Link_side **buckets = nullptr;
+	try {
+		if (!_alloc.alloc(num_buckets * sizeof(Link_side *), (void **)&buckets)) {
+			return; }
+	}
+	catch (Out_of_ram)  { return; }
+	catch (Out_of_caps) { return; }
+
+	for (size_t i = 0; i < num_buckets; i++) {
+		buckets[i] = nullptr; }
+
+	Link_side **const old_buckets     = _buckets;
+	size_t      const old_num_buckets = _num_buckets;
+
+	_buckets     = buckets;
+	_num_buckets = num_buckets;
+
+	for (size_t i = 0; i < old_num_buckets; i++) {
+		while (Link_side *side = old_buckets[i]) {
+			old_buckets[i] = side->_hash_next;
+			Link_side *&bucket = _bucket(side->_id);
+			side->_hash_next = bucket;
+			bucket = side;
+		}
+	}
+	if (old_buckets != _min_buckets) {
+		_alloc.free(old_buckets, old_num_buckets * sizeof(Link_side *)); }
+}
+
+
+Link_side_table::~Link_side_table()
+{
+	if (_buckets != _min_buckets) {
+		_alloc.free(_buckets, _num_buckets * sizeof(Link_side *)); }
+}
+
+
+void Link_side_table::insert(Link_side *side)
+{
+	/* keep the average length of the hash chains below 1 */
+	if (_count >= _num_buckets) {
+		_resize(_num_buckets * 2); }
+
+	Link_side *&bucket = _bucket(side->_id);
+	side->_hash_next = bucket;
+	bucket = side;
+	_count++;
+}
+
+
+void Link_side_table::remove(Link_side *side)
+{
+	for (Link_side **curr = &_bucket(side->_id); *curr;
+	     curr = &(*curr)->_hash_next)
+	{
+		if (*curr != side) {
+			continue; }
+
+		*curr = side->_hash_next;
+		side->_hash_next = nullptr;
+		_count--;
+		return;
+	}
+}
+
+
+Link_side const &Link_side_table::find_by_id(Link_side_id const &id) const
+{
+	for (Link_side const *side = _bucket(id); side; side = side->_hash_next) {
+		if (side->_id == id) {
+			return *side; }
+	}
+	throw No_match();
+}
+
+
+/******************
+ ** Link_timeout **
+ ******************/
+
+Link_timeout::~Link_timeout()
+{
+	if (_scheduled) {
+		_wheel._remove(*this); }
 }
 
 
-/********************
- ** Link_side_tree **
- ********************/
+void Link_timeout::schedule(Microseconds duration)
+{
+	_wheel._schedule(*this, duration);
+}
+
 
-Link_side const &Link_side_tree::find_by_id(Link_side_id const &id) const
+/************************
+ ** Link_timeout_wheel **
+ ************************/
+
+void Link_timeout_wheel::_insert(Link_timeout &timeout, uint64_t tick)
 {
-	Link_side *const link_side = first();
-	if (!link_side) {
-		throw No_match(); }
+	timeout._slot_tick = tick > _tick ? tick : _tick + 1;
+	timeout._scheduled = true;
+	_slot(timeout._slot_tick).insert(&timeout);
+
+	if (!_count++ && !_timeout.scheduled()) {
+		_timeout.schedule(Microseconds(TICK_US)); }
+}
+
+
+void Link_timeout_wheel::_remove(Link_timeout &timeout)
+{
+	_slot(timeout._slot_tick).remove(&timeout);
+	timeout._scheduled = false;
+	_count--;
+}
+
 
-	return link_side->find_by_id(id);
+void Link_timeout_wheel::_schedule(Link_timeout &timeout,
+                                   Microseconds  duration)
+{
+	/* the tick is not advanced while the wheel is empty */
+	if (!_count) {
+		_tick = _curr_tick(); }
+
+	/* round up and account for the elapsed part of the current tick */
+	uint64_t const ticks = (duration.value + TICK_US - 1) / TICK_US + 1;
+
+	timeout._expiry_tick = _tick + ticks;
+
+	if (timeout._scheduled) {
+
+		/* the timeout is moved lazily when its current slot is due */
+		if (timeout._expiry_tick >= timeout._slot_tick) {
+			return; }
+
+		_remove(timeout);
+	}
+	_insert(timeout, timeout._expiry_tick);
+}
+
+
+void Link_timeout_wheel::_handle_timeout(Duration)
+{
+	uint64_t const now = _curr_tick();
+
+	/* visit each slot at most once even if many ticks passed */
+	uint64_t tick = now - _tick > NUM_SLOTS ? now - NUM_SLOTS : _tick;
+
+	while (tick < now) {
+
+		_tick = ++tick;
+
+		/* detach the slot as expired timeouts may re-enter the wheel */
+		Slot due { };
+		Slot &slot = _slot(tick);
+		while (Link_timeout *timeout = slot.first()) {
+			slot.remove(timeout);
+			due.insert(timeout);
+		}
+		while (Link_timeout *timeout = due.first()) {
+			due.remove(timeout);
+
+			/* timeout belongs to a later round of the wheel */
+			if (timeout->_slot_tick > now) {
+				slot.insert(timeout);
+				continue;
+			}
+			if (timeout->_expiry_tick > now) {
+				timeout->_slot_tick = timeout->_expiry_tick;
+				_slot(timeout->_slot_tick).insert(timeout);
+				continue;
+			}
+			timeout->_scheduled = false;
+			_count--;
+			timeout->_link.handle_dissolve_timeout();
+		}
+	}
+	_tick = now;
+	if (_count) {
+		_timeout.schedule(Microseconds(TICK_US)); }
 }
 
 
@@ -118,7 +313,7 @@ Link::Link(Interface                     &cln_interface,
            Pointer<Port_allocator_guard>  srv_port_alloc,
            Domain                        &srv_domain,
            Link_side_id            const &srv_id,
-           Timer::Connection             &timer,
+           Link_timeout_wheel            &timeouts,
            Configuration                 &config,
            L3_protocol             const  protocol,
            Microseconds            const  dissolve_timeout,
@@ -127,7 +322,7 @@ Link::Link(Interface                     &cln_interface,
 	_config(config),
 	_client_interface(cln_interface),
 	_server_port_alloc(srv_port_alloc),
-	_dissolve_timeout(timer, *this, &Link::_handle_dissolve_timeout),
+	_dissolve_timeout(timeouts, *this),
 	_dissolve_timeout_us(dissolve_timeout),
 	_protocol(protocol),
 	_client(cln_interface.domain(), cln_id, *this),
@@ -146,7 +341,7 @@ Link::Link(Interface                     &cln_interface,
 Link::~Link() { _stats.destroyed++; }
 
 
-void Link::_handle_dissolve_timeout(Duration)
+void Link::handle_dissolve_timeout()
 {
 	dissolve(true);
 	_client_interface.links(_protocol).remove(this);
@@ -228,12 +423,12 @@ Tcp_link::Tcp_link(Interface                     &cln_interface,
                    Pointer<Port_allocator_guard>  srv_port_alloc,
                    Domain                        &srv_domain,
                    Link_side_id            const &srv_id,
-                   Timer::Connection             &timer,
+                   Link_timeout_wheel            &timeouts,
                    Configuration                 &config,
                    L3_protocol             const  protocol,
                    Interface_link_stats          &stats)
 :
-	Link(cln_interface, cln_id, srv_port_alloc, srv_domain, srv_id, timer,
+	Link(cln_interface, cln_id, srv_port_alloc, srv_domain, srv_id, timeouts,
 	     config, protocol, config.tcp_idle_timeout(), stats)
 { }
 
@@ -309,12 +504,12 @@ Udp_link::Udp_link(Interface                     &cln_interface,
                    Pointer<Port_allocator_guard>  srv_port_alloc,
                    Domain                        &srv_domain,
                    Link_side_id            const &srv_id,
-                   Timer::Connection             &timer,
+                   Link_timeout_wheel            &timeouts,
                    Configuration                 &config,
                    L3_protocol             const  protocol,
                    Interface_link_stats          &stats)
 :
-	Link(cln_interface, cln_id, srv_port_alloc, srv_domain, srv_id, timer,
+	Link(cln_interface, cln_id, srv_port_alloc, srv_domain, srv_id, timeouts,
 	     config, protocol, config.udp_idle_timeout(), stats)
 { }
 
@@ -340,12 +535,12 @@ Icmp_link::Icmp_link(Interface                     &cln_interface,
                      Pointer<Port_allocator_guard>  srv_port_alloc,
                      Domain                        &srv_domain,
                      Link_side_id            const &srv_id,
-                     Timer::Connection             &timer,
+                     Link_timeout_wheel            &timeouts,
                      Configuration                 &config,
                      L3_protocol             const  protocol,
                      Interface_link_stats          &stats)
 :
-	Link(cln_interface, cln_id, srv_port_alloc, srv_domain, srv_id, timer,
+	Link(cln_interface, cln_id, srv_port_alloc, srv_domain, srv_id, timeouts,
 	     config, protocol, config.icmp_idle_timeout(), stats)
 { }
 
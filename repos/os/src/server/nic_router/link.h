@@ -31,14 +31,13 @@
 #define _LINK_H_
 
 /* Genode includes */
+#include <base/allocator.h>
 #include <timer_session/connection.h>
-#include <util/avl_tree.h>
-#include <util/list.h>
 #include <net/ipv4.h>
 #include <net/port.h>
 
 /* local includes */
-#include <list.h>
+#include <dlist.h>
 #include <reference.h>
 #include <pointer.h>
 #include <l3_protocol.h>
@@ -53,9 +52,11 @@ namespace Net {
 	class  Interface;
 	class  Link_side_id;
 	class  Link_side;
-	class  Link_side_tree;
+	class  Link_side_table;
+	class  Link_timeout;
+	class  Link_timeout_wheel;
 	class  Link;
-	struct Link_list : List<Link> { };
+	struct Link_list : Dlist<Link> { };
 	class  Tcp_link;
 	class  Udp_link;
 	class  Icmp_link;
@@ -85,15 +86,23 @@ struct Net::Link_side_id
 __attribute__((__packed__));
 
 
-class Net::Link_side : public Genode::Avl_node<Link_side>
+class Net::Link_side
 {
 	friend class Link;
+	friend class Link_side_table;
 
 	private:
 
 		Reference<Domain>   _domain;
 		Link_side_id const  _id;
 		Link               &_link;
+		Link_side          *_hash_next { nullptr };
+
+		/*
+		 * Noncopyable
+		 */
+		Link_side(Link_side const &);
+		Link_side &operator = (Link_side const &);
 
 	public:
 
@@ -101,18 +110,9 @@ class Net::Link_side : public Genode::Avl_node<Link_side>
 		          Link_side_id const &id,
 		          Link               &link);
 
-		Link_side const &find_by_id(Link_side_id const &id) const;
-
 		bool is_client() const;
 
 
-		/**************
-		 ** Avl_node **
-		 **************/
-
-		bool higher(Link_side *side) { return side->_id > _id; }
-
-
 		/*********
 		 ** Log **
 		 *********/
@@ -133,11 +133,143 @@ class Net::Link_side : public Genode::Avl_node<Link_side>
 };
 
 
-struct Net::Link_side_tree : Genode::Avl_tree<Link_side>
+/**
+ * Hash table of the link sides of a domain, indexed by their ID
+ *
+ * The table starts with a bucket array embedded in the object and grows
+ * with the number of link sides. If the allocator cannot provide a larger
+ * bucket array, the table keeps working with longer hash chains.
+ */
+class Net::Link_side_table
 {
-	struct No_match : Genode::Exception { };
+	private:
+
+		enum { MIN_BUCKETS = 64 };
+
+		Genode::Allocator &_alloc;
+		Link_side         *_min_buckets[MIN_BUCKETS] { };
+		Link_side        **_buckets     { _min_buckets };
+		Genode::size_t     _num_buckets { MIN_BUCKETS };
+		Genode::size_t     _count       { 0 };
+
+		static Genode::uint32_t _hash(Link_side_id const &id);
 
-	Link_side const &find_by_id(Link_side_id const &id) const;
+		Link_side *&_bucket(Link_side_id const &id) const {
+			return _buckets[_hash(id) & (_num_buckets - 1)]; }
+
+		void _resize(Genode::size_t num_buckets);
+
+		/*
+		 * Noncopyable
+		 */
+		Link_side_table(Link_side_table const &);
+		Link_side_table &operator = (Link_side_table const &);
+
+	public:
+
+		struct No_match : Genode::Exception { };
+
+		Link_side_table(Genode::Allocator &alloc) : _alloc(alloc) { }
+
+		~Link_side_table();
+
+		void insert(Link_side *side);
+
+		void remove(Link_side *side);
+
+		Link_side const &find_by_id(Link_side_id const &id) const;
+};
+
+
+/**
+ * Idle timeout of a link, driven by a 'Link_timeout_wheel'
+ */
+class Net::Link_timeout : public Dlist<Link_timeout>::Element
+{
+	friend class Link_timeout_wheel;
+
+	private:
+
+		Link_timeout_wheel &_wheel;
+		Link               &_link;
+		Genode::uint64_t    _expiry_tick { 0 };
+		Genode::uint64_t    _slot_tick   { 0 };
+		bool                _scheduled   { false };
+
+		/*
+		 * Noncopyable
+		 */
+		Link_timeout(Link_timeout const &);
+		Link_timeout &operator = (Link_timeout const &);
+
+	public:
+
+		Link_timeout(Link_timeout_wheel &wheel, Link &link)
+		: _wheel(wheel), _link(link) { }
+
+		~Link_timeout();
+
+		/**
+		 * Let the timeout trigger once the link was idle for 'duration'
+		 *
+		 * Rescheduling is cheap: the new expiry time is only recorded and
+		 * the timeout is moved within the wheel when its slot is due.
+		 */
+		void schedule(Genode::Microseconds duration);
+};
+
+
+/**
+ * Timer wheel that triggers the idle timeouts of links
+ *
+ * Each slot of the wheel holds the timeouts that are due in the
+ * corresponding tick modulo the number of slots. Timeouts that were
+ * rescheduled to a later tick in the meantime are re-inserted at their new
+ * slot when their old slot is processed. The wheel advances only while it
+ * holds timeouts.
+ */
+class Net::Link_timeout_wheel
+{
+	friend class Link_timeout;
+
+	private:
+
+		enum { NUM_SLOTS = 512, TICK_US = 100 * 1000 };
+
+		using Slot = Dlist<Link_timeout>;
+
+		Timer::Connection                            &_timer;
+		Timer::One_shot_timeout<Link_timeout_wheel>   _timeout;
+		Slot                                          _slots[NUM_SLOTS] { };
+		Genode::uint64_t                              _tick  { 0 };
+		Genode::size_t                                _count { 0 };
+
+		Genode::uint64_t _curr_tick() {
+			return _timer.curr_time().trunc_to_plain_us().value / TICK_US; }
+
+		Slot &_slot(Genode::uint64_t tick) { return _slots[tick % NUM_SLOTS]; }
+
+		void _insert(Link_timeout &timeout, Genode::uint64_t tick);
+
+		void _remove(Link_timeout &timeout);
+
+		void _schedule(Link_timeout &timeout, Genode::Microseconds duration);
+
+		void _handle_timeout(Genode::Duration);
+
+		/*
+		 * Noncopyable
+		 */
+		Link_timeout_wheel(Link_timeout_wheel const &);
+		Link_timeout_wheel &operator = (Link_timeout_wheel const &);
+
+	public:
+
+		Link_timeout_wheel(Timer::Connection &timer)
+		:
+			_timer(timer),
+			_timeout(timer, *this, &Link_timeout_wheel::_handle_timeout)
+		{ }
 };
 
 
@@ -148,7 +280,7 @@ class Net::Link : public Link_list::Element
 		Reference<Configuration>       _config;
 		Interface                     &_client_interface;
 		Pointer<Port_allocator_guard>  _server_port_alloc;
-		Timer::One_shot_timeout<Link>  _dissolve_timeout;
+		Link_timeout                   _dissolve_timeout;
 		Genode::Microseconds           _dissolve_timeout_us;
 		L3_protocol             const  _protocol;
 		Link_side                      _client;
@@ -157,8 +289,6 @@ class Net::Link : public Link_list::Element
 		Interface_link_stats          &_stats;
 		Reference<Genode::size_t>      _stats_curr;
 
-		void _handle_dissolve_timeout(Genode::Duration);
-
 		void _packet() { _dissolve_timeout.schedule(_dissolve_timeout_us); }
 
 	public:
@@ -170,7 +300,7 @@ class Net::Link : public Link_list::Element
 		     Pointer<Port_allocator_guard>        srv_port_alloc,
 		     Domain                              &srv_domain,
 		     Link_side_id                  const &srv_id,
-		     Timer::Connection                   &timer,
+		     Link_timeout_wheel                  &timeouts,
 		     Configuration                       &config,
 		     L3_protocol                   const  protocol,
 		     Genode::Microseconds          const  dissolve_timeout,
@@ -180,6 +310,8 @@ class Net::Link : public Link_list::Element
 
 		void dissolve(bool timeout);
 
+		void handle_dissolve_timeout();
+
 		void handle_config(Domain                        &cln_domain,
 		                   Domain                        &srv_domain,
 		                   Pointer<Port_allocator_guard>  srv_port_alloc,
@@ -234,7 +366,7 @@ class Net::Tcp_link : public Link
 		         Pointer<Port_allocator_guard>  srv_port_alloc,
 		         Domain                        &srv_domain,
 		         Link_side_id            const &srv_id,
-		         Timer::Connection             &timer,
+		         Link_timeout_wheel            &timeouts,
 		         Configuration                 &config,
 		         L3_protocol             const  protocol,
 		         Interface_link_stats          &stats);
@@ -252,7 +384,7 @@ struct Net::Udp_link : Link
 	         Pointer<Port_allocator_guard>  srv_port_alloc,
 	         Domain                        &srv_domain,
 	         Link_side_id            const &srv_id,
-	         Timer::Connection             &timer,
+	         Link_timeout_wheel            &timeouts,
 	         Configuration                 &config,
 	         L3_protocol             const  protocol,
 	         Interface_link_stats          &stats);
@@ -270,7 +402,7 @@ struct Net::Icmp_link : Link
 	          Pointer<Port_allocator_guard>  srv_port_alloc,
 	          Domain                        &srv_domain,
 	          Link_side_id            const &srv_id,
-	          Timer::Connection             &timer,
+	          Link_timeout_wheel            &timeouts,
 	          Configuration                 &config,
 	          L3_protocol             const  protocol,
 	          Interface_link_stats          &stats);
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2013-2017 Genode Labs GmbH
+ * Copyright (C) 2013-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -74,6 +74,11 @@ class Nitpicker::Canvas : public Canvas_base, public Surface_base::Flusher
 		 */
 		void flush_pixels(Rect) override { }
 
+		/**
+		 * Return base address of the pixel buffer
+		 */
+		PT *addr() { return _surface.addr(); }
+
 		Area size() const override { return _surface.size(); }
 
 		Rect clip() const override { return _surface.clip(); }
@@ -0,0 +1,261 @@
+/*
+ * \brief  Composition of the dirty screen areas by multiple threads
+ * \author Genode Labs
+ * \date   2019-10-25
+ *
+ * The dirty areas are split into tiles, which are drawn concurrently by a
+ * pool of worker threads and the entrypoint. Each thread draws into its own
+ * canvas to keep the clipping state private, and uses its own font because
+ * glyphs are rendered into the glyph buffer of the font. Tiles never
+ * overlap, and the dirty rectangles covering a tile are drawn in the same
+ * order as by a single thread. Hence, the result is pixel-identical to the
+ * sequential composition.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _COMPOSITOR_H_
+#define _COMPOSITOR_H_
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/heap.h>
+#include <base/lock.h>
+#include <base/semaphore.h>
+#include <base/thread.h>
+#include <util/reconstructible.h>
+#include <nitpicker_gfx/tff_font.h>
+
+/* local includes */
+#include "view_stack.h"
+
+namespace Nitpicker { template <typename> class Compositor; }
+
+
+template <typename PT>
+class Nitpicker::Compositor : Noncopyable
+{
+	public:
+
+		enum { MAX_THREADS = 16 };
+
+	private:
+
+		enum {
+			TILE_SIZE  = 128,
+			STACK_SIZE = 64*1024,  /* same as the entrypoint */
+
+			/* number of rectangles produced by 'Dirty_rect::flush' */
+			MAX_RECTS = 3,
+
+			/* smaller areas are drawn by the entrypoint alone */
+			MIN_PARALLEL_PIXELS = 4*TILE_SIZE*TILE_SIZE
+		};
+
+		struct Job
+		{
+			View_stack const &view_stack;
+			Font       const &font;
+
+			PT   * const base;
+			Area   const size;
+
+			Rect     rects[MAX_RECTS] { };
+			unsigned num_rects = 0;
+
+			/* bounding box of all rectangles, split into tiles */
+			Rect     bounds { };
+			unsigned tiles_x = 0, tiles_y = 0;
+
+			Job(View_stack const &view_stack, Font const &font,
+			    PT *base, Area size)
+			: view_stack(view_stack), font(font), base(base), size(size) { }
+
+			Rect tile(unsigned i) const
+			{
+				Point const p = bounds.p1() + Point((i % tiles_x)*TILE_SIZE,
+				                                    (i / tiles_x)*TILE_SIZE);
+				return Rect(p, Area(TILE_SIZE, TILE_SIZE));
+			}
+		};
+
+		struct Worker : Thread
+		{
+			Compositor &_compositor;
+
+			Tff_font::Allocated_glyph_buffer _glyph_buffer {
+				_compositor._tff, _compositor._heap };
+
+			Tff_font const _font { _compositor._tff, _glyph_buffer };
+
+			Semaphore _start { };
+
+			/*
+			 * Noncopyable
+			 */
+			Worker(Worker const &);
+			Worker &operator = (Worker const &);
+
+			Worker(Env &env, Compositor &compositor, Affinity::Location location)
+			:
+				Thread(env, "compositor", STACK_SIZE, location, Weight(), env.cpu()),
+				_compositor(compositor)
+			{
+				Thread::start();
+			}
+
+			void entry() override
+			{
+				for (;;) {
+					_start.down();
+					_compositor._draw_tiles(_font);
+					_compositor._done.up();
+				}
+			}
+		};
+
+		/*
+		 * Noncopyable
+		 */
+		Compositor(Compositor const &);
+		Compositor &operator = (Compositor const &);
+
+		Env &_env;
+
+		/* font data and allocator for the glyph buffers of the workers */
+		void const *_tff;
+		Heap        _heap { _env.ram(), _env.rm() };
+
+		Constructible<Worker> _workers[MAX_THREADS - 1];
+
+		unsigned _num_workers = 0;
+
+		Lock       _lock { };
+		Job const *_job  = nullptr;
+		unsigned   _next_tile = 0;
+		Semaphore  _done { };
+
+		bool _take_tile(unsigned &tile)
+		{
+			Lock::Guard guard(_lock);
+
+			if (_next_tile >= _job->tiles_x*_job->tiles_y)
+				return false;
+
+			tile = _next_tile++;
+			return true;
+		}
+
+		/**
+		 * Draw tiles until none is left, called by each thread
+		 *
+		 * \param font  font owned by the calling thread
+		 */
+		void _draw_tiles(Font const &font)
+		{
+			Job const &job = *_job;
+
+			Canvas<PT> canvas(job.base, job.size);
+
+			unsigned i = 0;
+			while (_take_tile(i)) {
+
+				Rect const tile = job.tile(i);
+
+				for (unsigned j = 0; j < job.num_rects; j++) {
+					Rect const rect = Rect::intersect(tile, job.rects[j]);
+					if (rect.valid())
+						job.view_stack.draw_area(canvas, font, rect);
+				}
+			}
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param tff  font used by the worker threads
+		 */
+		Compositor(Env &env, void const *tff) : _env(env), _tff(tff) { }
+
+		/**
+		 * Define the number of threads used for composing
+		 *
+		 * The number includes the entrypoint. Worker threads are created on
+		 * demand and distributed over the CPUs of the affinity space. Once
+		 * created, they are kept for later use.
+		 */
+		void threads(unsigned num_threads)
+		{
+			num_threads = max(1U, min(num_threads, (unsigned)MAX_THREADS));
+
+			Affinity::Space space = _env.cpu().affinity_space();
+
+			/* the entrypoint occupies the first CPU */
+			for (unsigned i = 0; i < num_threads - 1; i++)
+				if (!_workers[i].constructed())
+					_workers[i].construct(_env, *this,
+					                      space.location_of_index((i + 1) % space.total()));
+
+			_num_workers = num_threads - 1;
+		}
+
+		/**
+		 * Draw dirty areas of the view stack
+		 *
+		 * \return  dirty areas to be refreshed at the framebuffer
+		 */
+		Dirty_rect draw(View_stack const &view_stack, Canvas<PT> &screen,
+		                Font const &font)
+		{
+			if (_num_workers == 0)
+				return view_stack.draw(screen, font);
+
+			Job job(view_stack, font, screen.addr(), screen.size());
+
+			size_t num_pixels = 0;
+
+			Dirty_rect const result = view_stack.flush_dirty_rect([&] (Rect const &rect) {
+
+				if (job.num_rects == MAX_RECTS)
+					return;
+
+				job.bounds = job.num_rects ? Rect::compound(job.bounds, rect) : rect;
+				job.rects[job.num_rects++] = rect;
+				num_pixels += rect.area().count();
+			});
+
+			/* avoid the synchronization overhead for small areas */
+			if (num_pixels < MIN_PARALLEL_PIXELS) {
+				for (unsigned i = 0; i < job.num_rects; i++)
+					view_stack.draw_area(screen, font, job.rects[i]);
+				return result;
+			}
+
+			job.tiles_x = (job.bounds.w() + TILE_SIZE - 1)/TILE_SIZE;
+			job.tiles_y = (job.bounds.h() + TILE_SIZE - 1)/TILE_SIZE;
+
+			_job       = &job;
+			_next_tile = 0;
+
+			for (unsigned i = 0; i < _num_workers; i++)
+				_workers[i]->_start.up();
+
+			_draw_tiles(job.font);
+
+			for (unsigned i = 0; i < _num_workers; i++)
+				_done.down();
+
+			_job = nullptr;
+
+			return result;
+		}
+};
+
+#endif /* _COMPOSITOR_H_ */
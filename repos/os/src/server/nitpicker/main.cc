@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2006-2017 Genode Labs GmbH
+ * Copyright (C) 2006-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -31,6 +31,7 @@
 #include "clip_guard.h"
 #include "pointer_origin.h"
 #include "domain_registry.h"
+#include "compositor.h"
 
 namespace Nitpicker {
 	template <typename> class Root;
@@ -242,6 +243,8 @@ struct Nitpicker::Main : Focus_updater
 
 	Reconstructible<Framebuffer_screen> _fb_screen = { _env.rm(), _framebuffer };
 
+	Compositor<PT> _compositor { _env, _binary_default_tff_start };
+
 	Point _initial_pointer_pos()
 	{
 		Area const scr_size = _fb_screen->screen.size();
@@ -374,7 +377,7 @@ struct Nitpicker::Main : Focus_updater
 	 */
 	void _draw_and_flush()
 	{
-		_view_stack.draw(_fb_screen->screen, _font).flush([&] (Rect const &rect) {
+		_compositor.draw(_view_stack, _fb_screen->screen, _font).flush([&] (Rect const &rect) {
 			_framebuffer.refresh(rect.x1(), rect.y1(),
 			                     rect.w(),  rect.h()); });
 	}
@@ -480,7 +483,7 @@ void Nitpicker::Main::_handle_input()
 		_view_stack.geometry(_pointer_origin, Rect(_user_state.pointer_pos(), Area()));
 
 	/* perform redraw and flush pixels to the framebuffer */
-	_view_stack.draw(_fb_screen->screen, _font).flush([&] (Rect const &rect) {
+	_compositor.draw(_view_stack, _fb_screen->screen, _font).flush([&] (Rect const &rect) {
 		_framebuffer.refresh(rect.x1(), rect.y1(),
 		                     rect.w(),  rect.h()); });
 
@@ -553,6 +556,11 @@ void Nitpicker::Main::_handle_config()
 	configure_reporter(config, _clicked_reporter);
 	configure_reporter(config, _displays_reporter);
 
+	/* update number of threads used for composing the screen */
+	_compositor.threads(config.has_sub_node("compositor")
+	                  ? config.sub_node("compositor").attribute_value("threads", 1U)
+	                  : 1U);
+
 	/* update domain registry and session policies */
 	for (Session_component *s = _session_list.first(); s; s = s->next())
 		s->reset_domain();
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2006-2017 Genode Labs GmbH
+ * Copyright (C) 2006-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -118,18 +118,39 @@ class Nitpicker::View_stack
 		void draw_rec(Canvas_base &, Font const &, View_component const *, Rect) const;
 
 		/**
-		 * Draw dirty areas
+		 * Draw views in specified area
 		 */
-		Dirty_rect draw(Canvas_base &canvas, Font const &font) const
+		void draw_area(Canvas_base &canvas, Font const &font, Rect rect) const
+		{
+			draw_rec(canvas, font, _first_view(), rect);
+		}
+
+		/**
+		 * Mark dirty areas as clean
+		 *
+		 * \param fn  functor called with each dirty rectangle
+		 *
+		 * \return   dirty areas to be refreshed at the framebuffer
+		 */
+		template <typename FN>
+		Dirty_rect flush_dirty_rect(FN const &fn) const
 		{
 			Dirty_rect result = _dirty_rect;
 
-			_dirty_rect.flush([&] (Rect const &rect) {
-				draw_rec(canvas, font, _first_view(), rect); });
+			_dirty_rect.flush(fn);
 
 			return result;
 		}
 
+		/**
+		 * Draw dirty areas
+		 */
+		Dirty_rect draw(Canvas_base &canvas, Font const &font) const
+		{
+			return flush_dirty_rect([&] (Rect const &rect) {
+				draw_area(canvas, font, rect); });
+		}
+
 		/**
 		 * Trigger redraw of the whole view stack
 		 */
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2012-2017 Genode Labs GmbH
+ * Copyright (C) 2012-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -197,23 +197,25 @@ class Ram_fs::Directory : public Node
 				return 0;
 			}
 
-			Node *node = _entry_unsynchronized(index);
+			/* return as many consecutive entries as fit into 'dst' */
+			size_t const max_count = len / sizeof(Directory_entry);
+			size_t       count     = 0;
 
-			/* index out of range */
-			if (!node)
-				return 0;
+			for (Node *node = _entry_unsynchronized(index);
+			     node && count < max_count; node = node->next(), count++) {
 
-			Directory_entry *e = (Directory_entry *)(dst);
+				Directory_entry *e = (Directory_entry *)(dst) + count;
 
-			e->inode = node->inode();
+				e->inode = node->inode();
 
-			if (dynamic_cast<File      *>(node)) e->type = Directory_entry::TYPE_FILE;
-			if (dynamic_cast<Directory *>(node)) e->type = Directory_entry::TYPE_DIRECTORY;
-			if (dynamic_cast<Symlink   *>(node)) e->type = Directory_entry::TYPE_SYMLINK;
+				if (dynamic_cast<File      *>(node)) e->type = Directory_entry::TYPE_FILE;
+				if (dynamic_cast<Directory *>(node)) e->type = Directory_entry::TYPE_DIRECTORY;
+				if (dynamic_cast<Symlink   *>(node)) e->type = Directory_entry::TYPE_SYMLINK;
 
-			strncpy(e->name, node->name(), sizeof(e->name));
+				strncpy(e->name, node->name(), sizeof(e->name));
+			}
 
-			return sizeof(Directory_entry);
+			return count*sizeof(Directory_entry);
 		}
 
 		size_t write(char const *, size_t, seek_off_t) override
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2012-2017 Genode Labs GmbH
+ * Copyright (C) 2012-2019 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -19,14 +19,13 @@
 #include <base/allocator.h>
 
 /* local includes */
-#include <ram_fs/chunk.h>
+#include <ram_fs/extent.h>
 #include <ram_fs/param.h>
 #include "node.h"
 
 namespace Ram_fs
 {
-	using File_system::Chunk;
-	using File_system::Chunk_index;
+	using File_system::Extent_store;
 	using File_system::file_size_t;
 	using File_system::SEEK_TAIL;
 	class File;
@@ -37,52 +36,26 @@ class Ram_fs::File : public Node
 {
 	private:
 
-		typedef Chunk      <num_level_3_entries()>                Chunk_level_3;
-		typedef Chunk_index<num_level_2_entries(), Chunk_level_3> Chunk_level_2;
-		typedef Chunk_index<num_level_1_entries(), Chunk_level_2> Chunk_level_1;
-		typedef Chunk_index<num_level_0_entries(), Chunk_level_1> Chunk_level_0;
-
-		Chunk_level_0 _chunk;
+		Extent_store<min_extent_size(), max_extent_size()> _extents;
 
 		file_size_t _length;
 
 	public:
 
 		File(Allocator &alloc, char const *name)
-		: _chunk(alloc, 0), _length(0) { Node::name(name); }
+		: _extents(alloc), _length(0) { Node::name(name); }
 
 		size_t read(char *dst, size_t len, seek_off_t seek_offset) override
 		{
-			file_size_t const chunk_used_size = _chunk.used_size();
-
 			if (seek_offset == SEEK_TAIL)
 				seek_offset = (len < _length) ? (_length - len) : 0;
 			else if (seek_offset >= _length)
 				return 0;
 
-			/*
-			 * Constrain read transaction to available chunk data
-			 *
-			 * Note that 'chunk_used_size' may be lower than '_length'
-			 * because 'Chunk' may have truncated tailing zeros.
-			 */
-			if (seek_offset + len >= _length)
-				len = _length - seek_offset;
-
-			file_size_t read_len = len;
+			len = (size_t)min((file_size_t)len, _length - seek_offset);
 
-			if (seek_offset + read_len > chunk_used_size) {
-				if (chunk_used_size >= seek_offset)
-					read_len = chunk_used_size - seek_offset;
-				else
-					read_len = 0;
-			}
-
-			_chunk.read(dst, read_len, seek_offset);
-
-			/* add zero padding if needed */
-			if (read_len < len)
-				memset(dst + read_len, 0, len - read_len);
+			/* regions without extents are read as zeros */
+			_extents.read(dst, len, seek_offset);
 
 			return len;
 		}
@@ -92,22 +65,20 @@ class Ram_fs::File : public Node
 			if (seek_offset == SEEK_TAIL)
 				seek_offset = _length;
 
-			if (seek_offset + len >= Chunk_level_0::SIZE) {
-				len = (Chunk_level_0::SIZE-1) - seek_offset;
-				Genode::error(name(), ": size limit ", (long)Chunk_level_0::SIZE, " reached");
-			}
-
-			_chunk.write(src, len, (size_t)seek_offset);
+			size_t const written = _extents.write(src, len, seek_offset);
+			if (written < len)
+				Genode::error(name(), ": out of memory after writing ",
+				              written, " of ", len, " bytes");
 
 			/*
-			 * Keep track of file length. We cannot use 'chunk.used_size()'
-			 * as file length because trailing zeros may by represented
-			 * by zero chunks, which do not contribute to 'used_size()'.
+			 * Keep track of file length. We cannot use 'used_size()' as
+			 * file length because the file may have a sparse tail.
 			 */
-			_length = max(_length, seek_offset + len);
+			if (written)
+				_length = max(_length, seek_offset + written);
 
 			mark_as_updated();
-			return len;
+			return written;
 		}
 
 		Status status() override
@@ -121,8 +92,7 @@ class Ram_fs::File : public Node
 
 		void truncate(file_size_t size) override
 		{
-			if (size < _chunk.used_size())
-				_chunk.truncate(size);
+			_extents.truncate(size);
 
 			_length = size;
 
@@ -100,12 +100,24 @@ class Vfs_server::Session_component : private Session_resources,
 		/* global queue of sessions for which packets await progress */
 		Session_queue &_pending_sessions;
 
+		/* packets taken from the stream but not yet processed */
+		Packet_pool _packet_pool { };
+
 		/* collection of open nodes local to this session */
 		Node_space _node_space { };
 
 		Genode::Signal_handler<Session_component> _process_packet_handler {
 			_ep, *this, &Session_component::_process_packets };
 
+		/*
+		 * The entrypoint calls the global I/O-progress handler after
+		 * dispatching this signal, which processes the '_pending_nodes'.
+		 */
+		Genode::Io_signal_handler<Session_component> _io_progress_handler {
+			_ep, *this, &Session_component::_handle_io_progress };
+
+		void _handle_io_progress() { }
+
 		/*
 		 * The root node needs be allocated with the session struct
 		 * but removeable from the id space at session destruction.
@@ -163,9 +175,12 @@ class Vfs_server::Session_component : private Session_resources,
 		/**
 		 * Attempt to process the head of the packet queue
 		 *
+		 * The packet is handed over to the node of its handle, which
+		 * completes it independent from the packets of other handles.
+		 *
 		 * Return true if the packet can be popped from the
-		 * queue or false if the the packet cannot be processed
-		 * or further queued.
+		 * queue or false if the the packet cannot be queued
+		 * at its node.
 		 */
 		bool _process_packet()
 		{
@@ -219,6 +234,9 @@ class Vfs_server::Session_component : private Session_resources,
 			 */
 			int quantum = TX_QUEUE_SIZE;
 
+			/* return packets of closed handles first */
+			_packet_pool.ack_deferred(_stream);
+
 			while (_stream.packet_avail()) {
 				if (_process_packet()) {
 					/*
@@ -258,6 +276,13 @@ class Vfs_server::Session_component : private Session_resources,
 				/* this session needs unblocking */
 				_pending_sessions.enqueue(*this);
 			}
+
+			/*
+			 * Nodes may wait for the acknowledgement queue, which
+			 * might have been drained by the client meanwhile.
+			 */
+			if (!_pending_nodes.empty())
+				Genode::Signal_transmitter(_io_progress_handler).submit();
 		}
 
 		/**
@@ -376,7 +401,7 @@ class Vfs_server::Session_component : private Session_resources,
 			Directory *dir;
 			try { dir = new (_alloc) Directory(_node_space, _vfs, _alloc,
 			                                   _pending_nodes, _stream,
-			                                   path_str, create); }
+			                                   _packet_pool, path_str, create); }
 			catch (Out_of_memory) { throw Out_of_ram(); }
 
 			return Dir_handle(dir->id().value);
@@ -688,19 +713,25 @@ class Vfs_server::Root : public Genode::Root_component<Session_component>
 			auto const ram_quota = parse_ram_quota(args).value;
 			auto const cap_quota = parse_cap_quota(args).value;
 
-			size_t tx_buf_size =
+			size_t const requested_tx_buf_size =
 				Arg_string::find_arg(args, "tx_buf_size").aligned_size();
 
-			if (!tx_buf_size)
+			if (!requested_tx_buf_size)
 				throw Service_denied();
 
-			size_t session_size =
-				max((size_t)4096, sizeof(Session_component)) +
-				tx_buf_size;
+			/* shrink the packet buffer to what the quota covers */
+			size_t const session_costs =
+				max((size_t)4096, sizeof(Session_component));
+
+			size_t const tx_buf_size = ram_quota > session_costs
+				? ::File_system::Session::granted_tx_buf_size(
+					requested_tx_buf_size, ram_quota - session_costs)
+				: 0;
 
-			if (session_size > ram_quota) {
+			if (!tx_buf_size) {
 				error("insufficient 'ram_quota' from '", label, "' "
-				      "got ", ram_quota, ", need ", session_size);
+				      "got ", ram_quota, ", need ",
+				      session_costs + ::File_system::Session::min_tx_buf_size());
 				throw Insufficient_ram_quota();
 			}
 
@@ -36,6 +36,7 @@ namespace Vfs_server {
 	typedef ::File_system::Session::Tx::Sink Packet_stream;
 
 	class Node;
+	class Packet_pool;
 	class Io_node;
 	class Watch_node;
 	class Directory;
@@ -45,6 +46,16 @@ namespace Vfs_server {
 	typedef Genode::Id_space<Node> Node_space;
 	typedef Genode::Fifo<Node>     Node_queue;
 
+	/**
+	 * Packet taken from the packet stream that awaits processing at a node
+	 */
+	struct Packet_slot : Genode::Fifo<Packet_slot>::Element
+	{
+		Packet_descriptor packet { };
+	};
+
+	typedef Genode::Fifo<Packet_slot> Packet_queue;
+
 	/* Vfs::MAX_PATH is shorter than File_system::MAX_PATH */
 	enum { MAX_PATH_LEN = Vfs::MAX_PATH_LEN };
 
@@ -82,6 +93,75 @@ namespace Vfs_server {
 }
 
 
+/**
+ * Session-local storage for packets that are queued at nodes
+ *
+ * Packets are removed from the packet stream as soon as they arrive, so a
+ * packet that cannot be processed right away does not hold back the packets
+ * of other handles behind it. The pool bounds the number of such packets.
+ */
+class Vfs_server::Packet_pool
+{
+	public:
+
+		enum { MAX_PACKETS = ::File_system::Session::TX_QUEUE_SIZE };
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Packet_pool(Packet_pool const &);
+		Packet_pool &operator = (Packet_pool const &);
+
+		Packet_slot  _slots[MAX_PACKETS];
+		Packet_queue _free { };
+
+		/* packets that await room in the acknowledgement queue */
+		Packet_queue _unacked { };
+
+	public:
+
+		Packet_pool()
+		{
+			for (unsigned i = 0; i < MAX_PACKETS; i++)
+				_free.enqueue(_slots[i]);
+		}
+
+		/**
+		 * Return unused slot or nullptr if all slots are occupied
+		 */
+		Packet_slot *alloc()
+		{
+			Packet_slot *slot = nullptr;
+			_free.dequeue([&] (Packet_slot &s) { slot = &s; });
+			return slot;
+		}
+
+		void release(Packet_slot &slot) { _free.enqueue(slot); }
+
+		/**
+		 * Acknowledge packet of slot as soon as the acknowledgement queue
+		 * has room
+		 *
+		 * The slot is released once the packet is acknowledged.
+		 */
+		void defer_ack(Packet_slot &slot) { _unacked.enqueue(slot); }
+
+		/**
+		 * Acknowledge deferred packets as far as possible
+		 */
+		void ack_deferred(Packet_stream &stream)
+		{
+			while (!_unacked.empty() && stream.ready_to_ack())
+				_unacked.dequeue([&] (Packet_slot &slot) {
+					stream.acknowledge_packet(slot.packet);
+					release(slot);
+				});
+		}
+};
+
+
 class Vfs_server::Node : public  ::File_system::Node_base,
                          private Node_space::Element,
                          private Node_queue::Element
@@ -173,13 +253,21 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 		bool _packet_queued = false;
 		bool _packet_op_pending = false;
 
+		/* packets of this handle that wait for '_packet' to complete */
+		Packet_queue _queued_packets { };
+
 	protected:
 
+		Packet_pool &_packet_pool;
+
 		Vfs::Vfs_handle &_handle;
 
 		/**
-		 * Packets that have been removed from the
-		 * packet stream are transfered here
+		 * Packet currently processed at this handle
+		 *
+		 * The VFS handle carries the seek offset and the state of a
+		 * queued operation, so the packets of a handle are processed one
+		 * after another, in the order of their submission.
 		 */
 		Packet_descriptor _packet { };
 
@@ -321,36 +409,13 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 		virtual bool  _read() = 0;
 		virtual bool _write() = 0;
 
-	public:
-
-		Io_node(Node_space &space, char const *node_path, Mode node_mode,
-		        Node_queue &response_queue, Packet_stream &stream,
-		        Vfs_handle &handle)
-		: Node(space, node_path, response_queue, stream),
-		  _mode(node_mode), _handle(handle)
-		{
-			_handle.handler(this);
-		}
-
-		virtual ~Io_node()
-		{
-			_handle.handler(nullptr);
-			_handle.close();
-		}
-
-		using Node_space::Element::id;
-
 		/**
-		 * Process the packet that is queued at this handle
+		 * Process '_packet'
 		 *
-		 * Return true if the node was processed and is now idle.
+		 * Return true if the packet was completed.
 		 */
-		bool process_io() override
+		bool _process_current()
 		{
-			if (!_packet_queued) return true;
-			if (!_stream.ready_to_ack())
-				return false;
-
 			bool result = true;
 
 			switch (_packet.operation()) {
@@ -384,23 +449,83 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 			return result;
 		}
 
+	public:
+
+		Io_node(Node_space &space, char const *node_path, Mode node_mode,
+		        Node_queue &response_queue, Packet_stream &stream,
+		        Packet_pool &packet_pool, Vfs_handle &handle)
+		: Node(space, node_path, response_queue, stream),
+		  _mode(node_mode), _packet_pool(packet_pool), _handle(handle)
+		{
+			_handle.handler(this);
+		}
+
+		virtual ~Io_node()
+		{
+			/*
+			 * Return the packets that were not processed to the client,
+			 * the session acknowledges the packets that do not fit into
+			 * the acknowledgement queue later.
+			 */
+			_queued_packets.dequeue_all([&] (Packet_slot &slot) {
+				_packet_pool.defer_ack(slot); });
+
+			_packet_pool.ack_deferred(_stream);
+
+			_handle.handler(nullptr);
+			_handle.close();
+		}
+
+		using Node_space::Element::id;
+
+		/**
+		 * Process the packets that are queued at this handle
+		 *
+		 * Return true if the node was processed and is now idle.
+		 */
+		bool process_io() override
+		{
+			for (;;) {
+				if (!_packet_queued) {
+					if (_queued_packets.empty())
+						return true;
+
+					_queued_packets.dequeue([&] (Packet_slot &slot) {
+						_packet        = slot.packet;
+						_packet_queued = true;
+						_packet_pool.release(slot);
+					});
+				}
+
+				if (!_stream.ready_to_ack())
+					return false;
+
+				if (!_process_current())
+					return false;
+			}
+		}
+
 		/**
-		 * Process a packet by queuing it locally or sending
-		 * an immediate response. Return false if no progress
-		 * can be made.
+		 * Queue a packet at this handle and process as much as possible
+		 *
+		 * Return false if the packet cannot be queued, in which case it
+		 * must stay in the packet stream.
 		 *
 		 * Called by packet stream signal handler
 		 */
 		bool process_packet(Packet_descriptor const &packet)
 		{
-			/* attempt to clear any pending packet */
-			if (!process_io())
+			Packet_slot *slot = _packet_pool.alloc();
+			if (!slot)
 				return false;
 
-			/* otherwise store the packet locally and process */
-			_packet = packet;
-			_packet_queued = true;
-			process_io();
+			slot->packet = packet;
+			_queued_packets.enqueue(*slot);
+
+			/* retry from the post-signal hook if the packet is blocked */
+			if (!process_io() && !enqueued())
+				_response_queue.enqueue(*this);
+
 			return true;
 		}
 
@@ -588,10 +713,11 @@ struct Vfs_server::Symlink : Io_node
 		        Genode::Allocator &alloc,
 		        Node_queue        &response_queue,
 		        Packet_stream     &stream,
+		        Packet_pool       &packet_pool,
 		        char       const  *link_path,
 		        Mode               mode,
 		        bool               create)
-		: Io_node(space, link_path, mode, response_queue, stream,
+		: Io_node(space, link_path, mode, response_queue, stream, packet_pool,
 		          _open(vfs, alloc, link_path, create))
 		{ }
 };
@@ -679,12 +805,13 @@ class Vfs_server::File : public Io_node
 		     Genode::Allocator &alloc,
 		     Node_queue        &response_queue,
 		     Packet_stream     &stream,
+		     Packet_pool       &packet_pool,
 		     char       const  *file_path,
 		     Mode               fs_mode,
 		     bool               create)
 		:
 			Io_node(space, file_path, fs_mode, response_queue, stream,
-			        _open(vfs, alloc, file_path, fs_mode, create))
+			        packet_pool, _open(vfs, alloc, file_path, fs_mode, create))
 		{
 			_leaf_path = vfs.leaf_path(path());
 		}
@@ -699,64 +826,73 @@ class Vfs_server::File : public Io_node
 
 struct Vfs_server::Directory : Io_node
 {
+	private:
+
+		/* number of entries already placed into the current packet */
+		size_t _entries_done = 0;
+
+		static ::File_system::Directory_entry::Type
+		_entry_type(Directory_service::Dirent_type type)
+		{
+			using ::File_system::Directory_entry;
+
+			switch (type) {
+			case Directory_service::DIRENT_TYPE_DIRECTORY: return Directory_entry::TYPE_DIRECTORY;
+			case Directory_service::DIRENT_TYPE_SYMLINK:   return Directory_entry::TYPE_SYMLINK;
+			default:                                       return Directory_entry::TYPE_FILE;
+			}
+		}
+
 	protected:
 
 		/********************
 		 ** Node interface **
 		 ********************/
 
+		/**
+		 * Fill the packet with as many consecutive entries as fit
+		 *
+		 * Each entry is obtained by a separate VFS read, which may be
+		 * queued. In this case, the filling continues at the next call.
+		 */
 		bool _read() override
 		{
-			if (_packet.length() < sizeof(Directory_entry)) {
+			size_t const max_count = _packet.length() / sizeof(Directory_entry);
+			if (!max_count) {
 				_ack_packet(0);
 				return true;
 			}
 
-			seek_off_t seek_offset = _packet.position();
-
-			Directory_service::Dirent vfs_dirent;
-			size_t blocksize = sizeof(::File_system::Directory_entry);
-
-			unsigned index = (seek_offset / blocksize);
+			size_t const blocksize = sizeof(::File_system::Directory_entry);
+			seek_off_t const first = _packet.position() / blocksize;
 
-			file_size out_count = 0;
-			bool result = _vfs_read(
-				(char*)&vfs_dirent, sizeof(vfs_dirent),
-				index * sizeof(vfs_dirent), out_count);
+			Directory_entry * const entries =
+				(Directory_entry *)_stream.packet_content(_packet);
 
-			if (result) {
-				if (out_count != sizeof(vfs_dirent)) {
-					_ack_packet(0);
-					return true;
-				}
+			while (_entries_done < max_count) {
 
-				::File_system::Directory_entry *fs_dirent =
-					(Directory_entry *)_stream.packet_content(_packet);
-				fs_dirent->inode = vfs_dirent.fileno;
+				Directory_service::Dirent vfs_dirent;
+				file_size out_count = 0;
 
-				switch (vfs_dirent.type) {
-				case Vfs::Directory_service::DIRENT_TYPE_END:
-					_ack_packet(0);
-					return true;
+				if (!_vfs_read((char*)&vfs_dirent, sizeof(vfs_dirent),
+				               (first + _entries_done) * sizeof(vfs_dirent),
+				               out_count))
+					return false;
 
-				case Vfs::Directory_service::DIRENT_TYPE_DIRECTORY:
-					fs_dirent->type = ::File_system::Directory_entry::TYPE_DIRECTORY;
-					break;
-				case Vfs::Directory_service::DIRENT_TYPE_SYMLINK:
-					fs_dirent->type = ::File_system::Directory_entry::TYPE_SYMLINK;
-					break;
-				case Vfs::Directory_service::DIRENT_TYPE_FILE:
-				default:
-					fs_dirent->type = ::File_system::Directory_entry::TYPE_FILE;
+				if (out_count != sizeof(vfs_dirent)
+				 || vfs_dirent.type == Directory_service::DIRENT_TYPE_END)
 					break;
-				}
 
-				strncpy(fs_dirent->name, vfs_dirent.name, MAX_NAME_LEN);
+				Directory_entry &fs_dirent = entries[_entries_done++];
 
-				_ack_packet(sizeof(Directory_entry));
-				return true;
+				fs_dirent.inode = vfs_dirent.fileno;
+				fs_dirent.type  = _entry_type(vfs_dirent.type);
+				strncpy(fs_dirent.name, vfs_dirent.name, MAX_NAME_LEN);
 			}
-			return false;
+
+			_ack_packet(_entries_done * sizeof(Directory_entry));
+			_entries_done = 0;
+			return true;
 		}
 
 		bool _write() override
@@ -781,10 +917,11 @@ struct Vfs_server::Directory : Io_node
 		          Genode::Allocator &alloc,
 		          Node_queue        &response_queue,
 		          Packet_stream     &stream,
+		          Packet_pool       &packet_pool,
 		          char const        *dir_path,
 		          bool               create)
 		: Io_node(space, dir_path, READ_ONLY, response_queue, stream,
-		          _open(vfs, alloc, dir_path, create))
+		          packet_pool, _open(vfs, alloc, dir_path, create))
 		{ }
 
 		/**
@@ -803,7 +940,7 @@ struct Vfs_server::Directory : Io_node
 			File *file;
 			try {
 				file = new (alloc) File(space, vfs, alloc,
-				                        _response_queue, _stream,
+				                        _response_queue, _stream, _packet_pool,
 				                        path_str, mode, create);
 			} catch (Out_of_memory) { throw Out_of_ram(); }
 
@@ -827,7 +964,7 @@ struct Vfs_server::Directory : Io_node
 
 			Symlink *link;
 			try { link = new (alloc) Symlink(space, vfs, alloc,
-			                                 _response_queue, _stream,
+			                                 _response_queue, _stream, _packet_pool,
 			                                 path_str, mode, create); }
 			catch (Out_of_memory) { throw Out_of_ram(); }
 			if (create)
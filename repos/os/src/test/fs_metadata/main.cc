@@ -0,0 +1,117 @@
+/*
+ * \brief  Benchmark of repeated metadata lookups via the VFS
+ * \author Genode Labs
+ * \date   2019-10-15
+ *
+ * For each '<pass dir="..."/>' node of the config, a number of files is
+ * created and stat'ed repeatedly, similar to a build tool checking its
+ * dependencies. The directories are expected to be backed by 'fs' plugins
+ * with and without metadata cache.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <os/path.h>
+#include <timer_session/connection.h>
+#include <vfs/simple_env.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	typedef Vfs::Directory_service   Ds;
+	typedef Genode::Path<Vfs::MAX_PATH_LEN> Path;
+
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Vfs::Simple_env _vfs_env { _env, _heap, _config.xml().sub_node("vfs") };
+
+	Vfs::File_system &_vfs = _vfs_env.root_dir();
+
+	Timer::Connection _timer { _env };
+
+	unsigned const _files  = _config.xml().attribute_value("files",  100U);
+	unsigned const _rounds = _config.xml().attribute_value("rounds", 100U);
+
+	Path _file_path(char const *dir, unsigned i)
+	{
+		return Path(String<32>("file", i).string(), dir);
+	}
+
+	void _create(char const *dir)
+	{
+		for (unsigned i = 0; i < _files; i++) {
+			Vfs::Vfs_handle *handle = nullptr;
+			if (_vfs.open(_file_path(dir, i).base(),
+			              Ds::OPEN_MODE_WRONLY | Ds::OPEN_MODE_CREATE,
+			              &handle, _heap) != Ds::OPEN_OK)
+				throw Exception();
+			handle->close();
+		}
+	}
+
+	void _stat(char const *dir)
+	{
+		for (unsigned r = 0; r < _rounds; r++) {
+			for (unsigned i = 0; i < _files; i++) {
+				Ds::Stat st { };
+				if (_vfs.stat(_file_path(dir, i).base(), st) != Ds::STAT_OK)
+					throw Exception();
+			}
+
+			/* lookups of absent files, like searching a PATH */
+			Ds::Stat st { };
+			if (_vfs.stat(Path("missing", dir).base(), st) == Ds::STAT_OK)
+				throw Exception();
+		}
+	}
+
+	void _pass(char const *dir)
+	{
+		_create(dir);
+
+		uint64_t const start_ms = _timer.elapsed_ms();
+		_stat(dir);
+		uint64_t const duration_ms = max(_timer.elapsed_ms() - start_ms, (uint64_t)1);
+
+		unsigned long const lookups = (unsigned long)_rounds*(_files + 1);
+
+		log(dir, ": ", lookups, " lookups in ", duration_ms, " ms, ",
+		    lookups*1000/duration_ms, " lookups/s");
+
+		for (unsigned i = 0; i < _files; i++)
+			_vfs.unlink(_file_path(dir, i).base());
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log(_files, " files, ", _rounds, " rounds");
+
+		_config.xml().for_each_sub_node("pass", [&] (Xml_node pass) {
+			typedef String<Vfs::MAX_PATH_LEN> Dir;
+			_pass(pass.attribute_value("dir", Dir("/")).string()); });
+
+		log("--- file-system metadata benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-fs_metadata
+SRC_CC = main.cc
+LIBS   = base vfs
@@ -0,0 +1,160 @@
+/*
+ * \brief  Throughput benchmark for sequential file access via the VFS
+ * \author Genode Labs
+ * \date   2019-10-12
+ *
+ * For each '<pass dir="..."/>' node of the config, a file is written and
+ * read back sequentially in chunks of 'chunk' bytes. The directories are
+ * expected to be backed by differently configured VFS plugins, e.g., 'fs'
+ * plugins with different buffer sizes and read-ahead depths.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_ram_dataspace.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <os/path.h>
+#include <timer_session/connection.h>
+#include <vfs/simple_env.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	typedef Vfs::File_io_service     Io;
+	typedef Vfs::Directory_service   Ds;
+	typedef Genode::Path<Vfs::MAX_PATH_LEN> Path;
+
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Vfs::Simple_env _vfs_env { _env, _heap, _config.xml().sub_node("vfs") };
+
+	Vfs::File_system &_vfs = _vfs_env.root_dir();
+
+	Timer::Connection _timer { _env };
+
+	size_t const _size  = _config.xml().attribute_value("size",
+	                                                    Number_of_bytes(64 << 20));
+	size_t const _chunk = _config.xml().attribute_value("chunk",
+	                                                    Number_of_bytes(64 << 10));
+
+	Attached_ram_dataspace _buffer_ds { _env.ram(), _env.rm(), _chunk };
+
+	char *_buffer() { return _buffer_ds.local_addr<char>(); }
+
+	void _wait() { _env.ep().wait_and_dispatch_one_io_signal(); }
+
+	Vfs::Vfs_handle &_open(char const *path, unsigned mode)
+	{
+		Vfs::Vfs_handle *handle = nullptr;
+		if (_vfs.open(path, mode, &handle, _heap) != Ds::OPEN_OK)
+			throw Exception();
+		return *handle;
+	}
+
+	void _write(Vfs::Vfs_handle &handle)
+	{
+		for (size_t i = 0; i < _chunk; i++)
+			_buffer()[i] = (char)i;
+
+		for (Vfs::file_size offset = 0; offset < _size; ) {
+
+			Vfs::file_size n = 0;
+			handle.seek(offset);
+			try {
+				if (handle.fs().write(&handle, _buffer(), _chunk, n) != Io::WRITE_OK)
+					throw Exception();
+			}
+			catch (Io::Insufficient_buffer) { _wait(); continue; }
+
+			offset += n;
+		}
+
+		while (!handle.fs().queue_sync(&handle))
+			_wait();
+
+		while (handle.fs().complete_sync(&handle) == Io::SYNC_QUEUED)
+			_wait();
+	}
+
+	void _read(Vfs::Vfs_handle &handle)
+	{
+		for (Vfs::file_size offset = 0; offset < _size; ) {
+
+			handle.seek(offset);
+			while (!handle.fs().queue_read(&handle, _chunk))
+				_wait();
+
+			Vfs::file_size n = 0;
+			Io::Read_result result;
+			while ((result = handle.fs().complete_read(&handle, _buffer(),
+			                                           _chunk, n)) == Io::READ_QUEUED)
+				_wait();
+
+			if (result != Io::READ_OK || n == 0)
+				throw Exception();
+
+			offset += n;
+		}
+	}
+
+	template <typename FN>
+	void _measure(char const *what, char const *dir, FN const &fn)
+	{
+		uint64_t const start_ms = _timer.elapsed_ms();
+		fn();
+		uint64_t const duration_ms = max(_timer.elapsed_ms() - start_ms, (uint64_t)1);
+
+		log(dir, ": ", what, " ", _size/1024, " KiB in ", duration_ms, " ms, ",
+		    (_size/1024)*1000/duration_ms, " KiB/s");
+	}
+
+	void _pass(char const *dir)
+	{
+		Path const path("bench.dat", dir);
+
+		{
+			Vfs::Vfs_handle &handle =
+				_open(path.base(), Ds::OPEN_MODE_WRONLY | Ds::OPEN_MODE_CREATE);
+			_measure("write", dir, [&] () { _write(handle); });
+			handle.close();
+		}
+		{
+			Vfs::Vfs_handle &handle = _open(path.base(), Ds::OPEN_MODE_RDONLY);
+			_measure("read ", dir, [&] () { _read(handle); });
+			handle.close();
+		}
+		_vfs.unlink(path.base());
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("file size ", _size/1024, " KiB, chunk size ", _chunk/1024, " KiB");
+
+		_config.xml().for_each_sub_node("pass", [&] (Xml_node pass) {
+			typedef String<Vfs::MAX_PATH_LEN> Dir;
+			_pass(pass.attribute_value("dir", Dir("/")).string()); });
+
+		log("--- file-system throughput benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
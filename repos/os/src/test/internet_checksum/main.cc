@@ -0,0 +1,186 @@
+/*
+ * \brief  Test and benchmark of the Internet Checksum
+ * \author Genode Labs
+ * \date   2019-10-09
+ *
+ * The test compares the checksum kernels of the net library with a plain
+ * word-by-word reference for all combinations of small lengths and
+ * alignments. The benchmark measures the throughput for typical packet
+ * sizes with and without copying the data.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_ram_dataspace.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+#include <net/internet_checksum.h>
+#include <util/string.h>
+
+using namespace Genode;
+using namespace Net;
+
+
+/**
+ * Reference implementation as specified by RFC 1071
+ */
+static uint16_t reference_checksum(uint8_t const *data, size_t size, addr_t sum)
+{
+	for (; size > 1; size -= 2, data += 2) {
+		uint16_t word;
+		memcpy(&word, data, sizeof(word));
+		sum += word;
+	}
+
+	if (size > 0)
+		sum += *data;
+
+	while (addr_t const sum_rsh = sum >> 16)
+		sum = (sum & 0xffff) + sum_rsh;
+
+	return (uint16_t)~sum;
+}
+
+
+struct Main
+{
+	enum {
+		MAX_TEST_SIZE = 2048,
+		MAX_OFFSET    = 16,
+		BENCH_BYTES   = 256*1024*1024,
+		BUFFER_SIZE   = 64*1024 + MAX_OFFSET,
+	};
+
+	Env                    &_env;
+	Timer::Connection       _timer { _env };
+	Attached_ram_dataspace  _src   { _env.ram(), _env.rm(), BUFFER_SIZE };
+	Attached_ram_dataspace  _dst   { _env.ram(), _env.rm(), BUFFER_SIZE };
+	unsigned                _seed  { 1 };
+	unsigned                _errors { 0 };
+
+	uint8_t *_src_bytes() { return _src.local_addr<uint8_t>(); }
+	uint8_t *_dst_bytes() { return _dst.local_addr<uint8_t>(); }
+
+	unsigned _random()
+	{
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	void _check(char const *what, size_t offset, size_t size,
+	            uint16_t result, uint16_t expected)
+	{
+		if (result == expected)
+			return;
+
+		if (_errors++ < 10)
+			error(what, ": offset ", offset, " size ", size, " checksum ",
+			      Hex(result), " expected ", Hex(expected));
+	}
+
+	void _test()
+	{
+		for (size_t i = 0; i < BUFFER_SIZE; i++)
+			_src_bytes()[i] = (uint8_t)_random();
+
+		/* all-ones data provokes the most carries */
+		memset(_src_bytes() + BUFFER_SIZE/2, 0xff, BUFFER_SIZE/4);
+
+		static size_t const bases[] = { 0, BUFFER_SIZE/2 };
+
+		for (size_t base : bases) {
+			for (size_t offset = 0; offset < MAX_OFFSET; offset++) {
+				for (size_t size = 0; size <= MAX_TEST_SIZE; size++) {
+
+					uint8_t  const *src = _src_bytes() + base + offset;
+					addr_t   const  init_sum = (addr_t)size * 0x1234;
+					uint16_t const  expected = reference_checksum(src, size, init_sum);
+
+					_check("checksum", offset, size,
+					       internet_checksum((uint16_t const *)src, size, init_sum),
+					       expected);
+
+					/* vary the destination alignment independently */
+					uint8_t *dst = _dst_bytes() + (offset * 7) % MAX_OFFSET;
+					_check("copy checksum", offset, size,
+					       internet_checksum_copy(dst, (uint16_t const *)src, size, init_sum),
+					       expected);
+
+					if (memcmp(dst, src, size)) {
+						if (_errors++ < 10)
+							error("copy: offset ", offset, " size ", size,
+							      " data differs");
+					}
+				}
+			}
+		}
+	}
+
+	template <typename FN>
+	void _measure(char const *what, size_t size, FN const &fn)
+	{
+		unsigned const rounds = BENCH_BYTES / size;
+
+		uint64_t const start_ms = _timer.elapsed_ms();
+		for (unsigned i = 0; i < rounds; i++)
+			fn();
+		uint64_t const duration_ms = max(_timer.elapsed_ms() - start_ms, 1ULL);
+
+		log(what, " ", size, " bytes: ", duration_ms, " ms, ",
+		    (BENCH_BYTES / 1024 / 1024) * 1000 / duration_ms, " MiB/s");
+	}
+
+	void _benchmark()
+	{
+		static size_t const sizes[] = { 20, 64, 576, 1500, 9000, 65536 };
+
+		uint16_t const *src = _src.local_addr<uint16_t const>();
+		void           *dst = _dst.local_addr<void>();
+
+		uint16_t volatile result = 0;
+		for (size_t size : sizes) {
+
+			_measure("reference    ", size, [&] () {
+				result = reference_checksum((uint8_t const *)src, size, 0); });
+
+			_measure("checksum     ", size, [&] () {
+				result = internet_checksum(src, size); });
+
+			_measure("copy+checksum", size, [&] () {
+				memcpy(dst, src, size);
+				result = internet_checksum((uint16_t const *)dst, size); });
+
+			_measure("copy checksum", size, [&] () {
+				result = internet_checksum_copy(dst, src, size); });
+		}
+		(void)result;
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- Internet-checksum test started ---");
+
+		_test();
+		if (_errors) {
+			error(_errors, " checksum errors");
+			env.parent().exit(-1);
+			return;
+		}
+		log("checksums of all lengths and alignments are correct");
+
+		_benchmark();
+
+		log("--- Internet-checksum test finished ---");
+		env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
@@ -64,6 +64,8 @@ class Main : public Nic_handler,
 		                                               Ipv4_address() };
 		Protocol                 const  _protocol    { _config.attribute_value("protocol", Protocol::ICMP) };
 		Port                            _dst_port    { FIRST_DST_PORT };
+		unsigned                 const  _src_ports   { _config.attribute_value("src_ports", 1U) };
+		Port                            _src_port    { SRC_PORT };
 		size_t                          _ping_sz     { _init_ping_sz() };
 
 		size_t _init_ping_sz() const;
@@ -78,6 +80,8 @@ class Main : public Nic_handler,
 
 		void _send_ping(Duration not_used = Duration(Microseconds(0)));
 
+		void _next_port();
+
 	public:
 
 		struct Invalid_arguments : Exception { };
@@ -264,6 +268,22 @@ void Main::_broadcast_arp_request(Ipv4_address const &dst_ip)
 }
 
 
+void Main::_next_port()
+{
+	if (_dst_port.value != LAST_DST_PORT) {
+		_dst_port.value++;
+		return;
+	}
+	/* continue with the next source port to open further connections */
+	_dst_port.value = FIRST_DST_PORT;
+	if ((unsigned)(_src_port.value + 1 - SRC_PORT) < _src_ports &&
+	    _src_port.value < LAST_DST_PORT) {
+		_src_port.value++; }
+	else {
+		_src_port.value = SRC_PORT; }
+}
+
+
 void Main::_send_ping(Duration)
 {
 	/* if we do not yet know the Ethernet destination, request it via ARP */
@@ -323,7 +343,7 @@ void Main::_send_ping(Duration)
 						/* create UDP header */
 						size_t const udp_off = size_guard.head_size();
 						Udp_packet &udp = ip.construct_at_data<Udp_packet>(size_guard);
-						udp.src_port(Port(SRC_PORT));
+						udp.src_port(_src_port);
 						udp.dst_port(_dst_port);
 
 						/* finish UDP header */
@@ -331,10 +351,7 @@ void Main::_send_ping(Duration)
 						udp.update_checksum(ip.src(), ip.dst());
 
 						/* prepare next ping */
-						if (_dst_port.value == LAST_DST_PORT) {
-							_dst_port.value = FIRST_DST_PORT; }
-						else {
-							_dst_port.value++; }
+						_next_port();
 						break;
 					}
 				case Protocol::TCP:
@@ -345,17 +362,14 @@ void Main::_send_ping(Duration)
 						/* create TCP header */
 						size_t const tcp_off = size_guard.head_size();
 						Tcp_packet &tcp = ip.construct_at_data<Tcp_packet>(size_guard);
-						tcp.src_port(Port(SRC_PORT));
+						tcp.src_port(_src_port);
 						tcp.dst_port(_dst_port);
 
 						/* finish TCP header */
 						tcp.update_checksum(ip.src(), ip.dst(), size_guard.head_size() - tcp_off);
 
 						/* prepare next ping */
-						if (_dst_port.value == LAST_DST_PORT) {
-							_dst_port.value = FIRST_DST_PORT; }
-						else {
-							_dst_port.value++; }
+						_next_port();
 						break;
 					}
 				}
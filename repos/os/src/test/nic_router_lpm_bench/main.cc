@@ -0,0 +1,143 @@
+/*
+ * \brief  Benchmark for the longest-prefix match of NIC-router rules
+ * \author Genode Labs
+ * \date   2019-10-05
+ *
+ * The benchmark measures the cost of looking up the destination of a packet
+ * in a rule list with a growing number of rules. It compares the prefix trie
+ * of 'Direct_rule_list' with a linear scan of the prefix-sorted list.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+
+/* NIC-router includes */
+#include <direct_rule.h>
+
+using namespace Net;
+using namespace Genode;
+
+
+struct Rule;
+
+struct Rule_list : Direct_rule_list<Rule> { };
+
+struct Rule : Direct_rule<Rule>
+{
+	Rule(Xml_node const node) : Direct_rule<Rule>(node) { }
+};
+
+
+struct Main
+{
+	enum { LOOKUPS = 1000000 };
+
+	Env               &_env;
+	Heap               _heap  { _env.ram(), _env.rm() };
+	Timer::Connection  _timer { _env };
+	unsigned           _seed  { 1 };
+
+	unsigned _random()
+	{
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	Ipv4_address _random_ip()
+	{
+		unsigned const r = _random();
+		Ipv4_address ip;
+		ip.addr[0] = 10;
+		ip.addr[1] = (uint8_t)(r >> 16);
+		ip.addr[2] = (uint8_t)(r >> 8);
+		ip.addr[3] = (uint8_t)r;
+		return ip;
+	}
+
+	/**
+	 * Add rules for 10.x.y.0/24 and a few shorter prefixes
+	 */
+	void _add_rules(Rule_list &rules, unsigned count)
+	{
+		for (unsigned i = 0; i < count; i++) {
+
+			unsigned const prefix = (i % 8 == 7) ? 16 : 24;
+
+			String<64> const xml("<ip dst=\"10.", (i / 256) % 256, ".",
+			                     i % 256, ".0/", prefix, "\"/>");
+
+			rules.insert(*new (_heap) Rule(Xml_node(xml.string())), _heap);
+		}
+	}
+
+	static Rule const *_linear_match(Rule_list const &rules,
+	                                 Ipv4_address const &ip)
+	{
+		for (Rule const *rule = rules.first(); rule; rule = rule->next()) {
+			if (rule->dst().prefix_matches(ip)) {
+				return rule; }
+		}
+		return nullptr;
+	}
+
+	template <typename FN>
+	void _measure(char const *name, unsigned count, FN const &fn)
+	{
+		_seed = 1;
+
+		unsigned matches = 0;
+
+		uint64_t const start_us = _timer.elapsed_us();
+		for (unsigned i = 0; i < LOOKUPS; i++) {
+			if (fn(_random_ip())) {
+				matches++; }
+		}
+		uint64_t const duration_us = _timer.elapsed_us() - start_us;
+
+		log(name, " rules=", count, ": ", (unsigned)LOOKUPS, " lookups in ",
+		    duration_us, " us (", (duration_us * 1000) / LOOKUPS,
+		    " ns/lookup, ", matches, " matches)");
+	}
+
+	void _bench(unsigned count)
+	{
+		Rule_list rules;
+		_add_rules(rules, count);
+
+		_measure("trie  ", count, [&] (Ipv4_address const &ip) {
+			try {
+				rules.longest_prefix_match(ip);
+				return true;
+			}
+			catch (Rule_list::No_match) { return false; }
+		});
+
+		_measure("linear", count, [&] (Ipv4_address const &ip) {
+			return _linear_match(rules, ip) != nullptr; });
+
+		rules.destroy_each(_heap);
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- NIC-router LPM benchmark started ---");
+
+		for (unsigned count = 1; count <= 4096; count *= 4)
+			_bench(count);
+
+		log("--- NIC-router LPM benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
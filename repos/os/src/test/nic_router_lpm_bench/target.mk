@@ -0,0 +1,10 @@
+TARGET = test-nic_router_lpm_bench
+SRC_CC = main.cc direct_rule.cc ipv4_address_prefix.cc
+LIBS   = base net
+
+NIC_ROUTER_DIR = $(REP_DIR)/src/server/nic_router
+
+INC_DIR += $(NIC_ROUTER_DIR)
+
+vpath direct_rule.cc         $(NIC_ROUTER_DIR)
+vpath ipv4_address_prefix.cc $(NIC_ROUTER_DIR)
@@ -0,0 +1,288 @@
+/*
+ * \brief  Benchmark of nitpicker's multi-threaded composition
+ * \author Genode Labs
+ * \date   2019-10-25
+ *
+ * The test provides a 4K framebuffer in RAM and a dummy input device to
+ * nitpicker. As nitpicker client, it moves many overlapping transparent
+ * views per frame and measures the time nitpicker needs to compose and
+ * refresh the screen. The number of composing threads is changed by
+ * reporting nitpicker's config. At the end of each round, the views are at
+ * the same positions, so the screen content must be identical for all
+ * thread counts. The views are labeled to cover the drawing of text by
+ * the composing threads.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_dataspace.h>
+#include <base/attached_ram_dataspace.h>
+#include <base/log.h>
+#include <framebuffer_session/framebuffer_session.h>
+#include <input/root.h>
+#include <nitpicker_session/connection.h>
+#include <os/reporter.h>
+#include <os/static_root.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+
+	using namespace Genode;
+
+	struct Screen;
+	struct Main;
+}
+
+
+/**
+ * Framebuffer with a 4K screen in RAM
+ */
+struct Test::Screen : Rpc_object<Framebuffer::Session>
+{
+	Framebuffer::Mode const _mode { 3840, 2160, Framebuffer::Mode::RGB565 };
+
+	Attached_ram_dataspace _ds;
+
+	Signal_context_capability _sync_sigh { };
+
+	Screen(Ram_allocator &ram, Region_map &rm)
+	: _ds(ram, rm, _mode.width()*_mode.height()*_mode.bytes_per_pixel()) { }
+
+	void submit_sync() { Signal_transmitter(_sync_sigh).submit(); }
+
+	/**
+	 * Return checksum of the screen content
+	 */
+	unsigned long checksum() const
+	{
+		unsigned long result = 0;
+
+		unsigned short const *pixel = _ds.local_addr<unsigned short>();
+		for (size_t i = 0; i < _ds.size()/sizeof(*pixel); i++)
+			result = result*31 + pixel[i];
+
+		return result;
+	}
+
+
+	/************************************
+	 ** Framebuffer::Session interface **
+	 ************************************/
+
+	Dataspace_capability dataspace() override { return _ds.cap(); }
+
+	Framebuffer::Mode mode() const override { return _mode; }
+
+	void mode_sigh(Signal_context_capability) override { }
+
+	void sync_sigh(Signal_context_capability sigh) override { _sync_sigh = sigh; }
+
+	void refresh(int, int, int, int) override { }
+};
+
+
+struct Test::Main
+{
+	enum { NUM_VIEWS = 32, VIEW_W = 1024, VIEW_H = 768, FRAMES = 100,
+	       SETTLE_MS = 500, MAX_THREADS = 8 };
+
+	Env &_env;
+
+	Timer::Connection _timer { _env };
+
+	/*
+	 * Serve nitpicker via an independent entrypoint because the test
+	 * blocks in nitpicker-session requests while nitpicker requests the
+	 * framebuffer and input sessions.
+	 */
+	enum { STACK_SIZE = 4*1024*sizeof(long) };
+
+	Entrypoint _ep { _env, STACK_SIZE, "server_ep", Affinity::Location() };
+
+	Screen _screen { _env.ram(), _env.rm() };
+
+	Static_root<Framebuffer::Session> _fb_root { _ep.manage(_screen) };
+
+	Input::Session_component _input { _env, _env.ram() };
+	Input::Root_component    _input_root { _ep.rpc_ep(), _input };
+
+	Reporter _config { _env, "config", "nitpicker.config" };
+
+	Constructible<Nitpicker::Connection> _nitpicker { };
+	Constructible<Attached_dataspace>    _buffer    { };
+
+	typedef Nitpicker::Session::View_handle View_handle;
+	typedef Nitpicker::Session::Command     Command;
+
+	View_handle _views[NUM_VIEWS];
+
+	unsigned const _max_threads =
+		min((unsigned)MAX_THREADS, (unsigned)_env.cpu().affinity_space().total());
+
+	unsigned _threads = 0;
+	unsigned _frame   = 0;
+
+	uint64_t _start_us = 0;
+	uint64_t _total_us = 0;
+
+	unsigned long _checksum = 0;
+
+	void _report_config(unsigned threads)
+	{
+		Reporter::Xml_generator xml(_config, [&] () {
+			xml.node("domain", [&] () {
+				xml.attribute("name",    "default");
+				xml.attribute("layer",   1);
+				xml.attribute("content", "client");
+				xml.attribute("label",   "yes");
+			});
+			xml.node("default-policy", [&] () {
+				xml.attribute("domain", "default"); });
+			xml.node("compositor", [&] () {
+				xml.attribute("threads", threads); });
+		});
+	}
+
+	void _init_buffer()
+	{
+		Framebuffer::Mode const mode(VIEW_W, VIEW_H, Framebuffer::Mode::RGB565);
+		_nitpicker->buffer(mode, true);
+
+		_buffer.construct(_env.rm(), _nitpicker->framebuffer()->dataspace());
+
+		unsigned short *pixel = _buffer->local_addr<unsigned short>();
+		unsigned char  *alpha = (unsigned char *)(pixel + VIEW_W*VIEW_H);
+		unsigned char  *input = alpha + VIEW_W*VIEW_H;
+
+		for (unsigned y = 0; y < VIEW_H; y++) {
+			for (unsigned x = 0; x < VIEW_W; x++) {
+				unsigned const i = y*VIEW_W + x;
+				pixel[i] = (unsigned short)((y/8)*32*64 + (x/4)*32 + ((x*y) >> 8));
+				alpha[i] = (unsigned char)(64 + ((x ^ y) & 0x7f));
+				input[i] = 0;
+			}
+		}
+	}
+
+	/**
+	 * Move all views to their positions of the current frame
+	 */
+	void _move_views()
+	{
+		int const max_x = _screen._mode.width()  - VIEW_W,
+		          max_y = _screen._mode.height() - VIEW_H;
+
+		for (unsigned i = 0; i < NUM_VIEWS; i++) {
+
+			int const x = (int)((i*211 + _frame*(i % 5 + 1)*16) % max_x),
+			          y = (int)((i*137 + _frame*(i % 3 + 1)*12) % max_y);
+
+			Nitpicker::Rect const rect(Nitpicker::Point(x, y),
+			                           Nitpicker::Area(VIEW_W, VIEW_H));
+
+			_nitpicker->enqueue<Command::Geometry>(_views[i], rect);
+		}
+		_nitpicker->execute();
+	}
+
+	void _next_frame()
+	{
+		_move_views();
+
+		_start_us = _timer.elapsed_us();
+		_screen.submit_sync();
+	}
+
+	void _start_round(unsigned threads)
+	{
+		_threads  = threads;
+		_frame    = 0;
+		_total_us = 0;
+
+		_report_config(_threads);
+
+		/* give nitpicker the chance to apply the new config */
+		_timer.trigger_once(SETTLE_MS*1000);
+	}
+
+	void _handle_timer() { _next_frame(); }
+
+	Signal_handler<Main> _timer_handler {
+		_env.ep(), *this, &Main::_handle_timer };
+
+	/**
+	 * Called after nitpicker composed and refreshed the screen
+	 */
+	void _handle_sync()
+	{
+		if (!_threads)
+			return;
+
+		/* the first frame includes the full redraw caused by the config */
+		if (_frame > 0)
+			_total_us += _timer.elapsed_us() - _start_us;
+
+		if (++_frame <= FRAMES) {
+			_next_frame();
+			return;
+		}
+
+		unsigned long const checksum = _screen.checksum();
+
+		log("threads: ", _threads, " "
+		    "frame: ", _total_us/FRAMES, " us "
+		    "checksum: ", Hex(checksum));
+
+		if (_checksum && checksum != _checksum)
+			error("screen content differs from the single-threaded composition");
+
+		_checksum = checksum;
+
+		if (_threads < _max_threads) {
+			_start_round(_threads*2);
+			return;
+		}
+
+		_threads = 0;
+		log("--- nitpicker compositor benchmark finished ---");
+	}
+
+	Signal_handler<Main> _sync_handler {
+		_env.ep(), *this, &Main::_handle_sync };
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- nitpicker compositor benchmark started ---");
+
+		_config.enabled(true);
+		_report_config(1);
+
+		_env.parent().announce(_ep.manage(_fb_root));
+		_env.parent().announce(_ep.manage(_input_root));
+
+		_nitpicker.construct(_env, "benchmark");
+		_init_buffer();
+
+		for (unsigned i = 0; i < NUM_VIEWS; i++) {
+			_views[i] = _nitpicker->create_view();
+			_nitpicker->enqueue<Command::To_front>(_views[i], View_handle());
+			_nitpicker->enqueue<Command::Title>(_views[i], String<64>("view ", i));
+		}
+		_nitpicker->execute();
+
+		_timer.sigh(_timer_handler);
+		_nitpicker->framebuffer()->sync_sigh(_sync_handler);
+
+		_start_round(1);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
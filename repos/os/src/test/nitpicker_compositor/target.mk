@@ -0,0 +1,3 @@
+TARGET = test-nitpicker_compositor
+SRC_CC = main.cc
+LIBS   = base
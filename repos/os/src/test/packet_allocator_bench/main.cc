@@ -0,0 +1,206 @@
+/*
+ * \brief  Benchmark for the packet-stream allocator
+ * \author Genode Labs
+ * \date   2019-10-02
+ *
+ * The benchmark simulates the allocation patterns of NIC and block
+ * sessions with many packets in flight. It compares the word-scanning
+ * 'Packet_allocator' with the former bit-by-bit scanning implementation.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <os/packet_allocator.h>
+#include <timer_session/connection.h>
+#include <util/bit_array.h>
+
+using namespace Genode;
+
+
+/**
+ * Former packet allocator, which scans the bit array block by block
+ */
+class Bit_array_packet_allocator : public Allocator
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Bit_array_packet_allocator(Bit_array_packet_allocator const &);
+		Bit_array_packet_allocator &operator = (Bit_array_packet_allocator const &);
+
+		Allocator      &_md_alloc;
+		size_t   const  _block_size;
+		size_t   const  _block_cnt;
+		void           *_bits;
+		Bit_array_base  _array;
+		addr_t   const  _base;
+		addr_t          _next = 0;
+
+	public:
+
+		Bit_array_packet_allocator(Allocator &md_alloc, size_t block_size,
+		                           addr_t base, size_t size)
+		:
+			_md_alloc(md_alloc), _block_size(block_size),
+			_block_cnt((size/block_size) & ~(sizeof(addr_t)*8 - 1)),
+			_bits(md_alloc.alloc(_block_cnt/8)),
+			_array(_block_cnt, (addr_t *)_bits, true),
+			_base(base)
+		{ }
+
+		~Bit_array_packet_allocator() { _md_alloc.free(_bits, _block_cnt/8); }
+
+		bool alloc(size_t size, void **out_addr) override
+		{
+			addr_t const cnt = (size % _block_size) ? size / _block_size + 1
+			                                        : size / _block_size;
+			addr_t max = ~0UL;
+
+			do {
+				try {
+					for (addr_t i = _next & ~(cnt - 1); i < max; i += cnt) {
+						if (_array.get(i, cnt))
+							continue;
+
+						_array.set(i, cnt);
+						_next = i + cnt;
+						*out_addr = reinterpret_cast<void *>(i * _block_size
+						                                     + _base);
+						return true;
+					}
+				} catch (Bit_array_base::Invalid_index_access) { }
+
+				max = _next;
+				_next = 0;
+
+			} while (max != 0);
+
+			return false;
+		}
+
+		void free(void *addr, size_t size) override
+		{
+			addr_t i   = (((addr_t)addr) - _base) / _block_size;
+			size_t cnt = (size % _block_size) ? size / _block_size + 1
+			                                  : size / _block_size;
+			try { _array.clear(i, cnt); } catch(...) { }
+			_next = i;
+		}
+
+		bool   need_size_for_free() const override { return true; }
+		size_t consumed()           const override { return 0; }
+		size_t overhead(size_t)     const override { return 0; }
+};
+
+
+struct Main
+{
+	enum { BASE = 0x10000000, ROUNDS = 200000, MAX_IN_FLIGHT = 512 };
+
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Timer::Connection _timer { _env };
+
+	struct Workload
+	{
+		char const *name;
+		size_t      block_size;
+		size_t      buffer_size;
+		size_t      min_packet;
+		size_t      max_packet;
+		unsigned    in_flight;
+	};
+
+	/**
+	 * Allocate packets and release them in FIFO order, like a session
+	 * with 'in_flight' outstanding requests does
+	 */
+	uint64_t _measure(Allocator &alloc, Workload const &w)
+	{
+		struct Packet { void *addr; size_t size; };
+
+		Packet   packets[MAX_IN_FLIGHT] { };
+		unsigned seed   = 1;
+		unsigned failed = 0;
+
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < ROUNDS; i++) {
+
+			Packet &p = packets[i % w.in_flight];
+			if (p.addr)
+				alloc.free(p.addr, p.size);
+
+			seed   = seed*1103515245 + 12345;
+			p.size = w.min_packet + (seed >> 16) % (w.max_packet - w.min_packet + 1);
+
+			if (!alloc.alloc(p.size, &p.addr)) {
+				p.addr = nullptr;
+				failed++;
+			}
+		}
+
+		uint64_t const duration_us = _timer.elapsed_us() - start_us;
+
+		for (unsigned i = 0; i < w.in_flight; i++)
+			if (packets[i].addr)
+				alloc.free(packets[i].addr, packets[i].size);
+
+		if (failed)
+			log("  ", failed, " allocations failed");
+
+		return duration_us;
+	}
+
+	void _run(Workload const &w)
+	{
+		Packet_allocator packet_alloc(&_heap, w.block_size);
+		packet_alloc.add_range(BASE, w.buffer_size);
+
+		Bit_array_packet_allocator bit_array_alloc(_heap, w.block_size,
+		                                           BASE, w.buffer_size);
+
+		uint64_t const packet_us    = _measure(packet_alloc,    w);
+		uint64_t const bit_array_us = _measure(bit_array_alloc, w);
+
+		packet_alloc.remove_range(BASE, w.buffer_size);
+
+		log(w.name, ": "
+		    "packet allocator: ", (packet_us*1000)/ROUNDS, " ns/packet "
+		    "bit-array allocator: ", (bit_array_us*1000)/ROUNDS, " ns/packet");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- packet allocator benchmark started ---");
+
+		/* NIC session as used by nic_router, 1600-byte blocks */
+		_run({ "nic  64 in flight",   1600, 1600*256,   60, 1514,  64 });
+		_run({ "nic 240 in flight",   1600, 1600*256,   60, 1514, 240 });
+
+		/* block session with 512-byte blocks and requests up to 64 KiB */
+		_run({ "block  32 in flight",  512, 4*1024*1024, 512, 64*1024,  32 });
+		_run({ "block 128 in flight",  512, 16*1024*1024, 512, 64*1024, 128 });
+
+		/* large block requests spanning 96 to 512 blocks */
+		_run({ "block large 16 in flight", 512, 32*1024*1024, 48*1024, 256*1024, 16 });
+
+		log("--- packet allocator benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
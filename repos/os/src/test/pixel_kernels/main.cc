@@ -0,0 +1,211 @@
+/*
+ * \brief  Test and benchmark of the pixel kernels used by the painters
+ * \author Genode Labs
+ * \date   2019-10-25
+ *
+ * The test compares the kernels for the RGB565 and RGB888 formats with the
+ * generic per-pixel implementation for rows of all lengths up to 64 pixels.
+ * The benchmark measures the pixel throughput of both for a screen-sized
+ * surface.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_ram_dataspace.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+#include <os/pixel_kernels.h>
+#include <util/string.h>
+
+using namespace Genode;
+
+namespace Kernels = Genode::Pixel_kernels;
+
+
+struct Main
+{
+	enum {
+		WIDTH = 1024, HEIGHT = 768, PIXELS = WIDTH*HEIGHT,
+		MAX_TEST_LEN = 64, BENCH_ROUNDS = 50,
+	};
+
+	Env                    &_env;
+	Timer::Connection       _timer { _env };
+	Attached_ram_dataspace  _src   { _env.ram(), _env.rm(), PIXELS*4 };
+	Attached_ram_dataspace  _dst   { _env.ram(), _env.rm(), PIXELS*4 };
+	Attached_ram_dataspace  _ref   { _env.ram(), _env.rm(), PIXELS*4 };
+	Attached_ram_dataspace  _alpha { _env.ram(), _env.rm(), PIXELS };
+	unsigned                _seed  { 1 };
+	unsigned                _errors { 0 };
+
+	unsigned _random()
+	{
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	void _randomize(void *dst, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+			((unsigned char *)dst)[i] = (unsigned char)_random();
+	}
+
+	/**
+	 * Generate alpha values with runs of transparent and opaque pixels
+	 */
+	void _randomize_alpha()
+	{
+		unsigned char *alpha = _alpha.local_addr<unsigned char>();
+
+		for (unsigned i = 0; i < PIXELS; ) {
+			unsigned const len  = min(1 + _random() % 32, (unsigned)PIXELS - i);
+			unsigned const kind = _random() % 4;
+			for (unsigned j = 0; j < len; j++, i++)
+				alpha[i] = kind == 0 ? 0 : kind == 1 ? 255 : (unsigned char)_random();
+		}
+	}
+
+	/**
+	 * Apply 'generic' and 'kernel' to rows of all lengths and offsets
+	 *
+	 * Both functors are called with the row length and the offset of the
+	 * first pixel.
+	 */
+	template <typename PT, typename GENERIC, typename KERNEL>
+	void _check(char const *what, GENERIC const &generic, KERNEL const &kernel)
+	{
+		PT *dst = _dst.local_addr<PT>(), *ref = _ref.local_addr<PT>();
+
+		_randomize(ref, PIXELS*sizeof(PT));
+		memcpy(dst, ref, PIXELS*sizeof(PT));
+
+		unsigned offset = 0;
+		for (unsigned len = 0; len <= MAX_TEST_LEN; len++) {
+			for (unsigned shift = 0; shift < 8; shift++, offset += len + shift) {
+				generic(len, offset);
+				kernel(len, offset);
+			}
+		}
+
+		for (unsigned i = 0; i < offset; i++) {
+			if (dst[i].pixel == ref[i].pixel)
+				continue;
+
+			if (_errors++ < 10)
+				error(what, ": pixel ", i, " is ", Hex(dst[i].pixel),
+				      " expected ", Hex(ref[i].pixel));
+		}
+	}
+
+	/**
+	 * Measure throughput of 'fn' applied to all rows of the surface
+	 */
+	template <typename FN>
+	void _measure(char const *what, FN const &fn)
+	{
+		uint64_t const start_ms = _timer.elapsed_ms();
+		for (unsigned r = 0; r < BENCH_ROUNDS; r++)
+			for (unsigned y = 0; y < HEIGHT; y++)
+				fn(WIDTH, y*WIDTH);
+		uint64_t const duration_ms = max(_timer.elapsed_ms() - start_ms, 1ULL);
+
+		log(what, ": ", duration_ms, " ms, ",
+		    (uint64_t)PIXELS*BENCH_ROUNDS / 1000 / duration_ms, " Mpixel/s");
+	}
+
+	template <typename PT, typename GENERIC, typename KERNEL>
+	void _test_op(char const *what, GENERIC const &generic, KERNEL const &kernel)
+	{
+		_check<PT>(what, generic, kernel);
+
+		String<64> const generic_what(what, " generic");
+		String<64> const kernel_what (what, " kernel ");
+
+		_measure(generic_what.string(), generic);
+		_measure(kernel_what.string(),  kernel);
+	}
+
+	template <typename PT>
+	void _test_format(char const *format)
+	{
+		PT            const *src   = _src.local_addr<PT const>();
+		PT                  *dst   = _dst.local_addr<PT>();
+		PT                  *ref   = _ref.local_addr<PT>();
+		unsigned char const *alpha = _alpha.local_addr<unsigned char const>();
+
+		PT const pixel(0x40, 0x80, 0xc0);
+		int const pixel_alpha = 0x60;
+
+		String<32> const fill(format, " fill");
+		_test_op<PT>(fill.string(),
+			[&] (unsigned n, unsigned o) { Kernels::fill<PT>(ref + o, pixel, n); },
+			[&] (unsigned n, unsigned o) { Kernels::fill    (dst + o, pixel, n); });
+
+		String<32> const mix_pixel(format, " mix pixel");
+		_test_op<PT>(mix_pixel.string(),
+			[&] (unsigned n, unsigned o) { Kernels::mix<PT>(ref + o, pixel, pixel_alpha, n); },
+			[&] (unsigned n, unsigned o) { Kernels::mix    (dst + o, pixel, pixel_alpha, n); });
+
+		String<32> const mix_texture(format, " mix texture");
+		_test_op<PT>(mix_texture.string(),
+			[&] (unsigned n, unsigned o) { Kernels::mix<PT>(ref + o, src + o, alpha + o, n); },
+			[&] (unsigned n, unsigned o) { Kernels::mix    (dst + o, src + o, alpha + o, n); });
+
+		String<32> const avr(format, " avr");
+		_test_op<PT>(avr.string(),
+			[&] (unsigned n, unsigned o) { Kernels::avr<PT>(ref + o, src + o, pixel, n); },
+			[&] (unsigned n, unsigned o) { Kernels::avr    (dst + o, src + o, pixel, n); });
+	}
+
+	void _test_dither(bool with_alpha)
+	{
+		Pixel_rgb888  const *src   = _src.local_addr<Pixel_rgb888 const>();
+		Pixel_rgb565        *dst   = _dst.local_addr<Pixel_rgb565>();
+		Pixel_rgb565        *ref   = _ref.local_addr<Pixel_rgb565>();
+		unsigned char const *alpha = with_alpha ? _alpha.local_addr<unsigned char const>()
+		                                        : nullptr;
+
+		auto row = [] (unsigned o) { return Dither_matrix::row(o / WIDTH); };
+
+		_test_op<Pixel_rgb565>(with_alpha ? "dither with alpha" : "dither",
+			[&] (unsigned n, unsigned o) {
+				Kernels::dither<Pixel_rgb565, Pixel_rgb888>(ref + o, src + o,
+				                                            alpha ? alpha + o : nullptr,
+				                                            row(o), o % WIDTH, n); },
+			[&] (unsigned n, unsigned o) {
+				Kernels::dither(dst + o, src + o, alpha ? alpha + o : nullptr,
+				                row(o), o % WIDTH, n); });
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- pixel-kernel test started ---");
+
+		_randomize(_src.local_addr<void>(), PIXELS*4);
+		_randomize_alpha();
+
+		_test_format<Pixel_rgb565>("RGB565");
+		_test_format<Pixel_rgb888>("RGB888");
+		_test_dither(false);
+		_test_dither(true);
+
+		if (_errors) {
+			error(_errors, " pixel errors");
+			env.parent().exit(-1);
+			return;
+		}
+
+		log("--- pixel-kernel test finished ---");
+		env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
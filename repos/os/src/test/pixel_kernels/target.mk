@@ -0,0 +1,3 @@
+TARGET = test-pixel_kernels
+SRC_CC = main.cc
+LIBS   = base
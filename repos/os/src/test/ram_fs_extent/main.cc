@@ -0,0 +1,236 @@
+/*
+ * \brief  Benchmark of the RAM fs extent store against the chunk tree
+ * \author Genode Labs
+ * \date   2019-10-24
+ *
+ * Both data structures are dimensioned as used by the RAM file systems. A
+ * file is written and read sequentially with small and large blocks, and
+ * randomly with small blocks. After each pass, the content of both
+ * structures is compared.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <ram_fs/chunk.h>
+#include <ram_fs/extent.h>
+#include <ram_fs/param.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+
+	using namespace Genode;
+	using namespace Ram_fs;
+	using File_system::file_size_t;
+
+	struct Chunk_file;
+	struct Extent_file;
+	struct Main;
+}
+
+
+struct Test::Chunk_file
+{
+	typedef File_system::Chunk      <num_level_3_entries()>                Chunk_level_3;
+	typedef File_system::Chunk_index<num_level_2_entries(), Chunk_level_3> Chunk_level_2;
+	typedef File_system::Chunk_index<num_level_1_entries(), Chunk_level_2> Chunk_level_1;
+	typedef File_system::Chunk_index<num_level_0_entries(), Chunk_level_1> Chunk_level_0;
+
+	static char const *name() { return "chunk tree"; }
+
+	Chunk_level_0 chunk;
+
+	Chunk_file(Allocator &alloc) : chunk(alloc, 0) { }
+
+	void write(char const *src, size_t len, file_size_t pos) { chunk.write(src, len, pos); }
+
+	void read(char *dst, size_t len, file_size_t pos) const
+	{
+		/* the chunk tree must not be read behind its used size */
+		file_size_t const used = chunk.used_size();
+		size_t const n = pos >= used ? 0 : (size_t)min((file_size_t)len, used - pos);
+
+		chunk.read(dst, n, pos);
+		memset(dst + n, 0, len - n);
+	}
+
+	void truncate(file_size_t size) { chunk.truncate(size); }
+};
+
+
+struct Test::Extent_file
+{
+	static char const *name() { return "extents"; }
+
+	File_system::Extent_store<min_extent_size(), max_extent_size()> extents;
+
+	Extent_file(Allocator &alloc) : extents(alloc) { }
+
+	void write(char const *src, size_t len, file_size_t pos)
+	{
+		if (extents.write(src, len, pos) != len)
+			throw Out_of_ram();
+	}
+
+	void read(char *dst, size_t len, file_size_t pos) const { extents.read(dst, len, pos); }
+
+	void truncate(file_size_t size) { extents.truncate(size); }
+};
+
+
+struct Test::Main
+{
+	enum { FILE_SIZE   = 32*1024*1024,
+	       SMALL_BLOCK = 4*1024,
+	       LARGE_BLOCK = 256*1024,
+	       RANDOM_OPS  = 16*1024 };
+
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Timer::Connection _timer { _env };
+
+	Chunk_file  _chunk_file  { _heap };
+	Extent_file _extent_file { _heap };
+
+	char _buf[LARGE_BLOCK];
+	char _cmp[LARGE_BLOCK];
+
+	unsigned _seed { 1 };
+
+	unsigned _random()
+	{
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	void _fill(size_t len)
+	{
+		for (size_t i = 0; i < len; i++)
+			_buf[i] = (char)_random();
+	}
+
+	template <typename FILE, typename FN>
+	void _measure(FILE &file, char const *pass, size_t bytes, FN const &fn)
+	{
+		uint64_t const start_us = _timer.elapsed_us();
+		fn(file);
+		uint64_t const duration_us = max(_timer.elapsed_us() - start_us, (uint64_t)1);
+
+		log(FILE::name(), ": ", pass, ": ", bytes/1024, " KiB in ",
+		    duration_us/1000, " ms, ", (bytes/duration_us)*1000*1000/(1024*1024),
+		    " MiB/s");
+	}
+
+	template <typename FILE>
+	void _sequential_write(FILE &file, char const *pass, size_t block)
+	{
+		_measure(file, pass, FILE_SIZE, [&] (FILE &file) {
+			for (file_size_t pos = 0; pos < FILE_SIZE; pos += block)
+				file.write(_buf, block, pos); });
+	}
+
+	template <typename FILE>
+	void _sequential_read(FILE &file, char const *pass, size_t block)
+	{
+		_measure(file, pass, FILE_SIZE, [&] (FILE &file) {
+			for (file_size_t pos = 0; pos < FILE_SIZE; pos += block)
+				file.read(_cmp, block, pos); });
+	}
+
+	template <typename FILE>
+	void _random_io(FILE &file, char const *pass, bool write)
+	{
+		_measure(file, pass, RANDOM_OPS*SMALL_BLOCK, [&] (FILE &file) {
+			for (unsigned i = 0; i < RANDOM_OPS; i++) {
+				file_size_t const pos =
+					(file_size_t)(_random() % (FILE_SIZE/SMALL_BLOCK))*SMALL_BLOCK;
+				if (write)
+					file.write(_buf, SMALL_BLOCK, pos);
+				else
+					file.read(_cmp, SMALL_BLOCK, pos);
+			}
+		});
+	}
+
+	/**
+	 * Compare content of both data structures
+	 */
+	void _compare(char const *pass)
+	{
+		for (file_size_t pos = 0; pos < FILE_SIZE; pos += LARGE_BLOCK) {
+			_chunk_file.read(_buf, LARGE_BLOCK, pos);
+			_extent_file.read(_cmp, LARGE_BLOCK, pos);
+
+			if (memcmp(_buf, _cmp, LARGE_BLOCK)) {
+				error(pass, ": content differs at offset ", pos);
+				throw Exception();
+			}
+		}
+	}
+
+	/**
+	 * Apply pass to both data structures with the same random positions
+	 */
+	template <typename FN>
+	void _pass(char const *pass, FN const &fn)
+	{
+		unsigned const seed = _seed;
+		fn(_chunk_file);
+		_seed = seed;
+		fn(_extent_file);
+		_compare(pass);
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- RAM fs extent benchmark ---");
+
+		_fill(LARGE_BLOCK);
+
+		_pass("sequential 4 KiB writes", [&] (auto &file) {
+			this->_sequential_write(file, "sequential 4 KiB writes", SMALL_BLOCK); });
+
+		_pass("sequential 256 KiB writes", [&] (auto &file) {
+			this->_sequential_write(file, "sequential 256 KiB writes", LARGE_BLOCK); });
+
+		_pass("sequential 4 KiB reads", [&] (auto &file) {
+			this->_sequential_read(file, "sequential 4 KiB reads", SMALL_BLOCK); });
+
+		_pass("sequential 256 KiB reads", [&] (auto &file) {
+			this->_sequential_read(file, "sequential 256 KiB reads", LARGE_BLOCK); });
+
+		_pass("random 4 KiB writes", [&] (auto &file) {
+			this->_random_io(file, "random 4 KiB writes", true); });
+
+		_pass("random 4 KiB reads", [&] (auto &file) {
+			this->_random_io(file, "random 4 KiB reads", false); });
+
+		_pass("truncate", [&] (auto &file) {
+			_measure(file, "truncate", FILE_SIZE, [&] (auto &file) {
+				file.truncate(FILE_SIZE/2);
+				file.truncate(0); }); });
+
+		/* sparse file, only the written blocks consume memory */
+		size_t const consumed = _heap.consumed();
+		for (unsigned i = 0; i < 16; i++)
+			_extent_file.write(_buf, SMALL_BLOCK, (file_size_t)i*1024*1024*1024);
+
+		log("extents: sparse 16 GiB file with 16 blocks uses ",
+		    (_heap.consumed() - consumed)/1024, " KiB");
+
+		log("--- RAM fs extent benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -61,7 +61,7 @@ class Trace_buffer_monitor
 		Region_map           &_rm;
 		Trace::Subject_id     _id;
 		Trace::Buffer        *_buffer;
-		Trace::Buffer::Entry  _curr_entry;
+		Trace::Buffer::Reader _reader { };
 
 		const char *_terminate_entry(Trace::Buffer::Entry const &entry)
 		{
@@ -77,8 +77,7 @@ class Trace_buffer_monitor
 		                     Trace::Subject_id     id,
 		                     Dataspace_capability  ds_cap)
 		:
-			_rm(rm), _id(id), _buffer(rm.attach(ds_cap)),
-			_curr_entry(_buffer->first())
+			_rm(rm), _id(id), _buffer(rm.attach(ds_cap))
 		{
 			log("monitor "
 				"subject:", _id.id, " "
@@ -97,17 +96,13 @@ class Trace_buffer_monitor
 			log("overflows: ", _buffer->wrapped());
 			log("read all remaining events");
 
-			for (; !_curr_entry.last(); _curr_entry = _buffer->next(_curr_entry)) {
-				/* omit empty entries */
-				if (_curr_entry.length() == 0)
-					continue;
-
-				char const * const data = _terminate_entry(_curr_entry);
+			_reader.for_each_new_entry(*_buffer, [&] (Trace::Buffer::Entry const &entry) {
+				char const * const data = _terminate_entry(entry);
 				if (data) { log(data); }
-			}
+				return true;
+			});
 
-			/* reset after we read all available entries */
-			_curr_entry = _buffer->first();
+			log("overruns: ", _reader.overruns());
 		}
 };
 
@@ -0,0 +1,141 @@
+/*
+ * \brief  Test for the out-of-order completion of File_system packets
+ * \author Genode Labs
+ * \date   2019-10-11
+ *
+ * A read of a terminal without input blocks forever. Further packets for
+ * the terminal handle queue up behind the blocked read. Packets of another
+ * handle of the same session that are submitted afterwards must
+ * nevertheless be completed.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <file_system_session/connection.h>
+#include <base/allocator_avl.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+
+namespace Test {
+	using namespace Genode;
+	using namespace File_system;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	typedef File_system::Packet_descriptor Packet_descriptor;
+
+	Env &_env;
+
+	Heap          _heap      { _env.ram(), _env.rm() };
+	Allocator_avl _avl_alloc { &_heap };
+
+	File_system::Connection _fs { _env, _avl_alloc, "", "/", true, 16<<10 };
+
+	File_system::Session::Tx::Source &_tx { *_fs.tx() };
+
+	Dir_handle  _root_handle     { _fs.dir("/", false) };
+	File_handle _terminal_handle { _fs.file(_root_handle, "terminal", READ_ONLY, false) };
+	Dir_handle  _ram_handle      { _fs.dir("/ram", false) };
+	File_handle _file_handle     { _fs.file(_ram_handle, "file", READ_WRITE, true) };
+
+	enum { ROUNDS = 10, CHUNK = 1024 };
+
+	unsigned _round = 0;
+
+	Signal_handler<Main> _ack_handler { _env.ep(), *this, &Main::_handle_ack };
+
+	static char _pattern(unsigned round, size_t i) {
+		return (char)('a' + (round + i) % 26); }
+
+	void _submit(Node_handle handle, Packet_descriptor::Opcode op,
+	             unsigned round)
+	{
+		Packet_descriptor packet(_tx.alloc_packet(CHUNK), handle, op,
+		                         CHUNK, round*CHUNK);
+
+		if (op == Packet_descriptor::WRITE) {
+			char *content = _tx.packet_content(packet);
+			for (size_t i = 0; i < CHUNK; i++)
+				content[i] = _pattern(round, i);
+		}
+		_tx.submit_packet(packet);
+	}
+
+	/**
+	 * Write a chunk of the ram file and read it back
+	 */
+	void _submit_round()
+	{
+		_submit(_file_handle, Packet_descriptor::WRITE, _round);
+		_submit(_file_handle, Packet_descriptor::READ,  _round);
+	}
+
+	void _fail(char const *msg)
+	{
+		error(msg);
+		_env.parent().exit(-1);
+	}
+
+	void _handle_ack()
+	{
+		while (_tx.ack_avail()) {
+
+			Packet_descriptor const packet = _tx.get_acked_packet();
+
+			if (packet.handle() == _terminal_handle) {
+				_fail("blocked terminal read completed");
+				return;
+			}
+
+			if (!packet.succeeded() || packet.length() != CHUNK) {
+				_fail("ram-file operation failed");
+				return;
+			}
+
+			if (packet.operation() == Packet_descriptor::READ) {
+				char const *content = _tx.packet_content(packet);
+				for (size_t i = 0; i < CHUNK; i++) {
+					if (content[i] != _pattern(_round, i)) {
+						_fail("ram-file content mismatch");
+						return;
+					}
+				}
+
+				if (++_round == ROUNDS) {
+					log("completed ", (unsigned)ROUNDS, " rounds of ram-file "
+					    "I/O while the terminal read is blocked");
+					log("--- VFS out-of-order test finished ---");
+					_env.parent().exit(0);
+					return;
+				}
+				_submit_round();
+			}
+
+			_tx.release_packet(packet);
+		}
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		_fs.sigh_ack_avail(_ack_handler);
+
+		/* the terminal never delivers input, so the reads never complete */
+		_submit(_terminal_handle, Packet_descriptor::READ, 0);
+		_submit(_terminal_handle, Packet_descriptor::READ, 0);
+
+		_submit_round();
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-vfs_out_of_order
+SRC_CC = main.cc
+LIBS   = base
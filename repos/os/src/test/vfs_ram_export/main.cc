@@ -0,0 +1,163 @@
+/*
+ * \brief  Test for sharing the dataspace of a file of the VFS ram plugin
+ * \author Genode Labs
+ * \date   2019-10-25
+ *
+ * A large file is requested as dataspace by many clients, which must share
+ * the file content instead of getting a copy each. A write to the file must
+ * not affect the dataspaces handed out before.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <vfs/simple_env.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	typedef Vfs::Directory_service Ds;
+	typedef Vfs::File_io_service   Fs;
+
+	enum { BLOCK = 1024*1024, NUM_CLIENTS = 20, MAX_CLIENTS = 64 };
+
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Vfs::Simple_env _vfs_env { _env, _heap, _config.xml().sub_node("vfs") };
+
+	Vfs::File_system &_vfs = _vfs_env.root_dir();
+
+	size_t   const _size    = _config.xml().attribute_value("size_mb", 64UL)*BLOCK;
+	unsigned const _clients = min(_config.xml().attribute_value("clients",
+	                                                            (unsigned)NUM_CLIENTS),
+	                              (unsigned)MAX_CLIENTS);
+
+	static char const *_path() { return "/shared"; }
+
+	struct Client { Dataspace_capability ds { }; char const *local = nullptr; };
+
+	Client _client[MAX_CLIENTS];
+
+	char _block[BLOCK];
+
+	static char _pattern(size_t offset) { return (char)(offset / 4096 + 1); }
+
+	size_t _used_kib() const { return _env.pd().used_ram().value / 1024; }
+
+	void _write(Vfs::Vfs_handle &handle, char const *src, size_t len, size_t offset)
+	{
+		Vfs::file_size out = 0;
+		handle.seek(offset);
+		if (_vfs.write(&handle, src, len, out) != Fs::WRITE_OK || out != len) {
+			error("write at offset ", offset, " failed");
+			throw Exception();
+		}
+	}
+
+	void _create_file()
+	{
+		Vfs::Vfs_handle *handle = nullptr;
+		if (_vfs.open(_path(), Ds::OPEN_MODE_RDWR | Ds::OPEN_MODE_CREATE,
+		              &handle, _heap) != Ds::OPEN_OK)
+			throw Exception();
+
+		for (size_t offset = 0; offset < _size; offset += BLOCK) {
+			for (size_t i = 0; i < BLOCK; i++)
+				_block[i] = _pattern(offset + i);
+			_write(*handle, _block, BLOCK, offset);
+		}
+		handle->close();
+	}
+
+	void _check(char const *local, char const *what)
+	{
+		for (size_t offset = 0; offset < _size; offset += 4096) {
+			if (local[offset] != _pattern(offset)) {
+				error(what, ": unexpected content at offset ", offset);
+				throw Exception();
+			}
+		}
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- VFS ram export test ---");
+
+		_create_file();
+
+		size_t const used_file = _used_kib();
+		log("file of ", _size/1024, " KiB written, ", used_file, " KiB used");
+
+		for (unsigned i = 0; i < _clients; i++) {
+			Client &c = _client[i];
+
+			c.ds = _vfs.dataspace(_path());
+			if (!c.ds.valid()) {
+				error("client ", i, ": no dataspace");
+				throw Exception();
+			}
+			c.local = _env.rm().attach(c.ds, 0, 0, false, (addr_t)0, false, false);
+			_check(c.local, "mapping");
+		}
+
+		size_t const used_mapped = _used_kib();
+		log(_clients, " clients mapped the file, ", used_mapped, " KiB used");
+
+		if (used_mapped > used_file + _size/1024/2) {
+			error("file content is not shared");
+			throw Exception();
+		}
+
+		/* modify the file, the mappings keep the original content */
+		{
+			Vfs::Vfs_handle *handle = nullptr;
+			if (_vfs.open(_path(), Ds::OPEN_MODE_RDWR, &handle, _heap) != Ds::OPEN_OK)
+				throw Exception();
+
+			char const c = 0;
+			_write(*handle, &c, 1, 0);
+			handle->close();
+		}
+
+		for (unsigned i = 0; i < _clients; i++)
+			_check(_client[i].local, "mapping after write");
+
+		log("file modified, ", _used_kib(), " KiB used");
+
+		for (unsigned i = 0; i < _clients; i++) {
+			_env.rm().detach(_client[i].local);
+			_vfs.release(_path(), _client[i].ds);
+		}
+
+		size_t const used_released = _used_kib();
+		log("mappings released, ", used_released, " KiB used");
+
+		if (used_released > used_file + _size/1024/2) {
+			error("dataspace was not freed");
+			throw Exception();
+		}
+
+		log("--- VFS ram export test finished ---");
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
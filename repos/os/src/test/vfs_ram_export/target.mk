@@ -0,0 +1,3 @@
+TARGET = test-vfs_ram_export
+SRC_CC = main.cc
+LIBS   = base vfs
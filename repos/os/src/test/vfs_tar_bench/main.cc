@@ -0,0 +1,135 @@
+/*
+ * \brief  Benchmark of the tar VFS plugin with large archives
+ * \author Genode Labs
+ * \date   2019-10-23
+ *
+ * The VFS configured by the '<vfs>' node is created, and the whole tree is
+ * traversed several times. Each traversal reads all directory entries and
+ * stats each entry found. With archives of tens of thousands of members,
+ * the cost of scanning the archive, of reading large directories, and of
+ * path lookups becomes visible.
+ */
+
+/*
+ * Copyright (C) 2019 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <os/path.h>
+#include <timer_session/connection.h>
+#include <util/reconstructible.h>
+#include <vfs/simple_env.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	typedef Vfs::Directory_service          Ds;
+	typedef Vfs::File_io_service            Fs;
+	typedef Genode::Path<Vfs::MAX_PATH_LEN> Path;
+
+	Env &_env;
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection _timer { _env };
+
+	Constructible<Vfs::Simple_env> _vfs_env { };
+
+	unsigned const _rounds = _config.xml().attribute_value("rounds", 3U);
+
+	struct Count { unsigned long dirs, entries; };
+
+	/**
+	 * Read directory entries of 'dir' and call 'fn' for each entry
+	 */
+	template <typename FN>
+	void _for_each_dirent(Vfs::File_system &vfs, char const *dir, FN const &fn)
+	{
+		Vfs::Vfs_handle *handle = nullptr;
+		if (vfs.opendir(dir, false, &handle, _heap) != Ds::OPENDIR_OK) {
+			error("opendir of '", dir, "' failed");
+			throw Exception();
+		}
+
+		for (unsigned long i = 0; ; i++) {
+
+			Ds::Dirent dirent { };
+			Vfs::file_size out_count = 0;
+
+			handle->seek(i*sizeof(dirent));
+			handle->fs().queue_read(handle, sizeof(dirent));
+
+			if (handle->fs().complete_read(handle, (char *)&dirent, sizeof(dirent),
+			                               out_count) != Fs::READ_OK
+			 || out_count < sizeof(dirent)
+			 || dirent.type == Ds::DIRENT_TYPE_END)
+				break;
+
+			fn(dirent);
+		}
+
+		handle->close();
+	}
+
+	void _traverse(Vfs::File_system &vfs, char const *dir, Count &count)
+	{
+		count.dirs++;
+
+		_for_each_dirent(vfs, dir, [&] (Ds::Dirent const &dirent) {
+
+			count.entries++;
+
+			Path const path(dirent.name, dir);
+
+			Ds::Stat st { };
+			if (vfs.stat(path.base(), st) != Ds::STAT_OK) {
+				error("stat of '", path, "' failed");
+				throw Exception();
+			}
+
+			if (dirent.type == Ds::DIRENT_TYPE_DIRECTORY)
+				_traverse(vfs, path.base(), count);
+		});
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		uint64_t start_ms = _timer.elapsed_ms();
+
+		_vfs_env.construct(_env, _heap, _config.xml().sub_node("vfs"));
+
+		log("VFS created in ", _timer.elapsed_ms() - start_ms, " ms");
+
+		for (unsigned r = 0; r < _rounds; r++) {
+
+			Count count { 0, 0 };
+
+			start_ms = _timer.elapsed_ms();
+			_traverse(_vfs_env->root_dir(), "/", count);
+			uint64_t const duration_ms = max(_timer.elapsed_ms() - start_ms, (uint64_t)1);
+
+			log("traversed ", count.dirs, " directories with ", count.entries,
+			    " entries in ", duration_ms, " ms, ",
+			    count.entries*1000/duration_ms, " entries/s");
+		}
+
+		log("--- tar VFS benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }